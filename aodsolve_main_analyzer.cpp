@@ -2,31 +2,330 @@
 #include "aod/optimization_rule_system.h"
 #include "aod/simd_instruction_rules.h"
 #include "aod/function_inline_rules.h"
+#include "clang/AST/ParentMapContext.h"
 #include <iostream>
+#include <sstream>
+#include <cstdlib>
+#include <cctype>
+#include <mutex>
+#include <functional>
 
 namespace aodsolve {
 
-std::string generateFuncSignature(const clang::FunctionDecl* func, const std::string& suffix) {
-    std::string sig = "void " + func->getNameAsString() + "_" + suffix + "(";
-    bool first = true;
-    for (auto param : func->parameters()) {
-        if (!first) sig += ", ";
-        std::string type = param->getType().getAsString();
-        // 类型映射
-        if (suffix == "SVE" && type.find("__m256i") != std::string::npos) type = "int8_t*"; // 简化假设
-        // Scalar -> NEON 中，float* 保持 float* (vld1 接受 float*)
+// 目标版本的参数类型: AVX2 向量指针改为字节指针 (简化假设)
+// Scalar -> NEON 中，float* 保持 float* (vld1 接受 float*)
+std::string mapParameterType(const std::string& type, const std::string& suffix) {
+    if ((suffix == "SVE" || suffix == "NEON") && type.find("__m256i") != std::string::npos) return "int8_t*";
+    return type;
+}
 
-        sig += type + " " + param->getNameAsString();
-        first = false;
+std::string parameterList(const clang::FunctionDecl* func, const std::string& suffix, bool with_names) {
+    std::string list;
+    for (auto param : func->parameters()) {
+        if (!list.empty()) list += ", ";
+        list += mapParameterType(param->getType().getAsString(), suffix);
+        if (with_names) list += " " + param->getNameAsString();
     }
+    return list;
+}
+
+std::string generateFuncSignature(const clang::FunctionDecl* func, const std::string& suffix) {
+    std::string sig = func->getReturnType().getAsString() + " " + func->getNameAsString() + "_" + suffix + "(";
+    sig += parameterList(func, suffix, true);
     sig += ") {\n";
     if (suffix == "SVE") sig += "    svbool_t pg = svptrue_b8();\n";
     return sig;
 }
 
+// 源函数是否直接使用 x86 SIMD (intrinsic 调用或 __m128/__m256/__m512 类型)
+bool usesX86Intrinsics(const clang::Stmt* stmt) {
+    if (!stmt) return false;
+    if (auto* call = llvm::dyn_cast<clang::CallExpr>(stmt)) {
+        if (auto* callee = call->getDirectCallee()) {
+            std::string name = callee->getNameAsString();
+            if (name.rfind("_mm", 0) == 0 || name.rfind("__builtin_ia32", 0) == 0) return true;
+        }
+    }
+    if (auto* expr = llvm::dyn_cast<clang::Expr>(stmt)) {
+        if (expr->getType().getAsString().find("__m") != std::string::npos) return true;
+    }
+    for (const auto* child : stmt->children()) {
+        if (usesX86Intrinsics(child)) return true;
+    }
+    return false;
+}
+
+// 生成的代码中是否还有 x86 SIMD 名字 (intrinsic、向量类型或 builtin), 有则在 Arm 上无法编译
+bool mentionsX86Simd(const std::string& code) {
+    for (const char* token : {"_mm", "__m64", "__m128", "__m256", "__m512", "__builtin_ia32"}) {
+        for (size_t at = code.find(token); at != std::string::npos; at = code.find(token, at + 1)) {
+            if (at == 0 || !(std::isalnum(static_cast<unsigned char>(code[at - 1])) || code[at - 1] == '_')) return true;
+        }
+    }
+    return false;
+}
+
+// 打印 x86 基线时把指针已知对齐的非对齐访存改为对齐形式 (_mm256_loadu_si256 -> _mm256_load_si256),
+// 对齐要求为向量宽度, 不满足时保持原样.
+// streaming_bytes > 0 时固定步长循环 (while (n >= C) { ...; p += K; n -= K; }) 另输出流式版本:
+// 计数达到工作集阈值时只写的指针用 _mm256_stream_si256 等非临时存储 (要求向量宽度对齐, 运行时检查),
+// 读取的指针用 _mm_prefetch(_MM_HINT_NTA) 提前 prefetch_distance 字节预取, 循环后 _mm_sfence
+class BaselinePrinter : public clang::PrinterHelper {
+public:
+    BaselinePrinter(const AlignmentAnalyzer& alignment, clang::ASTContext& ctx, const clang::PrintingPolicy& policy,
+                    int64_t streaming_bytes, int64_t prefetch_distance)
+        : alignment(alignment), ctx(ctx), policy(policy), streaming_bytes(streaming_bytes), prefetch_distance(prefetch_distance) {}
+
+    bool handledStmt(clang::Stmt* stmt, llvm::raw_ostream& os) override {
+        if (auto* loop = llvm::dyn_cast<clang::WhileStmt>(stmt)) return !active && printStreamingLoop(loop, os);
+        auto* call = llvm::dyn_cast<clang::CallExpr>(stmt);
+        auto* callee = call ? call->getDirectCallee() : nullptr;
+        if (!callee || call->getNumArgs() == 0) return false;
+        static const std::map<std::string, std::pair<std::string, int64_t>> aligned_forms = {
+            {"_mm_loadu_si128", {"_mm_load_si128", 16}}, {"_mm_storeu_si128", {"_mm_store_si128", 16}},
+            {"_mm_loadu_ps", {"_mm_load_ps", 16}}, {"_mm_storeu_ps", {"_mm_store_ps", 16}},
+            {"_mm_loadu_pd", {"_mm_load_pd", 16}}, {"_mm_storeu_pd", {"_mm_store_pd", 16}},
+            {"_mm256_loadu_si256", {"_mm256_load_si256", 32}}, {"_mm256_storeu_si256", {"_mm256_store_si256", 32}},
+            {"_mm256_loadu_ps", {"_mm256_load_ps", 32}}, {"_mm256_storeu_ps", {"_mm256_store_ps", 32}},
+            {"_mm256_loadu_pd", {"_mm256_load_pd", 32}}, {"_mm256_storeu_pd", {"_mm256_store_pd", 32}},
+        };
+        std::string name = callee->getNameAsString();
+        auto stream = streamForms().find(name);
+        if (stream != streamForms().end() && nontemporal.count(pointerOf(call->getArg(0)))) {
+            name = stream->second.first;
+            ++streamed;
+        } else {
+            auto form = aligned_forms.find(name);
+            if (form == aligned_forms.end() || alignment.alignmentOf(call->getArg(0)) < form->second.second) return false;
+            name = form->second.first;
+            ++rewritten;
+        }
+        os << name << "(";
+        for (unsigned i = 0; i < call->getNumArgs(); ++i) {
+            if (i > 0) os << ", ";
+            call->getArg(i)->printPretty(os, this, policy);
+        }
+        os << ")";
+        return true;
+    }
+
+    int rewritten = 0;
+    int streamed = 0;
+    std::vector<std::string> streaming_loops;   // 输出了流式版本的循环
+
+private:
+    const AlignmentAnalyzer& alignment;
+    clang::ASTContext& ctx;
+    const clang::PrintingPolicy& policy;
+    int64_t streaming_bytes;
+    int64_t prefetch_distance;
+    const clang::WhileStmt* active = nullptr;    // 正在输出的循环, 按默认方式打印
+    std::set<const clang::VarDecl*> nontemporal; // 当前流式循环中改用非临时存储的指针
+
+    // 存储 -> (非临时存储, 对齐要求)
+    static const std::map<std::string, std::pair<std::string, int64_t>>& streamForms() {
+        static const std::map<std::string, std::pair<std::string, int64_t>> forms = {
+            {"_mm_storeu_si128", {"_mm_stream_si128", 16}}, {"_mm_store_si128", {"_mm_stream_si128", 16}},
+            {"_mm_storeu_ps", {"_mm_stream_ps", 16}}, {"_mm_store_ps", {"_mm_stream_ps", 16}},
+            {"_mm_storeu_pd", {"_mm_stream_pd", 16}}, {"_mm_store_pd", {"_mm_stream_pd", 16}},
+            {"_mm256_storeu_si256", {"_mm256_stream_si256", 32}}, {"_mm256_store_si256", {"_mm256_stream_si256", 32}},
+            {"_mm256_storeu_ps", {"_mm256_stream_ps", 32}}, {"_mm256_store_ps", {"_mm256_stream_ps", 32}},
+            {"_mm256_storeu_pd", {"_mm256_stream_pd", 32}}, {"_mm256_store_pd", {"_mm256_stream_pd", 32}},
+        };
+        return forms;
+    }
+
+    static const clang::VarDecl* pointerOf(const clang::Expr* expr) {
+        auto* dre = llvm::dyn_cast<clang::DeclRefExpr>(expr->IgnoreParenCasts());
+        return dre ? llvm::dyn_cast<clang::VarDecl>(dre->getDecl()) : nullptr;
+    }
+
+    bool evaluate(const clang::Expr* expr, int64_t& value) const {
+        clang::Expr::EvalResult result;
+        if (expr->isValueDependent() || !expr->EvaluateAsInt(result, ctx)) return false;
+        value = result.Val.getInt().getExtValue();
+        return true;
+    }
+
+    // 语句在 StmtPrinter 中的缩进层数 (每层 2 空格): 函数体内每层 {} 两层, while 的 {} 另起一行再多两层
+    unsigned indentOf(const clang::Stmt* stmt) const {
+        unsigned level = 0;
+        clang::DynTypedNode node = clang::DynTypedNode::create(*stmt);
+        while (true) {
+            auto parents = ctx.getParents(node);
+            if (parents.empty()) return level;
+            node = parents[0];
+            const auto* parent = node.get<clang::Stmt>();
+            if (!parent) return level;
+            if (llvm::isa<clang::CompoundStmt>(parent)) level += 2;
+            if (llvm::isa<clang::WhileStmt>(parent)) level += 2;
+        }
+    }
+
+    bool printStreamingLoop(const clang::WhileStmt* loop, llvm::raw_ostream& os) {
+        if (streaming_bytes <= 0 || loop->getConditionVariable()) return false;
+        auto* cond = llvm::dyn_cast<clang::BinaryOperator>(loop->getCond()->IgnoreParenImpCasts());
+        auto* body = llvm::dyn_cast<clang::CompoundStmt>(loop->getBody());
+        const clang::VarDecl* count = cond ? pointerOf(cond->getLHS()) : nullptr;
+        int64_t bound = 0;
+        if (!body || !count || cond->getOpcode() != clang::BO_GE || !evaluate(cond->getRHS(), bound)) return false;
+
+        // 顶层的 p += K / n -= K, 以及各指针上的加载与存储
+        int64_t step = 0;
+        std::vector<std::pair<const clang::VarDecl*, int64_t>> pointers;
+        std::set<const clang::VarDecl*> loaded, stored;
+        std::map<const clang::VarDecl*, int64_t> store_alignment;
+        std::function<void(const clang::Stmt*)> scan = [&](const clang::Stmt* stmt) {
+            if (!stmt) return;
+            if (auto* call = llvm::dyn_cast<clang::CallExpr>(stmt)) {
+                auto* callee = call->getDirectCallee();
+                std::string name = callee ? callee->getNameAsString() : "";
+                const clang::VarDecl* pointer = call->getNumArgs() > 0 ? pointerOf(call->getArg(0)) : nullptr;
+                auto form = streamForms().find(name);
+                if (pointer && name.find("load") != std::string::npos) loaded.insert(pointer);
+                if (pointer && form != streamForms().end()) {
+                    stored.insert(pointer);
+                    store_alignment[pointer] = std::max(store_alignment[pointer], form->second.second);
+                } else if (pointer && name.find("store") != std::string::npos) {
+                    loaded.insert(pointer);     // 部分写入 (maskstore 等) 保持普通存储
+                }
+            }
+            for (const auto* child : stmt->children()) scan(child);
+        };
+        for (const auto* stmt : body->body()) {
+            scan(stmt);
+            auto* update = llvm::dyn_cast<clang::CompoundAssignOperator>(stmt);
+            const clang::VarDecl* var = update ? pointerOf(update->getLHS()) : nullptr;
+            int64_t amount = 0;
+            if (!var || !evaluate(update->getRHS(), amount)) continue;
+            if (var == count && update->getOpcode() == clang::BO_SubAssign) step = amount;
+            clang::QualType pointee = var->getType()->getPointeeType();
+            if (!pointee.isNull() && !pointee->isIncompleteType() && update->getOpcode() == clang::BO_AddAssign) pointers.push_back({var, amount});
+        }
+        if (step <= 0 || bound < step) return false;
+
+        // 计数每减 1 各指针前进一个元素; 只写且每次迭代前进整数个向量宽度的指针才改用非临时存储
+        int64_t unit = 0;
+        std::vector<const clang::VarDecl*> prefetched;
+        std::vector<std::string> checks;
+        std::string stores;
+        nontemporal.clear();
+        for (const auto& [pointer, amount] : pointers) {
+            if (amount != step) continue;
+            int64_t bytes = ctx.getTypeSizeInChars(pointer->getType()->getPointeeType()).getQuantity();
+            unit += bytes;
+            if (loaded.count(pointer) && prefetch_distance > 0) prefetched.push_back(pointer);
+            if (!stored.count(pointer) || loaded.count(pointer) || (step * bytes) % store_alignment[pointer] != 0) continue;
+            nontemporal.insert(pointer);
+            stores += (stores.empty() ? "non-temporal stores to " : ", ") + pointer->getNameAsString();
+            if (alignment.alignmentOf(pointer) < store_alignment[pointer]) {
+                checks.push_back("((uintptr_t)(" + pointer->getNameAsString() + ") % " + std::to_string(store_alignment[pointer]) + ") == 0");
+            }
+        }
+        if (unit == 0 || (nontemporal.empty() && prefetched.empty())) return false;
+        int64_t min_count = std::max(bound, (streaming_bytes + unit - 1) / unit);
+
+        const unsigned level = indentOf(loop);
+        auto indent = [](unsigned units) { return std::string(2 * units, ' '); };
+        std::string counter = count->getNameAsString();
+        std::string guard = counter + " >= " + std::to_string(min_count);
+        for (const auto& check : checks) guard += " && " + check;
+
+        // 流式版本: 预取放在每次迭代开头, 非临时存储在 handledStmt 中改写
+        active = loop;
+        os << indent(level) << "if (" << guard << ") {\n";
+        os << indent(level + 2) << "while (";
+        loop->getCond()->printPretty(os, this, policy);
+        os << ") {\n";
+        std::string notes;
+        for (const auto* pointer : prefetched) {
+            int64_t bytes = step * ctx.getTypeSizeInChars(pointer->getType()->getPointeeType()).getQuantity();
+            for (int64_t offset = 0; offset < bytes; offset += 64) {
+                os << indent(level + 4) << "_mm_prefetch((const char *)(" << pointer->getNameAsString() << ") + "
+                   << prefetch_distance + offset << ", _MM_HINT_NTA);\n";
+            }
+            notes += (notes.empty() ? "prefetch of " : ", ") + pointer->getNameAsString();
+        }
+        if (!notes.empty()) notes += " " + std::to_string(prefetch_distance) + " bytes ahead";
+        for (const auto* child : body->body()) {
+            if (llvm::isa<clang::Expr>(child)) {
+                os << indent(level + 4);
+                child->printPretty(os, this, policy, level + 4);
+                os << ";\n";
+            } else {
+                child->printPretty(os, this, policy, level + 4);
+            }
+        }
+        os << indent(level + 2) << "}\n";
+        if (!nontemporal.empty()) os << indent(level + 2) << "_mm_sfence();\n";
+        os << indent(level) << "}\n";
+        nontemporal.clear();
+
+        // 普通版本处理工作集较小的调用与流式循环留下的迭代
+        loop->printPretty(os, this, policy, level);
+        active = nullptr;
+
+        unsigned line = ctx.getSourceManager().getPresumedLineNumber(loop->getBeginLoc());
+        streaming_loops.push_back("loop at line " + std::to_string(line) + ": " + stores + (stores.empty() || notes.empty() ? "" : ", ") +
+                                  notes + " once " + guard);
+        return true;
+    }
+};
+
+// 多版本输出的公共头: 特性检测只依赖 getauxval / cpuid, 每个进程在启动时各执行一次
+const char* const kDispatchPreamble = R"(
+// ==== AODSOLVE multi-version support: each function is resolved once at startup ====
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#if defined(__aarch64__)
+#include <sys/auxv.h>
+#include <arm_neon.h>
+#include <arm_sve.h>
+#ifndef HWCAP_ASIMD
+#define HWCAP_ASIMD (1UL << 1)
+#endif
+#ifndef HWCAP_SVE
+#define HWCAP_SVE (1UL << 22)
+#endif
+// SVE bodies are compiled for SVE per function; the rest of the file stays baseline ARMv8-A
+#if defined(__clang__)
+#define AODSOLVE_TARGET_SVE __attribute__((target("sve")))
+#else
+#define AODSOLVE_TARGET_SVE __attribute__((target("+sve")))
+#endif
+#elif defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#include <immintrin.h>
+#define AODSOLVE_TARGET_AVX2 __attribute__((target("avx2")))
+// AVX2 needs the CPUID bit and OS support for YMM state (XCR0 bits 1 and 2)
+static int aodsolve_x86_has_avx2(void) {
+    unsigned eax, ebx, ecx, edx;
+    if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx) || !(ecx & bit_OSXSAVE) || !(ecx & bit_AVX)) return 0;
+    unsigned xcr0_lo, xcr0_hi;
+    __asm__ volatile("xgetbv" : "=a"(xcr0_lo), "=d"(xcr0_hi) : "c"(0));
+    (void)xcr0_hi;
+    if ((xcr0_lo & 6) != 6) return 0;
+    return __get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx) && (ebx & bit_AVX2);
+}
+#endif
+#if !defined(__x86_64__) && !defined(__i386__)
+// x86 vector types kept in the public signatures of translated AVX2 functions (same layout as <immintrin.h>)
+typedef long long __m128i __attribute__((vector_size(16), may_alias));
+typedef float __m128 __attribute__((vector_size(16), may_alias));
+typedef double __m128d __attribute__((vector_size(16), may_alias));
+typedef long long __m256i __attribute__((vector_size(32), may_alias));
+typedef float __m256 __attribute__((vector_size(32), may_alias));
+typedef double __m256d __attribute__((vector_size(32), may_alias));
+#endif
+)";
+
 AODSolveMainAnalyzer::AODSolveMainAnalyzer(clang::ASTContext& ctx)
     : ast_context(ctx), source_manager(ctx.getSourceManager()) {
     target_architecture = "SVE";
+    optimization_level = 2;
+    unroll_factor = VectorLoopOptions{}.unroll;
     initializeComponents();
 }
 
@@ -35,14 +334,45 @@ void AODSolveMainAnalyzer::initializeComponents() {
     converter = std::make_unique<EnhancedCPGToAODConverter>(ast_context, *cpg_analyzer);
     code_generator = std::make_unique<EnhancedCodeGenerator>(ast_context);
 
-    static RuleDatabase global_rule_db;
-    static bool rules_loaded = false;
-    if (!rules_loaded) {
-        SIMDInstructionRuleBuilder simd_builder(&global_rule_db);
-        simd_builder.buildAllRules();
-        rules_loaded = true;
+    refreshRules();
+}
+
+RuleRegistry& AODSolveMainAnalyzer::ruleRegistry() {
+    static RuleRegistry registry = [] {
+        // 规则加载后冻结为只读索引, 各函数的代码生成共用
+        RuleRegistry::Populate builtin = [](RuleDatabase& db) {
+            SIMDInstructionRuleBuilder simd_builder(&db);
+            simd_builder.buildAllRules();
+        };
+        return RuleRegistry(builtin, {"simd_instruction", "scalar_vectorization"});
+    }();
+    static std::once_flag files_added;
+    std::call_once(files_added, [] {
+        const char* paths = std::getenv("AODSOLVE_RULES");
+        std::stringstream list(paths ? paths : "");
+        std::string path;
+        while (std::getline(list, path, ':')) {
+            if (!path.empty()) registry.addRuleFile(path);
+        }
+    });
+    return registry;
+}
+
+void AODSolveMainAnalyzer::refreshRules() {
+    RuleRegistry& registry = ruleRegistry();
+    std::string error;
+    if (!registry.reloadIfChanged(&error) && !error.empty()) {
+        std::cerr << "Error: rule reload failed, keeping previous rules: " << error << std::endl;
     }
-    code_generator->setRuleDatabase(&global_rule_db);
+    auto snapshot = registry.current();
+    if (!snapshot || snapshot == rule_snapshot) return;
+    if (rule_snapshot) {
+        std::cout << "// Rules reloaded (version " << snapshot->version << ", " << snapshot->db->getRuleCount() << " rules)\n";
+        kernel_cache.clear();
+    }
+    rule_snapshot = snapshot;
+    code_generator->setRuleDatabase(rule_snapshot->db.get());
+    code_generator->setRuleIndex(rule_snapshot->index);
 }
 
 ComprehensiveAnalysisResult AODSolveMainAnalyzer::analyzeFunction(const clang::FunctionDecl* func) {
@@ -50,18 +380,21 @@ ComprehensiveAnalysisResult AODSolveMainAnalyzer::analyzeFunction(const clang::F
     if (!source_manager.isInMainFile(func->getLocation())) return result;
 
     std::cout << "\n=== AODSOLVE Analysis: " << func->getNameAsString() << " ===" << std::endl;
+    refreshRules();
 
     try {
         cpg_analyzer->analyzeFunctionWithCPG(func);
 
-        auto conversion_res = converter->convertWithOperators(func, "AVX2", target_architecture);
-
-        code_generator->setTargetArchitecture(target_architecture);
-        auto gen_res = code_generator->generateCodeFromGraph(conversion_res.aod_graph);
+        if (multi_version) {
+            emitMultiVersion(func);
+            result.successful = true;
+            return result;
+        }
 
-        std::cout << "\n// Generated " << target_architecture << " Code:\n";
+        auto body = generateFunctionBody(func);
+        if (!body) return result;
         std::cout << generateFuncSignature(func, target_architecture);
-        std::cout << gen_res.generated_code;
+        std::cout << *body;
         std::cout << "}\n";
 
         result.successful = true;
@@ -72,6 +405,308 @@ ComprehensiveAnalysisResult AODSolveMainAnalyzer::analyzeFunction(const clang::F
     return result;
 }
 
+std::optional<std::string> AODSolveMainAnalyzer::generateFunctionBody(const clang::FunctionDecl* func, std::vector<std::string>* unlowered) {
+    auto conversion_res = converter->convertWithOperators(func, "AVX2", target_architecture);
+    if (!conversion_res.aod_graph) return std::nullopt;
+    AODGraph& graph = *conversion_res.aod_graph;
+
+    // 结构等价的函数 (只差变量名) 直接复用已生成的代码
+    uint64_t hash = graph.canonicalHash();
+    if (auto reused = reuseGeneratedKernel(func, graph, hash, unlowered)) {
+        std::cout << "\n// Generated " << target_architecture << " Code:\n";
+        return reused;
+    }
+
+    auto pipeline_start = std::chrono::steady_clock::now();
+    auto original = std::make_shared<AODGraph>(AODGraph::deserialize(graph.serialize()));
+    runGraphOptimizations(graph);
+
+    code_generator->setTargetArchitecture(target_architecture);
+    code_generator->setUnrollFactor(unroll_factor);
+    code_generator->setFPReassociation(fp_reassociate);
+    code_generator->setAlignPeelThreshold(align_peel_trip);
+    code_generator->setStreamingThreshold(streaming_bytes);
+    code_generator->setPrefetchDistance(prefetch_distance);
+    auto gen_res = code_generator->generateCodeFromGraph(conversion_res.aod_graph);
+    auto pipeline_end = std::chrono::steady_clock::now();
+
+    std::cout << "\n// Generated " << target_architecture << " Code:\n";
+    for (const auto& report : graph.getPassReports()) {
+        std::cout << "// [" << report.pass_name << "] nodes " << report.nodes_before << " -> " << report.nodes_after
+                  << ", rewritten " << report.nodes_changed << ", instructions saved " << report.instructions_saved << "\n";
+        // 访存层次改写逐个列出被改写的循环
+        if (report.pass_name != "MemoryHierarchy") continue;
+        for (const auto& detail : report.details) std::cout << "// [MemoryHierarchy] " << detail << "\n";
+    }
+    for (const auto& note : gen_res.memory_notes) std::cout << "// [MemoryHierarchy] " << note << "\n";
+    reportCriticalPaths(graph, *original, "AVX2");
+
+    GeneratedKernel kernel;
+    kernel.function_name = func->getNameAsString();
+    kernel.graph = original;
+    kernel.variable_names = EnhancedCPGToAODConverter::collectVariableNames(func);
+    for (const auto* param : func->parameters()) kernel.parameter_types.push_back(param->getType().getAsString());
+    kernel.target_architecture = target_architecture;
+    kernel.optimization_level = optimization_level;
+    kernel.unroll_factor = unroll_factor;
+    kernel.fp_reassociate = fp_reassociate;
+    kernel.align_peel_trip = align_peel_trip;
+    kernel.streaming_bytes = streaming_bytes;
+    kernel.prefetch_distance = prefetch_distance;
+    kernel.code = gen_res.generated_code;
+    kernel.unlowered_operations = gen_res.unlowered_operations;
+    if (unlowered) *unlowered = gen_res.unlowered_operations;
+    kernel.pipeline_ms = std::chrono::duration<double, std::milli>(pipeline_end - pipeline_start).count();
+    kernel_cache[hash].push_back(std::move(kernel));
+    return gen_res.generated_code;
+}
+
+void AODSolveMainAnalyzer::emitMultiVersion(const clang::FunctionDecl* func) {
+    if (func->isVariadic()) {
+        std::cout << "// [MultiVersion] " << func->getNameAsString() << " is variadic, skipped\n";
+        return;
+    }
+    if (!dispatch_preamble_emitted) {
+        std::cout << kDispatchPreamble;
+        dispatch_preamble_emitted = true;
+    }
+
+    // Arm 版本各自完整走一遍转换 / 优化 / 生成; 图在优化中被改写, 不能跨架构复用.
+    // 只保留完全降级的版本: 有 x86 intrinsic 回退为源码原样输出的, 在 Arm 上无法编译, 不输出也不分发
+    std::string saved_arch = target_architecture;
+    std::map<std::string, std::string> bodies;
+    std::vector<std::string> dropped;
+    for (const std::string arch : {"SVE", "NEON"}) {
+        target_architecture = arch;
+        std::vector<std::string> unlowered;
+        auto body = generateFunctionBody(func, &unlowered);
+        if (!body) continue;
+        if (unlowered.empty() && !mentionsX86Simd(*body)) {
+            bodies[arch] = *body;
+            continue;
+        }
+        std::string ops;
+        for (const auto& op : unlowered) ops += (ops.empty() ? "" : ", ") + op;
+        dropped.push_back(arch + " (" + (ops.empty() ? std::string("x86 SIMD code left in the body") : "no lowering for " + ops) + ")");
+    }
+    target_architecture = saved_arch;
+
+    std::string name = func->getNameAsString();
+    std::string ret = func->getReturnType().getAsString();
+    bool returns_value = !func->getReturnType()->isVoidType();
+    std::string args, arm_args;
+    for (auto param : func->parameters()) {
+        std::string type = param->getType().getAsString();
+        std::string mapped = mapParameterType(type, "NEON");
+        args += (args.empty() ? "" : ", ") + param->getNameAsString();
+        arm_args += (arm_args.empty() ? "" : ", ") + (mapped == type ? "" : "(" + mapped + ")") + param->getNameAsString();
+    }
+
+    bool x86_source = usesX86Intrinsics(func->getBody());
+    for (auto param : func->parameters()) x86_source = x86_source || param->getType().getAsString().find("__m") != std::string::npos;
+
+    // 基线版本: 标量源码原样保留 (已知对齐的 x86 访存改为对齐形式); 直接使用 AVX2 intrinsic 的源码只能在 AVX2 主机上运行
+    std::string body_text;
+    llvm::raw_string_ostream body_os(body_text);
+    AlignmentAnalyzer alignment(ast_context, func);
+    clang::PrintingPolicy policy = ast_context.getPrintingPolicy();
+    BaselinePrinter aligned_printer(alignment, ast_context, policy, streaming_bytes, prefetch_distance);
+    func->getBody()->printPretty(body_os, &aligned_printer, policy);
+    body_os.flush();
+
+    std::ostringstream out;
+    std::string versions;
+    for (const auto& [arch, body] : bodies) versions += arch + ", ";
+    out << "\n// [MultiVersion] " << name << ": " << versions << (x86_source ? "AVX2" : "scalar") << "\n";
+    for (const auto& reason : dropped) out << "// [MultiVersion] " << name << ": dropped " << reason << "\n";
+    if (x86_source) {
+        out << "// [MultiVersion] " << name << ": no scalar version of the AVX2 source, CPUs without "
+            << versions << "AVX2 abort\n";
+    }
+    if (aligned_printer.rewritten > 0) {
+        out << "// [MultiVersion] " << name << ": " << aligned_printer.rewritten << " x86 accesses use aligned load/store\n";
+    }
+    for (const auto& loop : aligned_printer.streaming_loops) out << "// [MemoryHierarchy] " << name << " AVX2 " << loop << "\n";
+
+    // Arm 版本的参数按目标类型声明 (__m256i* -> int8_t*); 分发入口保持源签名, 经转换参数的桩函数调用 Arm 版本
+    std::string original_params = parameterList(func, "", true);
+    bool remapped = parameterList(func, "NEON", false) != parameterList(func, "", false);
+    std::map<std::string, std::string> entries;
+    if (!bodies.empty()) {
+        out << "#if defined(__aarch64__)\n";
+        if (bodies.count("SVE")) out << "static AODSOLVE_TARGET_SVE " << generateFuncSignature(func, "SVE") << bodies["SVE"] << "}\n";
+        if (bodies.count("NEON")) out << "static " << generateFuncSignature(func, "NEON") << bodies["NEON"] << "}\n";
+        for (const auto& [arch, body] : bodies) {
+            std::string version = name + "_" + arch;
+            entries[arch] = remapped ? version + "_entry" : version;
+            if (!remapped) continue;
+            out << "static " << ret << " " << version << "_entry(" << original_params << ") {\n"
+                << "    " << (returns_value ? "return " : "") << version << "(" << arm_args << ");\n}\n";
+        }
+        out << "#endif\n";
+    }
+
+    std::string baseline = name + (x86_source ? "_AVX2" : "_scalar");
+    if (x86_source) {
+        out << "#if defined(__x86_64__) || defined(__i386__)\n"
+            << "static AODSOLVE_TARGET_AVX2 " << ret << " " << baseline << "(" << original_params << ") " << body_text << "#endif\n";
+        out << "static " << ret << " " << name << "_unsupported(" << original_params << ") {\n";
+        for (auto param : func->parameters()) out << "    (void)" << param->getNameAsString() << ";\n";
+        out << "    fputs(\"" << name << ": no implementation for this CPU\\n\", stderr);\n    abort();\n}\n";
+    } else {
+        out << "static " << ret << " " << baseline << "(" << original_params << ") " << body_text;
+    }
+
+    // 分发: 构造函数在启动时解析一次并缓存函数指针, 之后每次调用只是一次间接调用;
+    // 首次调用桩兜底其它构造函数先于本文件运行的情况
+    std::string fn = name + "_fn";
+    std::string call = std::string(returns_value ? "return " : "") + name + "_impl(" + args + ");";
+    std::string fallback = x86_source ? name + "_unsupported" : baseline;
+    out << "typedef " << ret << " (*" << fn << ")(" << parameterList(func, "", false) << ");\n";
+    out << "static " << fn << " " << name << "_resolve(void) {\n";
+    out << "#if defined(__aarch64__)\n";
+    out << "    unsigned long hwcap = getauxval(AT_HWCAP);\n";
+    if (bodies.count("SVE")) out << "    if (hwcap & HWCAP_SVE) return " << entries["SVE"] << ";\n";
+    if (bodies.count("NEON")) out << "    if (hwcap & HWCAP_ASIMD) return " << entries["NEON"] << ";\n";
+    if (bodies.empty()) out << "    (void)hwcap;\n";
+    out << "#elif defined(__x86_64__) || defined(__i386__)\n";
+    if (x86_source) out << "    if (aodsolve_x86_has_avx2()) return " << baseline << ";\n";
+    out << "#endif\n";
+    out << "    return " << fallback << ";\n";
+    out << "}\n";
+    out << "static " << ret << " " << name << "_first_call(" << original_params << ");\n";
+    out << "static " << fn << " " << name << "_impl = " << name << "_first_call;\n";
+    out << "__attribute__((constructor)) static void " << name << "_init(void) { " << name << "_impl = " << name << "_resolve(); }\n";
+    out << "static " << ret << " " << name << "_first_call(" << original_params << ") {\n";
+    out << "    " << name << "_impl = " << name << "_resolve();\n";
+    out << "    " << call << "\n";
+    out << "}\n";
+    out << ret << " " << name << "(" << original_params << ") {\n";
+    out << "    " << call << "\n";
+    out << "}\n";
+    std::cout << out.str();
+}
+
+AODLowerable AODSolveMainAnalyzer::lowerableOperations() const {
+    auto index = rule_snapshot ? rule_snapshot->index : nullptr;
+    std::string arch = target_architecture;
+    return [index, arch](const std::string& op_name, int lane_bits) {
+        if (!index) return false;
+        auto handle = index->lookup(op_name, arch);
+        if (!handle) return false;
+        if (lane_bits == 0) return true;
+        // 有类型的目标 (SVE) 上模板的通道位宽必须与数据一致
+        auto elem = handle.target->performance_hints.find("element_type");
+        return elem != handle.target->performance_hints.end() && elementTypeBits(elem->second) == lane_bits;
+    };
+}
+
+void AODSolveMainAnalyzer::runGraphOptimizations(AODGraph& graph) {
+    if (optimization_level < 1) return;
+    graph.constantPropagation();
+    graph.strengthReduction(target_architecture, lowerableOperations());
+    if (optimization_level >= 2) graph.equalitySaturation(target_architecture, lowerableOperations());
+    graph.commonSubexpressionElimination();
+    if (optimization_level >= 2) graph.loopInvariantCodeMotion();
+    graph.eliminateDeadCode();
+    if (optimization_level >= 2) graph.ifConversion();
+    graph.vectorLengthAgnosticLoops(target_architecture);
+    if (streaming_bytes > 0) graph.memoryHierarchy(target_architecture, streaming_bytes, prefetch_distance);
+}
+
+void AODSolveMainAnalyzer::reportCriticalPaths(AODGraph& graph, const AODGraph& source_graph, const std::string& source_arch) {
+    graph.annotateLatencies(target_architecture);
+    auto source = source_graph.analyzeCriticalPaths(source_arch);
+    auto target = graph.analyzeCriticalPaths(target_architecture);
+
+    std::ostringstream oss;
+    oss.setf(std::ios::fixed);
+    oss.precision(2);
+    for (const auto& t : target) {
+        if (t.operation_count == 0) continue;
+        // 优化会增删节点, 循环按头节点与优化前的图对应; 循环被删掉的只输出目标侧
+        const AODCriticalPathReport* s = nullptr;
+        for (const auto& candidate : source) {
+            if (candidate.loop_header == t.loop_header) s = &candidate;
+        }
+        oss << "// [CriticalPath] " << (t.loop_id < 0 ? std::string("function") : "loop " + std::to_string(t.loop_header)) << ": ";
+        if (s) {
+            oss << source_arch << " " << s->critical_latency << " cycles, ILP " << s->ilp;
+            if (s->recurrence_latency > 0) oss << ", recurrence " << s->recurrence_latency;
+            oss << " -> ";
+        }
+        oss << target_architecture << " " << t.critical_latency << " cycles, ILP " << t.ilp << " (" << t.operation_count << " ops";
+        if (t.loop_id >= 0) oss << ", ~" << t.cycles_per_iteration << " cycles/iteration";
+        if (t.recurrence_bound) {
+            oss << ", recurrence-bound " << t.recurrence_latency << " cycles";
+        } else {
+            if (t.recurrence_latency > 0) oss << ", recurrence " << t.recurrence_latency << " cycles";
+            if (t.latency_bound) oss << ", latency-bound, interleave x" << t.suggested_interleave;
+        }
+        oss << ")\n";
+        if (t.path.size() > 1) {
+            oss << "//   chain:";
+            bool first = true;
+            for (int id : t.path) {
+                auto node = graph.getNode(id);
+                if (!node || node->getProperty("op_name") == "define") continue;
+                oss << (first ? " " : " -> ") << node->getProperty("op_name");
+                first = false;
+            }
+            oss << "\n";
+        }
+        if (t.recurrence_latency > 0) {
+            // 递推环以写入语句结束, 写入的变量回到下一次迭代的起点
+            oss << "//   recurrence:";
+            bool first = true;
+            for (int id : t.recurrence_path) {
+                auto node = graph.getNode(id);
+                if (!node) continue;
+                std::string op = node->getProperty("op_name");
+                if (op.empty() || op == "define") op = node->getProperty("assigns") + " " + node->getProperty("assign_op") + "=";
+                oss << (first ? " " : " -> ") << op;
+                first = false;
+            }
+            oss << "\n";
+        }
+    }
+    std::cout << oss.str();
+}
+
+std::optional<std::string> AODSolveMainAnalyzer::reuseGeneratedKernel(const clang::FunctionDecl* func, const AODGraph& graph, uint64_t hash,
+                                                                       std::vector<std::string>* unlowered) {
+    auto it = kernel_cache.find(hash);
+    if (it == kernel_cache.end()) return std::nullopt;
+
+    std::vector<std::string> parameter_types;
+    for (const auto* param : func->parameters()) parameter_types.push_back(param->getType().getAsString());
+    auto names = EnhancedCPGToAODConverter::collectVariableNames(func);
+
+    for (const auto& kernel : it->second) {
+        if (kernel.target_architecture != target_architecture || kernel.optimization_level != optimization_level ||
+            kernel.unroll_factor != unroll_factor || kernel.fp_reassociate != fp_reassociate ||
+            kernel.align_peel_trip != align_peel_trip || kernel.streaming_bytes != streaming_bytes ||
+            kernel.prefetch_distance != prefetch_distance) continue;
+        if (kernel.parameter_types != parameter_types || kernel.variable_names.size() != names.size()) continue;
+        // 哈希碰撞时以精确同构判定为准
+        if (!graph.isIsomorphicTo(*kernel.graph)) continue;
+
+        // 语句形状中的 $N 按变量首次出现顺序编号, 同构时两函数的变量按下标一一对应
+        std::map<std::string, std::string> renames;
+        for (size_t i = 0; i < names.size(); ++i) {
+            if (kernel.variable_names[i] != names[i]) renames[kernel.variable_names[i]] = names[i];
+        }
+        reused_kernels++;
+        reused_time_ms += kernel.pipeline_ms;
+        std::cout << "\n// [KernelDedup] " << func->getNameAsString() << " is structurally identical to "
+                  << kernel.function_name << ", reused its code (" << renames.size() << " variables renamed, saved "
+                  << kernel.pipeline_ms << " ms; total " << reused_kernels << " kernels, " << reused_time_ms << " ms)";
+        if (unlowered) *unlowered = kernel.unlowered_operations;
+        return EnhancedCPGToAODConverter::renameIdentifiers(kernel.code, renames);
+    }
+    return std::nullopt;
+}
+
 // Empty Stubs
 ComprehensiveAnalysisResult AODSolveMainAnalyzer::analyzeTranslationUnit() { return {}; }
 ComprehensiveAnalysisResult AODSolveMainAnalyzer::analyzeFile(const std::string&) { return {}; }
@@ -13,6 +13,8 @@
 #include <iostream>
 #include <fstream>
 #include <chrono>
+#include <optional>
+#include <unordered_map>
 
 namespace aodsolve {
 
@@ -66,6 +68,11 @@ private:
     // 配置
     std::string target_architecture;
     int optimization_level;
+    int unroll_factor;                             // NEON 循环主体的展开路数
+    bool fp_reassociate = false;                   // 浮点 sum/product 归约允许重结合
+    int64_t align_peel_trip = 0;                   // 剩余迭代数达到该值的 NEON / SVE 循环先剥离到对齐, 0 表示不剥离
+    int64_t streaming_bytes = 0;                   // 工作集达到该字节数的循环用非临时存储与预取, 0 表示关闭
+    int64_t prefetch_distance = 512;               // 预取提前的字节数
     bool enable_interprocedural_analysis;
     bool generate_visualizations;
     bool generate_reports;
@@ -75,6 +82,34 @@ private:
     std::map<const clang::FunctionDecl*, ComprehensiveAnalysisResult> analysis_cache;
     std::map<std::string, std::string> intermediate_files;
 
+    // 结构等价函数复用已生成的代码 (按 AOD 图规范哈希索引), 只需重命名变量
+    struct GeneratedKernel {
+        std::string function_name;
+        std::shared_ptr<AODGraph> graph;           // 优化前的图副本
+        std::vector<std::string> variable_names;
+        std::vector<std::string> parameter_types;
+        std::string target_architecture;
+        int optimization_level = 0;
+        int unroll_factor = 0;
+        bool fp_reassociate = false;
+        int64_t align_peel_trip = 0;
+        int64_t streaming_bytes = 0;
+        int64_t prefetch_distance = 0;
+        std::string code;                          // 函数体, 不含签名
+        std::vector<std::string> unlowered_operations;
+        double pipeline_ms = 0.0;                  // 图优化 + 代码生成耗时
+    };
+    std::unordered_map<uint64_t, std::vector<GeneratedKernel>> kernel_cache;
+    int reused_kernels = 0;
+    double reused_time_ms = 0.0;
+
+    // 当前翻译使用的规则快照; 规则热重载后在下一个函数开始时切换
+    std::shared_ptr<const RuleSnapshot> rule_snapshot;
+
+    // 多版本输出: 每个函数生成 SVE / NEON / 基线版本与启动时解析一次的分发入口
+    bool multi_version = false;
+    bool dispatch_preamble_emitted = false;
+
 public:
     explicit AODSolveMainAnalyzer(clang::ASTContext& ctx);
     ~AODSolveMainAnalyzer() = default;
@@ -112,11 +147,20 @@ public:
     // 配置管理
     void setTargetArchitecture(const std::string& arch) { target_architecture = arch; }
     void setOptimizationLevel(int level) { optimization_level = level; }
+    void setUnrollFactor(int factor) { unroll_factor = factor; }
+    void enableFPReassociation(bool enable) { fp_reassociate = enable; }
+    void setAlignPeelThreshold(int64_t trip) { align_peel_trip = trip; }
+    void setStreamingThreshold(int64_t bytes) { streaming_bytes = bytes; }
+    void setPrefetchDistance(int64_t distance) { prefetch_distance = distance; }
+    void enableMultiVersioning(bool enable) { multi_version = enable; }
     void enableInterproceduralAnalysis(bool enable) { enable_interprocedural_analysis = enable; }
     void enableVisualizations(bool enable) { generate_visualizations = enable; }
     void enableReportGeneration(bool enable) { generate_reports = enable; }
     void saveIntermediateResults(bool save) { save_intermediate_results = save; }
 
+    // 进程内共享的规则注册表: 内置规则 + 环境变量 AODSOLVE_RULES 列出的 JSON 规则文件 (':' 分隔)
+    static RuleRegistry& ruleRegistry();
+
     // 报告生成
     std::string generateComprehensiveReport(const ComprehensiveAnalysisResult& result);
     std::string generatePerformanceReport(const ComprehensiveAnalysisResult& result);
@@ -187,6 +231,23 @@ public:
 private:
     // 内部实现方法
     void initializeComponents();
+    // 规则文件有变化时重载, 快照更新后清空已生成函数的缓存
+    void refreshRules();
+    // 代码生成前在 AOD 图上运行的优化 pass (按 optimization_level 选择)
+    void runGraphOptimizations(AODGraph& graph);
+    // 当前规则快照在 target_architecture 上能生成的运算 (改写类 pass 只引入这些运算)
+    AODLowerable lowerableOperations() const;
+    // 输出源/目标架构下延迟加权的关键路径、循环递推与 ILP, 并把延迟写入图的边权重;
+    // 源架构按优化前的图 source 分析, 目标架构按优化后的 graph 分析
+    void reportCriticalPaths(AODGraph& graph, const AODGraph& source, const std::string& source_arch);
+    // 查找与 graph 同构且配置相同的已生成函数, 返回重命名后的函数体
+    std::optional<std::string> reuseGeneratedKernel(const clang::FunctionDecl* func, const AODGraph& graph, uint64_t hash,
+                                                    std::vector<std::string>* unlowered = nullptr);
+    // 按当前 target_architecture 转换、优化并生成函数体 (不含签名), 同时输出 pass 报告;
+    // unlowered 非空时填入没有目标模板、按源码原样输出的 x86 intrinsic
+    std::optional<std::string> generateFunctionBody(const clang::FunctionDecl* func, std::vector<std::string>* unlowered = nullptr);
+    // 多版本输出: 完全降级的 Arm 版本 + 基线版本 + 保持源签名的函数指针分发入口
+    void emitMultiVersion(const clang::FunctionDecl* func);
     ComprehensiveAnalysisResult performSingleFunctionAnalysis(const clang::FunctionDecl* func);
     void updateProgress(const std::string& message, int progress, int total);
 
@@ -5,6 +5,24 @@
 #include <stack>
 #include <sstream>
 #include <iostream>
+#include <map>
+#include <functional>
+#include <cmath>
+#include <cstring>
+#include <cstdlib>
+#include <cctype>
+#include <cerrno>
+#include <climits>
+#include <unordered_set>
+#include <fstream>
+#include <chrono>
+#include <tuple>
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
 
 namespace aodsolve {
 
@@ -25,9 +43,42 @@ void AODGraph::addNode(std::shared_ptr<AODNode> node) {
     nodes.push_back(node);
     node_map[node->getId()] = node;
     nodes_by_name[node->getName()] = node;
+    invalidateControlFlow();
 }
 
-bool AODGraph::removeNode(int /*node_id*/) { return false; }
+bool AODGraph::removeNode(int node_id) {
+    auto it = node_map.find(node_id);
+    if (it == node_map.end()) return false;
+    auto node = it->second;
+
+    // 删除语句节点时保持控制流连通: pred -> node -> succ 改为 pred -> succ
+    std::vector<std::shared_ptr<AODEdge>> in_ctrl, out_ctrl;
+    for (const auto& edge : edges) {
+        if (edge->getType() != AODEdgeType::Control) continue;
+        bool from = edge->getSource() == node, to = edge->getTarget() == node;
+        if (to && !from) in_ctrl.push_back(edge);
+        if (from && !to) out_ctrl.push_back(edge);
+    }
+
+    edges.erase(std::remove_if(edges.begin(), edges.end(), [&](const std::shared_ptr<AODEdge>& edge) {
+        return edge->getSource() == node || edge->getTarget() == node;
+    }), edges.end());
+
+    for (const auto& in : in_ctrl) {
+        for (const auto& out : out_ctrl) {
+            const std::string& label = out->getProperties().variable_name == "back"
+                ? out->getProperties().variable_name : in->getProperties().variable_name;
+            addEdge(in->getSource(), out->getTarget(), AODEdgeType::Control, label);
+        }
+    }
+
+    nodes.erase(std::remove(nodes.begin(), nodes.end(), node), nodes.end());
+    node_map.erase(node_id);
+    auto by_name = nodes_by_name.find(node->getName());
+    if (by_name != nodes_by_name.end() && by_name->second == node) nodes_by_name.erase(by_name);
+    invalidateControlFlow();
+    return true;
+}
 
 std::shared_ptr<AODNode> AODGraph::getNode(int node_id) const {
     auto it = node_map.find(node_id);
@@ -44,13 +95,22 @@ void AODGraph::addEdge(std::shared_ptr<AODNode> source, std::shared_ptr<AODNode>
     auto edge = std::make_shared<AODEdge>(source, target, type);
     edge->setVariableName(variable);
     edges.push_back(edge);
+    if (type == AODEdgeType::Control) invalidateControlFlow();
 }
 
 void AODGraph::addEdge(std::shared_ptr<AODNode> source, std::shared_ptr<AODNode> target, AODEdgeType type) {
     addEdge(source, target, type, "");
 }
 
-bool AODGraph::removeEdge(int /*source_id*/, int /*target_id*/) { return false; }
+bool AODGraph::removeEdge(int source_id, int target_id) {
+    size_t before = edges.size();
+    edges.erase(std::remove_if(edges.begin(), edges.end(), [&](const std::shared_ptr<AODEdge>& edge) {
+        return edge->getSource()->getId() == source_id && edge->getTarget()->getId() == target_id;
+    }), edges.end());
+    if (edges.size() == before) return false;
+    invalidateControlFlow();
+    return true;
+}
 
 std::vector<std::shared_ptr<AODEdge>> AODGraph::getEdgesFrom(int node_id) const {
     std::vector<std::shared_ptr<AODEdge>> result;
@@ -68,6 +128,121 @@ std::vector<std::shared_ptr<AODEdge>> AODGraph::getEdgesTo(int node_id) const {
     return result;
 }
 
+bool AODGraph::isOperandEdge(const AODEdge& edge) {
+    if (edge.getType() != AODEdgeType::Data) return false;
+    const std::string& var = edge.getProperties().variable_name;
+    return var == "init" || var.rfind("arg_", 0) == 0;
+}
+
+int AODGraph::getOperandIndex(const AODEdge& edge) {
+    const std::string& var = edge.getProperties().variable_name;
+    if (var == "init") return 0;
+    if (var.rfind("arg_", 0) == 0) return std::stoi(var.substr(4));
+    return -1;
+}
+
+int AODGraph::getStatementAnchor(const AODNode& node) {
+    const std::string anchor = node.getProperty("stmt_anchor");
+    if (anchor.empty()) return -1;
+    char* end = nullptr;
+    errno = 0;
+    long id = std::strtol(anchor.c_str(), &end, 10);
+    // 导入的图或手工编辑的属性可能不合法, 按没有所属语句处理
+    if (errno != 0 || *end != '\0' || id < 0 || id > INT_MAX) return -1;
+    return static_cast<int>(id);
+}
+
+std::shared_ptr<AODNode> AODGraph::getOperand(int node_id, int index) const {
+    for (const auto& edge : edges) {
+        if (edge->getTarget()->getId() == node_id && isOperandEdge(*edge) && getOperandIndex(*edge) == index) {
+            return edge->getSource();
+        }
+    }
+    return nullptr;
+}
+
+std::vector<std::shared_ptr<AODNode>> AODGraph::getOperandUsers(int node_id) const {
+    std::vector<std::shared_ptr<AODNode>> users;
+    for (const auto& edge : edges) {
+        if (edge->getSource()->getId() == node_id && isOperandEdge(*edge)) users.push_back(edge->getTarget());
+    }
+    return users;
+}
+
+int AODGraph::replaceAllUsesWith(const std::shared_ptr<AODNode>& from, const std::shared_ptr<AODNode>& to) {
+    if (!from || !to || from == to) return 0;
+    int rewritten = 0;
+    for (auto& edge : edges) {
+        if (edge->getSource() != from || !isOperandEdge(*edge)) continue;
+        auto replacement = std::make_shared<AODEdge>(to, edge->getTarget(), edge->getType());
+        replacement->getProperties() = edge->getProperties();
+        edge = replacement;
+        rewritten++;
+    }
+    return rewritten;
+}
+
+// 按操作数边做拓扑排序 (同层按节点在图中的顺序), 保证操作数先于使用者
+std::vector<int> AODGraph::operandTopologicalOrder() const {
+    std::unordered_map<int, size_t> position;
+    for (size_t i = 0; i < nodes.size(); ++i) position[nodes[i]->getId()] = i;
+
+    std::unordered_map<int, int> pending;
+    std::unordered_map<int, std::vector<int>> users;
+    for (const auto& edge : edges) {
+        if (!isOperandEdge(*edge)) continue;
+        users[edge->getSource()->getId()].push_back(edge->getTarget()->getId());
+        pending[edge->getTarget()->getId()]++;
+    }
+
+    auto later = [&](int a, int b) { return position[a] > position[b]; };
+    std::priority_queue<int, std::vector<int>, decltype(later)> ready(later);
+    for (const auto& node : nodes) {
+        if (pending[node->getId()] == 0) ready.push(node->getId());
+    }
+
+    std::vector<int> order;
+    while (!ready.empty()) {
+        int id = ready.top();
+        ready.pop();
+        order.push_back(id);
+        for (int user : users[id]) {
+            if (--pending[user] == 0) ready.push(user);
+        }
+    }
+    return order;
+}
+
+// 删除不再被使用的表达式节点及其独占的操作数子树, 返回删除的节点数
+int AODGraph::removeDeadOperands(const std::vector<std::shared_ptr<AODNode>>& candidates) {
+    std::vector<std::shared_ptr<AODNode>> worklist(candidates.begin(), candidates.end());
+    int removed = 0;
+    while (!worklist.empty()) {
+        auto node = worklist.back();
+        worklist.pop_back();
+        if (!node || !getNode(node->getId()) || node->isStatement()) continue;
+
+        std::string op = node->getProperty("op_name");
+        bool removable = node->isSideEffectFree() &&
+                         (isPureOperationName(op) || op.find("load") != std::string::npos);
+        if (!removable) continue;
+
+        bool used = false;
+        std::vector<std::shared_ptr<AODNode>> operands;
+        for (const auto& edge : edges) {
+            if (edge->getType() != AODEdgeType::Data) continue;
+            if (edge->getSource() == node) { used = true; break; }
+            if (edge->getTarget() == node) operands.push_back(edge->getSource());
+        }
+        if (used) continue;
+
+        removeNode(node->getId());
+        removed++;
+        worklist.insert(worklist.end(), operands.begin(), operands.end());
+    }
+    return removed;
+}
+
 // Analysis Methods
 void AODGraph::computeVariableDefinitions() {
     variable_defs_map.clear();
@@ -89,59 +264,3116 @@ std::set<std::string> AODGraph::getVariablesAtNode(int /*node_id*/) const { retu
 std::set<std::shared_ptr<AODNode>> AODGraph::getDefinitionsOf(const std::string& /*variable*/) const { return {}; }
 std::set<std::shared_ptr<AODNode>> AODGraph::getUsesOf(const std::string& /*variable*/) const { return {}; }
 
-void AODGraph::computeDominators() {}
-std::vector<int> AODGraph::getImmediateDominators() const { return {}; }
-std::set<int> AODGraph::getDominators(int /*node_id*/) const { return {}; }
-bool AODGraph::isDominatedBy(int /*dominated*/, int /*dominator*/) const { return false; }
-bool AODGraph::isCyclic() const { return false; }
+// ============================================
+// 控制流分析: 支配树 (Cooper-Harvey-Kennedy) 与循环嵌套森林 (Havlak)
+// 只考虑 Control 边; 表达式节点通过 stmt_anchor 属性归属到其所在语句
+// ============================================
 
-std::vector<int> AODGraph::getEntryNodes() const { return {}; }
-std::vector<int> AODGraph::getExitNodes() const { return {}; }
+void AODGraph::computeDominators() {
+    invalidateControlFlow();
+    ensureControlFlow();
+}
 
-void AODGraph::eliminateDeadCode() {}
-void AODGraph::constantPropagation() {}
-void AODGraph::commonSubexpressionElimination() {}
+void AODGraph::computePostDominators() {
+    invalidateControlFlow();
+    ensureControlFlow();
+}
 
-bool AODGraph::isValid() const { return true; }
-std::vector<std::string> AODGraph::getValidationErrors() const { return {}; }
-void AODGraph::validateCycles() const {}
-void AODGraph::validateNoOrphanedNodes() const {}
+void AODGraph::ensureControlFlow() const {
+    if (cfg_info.valid) return;
+    buildControlFlowIndex();
+    computeDominatorTree(false);
+    computeDominatorTree(true);
+    computeLoopForest();
+    cfg_info.valid = true;
+}
 
-std::string AODGraph::toDOT() const {
-    std::ostringstream oss;
-    oss << "digraph " << name << " {\n";
+void AODGraph::buildControlFlowIndex() const {
+    ControlFlowInfo& cfg = cfg_info;
+    cfg = ControlFlowInfo{};
+
+    std::set<int> in_cfg;
+    for (const auto& edge : edges) {
+        if (edge->getType() != AODEdgeType::Control) continue;
+        in_cfg.insert(edge->getSource()->getId());
+        in_cfg.insert(edge->getTarget()->getId());
+    }
+    // 按 nodes 顺序编号, 保证结果与源码顺序一致
     for (const auto& node : nodes) {
-        oss << "  " << node->getId() << " [label=\"" << node->getDOTLabel() << "\", " << node->getDOTStyle() << "];\n";
+        bool boundary = node->getType() == AODNodeType::Entry || node->getType() == AODNodeType::Exit;
+        if (!in_cfg.count(node->getId()) && !boundary) continue;
+        cfg.index[node->getId()] = static_cast<int>(cfg.ids.size());
+        cfg.ids.push_back(node->getId());
     }
+
+    const size_t n = cfg.ids.size();
+    cfg.succs.assign(n, {});
+    cfg.preds.assign(n, {});
     for (const auto& edge : edges) {
-        oss << "  " << edge->getSource()->getId() << " -> " << edge->getTarget()->getId() << ";\n";
+        if (edge->getType() != AODEdgeType::Control) continue;
+        auto s = cfg.index.find(edge->getSource()->getId());
+        auto t = cfg.index.find(edge->getTarget()->getId());
+        if (s == cfg.index.end() || t == cfg.index.end()) continue;
+        auto& out = cfg.succs[s->second];
+        if (std::find(out.begin(), out.end(), t->second) != out.end()) continue;
+        out.push_back(t->second);
+        cfg.preds[t->second].push_back(s->second);
+    }
+
+    for (size_t i = 0; i < n; ++i) {
+        auto node = getNode(cfg.ids[i]);
+        if (node && node->getType() == AODNodeType::Entry) cfg.roots.push_back(static_cast<int>(i));
+    }
+    if (cfg.roots.empty()) {
+        for (size_t i = 0; i < n; ++i) {
+            if (cfg.preds[i].empty()) cfg.roots.push_back(static_cast<int>(i));
+        }
     }
-    oss << "}\n";
-    return oss.str();
 }
 
-AODGraph::GraphStatistics AODGraph::getStatistics() const {
-    GraphStatistics stats;
-    stats.node_count = nodes.size();
-    stats.edge_count = edges.size();
+void AODGraph::computeDominatorTree(bool post) const {
+    ControlFlowInfo& cfg = cfg_info;
+    DominatorTree& tree = post ? cfg.pdom : cfg.dom;
+    const int n = static_cast<int>(cfg.ids.size());
+    const int root = n; // 虚拟根, 连接全部入口(后支配时连接全部出口)
+
+    const auto& fwd = post ? cfg.preds : cfg.succs;
+    const auto& bwd = post ? cfg.succs : cfg.preds;
+
+    std::vector<int> starts;
+    if (post) {
+        for (int i = 0; i < n; ++i) {
+            auto node = getNode(cfg.ids[i]);
+            if (cfg.succs[i].empty() || (node && node->getType() == AODNodeType::Exit)) starts.push_back(i);
+        }
+    } else {
+        starts = cfg.roots;
+    }
+    std::vector<char> is_start(n + 1, 0);
+    for (int s : starts) is_start[s] = 1;
+
+    auto successors = [&](int v) -> const std::vector<int>& { return v == root ? starts : fwd[v]; };
+
+    // 迭代 DFS 求逆后序
+    std::vector<int> rpo_num(n + 1, -1);
+    std::vector<int> postorder;
+    postorder.reserve(n + 1);
+    {
+        std::vector<char> seen(n + 1, 0);
+        std::vector<std::pair<int, size_t>> stack{{root, 0}};
+        seen[root] = 1;
+        while (!stack.empty()) {
+            auto& [v, next] = stack.back();
+            const auto& out = successors(v);
+            if (next < out.size()) {
+                int w = out[next++];
+                if (!seen[w]) { seen[w] = 1; stack.push_back({w, 0}); }
+            } else {
+                postorder.push_back(v);
+                stack.pop_back();
+            }
+        }
+    }
+    std::vector<int> rpo(postorder.rbegin(), postorder.rend());
+    for (size_t i = 0; i < rpo.size(); ++i) rpo_num[rpo[i]] = static_cast<int>(i);
+
+    tree.idom.assign(n + 1, -1);
+    tree.idom[root] = root;
+    auto intersect = [&](int a, int b) {
+        while (a != b) {
+            while (rpo_num[a] > rpo_num[b]) a = tree.idom[a];
+            while (rpo_num[b] > rpo_num[a]) b = tree.idom[b];
+        }
+        return a;
+    };
+
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (int v : rpo) {
+            if (v == root) continue;
+            int new_idom = -1;
+            auto consider = [&](int p) {
+                if (p < 0 || tree.idom[p] == -1) return;
+                new_idom = (new_idom == -1) ? p : intersect(p, new_idom);
+            };
+            if (is_start[v]) consider(root);
+            for (int p : bwd[v]) consider(p);
+            if (new_idom != tree.idom[v]) {
+                tree.idom[v] = new_idom;
+                changed = true;
+            }
+        }
+    }
+
+    // 支配树 DFS 区间编号, 使支配查询为 O(1)
+    std::vector<std::vector<int>> children(n + 1);
+    for (int v = 0; v < n; ++v) {
+        if (tree.idom[v] >= 0) children[tree.idom[v]].push_back(v);
+    }
+    tree.pre.assign(n + 1, -1);
+    tree.post.assign(n + 1, -1);
+    int clock = 0;
+    std::vector<std::pair<int, size_t>> stack{{root, 0}};
+    tree.pre[root] = clock++;
+    while (!stack.empty()) {
+        auto& [v, next] = stack.back();
+        if (next < children[v].size()) {
+            int w = children[v][next++];
+            tree.pre[w] = clock++;
+            stack.push_back({w, 0});
+        } else {
+            tree.post[v] = clock++;
+            stack.pop_back();
+        }
+    }
+}
+
+void AODGraph::computeLoopForest() const {
+    ControlFlowInfo& cfg = cfg_info;
+    const int n = static_cast<int>(cfg.ids.size());
+    cfg.loop_of.assign(n, -1);
+    cfg.loops.clear();
+    if (n == 0) return;
+
+    // 1. 从全部入口做 DFS 前序编号, last[v] 为 v 子树内最大前序号
+    std::vector<int> number(n, -1), last(n, -1), by_number;
+    by_number.reserve(n);
+    {
+        std::vector<std::pair<int, size_t>> stack;
+        for (int r : cfg.roots) {
+            if (number[r] != -1) continue;
+            number[r] = static_cast<int>(by_number.size());
+            by_number.push_back(r);
+            stack.push_back({r, 0});
+            while (!stack.empty()) {
+                auto& [v, next] = stack.back();
+                if (next < cfg.succs[v].size()) {
+                    int w = cfg.succs[v][next++];
+                    if (number[w] == -1) {
+                        number[w] = static_cast<int>(by_number.size());
+                        by_number.push_back(w);
+                        stack.push_back({w, 0});
+                    }
+                } else {
+                    last[v] = static_cast<int>(by_number.size()) - 1;
+                    stack.pop_back();
+                }
+            }
+        }
+    }
+    auto isAncestor = [&](int w, int v) {
+        return number[w] <= number[v] && number[v] <= last[w];
+    };
+
+    // 2. 划分回边与非回边前驱
+    std::vector<std::vector<int>> back_preds(n), non_back_preds(n);
+    for (int w = 0; w < n; ++w) {
+        if (number[w] == -1) continue;
+        for (int v : cfg.preds[w]) {
+            if (number[v] == -1) continue;
+            (isAncestor(w, v) ? back_preds[w] : non_back_preds[w]).push_back(v);
+        }
+    }
+
+    // 3. 按逆前序自内向外折叠循环, 并查集代表元为已识别循环的头节点
+    std::vector<int> uf(n);
+    for (int i = 0; i < n; ++i) uf[i] = i;
+    auto find = [&](int x) {
+        while (uf[x] != x) { uf[x] = uf[uf[x]]; x = uf[x]; }
+        return x;
+    };
+    std::vector<int> header_loop(n, -1);
+    std::vector<char> in_body(n, 0);
+
+    for (auto it = by_number.rbegin(); it != by_number.rend(); ++it) {
+        int w = *it;
+        if (back_preds[w].empty()) continue;
+
+        AODLoop loop;
+        loop.id = static_cast<int>(cfg.loops.size());
+        loop.header = cfg.ids[w];
+
+        std::vector<int> members, worklist;
+        for (int v : back_preds[w]) {
+            loop.latches.push_back(cfg.ids[v]);
+            if (v == w) continue;
+            int rep = find(v);
+            if (!in_body[rep]) { in_body[rep] = 1; members.push_back(rep); worklist.push_back(rep); }
+        }
+        while (!worklist.empty()) {
+            int x = worklist.back();
+            worklist.pop_back();
+            for (int y : non_back_preds[x]) {
+                int rep = find(y);
+                if (!isAncestor(w, rep)) {
+                    loop.irreducible = true;
+                } else if (rep != w && !in_body[rep]) {
+                    in_body[rep] = 1;
+                    members.push_back(rep);
+                    worklist.push_back(rep);
+                }
+            }
+        }
+
+        for (int x : members) {
+            in_body[x] = 0;
+            uf[x] = w;
+            if (header_loop[x] >= 0) cfg.loops[header_loop[x]].parent = loop.id;
+            else cfg.loop_of[x] = loop.id;
+        }
+        cfg.loop_of[w] = loop.id;
+        header_loop[w] = loop.id;
+        cfg.loops.push_back(std::move(loop));
+    }
+
+    // 4. 展开循环体、嵌套关系与深度
+    for (int v = 0; v < n; ++v) {
+        for (int l = cfg.loop_of[v]; l >= 0; l = cfg.loops[l].parent) {
+            cfg.loops[l].body.push_back(cfg.ids[v]);
+        }
+    }
+    for (auto& loop : cfg.loops) {
+        if (loop.parent >= 0) cfg.loops[loop.parent].children.push_back(loop.id);
+        int depth = 1;
+        for (int p = loop.parent; p >= 0; p = cfg.loops[p].parent) depth++;
+        loop.depth = depth;
+    }
+}
+
+int AODGraph::cfgIndexOf(int node_id) const {
+    ensureControlFlow();
+    auto it = cfg_info.index.find(node_id);
+    if (it != cfg_info.index.end()) return it->second;
+
+    // 表达式节点归属到其所在语句
+    auto node = getNode(node_id);
+    if (!node) return -1;
+    int anchor = getStatementAnchor(*node);
+    if (anchor < 0) return -1;
+    it = cfg_info.index.find(anchor);
+    return it != cfg_info.index.end() ? it->second : -1;
+}
+
+std::vector<int> AODGraph::getImmediateDominators() const {
+    std::vector<int> result;
+    result.reserve(nodes.size());
+    for (const auto& node : nodes) result.push_back(getImmediateDominator(node->getId()));
+    return result;
+}
+
+int AODGraph::getImmediateDominator(int node_id) const {
+    int v = cfgIndexOf(node_id);
+    if (v < 0) return -1;
+    int d = cfg_info.dom.idom[v];
+    if (d < 0 || d == static_cast<int>(cfg_info.ids.size())) return -1;
+    // 表达式节点由其所在语句直接支配
+    if (cfg_info.ids[v] != node_id) return cfg_info.ids[v];
+    return cfg_info.ids[d];
+}
+
+std::set<int> AODGraph::getDominators(int node_id) const {
+    std::set<int> result;
+    int v = cfgIndexOf(node_id);
+    if (v < 0 || cfg_info.dom.idom[v] < 0) return result;
+    result.insert(node_id);
+    const int root = static_cast<int>(cfg_info.ids.size());
+    for (int d = v; d != root; d = cfg_info.dom.idom[d]) result.insert(cfg_info.ids[d]);
+    return result;
+}
+
+std::set<int> AODGraph::getPostDominators(int node_id) const {
+    std::set<int> result;
+    int v = cfgIndexOf(node_id);
+    if (v < 0 || cfg_info.pdom.idom[v] < 0) return result;
+    result.insert(node_id);
+    const int root = static_cast<int>(cfg_info.ids.size());
+    for (int d = v; d != root; d = cfg_info.pdom.idom[d]) result.insert(cfg_info.ids[d]);
+    return result;
+}
+
+bool AODGraph::isDominatedBy(int dominated, int dominator) const {
+    int a = cfgIndexOf(dominated);
+    int b = cfgIndexOf(dominator);
+    if (a < 0 || b < 0) return false;
+    const auto& t = cfg_info.dom;
+    if (t.pre[a] < 0 || t.pre[b] < 0) return false;
+    return t.pre[b] <= t.pre[a] && t.post[a] <= t.post[b];
+}
+
+bool AODGraph::postDominates(int dominated, int dominator) const {
+    int a = cfgIndexOf(dominated);
+    int b = cfgIndexOf(dominator);
+    if (a < 0 || b < 0) return false;
+    const auto& t = cfg_info.pdom;
+    if (t.pre[a] < 0 || t.pre[b] < 0) return false;
+    return t.pre[b] <= t.pre[a] && t.post[a] <= t.post[b];
+}
+
+bool AODGraph::isCyclic() const {
+    std::unordered_map<int, std::vector<int>> adj;
+    for (const auto& edge : edges) {
+        adj[edge->getSource()->getId()].push_back(edge->getTarget()->getId());
+    }
+    // 0 = 未访问, 1 = 在栈上, 2 = 已完成
+    std::unordered_map<int, int> color;
     for (const auto& node : nodes) {
-        if (node->isSIMDNode()) stats.simd_nodes++;
-        else if (node->isControlNode()) stats.control_nodes++;
-        else if (node->isDataNode()) stats.data_nodes++;
-        else if (node->isCallNode()) stats.call_nodes++;
-        stats.complexity_score += node->getComplexity();
+        if (color[node->getId()] != 0) continue;
+        std::vector<std::pair<int, size_t>> stack{{node->getId(), 0}};
+        color[node->getId()] = 1;
+        while (!stack.empty()) {
+            auto& [v, next] = stack.back();
+            const auto& out = adj[v];
+            if (next < out.size()) {
+                int w = out[next++];
+                if (color[w] == 1) return true;
+                if (color[w] == 0) { color[w] = 1; stack.push_back({w, 0}); }
+            } else {
+                color[v] = 2;
+                stack.pop_back();
+            }
+        }
     }
-    return stats;
+    return false;
 }
 
-void AODGraph::printStatistics() const {
-    auto stats = getStatistics();
-    std::cout << "Graph Stats: " << stats.node_count << " nodes, " << stats.edge_count << " edges." << std::endl;
+std::vector<int> AODGraph::getLoopHeaders() const {
+    ensureControlFlow();
+    std::vector<int> headers;
+    for (const auto& loop : cfg_info.loops) headers.push_back(loop.header);
+    return headers;
 }
 
-// 缺少的接口空实现以通过链接
-void AODGraph::topologicalSort() const {}
-std::vector<int> AODGraph::getPath(int, int) const { return {}; }
-bool AODGraph::hasPath(int, int) const { return false; }
+const std::vector<AODLoop>& AODGraph::getLoops() const {
+    ensureControlFlow();
+    return cfg_info.loops;
+}
+
+const AODLoop* AODGraph::getLoopOf(int node_id) const {
+    int v = cfgIndexOf(node_id);
+    if (v < 0 || cfg_info.loop_of[v] < 0) return nullptr;
+    return &cfg_info.loops[cfg_info.loop_of[v]];
+}
+
+int AODGraph::getLoopDepth(int node_id) const {
+    const AODLoop* loop = getLoopOf(node_id);
+    return loop ? loop->depth : 0;
+}
+
+bool AODGraph::isInLoop(int node_id, int loop_id) const {
+    int v = cfgIndexOf(node_id);
+    if (v < 0) return false;
+    for (int l = cfg_info.loop_of[v]; l >= 0; l = cfg_info.loops[l].parent) {
+        if (l == loop_id) return true;
+    }
+    return false;
+}
+
+std::vector<int> AODGraph::getEntryNodes() const {
+    ensureControlFlow();
+    std::vector<int> result;
+    for (int r : cfg_info.roots) result.push_back(cfg_info.ids[r]);
+    return result;
+}
+
+std::vector<int> AODGraph::getExitNodes() const {
+    ensureControlFlow();
+    std::vector<int> result;
+    for (size_t i = 0; i < cfg_info.ids.size(); ++i) {
+        if (cfg_info.succs[i].empty()) result.push_back(cfg_info.ids[i]);
+    }
+    return result;
+}
+
+
+// ============================================
+// 优化: 稀疏条件常量传播 (SCCP)
+// 向量常量表示为 64 位周期的 splat 模式, 按算子的通道宽度逐通道求值
+// ============================================
+
+namespace {
+
+struct LatticeValue {
+    enum Kind { Top, Const, Bottom };
+    Kind kind = Top;
+    bool is_vector = false;
+    uint64_t bits = 0;    // 向量: 以 64 位为周期重复的位模式
+    double scalar = 0.0;  // 标量
+
+    static LatticeValue bottom() { LatticeValue v; v.kind = Bottom; return v; }
+    static LatticeValue vector(uint64_t b) { LatticeValue v; v.kind = Const; v.is_vector = true; v.bits = b; return v; }
+    static LatticeValue number(double d) { LatticeValue v; v.kind = Const; v.scalar = d; return v; }
+    bool isConst() const { return kind == Const; }
+    bool isVector(uint64_t b) const { return kind == Const && is_vector && bits == b; }
+};
+
+struct LaneFormat {
+    int width = 0;  // 0 表示无法识别
+    bool is_float = false;
+    bool is_unsigned = false;
+};
+
+// _mm256_add_epi8 -> {"add", "epi8"}
+std::pair<std::string, std::string> splitIntrinsicName(const std::string& op_name) {
+    size_t first = op_name.find('_', 3);
+    size_t last = op_name.rfind('_');
+    if (op_name.rfind("_mm", 0) != 0 || first == std::string::npos || last <= first) return {"", ""};
+    return {op_name.substr(first + 1, last - first - 1), op_name.substr(last + 1)};
+}
+
+LaneFormat parseLaneFormat(const std::string& suffix) {
+    LaneFormat f;
+    if (suffix == "ps") { f.width = 32; f.is_float = true; }
+    else if (suffix == "pd") { f.width = 64; f.is_float = true; }
+    else if (suffix.rfind("si", 0) == 0) f.width = 64;  // 按位运算与通道宽度无关
+    else if (suffix.rfind("ep", 0) == 0 && suffix.size() > 3) {
+        f.is_unsigned = suffix[2] == 'u';
+        f.width = std::atoi(suffix.c_str() + 3);  // epi64x -> 64
+    }
+    if (f.width != 8 && f.width != 16 && f.width != 32 && f.width != 64) f.width = 0;
+    return f;
+}
+
+uint64_t laneMask(int width) { return width == 64 ? ~0ULL : ((1ULL << width) - 1); }
+
+uint64_t splat(uint64_t lane, int width) {
+    lane &= laneMask(width);
+    uint64_t bits = 0;
+    for (int shift = 0; shift < 64; shift += width) bits |= lane << shift;
+    return bits;
+}
+
+int64_t signExtend(uint64_t lane, int width) {
+    if (width == 64) return static_cast<int64_t>(lane);
+    uint64_t sign = 1ULL << (width - 1);
+    return static_cast<int64_t>((lane ^ sign) - sign);
+}
+
+double laneToDouble(uint64_t lane, int width) {
+    if (width == 32) {
+        uint32_t u = static_cast<uint32_t>(lane);
+        float f;
+        std::memcpy(&f, &u, sizeof(f));
+        return f;
+    }
+    double d;
+    std::memcpy(&d, &lane, sizeof(d));
+    return d;
+}
+
+uint64_t doubleToLane(double value, int width) {
+    if (width == 32) {
+        float f = static_cast<float>(value);
+        uint32_t u;
+        std::memcpy(&u, &f, sizeof(u));
+        return u;
+    }
+    uint64_t u;
+    std::memcpy(&u, &value, sizeof(u));
+    return u;
+}
+
+// 逐通道折叠二元运算, 不支持的运算返回 false
+bool foldLanes(const std::string& op, const LaneFormat& fmt, uint64_t a, uint64_t b, uint64_t& out) {
+    const int w = fmt.width;
+    const uint64_t mask = laneMask(w);
+    out = 0;
+    for (int shift = 0; shift < 64; shift += w) {
+        uint64_t x = (a >> shift) & mask, y = (b >> shift) & mask, r = 0;
+        if (fmt.is_float) {
+            double dx = laneToDouble(x, w), dy = laneToDouble(y, w), dr = 0.0;
+            if (op == "add") dr = dx + dy;
+            else if (op == "sub") dr = dx - dy;
+            else if (op == "mul") dr = dx * dy;
+            else if (op == "div") dr = dx / dy;
+            else if (op == "min") dr = dx < dy ? dx : dy;
+            else if (op == "max") dr = dx > dy ? dx : dy;
+            else return false;
+            r = doubleToLane(dr, w);
+        } else {
+            int64_t sx = signExtend(x, w), sy = signExtend(y, w);
+            int64_t vx = fmt.is_unsigned ? static_cast<int64_t>(x) : sx;
+            int64_t vy = fmt.is_unsigned ? static_cast<int64_t>(y) : sy;
+            if (op == "add") r = x + y;
+            else if (op == "sub") r = x - y;
+            else if (op == "mullo") r = x * y;
+            else if (op == "cmpeq") r = x == y ? mask : 0;
+            else if (op == "cmpgt") r = sx > sy ? mask : 0;
+            else if (op == "min") r = static_cast<uint64_t>(std::min(vx, vy));
+            else if (op == "max") r = static_cast<uint64_t>(std::max(vx, vy));
+            else if ((op == "adds" || op == "subs") && w <= 16) {
+                int64_t lo = fmt.is_unsigned ? 0 : -(1LL << (w - 1));
+                int64_t hi = fmt.is_unsigned ? static_cast<int64_t>(mask) : (1LL << (w - 1)) - 1;
+                int64_t v = op == "adds" ? vx + vy : vx - vy;
+                r = static_cast<uint64_t>(std::min(std::max(v, lo), hi));
+            } else {
+                return false;
+            }
+        }
+        out |= (r & mask) << shift;
+    }
+    return true;
+}
+
+LatticeValue evaluateIntrinsic(const std::string& op_name, const std::vector<LatticeValue>& args) {
+    auto parts = splitIntrinsicName(op_name);
+    const std::string& op = parts.first;
+    LaneFormat fmt = parseLaneFormat(parts.second);
+    const uint64_t ones = ~0ULL;
+    auto arg = [&](size_t i) { return i < args.size() ? args[i] : LatticeValue::bottom(); };
+    auto any = [&](uint64_t b) { return arg(0).isVector(b) || arg(1).isVector(b); };
+    bool all_const = !args.empty() && std::all_of(args.begin(), args.end(), [](const LatticeValue& v) { return v.isConst(); });
+
+    if (op == "setzero") return LatticeValue::vector(0);
+    if (op == "set1" && fmt.width && arg(0).isConst() && !arg(0).is_vector) {
+        double v = arg(0).scalar;
+        return LatticeValue::vector(fmt.is_float ? splat(doubleToLane(v, fmt.width), fmt.width)
+                                                 : splat(static_cast<uint64_t>(static_cast<int64_t>(v)), fmt.width));
+    }
+
+    // 按位运算: 全零/全一操作数可以在另一侧未知时直接确定结果
+    if (!fmt.is_float) {
+        if (op == "and" && any(0)) return LatticeValue::vector(0);
+        if (op == "or" && any(ones)) return LatticeValue::vector(ones);
+        if (op == "mullo" && any(0)) return LatticeValue::vector(0);
+        if (op == "andnot" && (arg(1).isVector(0) || arg(0).isVector(ones))) return LatticeValue::vector(0);
+        if (op == "testz" && any(0)) return LatticeValue::number(1);
+    }
+
+    bool vectors = all_const && std::all_of(args.begin(), args.end(), [](const LatticeValue& v) { return v.is_vector; });
+    if (vectors && !fmt.is_float) {
+        uint64_t a = arg(0).bits, b = arg(1).bits;
+        if (op == "and") return LatticeValue::vector(a & b);
+        if (op == "or") return LatticeValue::vector(a | b);
+        if (op == "xor") return LatticeValue::vector(a ^ b);
+        if (op == "andnot") return LatticeValue::vector(~a & b);
+        if (op == "testz") return LatticeValue::number((a & b) == 0 ? 1 : 0);
+        if (op == "movemask" && fmt.width == 8) {
+            uint32_t m = 0;
+            for (int i = 0; i < 8; ++i) m |= ((a >> (i * 8 + 7)) & 1U) << i;
+            return LatticeValue::number(static_cast<int32_t>(m | m << 8 | m << 16 | m << 24));
+        }
+    }
+    if (vectors && args.size() == 2 && fmt.width) {
+        uint64_t out;
+        if (foldLanes(op, fmt, arg(0).bits, arg(1).bits, out)) return LatticeValue::vector(out);
+    }
+
+    bool pending = std::any_of(args.begin(), args.end(), [](const LatticeValue& v) { return v.kind == LatticeValue::Top; });
+    return pending ? LatticeValue() : LatticeValue::bottom();
+}
+
+LatticeValue evaluateScalar(const std::string& op, const std::vector<LatticeValue>& args, bool single_precision) {
+    if (args.size() != 2) return LatticeValue::bottom();
+    if (args[0].kind == LatticeValue::Bottom || args[1].kind == LatticeValue::Bottom) return LatticeValue::bottom();
+    if (!args[0].isConst() || !args[1].isConst()) return LatticeValue();
+    if (args[0].is_vector || args[1].is_vector) return LatticeValue::bottom();
+
+    double x = args[0].scalar, y = args[1].scalar, r;
+    if (op == "+") r = x + y;
+    else if (op == "-") r = x - y;
+    else if (op == "*") r = x * y;
+    else if (op == "/") r = x / y;
+    else if (op == "<") r = x < y;
+    else if (op == ">") r = x > y;
+    else if (op == "<=") r = x <= y;
+    else if (op == ">=") r = x >= y;
+    else if (op == "==") r = x == y;
+    else if (op == "!=") r = x != y;
+    else return LatticeValue::bottom();
+    if (single_precision) r = static_cast<float>(r);
+    return LatticeValue::number(r);
+}
+
+// 将折叠结果写入节点属性, 由代码生成器按目标架构物化为 splat 或字面量
+bool recordConstant(const std::shared_ptr<AODNode>& node, const LatticeValue& value) {
+    std::ostringstream text;
+    if (!value.is_vector) {
+        if (!std::isfinite(value.scalar)) return false;
+        bool single = node->getProperty("value_type") == "float";
+        text.precision(single ? 9 : 17);
+        text << value.scalar;
+        std::string literal = text.str();
+        if (node->getProperty("value_type").find("float") != std::string::npos ||
+            node->getProperty("value_type") == "double") {
+            if (literal.find_first_of(".e") == std::string::npos) literal += ".0";
+            if (single) literal += "f";
+        }
+        node->setProperty("const_kind", "scalar");
+        node->setProperty("const_value", literal);
+        return true;
+    }
+
+    LaneFormat fmt = parseLaneFormat(splitIntrinsicName(node->getProperty("op_name")).second);
+    if (fmt.is_float) {
+        double lane = laneToDouble(value.bits & laneMask(fmt.width), fmt.width);
+        if (!std::isfinite(lane)) return false;
+        text.precision(fmt.width == 32 ? 9 : 17);
+        text << lane;
+        node->setProperty("const_kind", "vector_float");
+        node->setProperty("const_lane", std::to_string(fmt.width));
+        node->setProperty("const_value", text.str());
+        return true;
+    }
+
+    // 取能表示该模式的最窄通道宽度
+    int width = 8;
+    while (width < 64 && splat(value.bits, width) != value.bits) width *= 2;
+    node->setProperty("const_kind", "vector_int");
+    node->setProperty("const_lane", std::to_string(width));
+    node->setProperty("const_value", std::to_string(signExtend(value.bits & laneMask(width), width)));
+    return true;
+}
+
+} // namespace
+
+void AODGraph::constantPropagation() {
+    AODPassReport report;
+    report.pass_name = "SCCP";
+    report.nodes_before = getNodeCount();
+
+    std::unordered_map<int, std::map<int, std::shared_ptr<AODNode>>> operands;
+    for (const auto& edge : edges) {
+        if (isOperandEdge(*edge)) operands[edge->getTarget()->getId()][getOperandIndex(*edge)] = edge->getSource();
+    }
+
+    // 控制流后继 (带分支标签) 以及参与控制流的语句集合
+    std::unordered_map<int, std::vector<std::pair<int, std::string>>> succs;
+    std::unordered_set<int> cfg_members;
+    std::vector<int> entries;
+    for (const auto& edge : edges) {
+        if (edge->getType() != AODEdgeType::Control) continue;
+        succs[edge->getSource()->getId()].push_back({edge->getTarget()->getId(), edge->getProperties().variable_name});
+        cfg_members.insert(edge->getSource()->getId());
+        cfg_members.insert(edge->getTarget()->getId());
+    }
+    for (const auto& node : nodes) {
+        if (node->getType() == AODNodeType::Entry && cfg_members.count(node->getId())) entries.push_back(node->getId());
+    }
+
+    // 条件已知的分支只沿对应的 true/false 边传播
+    auto computeExecutable = [&](const std::unordered_map<int, bool>& known) {
+        std::unordered_set<int> reached;
+        std::vector<int> stack(entries.begin(), entries.end());
+        while (!stack.empty()) {
+            int id = stack.back();
+            stack.pop_back();
+            if (!reached.insert(id).second) continue;
+            auto cond = known.find(id);
+            for (const auto& succ : succs[id]) {
+                if (cond != known.end() && succ.second == (cond->second ? "false" : "true")) continue;
+                stack.push_back(succ.first);
+            }
+        }
+        return reached;
+    };
+
+    auto statementOf = [&](const std::shared_ptr<AODNode>& node) {
+        int anchor = getStatementAnchor(*node);
+        return anchor < 0 ? node->getId() : anchor;
+    };
+
+    std::unordered_map<int, bool> known;
+    std::unordered_set<int> executable;
+    std::unordered_map<int, LatticeValue> lattice;
+    auto isExecutable = [&](const std::shared_ptr<AODNode>& node) {
+        if (entries.empty()) return true;
+        int stmt = statementOf(node);
+        return !cfg_members.count(stmt) || executable.count(stmt) > 0;
+    };
+
+    std::vector<int> order = operandTopologicalOrder();
+    for (size_t round = 0; round < nodes.size() + 1; ++round) {
+        executable = computeExecutable(known);
+        lattice.clear();
+
+        for (int id : order) {
+            auto node = getNode(id);
+            if (!isExecutable(node)) continue;  // 不可达代码保持 Top
+
+            std::string op = node->getProperty("op_name");
+            std::vector<LatticeValue> args;
+            std::string arity = node->getProperty("operand_count");
+            int count = arity.empty() ? 0 : std::stoi(arity);
+            for (int i = 0; i < count; ++i) {
+                auto src = operands[id].find(i);
+                std::string imm = node->getProperty("imm_" + std::to_string(i));
+                if (src != operands[id].end()) args.push_back(lattice.count(src->second->getId()) ? lattice[src->second->getId()] : LatticeValue());
+                else if (!imm.empty()) args.push_back(LatticeValue::number(std::stod(imm)));
+                else args.push_back(LatticeValue::bottom());
+            }
+
+            LatticeValue value = LatticeValue::bottom();
+            if (op == "define") {
+                auto init = operands[id].find(0);
+                if (node->getProperty("reassigned") != "true" && init != operands[id].end()) {
+                    value = lattice.count(init->second->getId()) ? lattice[init->second->getId()] : LatticeValue();
+                }
+            } else if (!arity.empty() && !node->isStatement() && isPureOperationName(op)) {
+                value = op.rfind("_mm", 0) == 0
+                    ? evaluateIntrinsic(op, args)
+                    : evaluateScalar(op, args, node->getProperty("value_type") == "float");
+            }
+            lattice[id] = value;
+        }
+
+        // 由格值确定分支条件
+        std::unordered_map<int, bool> next_known;
+        for (const auto& node : nodes) {
+            if (node->getType() != AODNodeType::Control) continue;
+            std::string fixed = node->getProperty("cond_value");
+            std::string cond_node = node->getProperty("cond_node");
+            if (!fixed.empty()) {
+                next_known[node->getId()] = fixed == "true";
+            } else if (!cond_node.empty()) {
+                auto it = lattice.find(std::stoi(cond_node));
+                if (it != lattice.end() && it->second.isConst() && !it->second.is_vector) {
+                    next_known[node->getId()] = it->second.scalar != 0.0;
+                }
+            }
+        }
+        if (next_known == known) break;
+        known = std::move(next_known);
+    }
+
+    // 1. 删除不可达语句 (控制头与块结束符保留, 保证输出的括号结构完整)
+    std::vector<std::shared_ptr<AODNode>> snapshot = nodes;
+    for (const auto& node : snapshot) {
+        if (entries.empty() || !node->isStatement() || !cfg_members.count(node->getId())) continue;
+        if (executable.count(node->getId())) continue;
+        switch (node->getType()) {
+            case AODNodeType::Control: case AODNodeType::BlockEnd:
+            case AODNodeType::Entry: case AODNodeType::Exit:
+                continue;
+            default: break;
+        }
+        if (node->getProperty("op_name") == "define" && std::stoi(node->getProperty("opaque_refs", "0")) > 0) continue;
+        removeNode(node->getId());
+        report.nodes_changed++;
+        report.instructions_saved++;
+        report.details.push_back("unreachable " + node->getName());
+    }
+
+    // 2. 常量折叠与代数化简
+    for (const auto& node : snapshot) {
+        if (!getNode(node->getId()) || node->isStatement() || !node->getProperty("const_kind").empty()) continue;
+        auto it = lattice.find(node->getId());
+        if (it == lattice.end()) continue;
+        std::string op = node->getProperty("op_name");
+        std::string kind = splitIntrinsicName(op).first;
+        LaneFormat fmt = parseLaneFormat(splitIntrinsicName(op).second);
+
+        if (it->second.isConst()) {
+            if (kind == "set1" || kind == "setzero") continue;  // 本身已是常量
+            if (it->second.is_vector && fmt.is_float && (kind == "and" || kind == "or" || kind == "xor" || kind == "andnot")) continue;
+            if (!recordConstant(node, it->second)) continue;
+
+            std::vector<std::shared_ptr<AODNode>> inputs;
+            for (const auto& operand : operands[node->getId()]) inputs.push_back(operand.second);
+            edges.erase(std::remove_if(edges.begin(), edges.end(), [&](const std::shared_ptr<AODEdge>& edge) {
+                return edge->getTarget() == node && isOperandEdge(*edge);
+            }), edges.end());
+            report.nodes_changed++;
+            report.instructions_saved += removeDeadOperands(inputs);
+            report.details.push_back(op + " = " + node->getProperty("const_value"));
+            continue;
+        }
+
+        // x & ~0, x | 0, x ^ 0, x + 0, x - 0, andnot(0, x) 直接转发为 x
+        if (fmt.is_float && kind != "and" && kind != "or" && kind != "xor") continue;
+        auto lhs = operands[node->getId()].count(0) ? operands[node->getId()][0] : nullptr;
+        auto rhs = operands[node->getId()].count(1) ? operands[node->getId()][1] : nullptr;
+        auto valueOf = [&](const std::shared_ptr<AODNode>& n) { return n && lattice.count(n->getId()) ? lattice[n->getId()] : LatticeValue::bottom(); };
+        std::shared_ptr<AODNode> forward;
+        if (kind == "and") {
+            if (valueOf(rhs).isVector(~0ULL)) forward = lhs;
+            else if (valueOf(lhs).isVector(~0ULL)) forward = rhs;
+        } else if (kind == "or" || kind == "xor" || kind == "add") {
+            if (valueOf(rhs).isVector(0)) forward = lhs;
+            else if (valueOf(lhs).isVector(0)) forward = rhs;
+        } else if (kind == "sub") {
+            if (valueOf(rhs).isVector(0)) forward = lhs;
+        } else if (kind == "andnot") {
+            if (valueOf(lhs).isVector(0)) forward = rhs;
+        }
+        if (!forward) continue;
+
+        replaceAllUsesWith(node, forward);
+        report.nodes_changed++;
+        report.instructions_saved += removeDeadOperands({node});
+        report.details.push_back(op + " forwarded to operand");
+    }
+
+    report.nodes_after = getNodeCount();
+    pass_reports.push_back(report);
+}
+
+// ============================================
+// 优化: 标记-清除死代码消除
+// 根为有副作用的语句 (存储、调用、控制流等), 沿数据边反向标记活跃节点
+// ============================================
+
+void AODGraph::eliminateDeadCode() {
+    AODPassReport report;
+    report.pass_name = "DCE";
+    report.nodes_before = getNodeCount();
+
+    std::function<bool(const std::shared_ptr<AODNode>&)> isRoot = [&](const std::shared_ptr<AODNode>& node) {
+        switch (node->getType()) {
+            case AODNodeType::Control: case AODNodeType::BlockEnd:
+            case AODNodeType::Entry: case AODNodeType::Exit:
+                return true;
+            default: break;
+        }
+        if (!node->isStatement()) {
+            // 所属语句按原文本输出时 (如 return), 表达式不一定有指向语句的数据边
+            int anchor = getStatementAnchor(*node);
+            auto owner = anchor < 0 ? nullptr : getNode(anchor);
+            return owner && owner->getProperty("op_name") != "define" && isRoot(owner);
+        }
+        if (node->getProperty("op_name") != "define") return true;
+        // 仍被按原文本输出的代码引用, 或初始化表达式有副作用的定义不能删除
+        return std::stoi(node->getProperty("opaque_refs", "0")) > 0 ||
+               node->getProperty("init_side_effects") == "true";
+    };
+
+    std::unordered_map<int, std::vector<std::shared_ptr<AODNode>>> inputs;
+    for (const auto& edge : edges) {
+        if (edge->getType() == AODEdgeType::Data) inputs[edge->getTarget()->getId()].push_back(edge->getSource());
+    }
+
+    std::unordered_set<int> live;
+    std::vector<std::shared_ptr<AODNode>> worklist;
+    for (const auto& node : nodes) {
+        if (isRoot(node)) worklist.push_back(node);
+    }
+    while (!worklist.empty()) {
+        auto node = worklist.back();
+        worklist.pop_back();
+        if (!live.insert(node->getId()).second) continue;
+        for (const auto& input : inputs[node->getId()]) worklist.push_back(input);
+    }
+
+    std::vector<std::shared_ptr<AODNode>> snapshot = nodes;
+    for (const auto& node : snapshot) {
+        if (live.count(node->getId())) continue;
+        bool is_define = node->getProperty("op_name") == "define";
+        if (node->isStatement() && !is_define) continue;
+        if (!is_define && isPureOperationName(node->getProperty("op_name"))) report.instructions_saved++;
+        report.nodes_changed++;
+        if (is_define) report.details.push_back("dead " + node->getProperty("var_name"));
+        removeNode(node->getId());
+    }
+
+    report.nodes_after = getNodeCount();
+    pass_reports.push_back(report);
+}
+
+// ============================================
+// 优化: 基于哈希合并 (hash-consing) 的全局值编号
+// 键为 (算子, 结果类型, 操作数值编号/立即数), 可交换算子的操作数排序归一
+// ============================================
+
+void AODGraph::commonSubexpressionElimination() {
+    AODPassReport report;
+    report.pass_name = "GVN-CSE";
+    report.nodes_before = getNodeCount();
+
+    std::unordered_map<int, std::map<int, int>> operands; // node -> (arg index -> source)
+    for (const auto& edge : edges) {
+        if (isOperandEdge(*edge)) operands[edge->getTarget()->getId()][getOperandIndex(*edge)] = edge->getSource()->getId();
+    }
+
+    // 2. 计算值编号
+    std::unordered_map<int, int> vn;
+    std::unordered_map<std::string, int> table;
+    int next_vn = 0;
+    auto fresh = [&]() { return next_vn++; };
+
+    for (int id : operandTopologicalOrder()) {
+        auto node = getNode(id);
+        std::string op = node->getProperty("op_name");
+
+        if (op == "define") {
+            auto init = operands[id].find(0);
+            bool reassigned = node->getProperty("reassigned") == "true";
+            vn[id] = (!reassigned && init != operands[id].end() && vn.count(init->second))
+                ? vn[init->second] : fresh();
+        } else if (!node->isStatement() && node->isSideEffectFree() && isPureOperationName(op)) {
+            std::string arity = node->getProperty("operand_count");
+            int count = arity.empty() ? 0 : std::stoi(arity);
+            std::vector<std::string> keys;
+            bool opaque = arity.empty(); // 未标注操作数的节点无法安全比较
+            for (int i = 0; i < count && !opaque; ++i) {
+                auto src = operands[id].find(i);
+                // 被重新赋值的变量在不同位置取值不同, 不能按定义合并
+                if (src != operands[id].end() && getNode(src->second)->getProperty("reassigned") == "true") {
+                    opaque = true;
+                } else if (src != operands[id].end() && vn.count(src->second)) {
+                    keys.push_back("v" + std::to_string(vn[src->second]));
+                } else if (!node->getProperty("imm_" + std::to_string(i)).empty()) {
+                    keys.push_back("i" + node->getProperty("imm_" + std::to_string(i)));
+                } else {
+                    opaque = true; // 非常量且无数据流来源的操作数 (如内存读), 不参与编号
+                }
+            }
+            if (opaque) {
+                vn[id] = fresh();
+            } else {
+                if (isCommutativeOperationName(op)) std::sort(keys.begin(), keys.end());
+                std::string key = op + "|" + node->getProperty("value_type");
+                for (const auto& k : keys) key += "|" + k;
+                auto found = table.find(key);
+                vn[id] = (found != table.end()) ? found->second : (table[key] = fresh());
+            }
+        } else {
+            vn[id] = fresh();
+        }
+    }
+
+    // 3. 按程序顺序合并: 有名字的 define 作为代表, 只替换被其严格支配的冗余值
+    std::unordered_map<int, std::vector<std::shared_ptr<AODNode>>> leaders;
+    auto findLeader = [&](const std::shared_ptr<AODNode>& node) -> std::shared_ptr<AODNode> {
+        auto it = leaders.find(vn[node->getId()]);
+        if (it == leaders.end()) return nullptr;
+        std::string anchor = node->getProperty("stmt_anchor");
+        for (const auto& leader : it->second) {
+            if (anchor == std::to_string(leader->getId())) continue; // 自身的初始化表达式
+            if (isDominatedBy(node->getId(), leader->getId())) return leader;
+        }
+        return nullptr;
+    };
+
+    std::vector<std::shared_ptr<AODNode>> order = nodes;
+    for (const auto& node : order) {
+        if (!getNode(node->getId()) || !vn.count(node->getId())) continue;
+        std::string op = node->getProperty("op_name");
+
+        if (op == "define") {
+            if (node->getProperty("reassigned") == "true" || !operands[node->getId()].count(0)) continue;
+            auto leader = findLeader(node);
+            if (!leader) {
+                leaders[vn[node->getId()]].push_back(node);
+                continue;
+            }
+            replaceAllUsesWith(node, leader);
+            // 初始化表达式可能已在前面作为纯表达式被合并为对代表的引用
+            auto init = getOperand(node->getId(), 0);
+            edges.erase(std::remove_if(edges.begin(), edges.end(), [&](const std::shared_ptr<AODEdge>& edge) {
+                return edge->getTarget() == node && isOperandEdge(*edge);
+            }), edges.end());
+            int removed = removeDeadOperands({init});
+            // 保留为别名定义: 后续语句按原文本输出时仍可能引用该变量名
+            node->setProperty("alias_of", leader->getProperty("var_name"));
+
+            report.nodes_changed++;
+            report.instructions_saved += removed;
+            report.details.push_back(node->getProperty("var_name") + " -> " + leader->getProperty("var_name"));
+        } else if (!node->isStatement() && isPureOperationName(op)) {
+            auto leader = findLeader(node);
+            if (!leader) continue;
+            replaceAllUsesWith(node, leader);
+            int removed = removeDeadOperands({node});
+            report.nodes_changed++;
+            report.instructions_saved += removed;
+            report.details.push_back(op + " reuses " + leader->getProperty("var_name"));
+        }
+    }
+
+    report.nodes_after = getNodeCount();
+    pass_reports.push_back(report);
+}
+
+// ============================================
+// 优化: 循环不变量外提 (LICM)
+// 纯向量运算的操作数全部来自循环外时, 提到循环前置块中的临时定义, 循环内改为引用该变量
+// ============================================
+
+void AODGraph::loopInvariantCodeMotion() {
+    AODPassReport report;
+    report.pass_name = "LICM";
+    report.nodes_before = getNodeCount();
+
+    std::unordered_map<int, std::map<int, std::shared_ptr<AODNode>>> operands;
+    for (const auto& edge : edges) {
+        if (isOperandEdge(*edge)) operands[edge->getTarget()->getId()][getOperandIndex(*edge)] = edge->getSource();
+    }
+
+    std::function<bool(const std::shared_ptr<AODNode>&, int)> isInvariant =
+        [&](const std::shared_ptr<AODNode>& node, int loop_id) -> bool {
+        if (node->isStatement()) {
+            return node->getProperty("op_name") == "define" &&
+                   node->getProperty("reassigned") != "true" &&
+                   !isInLoop(node->getId(), loop_id);
+        }
+        std::string arity = node->getProperty("operand_count");
+        if (arity.empty() || !isPureOperationName(node->getProperty("op_name"))) return false;
+        for (int i = 0, n = std::stoi(arity); i < n; ++i) {
+            std::string index = std::to_string(i);
+            auto src = operands[node->getId()].find(i);
+            if (src != operands[node->getId()].end()) {
+                if (!isInvariant(src->second, loop_id)) return false;
+            } else if (node->getProperty("imm_" + index).empty() && node->getProperty("stable_" + index).empty()) {
+                return false;  // 无法确认来源的操作数 (如指针运算)
+            }
+        }
+        return true;
+    };
+
+    auto anchorOf = [&](const std::shared_ptr<AODNode>& node) {
+        int anchor = getStatementAnchor(*node);
+        return anchor < 0 ? nullptr : getNode(anchor);
+    };
+
+    int hoisted_count = 0;
+    std::vector<std::shared_ptr<AODNode>> snapshot = nodes;
+    for (const auto& node : snapshot) {
+        if (!getNode(node->getId()) || node->isStatement()) continue;
+        // 只处理经由图生成代码的语句; 循环头条件按原文本输出, 不在此处理
+        auto owner = anchorOf(node);
+        if (!owner || owner->getType() == AODNodeType::Control || owner->getProperty("op_name").empty()) continue;
+
+        const AODLoop* loop = getLoopOf(node->getId());
+        if (!loop || loop->irreducible) continue;
+
+        // 只外提最大的不变子表达式: 使用者本身不变时由使用者整体外提
+        auto users = getOperandUsers(node->getId());
+        bool user_invariant = std::any_of(users.begin(), users.end(), [&](const std::shared_ptr<AODNode>& user) {
+            return !user->isStatement() && isInvariant(user, loop->id);
+        });
+        if (user_invariant) continue;
+
+        // 尽量提到最外层的不变循环之前
+        int target = -1;
+        for (int l = loop->id; l >= 0; l = getLoops()[l].parent) {
+            if (getLoops()[l].irreducible || !isInvariant(node, l)) break;
+            target = l;
+        }
+        if (target < 0) continue;
+
+        AODLoop target_loop = getLoops()[target];
+        auto header = getNode(target_loop.header);
+        std::unordered_set<int> body(target_loop.body.begin(), target_loop.body.end());
+
+        auto temp = std::make_shared<AODNode>(AODNodeType::GenericStmt, "LICM");
+        temp->setProperty("op_name", "define");
+        temp->setProperty("var_name", "licm_" + std::to_string(hoisted_count++));
+        temp->setProperty("hoisted", "true");
+        temp->setIsStatement(true);
+        addNode(temp);
+        nodes.pop_back();
+        nodes.insert(std::find(nodes.begin(), nodes.end(), header), temp);
+
+        // 循环入口边改经前置定义: pred -> temp -> header, 回边保持不变
+        std::vector<std::shared_ptr<AODEdge>> entries;
+        for (const auto& edge : edges) {
+            if (edge->getType() == AODEdgeType::Control && edge->getTarget() == header &&
+                !body.count(edge->getSource()->getId()) && edge->getProperties().variable_name != "back") {
+                entries.push_back(edge);
+            }
+        }
+        for (const auto& edge : entries) {
+            edges.erase(std::find(edges.begin(), edges.end(), edge));
+            addEdge(edge->getSource(), temp, AODEdgeType::Control, edge->getProperties().variable_name);
+        }
+        addEdge(temp, header, AODEdgeType::Control);
+
+        replaceAllUsesWith(node, temp);
+        addEdge(node, temp, AODEdgeType::Data, "init");
+
+        // 子表达式随之归属到新的定义语句
+        int moved = 0;
+        std::vector<std::shared_ptr<AODNode>> subtree = {node};
+        while (!subtree.empty()) {
+            auto expr = subtree.back();
+            subtree.pop_back();
+            expr->setProperty("stmt_anchor", std::to_string(temp->getId()));
+            moved++;
+            for (const auto& operand : operands[expr->getId()]) {
+                if (!operand.second->isStatement()) subtree.push_back(operand.second);
+            }
+        }
+
+        report.nodes_changed++;
+        report.instructions_saved += moved;  // 每次迭代少执行的指令数
+        report.details.push_back(node->getProperty("op_name") + " hoisted above loop " + std::to_string(target));
+    }
+
+    report.nodes_after = getNodeCount();
+    pass_reports.push_back(report);
+}
+
+// ============================================
+// 优化: 长度无关循环 (SVE)
+// 转换器标记的固定步长循环 (while (n >= 32) { ...; p += 32; n -= 32; }) 改为按 svcntb() 步进,
+// 由 svwhilelt_b8 谓词覆盖余数; 向量体对 256 个字节值的逐通道结果与标量尾循环一致时才改写, 并删除尾循环
+// ============================================
+
+namespace {
+
+// (__m256i *)src -> src
+std::string addressVariable(const std::string& text) {
+    size_t start = text.rfind(')');
+    start = start == std::string::npos ? 0 : start + 1;
+    std::string name;
+    for (size_t i = start; i < text.size(); ++i) {
+        if (!std::isspace(static_cast<unsigned char>(text[i]))) name += text[i];
+    }
+    return name;
+}
+
+bool isBytewiseOperation(const std::string& kind, const std::string& suffix) {
+    static const std::unordered_set<std::string> kinds = {
+        "add", "sub", "adds", "subs", "and", "or", "xor", "andnot", "cmpeq", "cmpgt", "min", "max",
+        "set1", "setzero", "load", "loadu", "store", "storeu",
+    };
+    return kinds.count(kind) && (suffix == "epi8" || suffix == "epu8" || suffix.rfind("si", 0) == 0);
+}
+
+}  // namespace
+
+void AODGraph::vectorLengthAgnosticLoops(const std::string& target_arch) {
+    AODPassReport report;
+    report.pass_name = "VLA";
+    report.nodes_before = getNodeCount();
+    if (target_arch != "SVE") {
+        report.nodes_after = report.nodes_before;
+        pass_reports.push_back(report);
+        return;
+    }
+
+    std::unordered_map<int, std::map<int, std::shared_ptr<AODNode>>> operands;
+    for (const auto& edge : edges) {
+        if (isOperandEdge(*edge)) operands[edge->getTarget()->getId()][getOperandIndex(*edge)] = edge->getSource();
+    }
+    auto statementOf = [&](const std::shared_ptr<AODNode>& node) {
+        int anchor = getStatementAnchor(*node);
+        return anchor < 0 ? node->getId() : anchor;
+    };
+
+    std::vector<std::shared_ptr<AODNode>> snapshot = nodes;
+    for (const auto& header : snapshot) {
+        if (!getNode(header->getId()) || header->getProperty("step_width").empty()) continue;
+        std::string where = "loop " + std::to_string(header->getId()) + ": ";
+
+        std::shared_ptr<AODNode> tail;
+        for (const auto& node : nodes) {
+            if (node->getProperty("tail_of") == std::to_string(header->getId())) tail = node;
+        }
+        const AODLoop* loop = nullptr;
+        for (const auto& candidate : getLoops()) {
+            if (candidate.header == header->getId()) loop = &candidate;
+        }
+        // 没有可证明等价的尾循环时, 步长变化会改变由向量体处理的元素, 保持原步长
+        if (!tail || !loop || loop->irreducible || header->getProperty("step_width") != "32") {
+            report.details.push_back(where + "no equivalent scalar remainder loop, fixed stride kept");
+            continue;
+        }
+
+        // 向量体只允许 8 位逐通道运算, 恰好一次存储, 加载都来自同一指针
+        std::unordered_set<int> body(loop->body.begin(), loop->body.end());
+        std::shared_ptr<AODNode> store;
+        std::string load_pointer, store_pointer;
+        std::vector<std::shared_ptr<AODNode>> inductions;
+        bool bytewise = true;
+        for (const auto& node : nodes) {
+            int stmt = statementOf(node);
+            if (!body.count(stmt) || stmt == header->getId()) continue;
+            if (!node->getProperty("induction").empty()) { inductions.push_back(node); continue; }
+            std::string op = node->getProperty("op_name");
+            if (op == "define" || !node->getProperty("const_kind").empty()) continue;
+            auto parts = splitIntrinsicName(op);
+            if (!isBytewiseOperation(parts.first, parts.second)) { bytewise = false; break; }
+            if (parts.first.find("load") != std::string::npos) {
+                std::string ptr = addressVariable(node->getProperty("text_0"));
+                if (!load_pointer.empty() && load_pointer != ptr) { bytewise = false; break; }
+                load_pointer = ptr;
+            } else if (parts.first.find("store") != std::string::npos) {
+                if (store) { bytewise = false; break; }
+                store = node;
+                store_pointer = addressVariable(node->getProperty("text_0"));
+            }
+        }
+        if (!bytewise || !store || load_pointer != tail->getProperty("elementwise_in") ||
+            store_pointer != tail->getProperty("elementwise_out")) {
+            report.details.push_back(where + "vector body is not a bytewise map from " +
+                                     tail->getProperty("elementwise_in") + " to " + tail->getProperty("elementwise_out"));
+            continue;
+        }
+
+        // 把加载替换为字节 b 的 splat, 逐个字节值求存储值并与尾循环的逐元素结果比较
+        std::unordered_map<int, LatticeValue> memo;
+        std::function<LatticeValue(const std::shared_ptr<AODNode>&, uint64_t)> evaluate =
+            [&](const std::shared_ptr<AODNode>& node, uint64_t byte) -> LatticeValue {
+            auto known = memo.find(node->getId());
+            if (known != memo.end()) return known->second;
+            LatticeValue value = LatticeValue::bottom();
+            std::string op = node->getProperty("op_name");
+            std::string kind = node->getProperty("const_kind");
+            auto& args = operands[node->getId()];
+            if (kind == "vector_int") {
+                value = LatticeValue::vector(splat(static_cast<uint64_t>(std::stoll(node->getProperty("const_value"))),
+                                                   std::stoi(node->getProperty("const_lane"))));
+            } else if (!kind.empty()) {
+                value = LatticeValue::bottom();
+            } else if (op == "define") {
+                if (node->getProperty("reassigned") != "true" && args.count(0)) value = evaluate(args[0], byte);
+            } else if (splitIntrinsicName(op).first.find("load") != std::string::npos) {
+                // 循环外的加载来自其他地址, 取值未知
+                if (body.count(statementOf(node))) value = LatticeValue::vector(splat(byte, 8));
+            } else if (!node->isStatement() && isPureOperationName(op)) {
+                std::vector<LatticeValue> inputs;
+                int count = std::atoi(node->getProperty("operand_count", "0").c_str());
+                for (int i = 0; i < count; ++i) {
+                    std::string imm = node->getProperty("imm_" + std::to_string(i));
+                    if (args.count(i)) inputs.push_back(evaluate(args[i], byte));
+                    else if (!imm.empty()) inputs.push_back(LatticeValue::number(std::stod(imm)));
+                    else inputs.push_back(LatticeValue::bottom());
+                }
+                value = evaluateIntrinsic(op, inputs);
+            }
+            memo[node->getId()] = value;
+            return value;
+        };
+
+        const std::string& map = tail->getProperty("elementwise_map");
+        auto stored = operands[store->getId()].count(1) ? operands[store->getId()][1] : nullptr;
+        int mismatch = stored && map.size() == 512 ? -1 : 0;
+        for (int byte = 0; byte < 256 && mismatch < 0; ++byte) {
+            memo.clear();
+            LatticeValue value = evaluate(stored, static_cast<uint64_t>(byte));
+            uint64_t expected = std::stoull(map.substr(byte * 2, 2), nullptr, 16);
+            if (!value.isConst() || !value.is_vector || value.bits != splat(expected, 8)) mismatch = byte;
+        }
+        if (mismatch >= 0) {
+            report.details.push_back(where + "vector body differs from scalar tail at byte " + std::to_string(mismatch) +
+                                     ", fixed stride kept");
+            continue;
+        }
+
+        // 尾循环在谓词覆盖余数后不再执行, 删除其 [头节点, region_end] 区间 (逆序删除, 控制流边逐个接续)
+        auto first = std::find(nodes.begin(), nodes.end(), tail);
+        auto last = first;
+        while (last != nodes.end() && std::to_string((*last)->getId()) != tail->getProperty("region_end")) ++last;
+        if (last == nodes.end()) continue;
+        std::vector<std::shared_ptr<AODNode>> region(first, last + 1);
+
+        // 头节点与归纳语句由代码生成器按 vla 标记输出
+        header->setProperty("vla", "true");
+        for (size_t i = 0; i < inductions.size(); ++i) {
+            inductions[i]->setProperty("vla_header", std::to_string(header->getId()));
+            if (i == 0) inductions[i]->setProperty("vla_step_decl", "true");
+        }
+        int removed = 0;
+        for (auto it = region.rbegin(); it != region.rend(); ++it) {
+            if (removeNode((*it)->getId())) removed++;
+        }
+
+        report.nodes_changed++;
+        report.instructions_saved += removed;
+        report.details.push_back(where + "svcntb() stride with svwhilelt_b8 predicate, scalar tail loop " +
+                                 std::to_string(tail->getId()) + " removed (256/256 byte values agree)");
+    }
+
+    report.nodes_after = getNodeCount();
+    pass_reports.push_back(report);
+}
+
+// ============================================
+// 优化: if-conversion
+// 转换器已判定分支内只有可无条件求值的赋值 (branch_*); 只改写循环内的分支, 循环外的分支只执行一次, 保留原样
+// ============================================
+
+void AODGraph::ifConversion() {
+    AODPassReport report;
+    report.pass_name = "IfConversion";
+    report.nodes_before = getNodeCount();
+
+    for (const auto& node : nodes) {
+        if (node->getType() != AODNodeType::Control || node->getName() != "IfStmt" || !node->isStatement()) continue;
+        if (!getLoopOf(node->getId())) continue;
+        std::string where = "if " + std::to_string(node->getId()) + ": ";
+        std::string blocker = node->getProperty("branch_blocker");
+        if (!blocker.empty()) {
+            report.details.push_back(where + "branch kept (" + blocker + ")");
+            continue;
+        }
+        if (node->getProperty("branch_assigns").empty()) continue;
+
+        std::string clamp = node->getProperty("branch_clamp");
+        node->setProperty("if_converted", clamp.empty() ? "select" : clamp);
+        report.nodes_changed++;
+        report.instructions_saved++;
+        std::string assigns = node->getProperty("branch_assigns");
+        std::string stores = node->getProperty("branch_stores");
+        std::string detail = where;
+        if (assigns != "0") detail += assigns + " guarded assignments";
+        if (stores != "0") detail += (assigns != "0" ? ", " : "") + stores + " guarded stores";
+        report.details.push_back(detail + (clamp.empty() ? " -> selects" : " -> " + clamp + " clamp"));
+    }
+
+    report.nodes_after = getNodeCount();
+    pass_reports.push_back(report);
+}
+
+// ============================================
+// 优化: 访存层次 (NEON / SVE)
+// 转换器标记的固定步长循环按工作集判断: 计数不少于 stream_min_count 时只写的指针改用非临时存储,
+// 读取的指针提前 prefetch_distance 字节预取. 计数在进入循环时判断一次, 由代码生成器输出两种形式
+// ============================================
+
+void AODGraph::memoryHierarchy(const std::string& target_arch, int64_t streaming_bytes, int64_t prefetch_distance) {
+    AODPassReport report;
+    report.pass_name = "MemoryHierarchy";
+    report.nodes_before = getNodeCount();
+    if ((target_arch != "SVE" && target_arch != "NEON") || streaming_bytes <= 0) {
+        report.nodes_after = report.nodes_before;
+        pass_reports.push_back(report);
+        return;
+    }
+
+    auto statementOf = [&](const std::shared_ptr<AODNode>& node) {
+        int anchor = getStatementAnchor(*node);
+        return anchor < 0 ? node->getId() : anchor;
+    };
+
+    for (const auto& header : nodes) {
+        if (header->getProperty("step_width").empty()) continue;
+        const AODLoop* loop = nullptr;
+        for (const auto& candidate : getLoops()) {
+            if (candidate.header == header->getId()) loop = &candidate;
+        }
+        if (!loop || loop->irreducible) continue;
+        std::string where = "loop " + std::to_string(header->getId()) + ": ";
+
+        std::unordered_set<int> body(loop->body.begin(), loop->body.end());
+        std::set<std::string> loaded;
+        std::map<std::string, std::vector<std::shared_ptr<AODNode>>> stores;
+        for (const auto& node : nodes) {
+            int stmt = statementOf(node);
+            if (!body.count(stmt) || stmt == header->getId()) continue;
+            auto parts = splitIntrinsicName(node->getProperty("op_name"));
+            std::string pointer = addressVariable(node->getProperty("text_0"));
+            if (pointer.empty()) continue;
+            if (parts.first.find("load") != std::string::npos) loaded.insert(pointer);
+            // 部分写入 (maskstore) 保持普通存储
+            if (parts.first == "store" || parts.first == "storeu") stores[pointer].push_back(node);
+        }
+
+        // 每个计数单位对应的字节数由转换器按指针的元素大小给出
+        int64_t unit = std::max<int64_t>(1, std::atoll(header->getProperty("step_unit_bytes", "1").c_str()));
+        int64_t min_count = (streaming_bytes + unit - 1) / unit;
+        std::string written, prefetched;
+        for (const auto& [pointer, store_nodes] : stores) {
+            if (loaded.count(pointer)) continue;
+            for (const auto& store : store_nodes) {
+                store->setProperty("nontemporal", "true");
+                store->setProperty("stream_header", std::to_string(header->getId()));
+            }
+            written += (written.empty() ? "" : ", ") + pointer;
+        }
+        for (const auto& pointer : loaded) prefetched += (prefetched.empty() ? "" : ",") + pointer;
+        if (written.empty() && (prefetched.empty() || prefetch_distance <= 0)) {
+            report.details.push_back(where + "no write-only or read stream, kept");
+            continue;
+        }
+
+        header->setProperty("stream_min_count", std::to_string(min_count));
+        std::string detail = where;
+        if (!written.empty()) detail += "non-temporal stores to " + written;
+        if (!prefetched.empty() && prefetch_distance > 0) {
+            header->setProperty("prefetch_pointers", prefetched);
+            header->setProperty("prefetch_distance", std::to_string(prefetch_distance));
+            detail += (written.empty() ? "" : ", ") + std::string("prefetch of ") + prefetched + " " +
+                      std::to_string(prefetch_distance) + " bytes ahead";
+        }
+        report.nodes_changed++;
+        report.details.push_back(detail + " once " + header->getProperty("step_count") + " >= " + std::to_string(min_count));
+    }
+
+    report.nodes_after = getNodeCount();
+    pass_reports.push_back(report);
+}
+
+// ============================================
+// 优化: 强度削减
+// 乘/除/取模常量改写为移位、加法、掩码或乘高位+移位, 每条改写都先按目标代价表比较,
+// 且改写出的运算都须能在目标上生成 (lowerable)
+// ============================================
+
+void AODGraph::strengthReduction(const std::string& target_arch, const AODLowerable& lowerable) {
+    AODPassReport report;
+    report.pass_name = "StrengthReduction";
+    report.nodes_before = getNodeCount();
+    auto cost = [&](const char* op_class) { return getTargetOperationCost(target_arch, op_class); };
+    // 改写后的每个运算都须在目标上有对应通道位宽的模板, 否则生成的代码无法编译
+    auto canLower = [&](const std::vector<std::string>& ops, int lane_bits) {
+        if (!lowerable) return false;
+        for (const auto& op : ops) {
+            if (!lowerable(op, lane_bits)) return false;
+        }
+        return true;
+    };
+
+    std::unordered_map<int, std::map<int, std::shared_ptr<AODNode>>> operands;
+    for (const auto& edge : edges) {
+        if (isOperandEdge(*edge)) operands[edge->getTarget()->getId()][getOperandIndex(*edge)] = edge->getSource();
+    }
+
+    // 操作数: 图中的节点, 或只记录在属性里的立即数/源码文本
+    struct Operand {
+        std::shared_ptr<AODNode> node;
+        std::string imm, text, stable;
+    };
+    auto operandOf = [&](const std::shared_ptr<AODNode>& node, int i) {
+        Operand op;
+        auto it = operands[node->getId()].find(i);
+        if (it != operands[node->getId()].end()) op.node = it->second;
+        std::string index = std::to_string(i);
+        op.imm = node->getProperty("imm_" + index);
+        op.text = node->getProperty("text_" + index);
+        op.stable = node->getProperty("stable_" + index);
+        return op;
+    };
+    auto setOperands = [&](const std::shared_ptr<AODNode>& node, const std::vector<Operand>& ops) {
+        edges.erase(std::remove_if(edges.begin(), edges.end(), [&](const std::shared_ptr<AODEdge>& edge) {
+            return edge->getTarget() == node && isOperandEdge(*edge);
+        }), edges.end());
+        int old_count = std::stoi(node->getProperty("operand_count", "0"));
+        for (int i = 0; i < std::max<int>(old_count, ops.size()); ++i) {
+            std::string index = std::to_string(i);
+            const Operand* op = i < static_cast<int>(ops.size()) ? &ops[i] : nullptr;
+            node->setProperty("imm_" + index, op ? op->imm : "");
+            node->setProperty("text_" + index, op ? op->text : "");
+            node->setProperty("stable_" + index, op ? op->stable : "");
+            if (op && op->node) addEdge(op->node, node, AODEdgeType::Data, "arg_" + index);
+        }
+        node->setProperty("operand_count", std::to_string(ops.size()));
+        operands.erase(node->getId());
+        for (size_t i = 0; i < ops.size(); ++i) {
+            if (ops[i].node) operands[node->getId()][static_cast<int>(i)] = ops[i].node;
+        }
+    };
+    auto immediate = [](const std::string& value) {
+        Operand op;
+        op.imm = op.text = value;
+        return op;
+    };
+    auto newExpression = [&](const std::shared_ptr<AODNode>& like, const std::string& op_name,
+                             const std::vector<Operand>& ops) {
+        auto node = std::make_shared<AODNode>(AODNodeType::SIMD_Intrinsic, "SIMD_Op");
+        node->setProperty("op_name", op_name);
+        node->setProperty("value_type", like->getProperty("value_type"));
+        node->setProperty("stmt_anchor", like->getProperty("stmt_anchor"));
+        node->setProperty("derived_from", std::to_string(like->getId()));
+        node->setIsStatement(false);
+        addNode(node);
+        setOperands(node, ops);
+        return node;
+    };
+
+    // 向量操作数是常量 splat 时取出通道值
+    auto splatValue = [&](const Operand& op, int width, uint64_t& value) {
+        if (!op.node) return false;
+        auto parts = splitIntrinsicName(op.node->getProperty("op_name"));
+        std::string kind = op.node->getProperty("const_kind");
+        if (kind == "vector_int") {
+            int lane = std::stoi(op.node->getProperty("const_lane"));
+            value = splat(static_cast<uint64_t>(std::stoll(op.node->getProperty("const_value"))), lane) & laneMask(width);
+            return true;
+        }
+        if (parts.first == "set1" && parseLaneFormat(parts.second).width == width && !op.node->getProperty("imm_0").empty()) {
+            value = static_cast<uint64_t>(std::stoll(op.node->getProperty("imm_0"))) & laneMask(width);
+            return true;
+        }
+        return false;
+    };
+    auto log2Exact = [](uint64_t v) {
+        if (v == 0 || (v & (v - 1)) != 0) return -1;
+        int k = 0;
+        while ((v >> k) != 1) ++k;
+        return k;
+    };
+    auto record = [&](const std::shared_ptr<AODNode>& node, const std::string& from, const std::string& detail) {
+        node->setProperty("strength_reduced_from", from);
+        report.nodes_changed++;
+        report.details.push_back(from + " -> " + detail);
+    };
+
+    std::vector<std::shared_ptr<AODNode>> snapshot = nodes;
+    for (const auto& node : snapshot) {
+        if (!getNode(node->getId()) || node->isStatement() || !node->getProperty("const_kind").empty()) continue;
+        std::string op = node->getProperty("op_name");
+        if (node->getProperty("operand_count").empty()) continue;
+
+        // 标量浮点 (NEON 路径整体向量化): x * 2 -> x + x, x / 2^k -> x * 2^-k, 两者都是精确的
+        if (op == "*" || op == "/") {
+            std::string type = node->getProperty("value_type");
+            if (type != "float" && type != "double") continue;
+            Operand lhs = operandOf(node, 0), rhs = operandOf(node, 1);
+            if (op == "*" && cost("fadd") <= cost("fmul")) {
+                Operand* other = nullptr;
+                if (!lhs.node && !lhs.imm.empty() && std::stod(lhs.imm) == 2.0) other = &rhs;
+                else if (!rhs.node && !rhs.imm.empty() && std::stod(rhs.imm) == 2.0) other = &lhs;
+                // x 会被引用两次, 只接受语句 (变量) 操作数, 避免重复计算表达式
+                if (!other || !other->imm.empty() || (other->node && !other->node->isStatement())) continue;
+                if (!canLower({"+"}, 0)) continue;
+                Operand x = *other;
+                node->setProperty("op_name", "+");
+                setOperands(node, {x, x});
+                record(node, "*", "x + x");
+            } else if (op == "/" && cost("fmul") < cost("fdiv") && !rhs.node && !rhs.imm.empty() && canLower({"*"}, 0)) {
+                int exponent = 0;
+                double divisor = std::stod(rhs.imm);
+                if (divisor == 0.0 || std::frexp(divisor, &exponent) != (divisor > 0 ? 0.5 : -0.5)) continue;
+                std::ostringstream reciprocal;
+                reciprocal.precision(17);
+                reciprocal << 1.0 / divisor;
+                std::string literal = reciprocal.str();
+                if (literal.find_first_of(".e") == std::string::npos) literal += ".0";
+                Operand r = immediate(reciprocal.str());
+                r.text = literal + (type == "float" ? "f" : "");
+                node->setProperty("op_name", "*");
+                setOperands(node, {lhs, r});
+                record(node, "/", "x * " + r.text);
+            }
+            continue;
+        }
+
+        auto parts = splitIntrinsicName(op);
+        LaneFormat fmt = parseLaneFormat(parts.second);
+        if (fmt.is_float || fmt.width == 0 || fmt.width > 32) continue;
+        const int width = fmt.width;
+        const std::string w = std::to_string(width);
+        const std::string prefix = op.substr(0, op.find('_', 3) + 1);  // "_mm256_"
+        Operand x = operandOf(node, 0), c = operandOf(node, 1);
+        uint64_t value = 0;
+        // 变量或立即数可以重复引用, 表达式操作数重复引用会被计算两次
+        bool x_reusable = !x.node || x.node->isStatement();
+
+        // 逐通道移位: 16/32 位通道直接 slli/srli; AVX2 没有 8 位移位, 按 16 位移位后用掩码清掉跨通道移入的位
+        auto shiftOps = [&](bool left) {
+            std::string name = prefix + (left ? "slli_epi" : "srli_epi");
+            if (width != 8) return std::vector<std::string>{name + w};
+            return std::vector<std::string>{name + "16", prefix + "and_si256", prefix + "set1_epi8"};
+        };
+        auto canShift = [&](bool left) { return canLower(shiftOps(left), width); };
+        auto shiftCost = [&]() { return cost("shift") + (width == 8 ? cost("logic") : 0); };
+        auto rewriteShift = [&](const std::shared_ptr<AODNode>& target, bool left, const Operand& input, int amount) {
+            if (width != 8) {
+                target->setProperty("op_name", prefix + (left ? "slli_epi" : "srli_epi") + w);
+                setOperands(target, {input, immediate(std::to_string(amount))});
+                return;
+            }
+            uint64_t keep = (left ? (0xFFULL << amount) : (0xFFULL >> amount)) & 0xFF;
+            Operand shifted, mask;
+            shifted.node = newExpression(target, prefix + (left ? "slli_epi16" : "srli_epi16"), {input, immediate(std::to_string(amount))});
+            mask.node = newExpression(target, prefix + "set1_epi8", {immediate(std::to_string(static_cast<int8_t>(keep)))});
+            target->setProperty("op_name", prefix + "and_si256");
+            setOperands(target, {shifted, mask});
+        };
+
+        if (parts.first == "mullo") {
+            if (!splatValue(c, width, value)) {
+                std::swap(x, c);
+                x_reusable = !x.node || x.node->isStatement();
+                if (!splatValue(c, width, value)) continue;
+            }
+            int k = log2Exact(value);
+            if (k < 1) continue;
+            if (k == 1 && x_reusable && width != 8 && cost("add") <= cost("shift") && cost("add") < cost("mul") &&
+                canLower({prefix + "add_epi" + w}, width)) {
+                node->setProperty("op_name", prefix + "add_epi" + w);
+                setOperands(node, {x, x});
+                record(node, op, "x + x");
+            } else if (shiftCost() < cost("mul") && canShift(true)) {
+                rewriteShift(node, true, x, k);
+                record(node, op, "x << " + std::to_string(k));
+            } else {
+                continue;
+            }
+            if (!c.node || !getOperandUsers(c.node->getId()).empty()) continue;
+            report.instructions_saved += removeDeadOperands({c.node});
+            continue;
+        }
+
+        if ((parts.first != "div" && parts.first != "rem") || !fmt.is_unsigned || !splatValue(c, width, value) || value == 0) continue;
+        std::shared_ptr<AODNode> divisor = c.node;
+        int k = log2Exact(value);
+
+        if (parts.first == "rem") {
+            if (k < 0 || cost("logic") >= cost("div") || !canLower({prefix + "and_si256", prefix + "set1_epi" + w}, width)) continue;
+            auto mask = newExpression(node, prefix + "set1_epi" + w, {immediate(std::to_string(value - 1))});
+            node->setProperty("op_name", prefix + "and_si256");
+            Operand m;
+            m.node = mask;
+            setOperands(node, {x, m});
+            record(node, op, "x & " + std::to_string(value - 1));
+        } else if (k >= 0) {
+            if (shiftCost() >= cost("div") || !canShift(false)) continue;
+            rewriteShift(node, false, x, k);
+            record(node, op, "x >> " + std::to_string(k));
+        } else {
+            // 无符号除常量 (只有 16 位通道有 mulhi_epu16):
+            //   t = mulhi(x, m), q = (((x - t) >> 1) + t) >> (l - 1)
+            //   l = ceil(log2 d), m = ceil(2^(16+l) / d) - 2^16; d 不是 2 的幂时 ceil(2^(16+l) / d) 总在 [2^16, 2^17) 内
+            if (width != 16) continue;
+            int sequence_cost = cost("mulhi") + 2 * cost("shift") + 2 * cost("add");
+            if (sequence_cost >= cost("div")) continue;
+            if (!x_reusable) continue;  // x 会被引用两次, 避免重复计算表达式
+            if (!canLower({prefix + "set1_epi16", prefix + "mulhi_epu16", prefix + "sub_epi16", prefix + "srli_epi16",
+                           prefix + "add_epi16"}, width)) {
+                continue;
+            }
+            int l = 0;
+            while ((1ULL << l) < value) ++l;
+            // ceil(n / d) = (n - 1) / d + 1
+            uint64_t m = (((1ULL << (16 + l)) - 1) / value + 1) - (1ULL << 16);
+
+            Operand mul;
+            mul.node = newExpression(node, prefix + "set1_epi16", {immediate(std::to_string(static_cast<int16_t>(m)))});
+            Operand t, diff, half, sum;
+            t.node = newExpression(node, prefix + "mulhi_epu16", {x, mul});
+            diff.node = newExpression(node, prefix + "sub_epi16", {x, t});
+            half.node = newExpression(node, prefix + "srli_epi16", {diff, immediate("1")});
+            sum.node = newExpression(node, prefix + "add_epi16", {half, t});
+            node->setProperty("op_name", prefix + "srli_epi16");
+            setOperands(node, {sum, immediate(std::to_string(l - 1))});
+            record(node, op, "mulhi(x, " + std::to_string(m) + ") fixup >> " + std::to_string(l));
+        }
+        if (divisor && getOperandUsers(divisor->getId()).empty()) report.instructions_saved += removeDeadOperands({divisor});
+        report.instructions_saved++;  // 除法本身
+    }
+
+    report.nodes_after = getNodeCount();
+    pass_reports.push_back(report);
+}
+
+namespace {
+
+// e-graph 中的一个 e-node: 运算名 + 操作数 e-class
+// "#leaf" 为不展开的图节点 (语句/非纯运算), payload 为节点ID; "#imm"/"#text" 为只记录在属性里的立即数/源码文本
+struct ENode {
+    std::string op;
+    std::vector<int> children;
+    std::string payload;
+
+    bool operator==(const ENode& other) const {
+        return op == other.op && children == other.children && payload == other.payload;
+    }
+};
+
+struct ENodeHash {
+    size_t operator()(const ENode& node) const {
+        size_t h = std::hash<std::string>()(node.op) ^ (std::hash<std::string>()(node.payload) << 1);
+        for (int c : node.children) h = h * 1000003u ^ static_cast<size_t>(c);
+        return h;
+    }
+};
+
+// 并查集 + hashcons, 合并后由 rebuild 恢复同余闭包
+// 每个 e-class 附带常量分析 (复用 SCCP 的 evaluateIntrinsic), 用于 splat 折叠与恒等式判定
+class EGraph {
+public:
+    int find(int id) {
+        while (parent[id] != id) {
+            parent[id] = parent[parent[id]];
+            id = parent[id];
+        }
+        return id;
+    }
+
+    int add(ENode node) {
+        for (int& c : node.children) c = find(c);
+        auto it = memo.find(node);
+        if (it != memo.end()) return find(it->second);
+        int id = static_cast<int>(parent.size());
+        parent.push_back(id);
+        values.push_back(evaluate(node));
+        classes.push_back({node});
+        memo.emplace(std::move(node), id);
+        enode_count++;
+        return id;
+    }
+
+    bool merge(int a, int b) {
+        a = find(a);
+        b = find(b);
+        if (a == b) return false;
+        if (classes[a].size() < classes[b].size()) std::swap(a, b);
+        parent[b] = a;
+        classes[a].insert(classes[a].end(), classes[b].begin(), classes[b].end());
+        classes[b].clear();
+        if (!values[a].isConst()) values[a] = values[b];
+        dirty = true;
+        return true;
+    }
+
+    void rebuild() {
+        while (dirty) {
+            dirty = false;
+            std::vector<std::pair<ENode, int>> all;
+            for (int id = 0; id < static_cast<int>(classes.size()); ++id) {
+                for (const auto& node : classes[id]) all.emplace_back(node, id);
+            }
+            memo.clear();
+            for (auto& [node, id] : all) {
+                for (int& c : node.children) c = find(c);
+                auto inserted = memo.emplace(node, id);
+                if (!inserted.second) merge(inserted.first->second, id);
+            }
+            enode_count = 0;
+            for (int id = 0; id < static_cast<int>(classes.size()); ++id) {
+                auto& list = classes[id];
+                for (auto& node : list) {
+                    for (int& c : node.children) c = find(c);
+                }
+                std::sort(list.begin(), list.end(), [](const ENode& x, const ENode& y) {
+                    return std::tie(x.op, x.children, x.payload) < std::tie(y.op, y.children, y.payload);
+                });
+                list.erase(std::unique(list.begin(), list.end()), list.end());
+                enode_count += list.size();
+            }
+        }
+    }
+
+    const std::vector<ENode>& nodes(int id) { return classes[find(id)]; }
+    const LatticeValue& value(int id) { return values[find(id)]; }
+    bool isVector(int id, uint64_t bits) { return value(id).isVector(bits); }
+    size_t size() const { return enode_count; }
+    int classCount() const { return static_cast<int>(classes.size()); }
+
+    LatticeValue evaluate(const ENode& node) {
+        if (node.op == "#imm") {
+            char* end = nullptr;
+            double v = std::strtod(node.payload.c_str(), &end);
+            return end && *end == '\0' ? LatticeValue::number(v) : LatticeValue::bottom();
+        }
+        if (node.op.rfind("_mm", 0) != 0) return LatticeValue::bottom();
+        std::vector<LatticeValue> args;
+        for (int c : node.children) args.push_back(values[find(c)].isConst() ? values[find(c)] : LatticeValue::bottom());
+        LatticeValue v = evaluateIntrinsic(node.op, args);
+        return v.isConst() ? v : LatticeValue::bottom();
+    }
+
+private:
+    std::vector<int> parent;
+    std::vector<std::vector<ENode>> classes;
+    std::vector<LatticeValue> values;
+    std::unordered_map<ENode, int, ENodeHash> memo;
+    size_t enode_count = 0;
+    bool dirty = false;
+};
+
+// 向量常量的最便宜物化形式: 全零用 setzero, 其余取能表示该位模式的最窄 set1
+ENode constantNode(EGraph& egraph, const std::string& prefix, uint64_t bits) {
+    if (bits == 0) return {prefix + "setzero_si256", {}, ""};
+    int width = 8;
+    while (width < 64 && splat(bits, width) != bits) width *= 2;
+    std::string lane = std::to_string(signExtend(bits & laneMask(width), width));
+    int imm = egraph.add({"#imm", {}, lane});
+    return {prefix + "set1_epi" + std::to_string(width) + (width == 64 ? "x" : ""), {imm}, ""};
+}
+
+// 简化后的表达式文本, 用于报告
+std::string describeExpression(const std::string& op, const std::vector<std::string>& args) {
+    std::string name = op;
+    auto parts = splitIntrinsicName(op);
+    if (!parts.first.empty()) name = parts.first;
+    if (args.empty()) return name;
+    std::string out = name + "(";
+    for (size_t i = 0; i < args.size(); ++i) out += (i ? ", " : "") + args[i];
+    return out + ")";
+}
+
+} // namespace
+
+// 等式饱和: 把纯 SIMD 表达式树装入 e-graph, 反复应用代数恒等式直到不再产生新等价 (或达到资源上限),
+// 再按目标架构的延迟表为每个表达式根提取代价最低的等价形式, 只在严格更便宜时改写图
+void AODGraph::equalitySaturation(const std::string& target_arch, const AODLowerable& lowerable,
+                                  const AODSaturationLimits& limits) {
+    AODPassReport report;
+    report.pass_name = "EqualitySaturation";
+    report.nodes_before = getNodeCount();
+    if (!lowerable) {
+        report.details.push_back("no lowering predicate for target, skipped");
+        report.nodes_after = report.nodes_before;
+        pass_reports.push_back(report);
+        return;
+    }
+    auto started = std::chrono::steady_clock::now();
+    auto elapsedMs = [&] {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - started).count();
+    };
+
+    std::unordered_map<int, std::map<int, std::shared_ptr<AODNode>>> operands;
+    std::unordered_map<int, int> user_count, pure_user_count;
+    auto expandable = [](const std::shared_ptr<AODNode>& node) {
+        std::string op = node->getProperty("op_name");
+        return !node->isStatement() && op.rfind("_mm", 0) == 0 && isPureOperationName(op) && node->isSideEffectFree() &&
+               !node->getProperty("operand_count").empty() && node->getProperty("const_kind").empty();
+    };
+    for (const auto& edge : edges) {
+        if (!isOperandEdge(*edge)) continue;
+        operands[edge->getTarget()->getId()][getOperandIndex(*edge)] = edge->getSource();
+        user_count[edge->getSource()->getId()]++;
+        if (expandable(edge->getTarget())) pure_user_count[edge->getSource()->getId()]++;
+    }
+
+    // 1. 建图: 表达式根是被语句或非纯运算使用的可展开节点
+    EGraph egraph;
+    std::unordered_map<int, int> class_of;
+    std::unordered_map<std::string, std::string> imm_text;
+    std::function<int(const std::shared_ptr<AODNode>&)> classOf = [&](const std::shared_ptr<AODNode>& node) {
+        auto known = class_of.find(node->getId());
+        if (known != class_of.end()) return known->second;
+        int id;
+        if (!expandable(node)) {
+            id = egraph.add({"#leaf", {}, std::to_string(node->getId())});
+        } else {
+            ENode enode{node->getProperty("op_name"), {}, ""};
+            int count = std::stoi(node->getProperty("operand_count"));
+            for (int i = 0; i < count; ++i) {
+                auto it = operands[node->getId()].find(i);
+                std::string index = std::to_string(i);
+                std::string imm = node->getProperty("imm_" + index), text = node->getProperty("text_" + index);
+                if (it != operands[node->getId()].end()) {
+                    enode.children.push_back(classOf(it->second));
+                } else if (!imm.empty()) {
+                    imm_text.emplace(imm, text.empty() ? imm : text);
+                    enode.children.push_back(egraph.add({"#imm", {}, imm}));
+                } else {
+                    enode.children.push_back(egraph.add({"#text", {}, text}));
+                }
+            }
+            id = egraph.add(enode);
+        }
+        class_of[node->getId()] = id;
+        return id;
+    };
+
+    std::vector<std::shared_ptr<AODNode>> roots;
+    for (const auto& node : nodes) {
+        if (!expandable(node) || user_count[node->getId()] == 0) continue;
+        if (pure_user_count[node->getId()] == user_count[node->getId()]) continue;  // 只被纯表达式使用, 随其根一起处理
+        roots.push_back(node);
+        classOf(node);
+    }
+    if (roots.empty()) {
+        report.nodes_after = getNodeCount();
+        pass_reports.push_back(report);
+        return;
+    }
+
+    // 2. 饱和: 每轮对快照中的全部 e-node 匹配规则, 收集等价对后统一合并
+    const uint64_t ones = ~0ULL;
+    auto bitwise = [](const std::string& base) { return base == "and" || base == "or" || base == "xor" || base == "andnot"; };
+    std::string stop_reason = "saturated";
+    int iteration = 0;
+    for (; iteration < limits.max_iterations; ++iteration) {
+        std::vector<std::pair<int, int>> unions;
+        std::vector<std::pair<int, ENode>> additions;
+
+        struct Match { int cls; ENode node; };
+        std::vector<Match> snapshot;
+        for (int id = 0; id < egraph.classCount(); ++id) {
+            if (egraph.find(id) != id) continue;
+            for (const auto& node : egraph.nodes(id)) snapshot.push_back({id, node});
+        }
+
+        // 在 e-class 中查找给定运算名 (同前缀与后缀) 的 e-node
+        auto nodesOf = [&](int cls, const std::string& op) {
+            std::vector<ENode> found;
+            for (const auto& node : egraph.nodes(cls)) {
+                if (node.op == op) found.push_back(node);
+            }
+            return found;
+        };
+        // not(x) 统一表示为 xor(x, 全一)
+        auto negated = [&](int cls, const std::string& xor_op, int& inner) {
+            for (const auto& node : nodesOf(cls, xor_op)) {
+                if (egraph.isVector(node.children[1], ones)) { inner = node.children[0]; return true; }
+                if (egraph.isVector(node.children[0], ones)) { inner = node.children[1]; return true; }
+            }
+            return false;
+        };
+
+        for (const auto& [cls, node] : snapshot) {
+            if (node.op.rfind("_mm", 0) != 0) continue;
+            auto parts = splitIntrinsicName(node.op);
+            LaneFormat fmt = parseLaneFormat(parts.second);
+            if (fmt.is_float || parts.first.empty()) continue;
+            const std::string prefix = node.op.substr(0, node.op.find('_', 3) + 1);
+            const std::string& base = parts.first;
+            const std::string and_op = prefix + "and_" + parts.second, or_op = prefix + "or_" + parts.second;
+            const std::string xor_op = prefix + "xor_" + parts.second, andnot_op = prefix + "andnot_" + parts.second;
+            auto constant = [&](uint64_t bits) { return constantNode(egraph, prefix, bits); };
+
+            // 常量折叠 (含 and 0 / or 全一 这类单侧决定的结果)
+            LatticeValue v = egraph.value(cls);
+            if (!v.isConst()) v = egraph.evaluate(node);  // 操作数在合并后才成为常量
+            if (v.isConst() && v.is_vector && base != "setzero" && base != "set1") additions.push_back({cls, constant(v.bits)});
+            if (node.children.size() != 2) continue;
+            int a = node.children[0], b = node.children[1];
+
+            if (isCommutativeOperationName(node.op) && a != b) additions.push_back({cls, {node.op, {b, a}, ""}});
+
+            // 结合律 (仅按位运算): op(op(x, y), z) -> op(x, op(y, z))
+            if (base == "and" || base == "or" || base == "xor") {
+                for (const auto& inner : nodesOf(a, node.op)) {
+                    int yz = egraph.add({node.op, {inner.children[1], b}, ""});
+                    additions.push_back({cls, {node.op, {inner.children[0], yz}, ""}});
+                }
+            }
+
+            // 幂等与自反
+            if (a == b) {
+                if (base == "and" || base == "or" || base == "min" || base == "max") unions.push_back({cls, a});
+                if (base == "xor" || base == "andnot" || base == "sub" || base == "cmpgt") additions.push_back({cls, constant(0)});
+                if (base == "cmpeq") additions.push_back({cls, constant(ones)});
+            }
+
+            // 单位元
+            if ((base == "and" && egraph.isVector(b, ones)) || ((base == "or" || base == "xor" || base == "add" || base == "sub") && egraph.isVector(b, 0)) ||
+                ((base == "slli" || base == "srli" || base == "srai") && egraph.value(b).isConst() && !egraph.value(b).is_vector &&
+                 egraph.value(b).scalar == 0.0)) {
+                unions.push_back({cls, a});
+            }
+            if (base == "andnot" && egraph.isVector(a, 0)) unions.push_back({cls, b});
+            if (!bitwise(base) || parts.second != "si256") continue;  // and_epi32 等只在 AVX-512 上有对应的 or/andnot
+
+            // 取反: andnot(x, 全一) == xor(x, 全一); not(not(x)) -> x; and(not(x), y) -> andnot(x, y)
+            if (base == "andnot" && egraph.isVector(b, ones)) additions.push_back({cls, {xor_op, {a, b}, ""}});
+            int inner = -1;
+            if (base == "xor" && egraph.isVector(b, ones) && negated(a, xor_op, inner)) unions.push_back({cls, inner});
+            if (base == "and" && negated(a, xor_op, inner)) additions.push_back({cls, {andnot_op, {inner, b}, ""}});
+
+            // 吸收律
+            std::vector<ENode> b_nodes = egraph.nodes(b);  // 规则内会加入新 e-node, 不能持有引用
+            for (const auto& n : b_nodes) {
+                if (n.children.size() != 2) continue;
+                bool left = egraph.find(n.children[0]) == egraph.find(a);
+                bool right = egraph.find(n.children[1]) == egraph.find(a);
+                if (base == "and" && n.op == or_op && left) unions.push_back({cls, a});                  // a & (a | y) = a
+                if (base == "or" && n.op == and_op && left) unions.push_back({cls, a});                  // a | (a & y) = a
+                if (base == "and" && n.op == andnot_op && left) additions.push_back({cls, constant(0)}); // a & (~a & y) = 0
+                if (base == "and" && n.op == andnot_op && right) unions.push_back({cls, b});             // a & (~x & a) = ~x & a
+                if (base == "or" && n.op == andnot_op && left) additions.push_back({cls, {or_op, {a, n.children[1]}, ""}});
+                if (base == "andnot" && n.op == and_op && left) additions.push_back({cls, constant(0)}); // ~a & (a & y) = 0
+                if (base == "andnot" && n.op == andnot_op && left) unions.push_back({cls, b});           // ~a & (~a & y)
+            }
+            if (negated(b, xor_op, inner) && egraph.find(inner) == egraph.find(a)) {
+                if (base == "and") additions.push_back({cls, constant(0)});      // a & ~a
+                if (base == "or" || base == "xor") additions.push_back({cls, constant(ones)});
+            }
+
+            // 互斥的比较对: gt(x, y) 与 gt(y, x) / eq(x, y) 不会同时为真
+            std::vector<ENode> a_nodes = egraph.nodes(a);
+            for (const auto& p : a_nodes) {
+                auto pp = splitIntrinsicName(p.op);
+                if (pp.first != "cmpgt" || p.children.size() != 2) continue;
+                int x = egraph.find(p.children[0]), y = egraph.find(p.children[1]);
+                const std::string eq_op = prefix + "cmpeq_" + pp.second;
+                for (const auto& q : b_nodes) {
+                    if (q.children.size() != 2) continue;
+                    int qx = egraph.find(q.children[0]), qy = egraph.find(q.children[1]);
+                    bool swapped = q.op == p.op && qx == y && qy == x;
+                    bool equal = q.op == eq_op && ((qx == x && qy == y) || (qx == y && qy == x));
+                    if (!swapped && !equal) continue;
+                    if (base == "and") additions.push_back({cls, constant(0)});
+                    if (base == "andnot") unions.push_back({cls, b});
+                    if (base == "xor") additions.push_back({cls, {or_op, {a, b}, ""}});
+                    if (base == "or" && swapped) {
+                        int eq = egraph.add({eq_op, {x, y}, ""});
+                        additions.push_back({cls, {xor_op, {eq, egraph.add(constant(ones))}, ""}});
+                    }
+                    if (base == "or" && equal) {
+                        int swapped_gt = egraph.add({p.op, {y, x}, ""});
+                        additions.push_back({cls, {xor_op, {swapped_gt, egraph.add(constant(ones))}, ""}});
+                    }
+                }
+            }
+        }
+
+        bool changed = false;
+        for (auto& [cls, enode] : additions) {
+            int id = egraph.add(enode);
+            changed |= egraph.merge(cls, id);
+        }
+        for (const auto& [x, y] : unions) changed |= egraph.merge(x, y);
+        egraph.rebuild();
+
+        if (!changed) break;
+        if (egraph.size() > limits.max_enodes) { stop_reason = "e-node limit"; ++iteration; break; }
+        if (elapsedMs() > limits.time_limit_ms) { stop_reason = "time limit"; ++iteration; break; }
+    }
+    if (iteration == limits.max_iterations) stop_reason = "iteration limit";
+
+    // 3. 提取: 自底向上不动点, 代价为所选树上各运算在目标架构上的延迟之和
+    // 改写出的节点没有 AST, 只能靠目标上的模板生成, 因此无模板的运算 (含原有运算) 代价为无穷;
+    // 按位运算 (si256) 与通道宽度无关, 其余按后缀的通道宽度匹配模板
+    const int kInfinite = 1 << 29;
+    std::unordered_map<std::string, bool> lowerable_cache;
+    auto ownCost = [&](const ENode& node) {
+        if (node.op[0] == '#') return 0;
+        auto cached = lowerable_cache.find(node.op);
+        if (cached == lowerable_cache.end()) {
+            std::string suffix = splitIntrinsicName(node.op).second;
+            int lane_bits = suffix.rfind("si", 0) == 0 ? 0 : parseLaneFormat(suffix).width;
+            cached = lowerable_cache.emplace(node.op, lowerable(node.op, lane_bits)).first;
+        }
+        return cached->second ? getOperationLatency(target_arch, node.op) : kInfinite;
+    };
+    std::vector<int> best_cost(egraph.classCount(), kInfinite);
+    std::vector<ENode> best_node(egraph.classCount());
+    for (bool changed = true; changed;) {
+        changed = false;
+        for (int id = 0; id < egraph.classCount(); ++id) {
+            if (egraph.find(id) != id) continue;
+            for (const auto& node : egraph.nodes(id)) {
+                long long cost = ownCost(node);
+                for (int c : node.children) cost += best_cost[egraph.find(c)];
+                if (cost < best_cost[id]) {
+                    best_cost[id] = static_cast<int>(cost);
+                    best_node[id] = node;
+                    changed = true;
+                }
+            }
+        }
+    }
+
+    // 4. 改写: 为提取出的树创建新节点, 根的使用者改接到新根, 旧树由死操作数清理回收
+    std::function<int(const std::shared_ptr<AODNode>&, std::string&)> originalCost =
+        [&](const std::shared_ptr<AODNode>& node, std::string& text) {
+            if (!expandable(node)) {
+                text = node->isStatement() ? node->getProperty("var_name") : "#" + std::to_string(node->getId());
+                return 0;
+            }
+            std::string op = node->getProperty("op_name");
+            int cost = getOperationLatency(target_arch, op);
+            std::vector<std::string> args;
+            int count = std::stoi(node->getProperty("operand_count"));
+            for (int i = 0; i < count; ++i) {
+                auto it = operands[node->getId()].find(i);
+                std::string arg = node->getProperty("text_" + std::to_string(i));
+                if (it != operands[node->getId()].end()) cost += originalCost(it->second, arg);
+                args.push_back(arg);
+            }
+            text = describeExpression(op, args);
+            return cost;
+        };
+
+    for (const auto& root : roots) {
+        if (elapsedMs() > limits.time_limit_ms * 4) { stop_reason += ", rewrite time limit"; break; }
+        if (!getNode(root->getId())) continue;
+        int cls = egraph.find(class_of[root->getId()]);
+        std::string before;
+        int old_cost = originalCost(root, before);
+        if (best_cost[cls] >= old_cost) continue;
+
+        int old_ops = 0, new_ops = 0;
+        std::function<void(const std::shared_ptr<AODNode>&)> countOps = [&](const std::shared_ptr<AODNode>& node) {
+            if (!expandable(node)) return;
+            old_ops++;
+            for (const auto& [index, operand] : operands[node->getId()]) countOps(operand);
+        };
+        countOps(root);
+
+        // 提取结果引用的叶子可能已随此前改写的旧树一起删除
+        std::function<bool(int)> leavesAlive = [&](int id) {
+            const ENode& node = best_node[egraph.find(id)];
+            if (node.op == "#leaf") return getNode(std::stoi(node.payload)) != nullptr;
+            return std::all_of(node.children.begin(), node.children.end(), leavesAlive);
+        };
+        if (!leavesAlive(cls)) continue;
+
+        std::map<int, std::shared_ptr<AODNode>> built;
+        std::function<std::shared_ptr<AODNode>(int, std::string&)> build = [&](int id, std::string& text) -> std::shared_ptr<AODNode> {
+            id = egraph.find(id);
+            const ENode& node = best_node[id];
+            if (node.op == "#leaf") {
+                auto leaf = getNode(std::stoi(node.payload));
+                text = leaf->isStatement() ? leaf->getProperty("var_name") : "#" + node.payload;
+                return leaf;
+            }
+            std::vector<std::string> args(node.children.size());
+            std::vector<std::shared_ptr<AODNode>> inputs(node.children.size());
+            for (size_t i = 0; i < node.children.size(); ++i) {
+                const ENode& child = best_node[egraph.find(node.children[i])];
+                if (child.op == "#imm" || child.op == "#text") {
+                    args[i] = child.op == "#imm" && imm_text.count(child.payload) ? imm_text[child.payload] : child.payload;
+                } else {
+                    inputs[i] = build(node.children[i], args[i]);
+                }
+            }
+            text = describeExpression(node.op, args);
+            auto cached = built.find(id);
+            if (cached != built.end()) return cached->second;
+
+            auto expr = std::make_shared<AODNode>(AODNodeType::SIMD_Intrinsic, "SIMD_Op");
+            expr->setProperty("op_name", node.op);
+            expr->setProperty("value_type", root->getProperty("value_type"));
+            expr->setProperty("stmt_anchor", root->getProperty("stmt_anchor"));
+            expr->setProperty("derived_from", std::to_string(root->getId()));
+            expr->setProperty("operand_count", std::to_string(node.children.size()));
+            expr->setIsStatement(false);
+            addNode(expr);
+            for (size_t i = 0; i < node.children.size(); ++i) {
+                std::string index = std::to_string(i);
+                if (inputs[i]) {
+                    addEdge(inputs[i], expr, AODEdgeType::Data, "arg_" + index);
+                    operands[expr->getId()][static_cast<int>(i)] = inputs[i];
+                } else {
+                    const ENode& child = best_node[egraph.find(node.children[i])];
+                    if (child.op == "#imm") expr->setProperty("imm_" + index, child.payload);
+                    expr->setProperty("text_" + index, args[i]);
+                }
+            }
+            new_ops++;
+            built[id] = expr;
+            return expr;
+        };
+        std::string after;
+        auto replacement = build(cls, after);
+
+        replaceAllUsesWith(root, replacement);
+        removeDeadOperands({root});
+        report.nodes_changed++;
+        report.instructions_saved += std::max(0, old_ops - new_ops);
+        report.details.push_back(before + " -> " + after + " (" + std::to_string(old_cost) + " -> " +
+                                 std::to_string(best_cost[cls]) + " cycles)");
+    }
+
+    report.details.push_back(stop_reason + " after " + std::to_string(iteration) + " iterations, " +
+                             std::to_string(egraph.size()) + " e-nodes, " +
+                             std::to_string(static_cast<int>(elapsedMs())) + " ms");
+    report.nodes_after = getNodeCount();
+    pass_reports.push_back(report);
+}
+
+bool AODGraph::isValid() const { return true; }
+std::vector<std::string> AODGraph::getValidationErrors() const { return {}; }
+void AODGraph::validateCycles() const {}
+void AODGraph::validateNoOrphanedNodes() const {}
+
+std::string AODGraph::toDOT() const {
+    std::ostringstream oss;
+    oss << "digraph " << name << " {\n";
+    for (const auto& node : nodes) {
+        oss << "  " << node->getId() << " [label=\"" << node->getDOTLabel() << "\", " << node->getDOTStyle() << "];\n";
+    }
+    for (const auto& edge : edges) {
+        oss << "  " << edge->getSource()->getId() << " -> " << edge->getTarget()->getId() << ";\n";
+    }
+    oss << "}\n";
+    return oss.str();
+}
+
+// ============================================
+// 序列化: GraphML 与二进制镜像
+// ============================================
+
+namespace {
+
+std::string escapeXml(const std::string& text) {
+    std::string out;
+    out.reserve(text.size());
+    for (char c : text) {
+        switch (c) {
+            case '&': out += "&amp;"; break;
+            case '<': out += "&lt;"; break;
+            case '>': out += "&gt;"; break;
+            case '"': out += "&quot;"; break;
+            default: out += c;
+        }
+    }
+    return out;
+}
+
+struct ImageHeader {
+    char magic[4];
+    uint32_t version;
+    uint32_t byte_order;
+    uint32_t graph_name;
+    uint32_t string_count;
+    uint32_t node_count;
+    uint32_t edge_count;
+    uint32_t attribute_count;
+    uint32_t string_bytes;
+};
+
+constexpr char kImageMagic[4] = {'A', 'O', 'D', 'G'};
+constexpr uint32_t kByteOrderMark = 0x01020304;
+
+static_assert(sizeof(ImageHeader) == 36, "image header must not contain padding");
+static_assert(sizeof(AODGraphImage::NodeRecord) == 32, "node record must not contain padding");
+static_assert(sizeof(AODGraphImage::EdgeRecord) == 28, "edge record must not contain padding");
+static_assert(sizeof(AODGraphImage::AttributeRecord) == 8, "attribute record must not contain padding");
+
+// 字符串驻留: 下标 0 固定为空串
+class StringTable {
+public:
+    StringTable() { intern(""); }
+
+    uint32_t intern(const std::string& text) {
+        auto it = index.find(text);
+        if (it != index.end()) return it->second;
+        uint32_t id = static_cast<uint32_t>(strings.size());
+        index.emplace(text, id);
+        strings.push_back(text);
+        return id;
+    }
+    const std::vector<std::string>& all() const { return strings; }
+
+private:
+    std::unordered_map<std::string, uint32_t> index;
+    std::vector<std::string> strings;
+};
+
+template <typename T>
+void appendRecord(std::string& out, const T& value) {
+    out.append(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template <typename T>
+T readRecord(const char* data, size_t offset) {
+    T value;
+    std::memcpy(&value, data + offset, sizeof(T));
+    return value;
+}
+
+void failImage(const std::string& reason) {
+    throw std::runtime_error("Invalid AOD graph image: " + reason);
+}
+
+bool hasSuffix(const std::string& text, const std::string& suffix) {
+    return text.size() >= suffix.size() && text.compare(text.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+}  // namespace
+
+AODGraphImage::AODGraphImage(const char* image_data, size_t image_size) : data(image_data), size(image_size) {
+    if (!data || size < sizeof(ImageHeader)) failImage("truncated header");
+    auto header = readRecord<ImageHeader>(data, 0);
+    if (std::memcmp(header.magic, kImageMagic, sizeof(kImageMagic)) != 0) failImage("bad magic");
+    if (header.version != kVersion) failImage("unsupported version " + std::to_string(header.version));
+    if (header.byte_order != kByteOrderMark) failImage("byte order mismatch");
+
+    graph_name = header.graph_name;
+    string_count = header.string_count;
+    node_count = header.node_count;
+    edge_count = header.edge_count;
+    attribute_count = header.attribute_count;
+    offsets_at = sizeof(ImageHeader);
+    nodes_at = offsets_at + (static_cast<size_t>(string_count) + 1) * sizeof(uint32_t);
+    edges_at = nodes_at + static_cast<size_t>(node_count) * sizeof(NodeRecord);
+    attributes_at = edges_at + static_cast<size_t>(edge_count) * sizeof(EdgeRecord);
+    strings_at = attributes_at + static_cast<size_t>(attribute_count) * sizeof(AttributeRecord);
+    if (string_count == 0 || strings_at > size || size - strings_at != header.string_bytes) failImage("section sizes do not match file size");
+
+    // 一次性校验全部下标, 之后的访问不再检查
+    if (read32(offsets_at) != 0) failImage("bad string offsets");
+    for (uint32_t i = 0; i < string_count; ++i) {
+        if (read32(offsets_at + i * sizeof(uint32_t)) > read32(offsets_at + (i + 1) * sizeof(uint32_t))) failImage("bad string offsets");
+    }
+    if (read32(offsets_at + string_count * sizeof(uint32_t)) != header.string_bytes) failImage("bad string offsets");
+    if (graph_name >= string_count) failImage("bad graph name");
+
+    auto check_range = [&](uint32_t begin, uint32_t count) {
+        if (static_cast<uint64_t>(begin) + count > attribute_count) failImage("attribute range out of bounds");
+    };
+    // 节点ID须唯一且可表示为 int: stmt_anchor 等属性按ID引用节点
+    std::unordered_set<uint32_t> ids;
+    ids.reserve(node_count);
+    for (uint32_t i = 0; i < node_count; ++i) {
+        NodeRecord record = node(i);
+        if (record.id > static_cast<uint32_t>(INT_MAX)) failImage("node id " + std::to_string(record.id) + " out of range");
+        if (!ids.insert(record.id).second) failImage("duplicate node id " + std::to_string(record.id));
+        if (record.type > static_cast<uint16_t>(AODNodeType::Unknown)) failImage("bad node type");
+        if (record.name >= string_count || record.type_name >= string_count || record.location >= string_count) failImage("bad node string");
+        check_range(record.attribute_begin, record.attribute_count);
+    }
+    for (uint32_t i = 0; i < edge_count; ++i) {
+        EdgeRecord record = edge(i);
+        if (record.type > static_cast<uint16_t>(AODEdgeType::Alias)) failImage("bad edge type");
+        if (record.source >= node_count || record.target >= node_count) failImage("edge endpoint out of bounds");
+        if (record.variable_name >= string_count) failImage("bad edge string");
+        check_range(record.attribute_begin, record.attribute_count);
+    }
+    for (uint32_t i = 0; i < attribute_count; ++i) {
+        AttributeRecord record = attribute(i);
+        if (record.key >= string_count || record.value >= string_count) failImage("bad attribute string");
+    }
+}
+
+AODGraphImage::~AODGraphImage() {
+    if (!mapping) return;
+#if defined(_WIN32)
+    delete[] static_cast<char*>(mapping);
+#else
+    munmap(mapping, size);
+#endif
+}
+
+std::shared_ptr<const AODGraphImage> AODGraphImage::mapFile(const std::string& filename) {
+#if defined(_WIN32)
+    std::ifstream in(filename, std::ios::binary | std::ios::ate);
+    if (!in) throw std::runtime_error("Cannot open AOD graph image: " + filename);
+    size_t file_size = static_cast<size_t>(in.tellg());
+    std::unique_ptr<char[]> buffer(new char[file_size == 0 ? 1 : file_size]);
+    in.seekg(0);
+    in.read(buffer.get(), static_cast<std::streamsize>(file_size));
+    std::shared_ptr<AODGraphImage> image(new AODGraphImage(buffer.get(), file_size));
+    image->mapping = buffer.release();
+    return image;
+#else
+    int fd = open(filename.c_str(), O_RDONLY);
+    if (fd < 0) throw std::runtime_error("Cannot open AOD graph image: " + filename);
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size == 0) {
+        close(fd);
+        throw std::runtime_error("Cannot map AOD graph image: " + filename);
+    }
+    size_t file_size = static_cast<size_t>(st.st_size);
+    void* mapped = mmap(nullptr, file_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (mapped == MAP_FAILED) throw std::runtime_error("Cannot map AOD graph image: " + filename);
+    try {
+        std::shared_ptr<AODGraphImage> image(new AODGraphImage(static_cast<const char*>(mapped), file_size));
+        image->mapping = mapped;
+        return image;
+    } catch (...) {
+        munmap(mapped, file_size);
+        throw;
+    }
+#endif
+}
+
+uint32_t AODGraphImage::read32(size_t offset) const { return readRecord<uint32_t>(data, offset); }
+
+AODGraphImage::NodeRecord AODGraphImage::node(uint32_t index) const {
+    return readRecord<NodeRecord>(data, nodes_at + static_cast<size_t>(index) * sizeof(NodeRecord));
+}
+
+AODGraphImage::EdgeRecord AODGraphImage::edge(uint32_t index) const {
+    return readRecord<EdgeRecord>(data, edges_at + static_cast<size_t>(index) * sizeof(EdgeRecord));
+}
+
+AODGraphImage::AttributeRecord AODGraphImage::attribute(uint32_t index) const {
+    return readRecord<AttributeRecord>(data, attributes_at + static_cast<size_t>(index) * sizeof(AttributeRecord));
+}
+
+std::string_view AODGraphImage::string(uint32_t index) const {
+    uint32_t begin = read32(offsets_at + static_cast<size_t>(index) * sizeof(uint32_t));
+    uint32_t end = read32(offsets_at + (static_cast<size_t>(index) + 1) * sizeof(uint32_t));
+    return std::string_view(data + strings_at + begin, end - begin);
+}
+
+std::string_view AODGraphImage::findAttribute(const NodeRecord& record, std::string_view key) const {
+    uint32_t lo = record.attribute_begin, hi = record.attribute_begin + record.attribute_count;
+    while (lo < hi) {
+        uint32_t mid = lo + (hi - lo) / 2;
+        AttributeRecord entry = attribute(mid);
+        int order = string(entry.key).compare(key);
+        if (order == 0) return string(entry.value);
+        if (order < 0) lo = mid + 1;
+        else hi = mid;
+    }
+    return {};
+}
+
+std::string AODGraph::serialize() const {
+    StringTable strings;
+    std::vector<AODGraphImage::NodeRecord> node_records;
+    std::vector<AODGraphImage::EdgeRecord> edge_records;
+    std::vector<AODGraphImage::AttributeRecord> attribute_records;
+    std::unordered_map<const AODNode*, uint32_t> node_index;
+
+    // 属性来自 std::map, 区间内天然按键有序, 读取端据此二分查找
+    auto append_attributes = [&](const std::map<std::string, std::string>& attributes, uint32_t& begin, uint32_t& count) {
+        begin = static_cast<uint32_t>(attribute_records.size());
+        count = static_cast<uint32_t>(attributes.size());
+        for (const auto& [key, value] : attributes) attribute_records.push_back({strings.intern(key), strings.intern(value)});
+    };
+
+    uint32_t graph_name = strings.intern(name);
+    node_records.reserve(nodes.size());
+    for (const auto& node : nodes) {
+        const auto& props = node->properties;
+        AODGraphImage::NodeRecord record{};
+        record.id = static_cast<uint32_t>(node->getId());
+        record.type = static_cast<uint16_t>(node->getType());
+        record.flags = (props.is_statement ? AODGraphImage::kNodeStatement : 0) |
+                       (props.has_side_effects ? AODGraphImage::kNodeSideEffects : 0);
+        record.name = strings.intern(props.name);
+        record.type_name = strings.intern(props.type);
+        record.location = strings.intern(props.location);
+        record.complexity = props.complexity;
+        append_attributes(props.attributes, record.attribute_begin, record.attribute_count);
+        node_index[node.get()] = static_cast<uint32_t>(node_records.size());
+        node_records.push_back(record);
+    }
+    edge_records.reserve(edges.size());
+    for (const auto& edge : edges) {
+        auto source = node_index.find(edge->getSource().get());
+        auto target = node_index.find(edge->getTarget().get());
+        if (source == node_index.end() || target == node_index.end()) continue;
+        const auto& props = edge->getProperties();
+        AODGraphImage::EdgeRecord record{};
+        record.source = source->second;
+        record.target = target->second;
+        record.type = static_cast<uint16_t>(edge->getType());
+        record.flags = props.is_critical ? AODGraphImage::kEdgeCritical : 0;
+        record.variable_name = strings.intern(props.variable_name);
+        record.weight = props.weight;
+        append_attributes(props.attributes, record.attribute_begin, record.attribute_count);
+        edge_records.push_back(record);
+    }
+
+    ImageHeader header{};
+    std::memcpy(header.magic, kImageMagic, sizeof(kImageMagic));
+    header.version = AODGraphImage::kVersion;
+    header.byte_order = kByteOrderMark;
+    header.graph_name = graph_name;
+    header.string_count = static_cast<uint32_t>(strings.all().size());
+    header.node_count = static_cast<uint32_t>(node_records.size());
+    header.edge_count = static_cast<uint32_t>(edge_records.size());
+    header.attribute_count = static_cast<uint32_t>(attribute_records.size());
+    size_t string_bytes = 0;
+    for (const auto& text : strings.all()) string_bytes += text.size();
+    if (string_bytes > UINT32_MAX) throw std::runtime_error("AOD graph too large to serialize");
+    header.string_bytes = static_cast<uint32_t>(string_bytes);
+
+    std::string out;
+    out.reserve(sizeof(ImageHeader) + (header.string_count + 1) * sizeof(uint32_t) +
+                node_records.size() * sizeof(AODGraphImage::NodeRecord) +
+                edge_records.size() * sizeof(AODGraphImage::EdgeRecord) +
+                attribute_records.size() * sizeof(AODGraphImage::AttributeRecord) + string_bytes);
+    appendRecord(out, header);
+    uint32_t offset = 0;
+    for (const auto& text : strings.all()) {
+        appendRecord(out, offset);
+        offset += static_cast<uint32_t>(text.size());
+    }
+    appendRecord(out, offset);
+    for (const auto& record : node_records) appendRecord(out, record);
+    for (const auto& record : edge_records) appendRecord(out, record);
+    for (const auto& record : attribute_records) appendRecord(out, record);
+    for (const auto& text : strings.all()) out += text;
+    return out;
+}
+
+AODGraph AODGraph::deserialize(const std::string& serialized) {
+    AODGraphImage image(serialized.data(), serialized.size());
+    return fromImage(image);
+}
+
+AODGraph AODGraph::fromImage(const AODGraphImage& image) {
+    AODGraph graph{std::string(image.graphName())};
+    std::vector<std::shared_ptr<AODNode>> by_index;
+    by_index.reserve(image.nodeCount());
+    graph.nodes.reserve(image.nodeCount());
+
+    int max_id = AODNode::next_id - 1;
+    for (uint32_t i = 0; i < image.nodeCount(); ++i) {
+        auto record = image.node(i);
+        auto node = std::make_shared<AODNode>(static_cast<AODNodeType>(record.type), std::string(image.string(record.name)));
+        // 保留原节点ID: stmt_anchor/alias_of 等属性按ID引用其他节点
+        node->id = static_cast<int>(record.id);
+        max_id = std::max(max_id, node->id);
+        auto& props = node->properties;
+        props.type = std::string(image.string(record.type_name));
+        props.location = std::string(image.string(record.location));
+        props.complexity = record.complexity;
+        props.is_statement = (record.flags & AODGraphImage::kNodeStatement) != 0;
+        props.has_side_effects = (record.flags & AODGraphImage::kNodeSideEffects) != 0;
+        for (uint32_t a = record.attribute_begin; a < record.attribute_begin + record.attribute_count; ++a) {
+            auto entry = image.attribute(a);
+            props.attributes.emplace_hint(props.attributes.end(), std::string(image.string(entry.key)), std::string(image.string(entry.value)));
+        }
+        by_index.push_back(node);
+        graph.addNode(node);
+    }
+    AODNode::next_id = max_id + 1;
+
+    graph.edges.reserve(image.edgeCount());
+    for (uint32_t i = 0; i < image.edgeCount(); ++i) {
+        auto record = image.edge(i);
+        auto edge = std::make_shared<AODEdge>(by_index[record.source], by_index[record.target], static_cast<AODEdgeType>(record.type));
+        edge->setVariableName(std::string(image.string(record.variable_name)));
+        edge->setWeight(record.weight);
+        edge->setCritical((record.flags & AODGraphImage::kEdgeCritical) != 0);
+        for (uint32_t a = record.attribute_begin; a < record.attribute_begin + record.attribute_count; ++a) {
+            auto entry = image.attribute(a);
+            edge->addAttribute(std::string(image.string(entry.key)), std::string(image.string(entry.value)));
+        }
+        graph.edges.push_back(edge);
+    }
+    return graph;
+}
+
+std::string AODGraph::toGraphML() const {
+    // 节点属性键不固定, 先收集并声明为 GraphML key
+    std::map<std::string, std::string> node_keys, edge_keys;
+    for (const auto& node : nodes) {
+        for (const auto& entry : node->getAttributes()) node_keys.emplace(entry.first, "");
+    }
+    for (const auto& edge : edges) {
+        for (const auto& entry : edge->getProperties().attributes) edge_keys.emplace(entry.first, "");
+    }
+    int key_id = 0;
+    for (auto& entry : node_keys) entry.second = "n" + std::to_string(key_id++);
+    key_id = 0;
+    for (auto& entry : edge_keys) entry.second = "e" + std::to_string(key_id++);
+
+    std::ostringstream oss;
+    oss << "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n";
+    oss << "<graphml xmlns=\"http://graphml.graphdrawing.org/xmlns\">\n";
+    oss << "  <key id=\"label\" for=\"node\" attr.name=\"label\" attr.type=\"string\"/>\n";
+    oss << "  <key id=\"kind\" for=\"node\" attr.name=\"kind\" attr.type=\"int\"/>\n";
+    oss << "  <key id=\"statement\" for=\"node\" attr.name=\"statement\" attr.type=\"boolean\"/>\n";
+    for (const auto& [key, id] : node_keys) {
+        oss << "  <key id=\"" << id << "\" for=\"node\" attr.name=\"" << escapeXml(key) << "\" attr.type=\"string\"/>\n";
+    }
+    oss << "  <key id=\"edge_kind\" for=\"edge\" attr.name=\"kind\" attr.type=\"int\"/>\n";
+    oss << "  <key id=\"variable\" for=\"edge\" attr.name=\"variable\" attr.type=\"string\"/>\n";
+    oss << "  <key id=\"weight\" for=\"edge\" attr.name=\"weight\" attr.type=\"int\"/>\n";
+    for (const auto& [key, id] : edge_keys) {
+        oss << "  <key id=\"" << id << "\" for=\"edge\" attr.name=\"" << escapeXml(key) << "\" attr.type=\"string\"/>\n";
+    }
+    oss << "  <graph id=\"" << escapeXml(name) << "\" edgedefault=\"directed\">\n";
+    for (const auto& node : nodes) {
+        oss << "    <node id=\"n" << node->getId() << "\">\n";
+        oss << "      <data key=\"label\">" << escapeXml(node->getName()) << "</data>\n";
+        oss << "      <data key=\"kind\">" << static_cast<int>(node->getType()) << "</data>\n";
+        oss << "      <data key=\"statement\">" << (node->isStatement() ? "true" : "false") << "</data>\n";
+        for (const auto& [key, value] : node->getAttributes()) {
+            oss << "      <data key=\"" << node_keys[key] << "\">" << escapeXml(value) << "</data>\n";
+        }
+        oss << "    </node>\n";
+    }
+    for (const auto& edge : edges) {
+        const auto& props = edge->getProperties();
+        oss << "    <edge source=\"n" << edge->getSource()->getId() << "\" target=\"n" << edge->getTarget()->getId() << "\">\n";
+        oss << "      <data key=\"edge_kind\">" << static_cast<int>(edge->getType()) << "</data>\n";
+        if (!props.variable_name.empty()) oss << "      <data key=\"variable\">" << escapeXml(props.variable_name) << "</data>\n";
+        oss << "      <data key=\"weight\">" << props.weight << "</data>\n";
+        for (const auto& [key, value] : props.attributes) {
+            oss << "      <data key=\"" << edge_keys[key] << "\">" << escapeXml(value) << "</data>\n";
+        }
+        oss << "    </edge>\n";
+    }
+    oss << "  </graph>\n</graphml>\n";
+    return oss.str();
+}
+
+void AODGraph::saveToFile(const std::string& filename) const {
+    std::string content;
+    if (hasSuffix(filename, ".dot")) content = toDOT();
+    else if (hasSuffix(filename, ".graphml")) content = toGraphML();
+    else content = serialize();
+
+    std::ofstream out(filename, std::ios::binary);
+    if (!out) throw std::runtime_error("Cannot write AOD graph: " + filename);
+    out.write(content.data(), static_cast<std::streamsize>(content.size()));
+    if (!out) throw std::runtime_error("Cannot write AOD graph: " + filename);
+}
+
+AODGraph AODGraph::loadFromFile(const std::string& filename) {
+    auto image = AODGraphImage::mapFile(filename);
+    return fromImage(*image);
+}
+
+// ============================================
+// 规范结构哈希与同构判定
+// 标签只取算子/类型/常量等语义属性, 变量名 (var_name, text_N) 与编号类属性不参与,
+// 引用其他节点ID的属性 (stmt_anchor 等) 按被引用节点的颜色参与细化
+// ============================================
+
+namespace {
+
+uint64_t hashBytes(std::string_view text, uint64_t seed = 1469598103934665603ULL) {
+    // FNV-1a: 结果不依赖标准库实现, 可跨进程比较
+    uint64_t h = seed;
+    for (unsigned char c : text) {
+        h ^= c;
+        h *= 1099511628211ULL;
+    }
+    return h;
+}
+
+uint64_t hashCombine(uint64_t seed, uint64_t value) {
+    value += 0x9e3779b97f4a7c15ULL + (seed << 6) + (seed >> 2);
+    value = (value ^ (value >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    value = (value ^ (value >> 27)) * 0x94d049bb133111ebULL;
+    return seed ^ (value ^ (value >> 31));
+}
+
+bool isNameAttribute(const std::string& key) {
+    return key == "var_name" || key == "assigns" || key.rfind("text_", 0) == 0 || key == "loop_id" || key == "loop_parent" || key == "loop_children" ||
+           key == "step_count" || key == "step_pointers" || key == "induction_var" || key == "elementwise_in" || key == "elementwise_out";
+}
+
+const char* const kNodeReferenceKeys[] = {"stmt_anchor", "alias_of", "cond_node", "derived_from", "region_end", "tail_of", "vla_header"};
+
+}  // namespace
+
+AODGraph::CanonicalForm AODGraph::computeCanonicalForm() const {
+    CanonicalForm form;
+    const size_t n = nodes.size();
+    std::unordered_map<int, uint32_t> index;
+    for (size_t i = 0; i < n; ++i) index[nodes[i]->getId()] = static_cast<uint32_t>(i);
+
+    // 邻接: (对端下标, 边标签哈希), 节点引用属性视为带键名标签的边
+    std::vector<std::vector<std::pair<uint32_t, uint64_t>>> out(n), in(n);
+    auto link = [&](uint32_t from, uint32_t to, uint64_t label) {
+        out[from].push_back({to, label});
+        in[to].push_back({from, label});
+        form.adjacency[(static_cast<uint64_t>(from) << 32) | to].push_back(label);
+    };
+    for (const auto& edge : edges) {
+        auto s = index.find(edge->getSource()->getId()), t = index.find(edge->getTarget()->getId());
+        if (s == index.end() || t == index.end()) continue;
+        // 非操作数数据边的标签是变量名, 不参与比较
+        std::string label = edge->getType() == AODEdgeType::Data && !isOperandEdge(*edge) ? "" : edge->getProperties().variable_name;
+        link(s->second, t->second, hashCombine(static_cast<uint64_t>(edge->getType()) + 1, hashBytes(label)));
+    }
+    form.colors.resize(n);
+    for (size_t i = 0; i < n; ++i) {
+        const auto& node = nodes[i];
+        uint64_t h = hashBytes(node->getName(), static_cast<uint64_t>(node->getType()) * 2 + (node->isStatement() ? 1 : 0));
+        for (const auto& [key, value] : node->getAttributes()) {
+            if (isNameAttribute(key)) continue;
+            bool reference = false;
+            for (const char* ref_key : kNodeReferenceKeys) reference |= key == ref_key;
+            if (reference) {
+                auto target = value.empty() ? index.end() : index.find(std::atoi(value.c_str()));
+                if (target != index.end()) link(static_cast<uint32_t>(i), target->second, hashBytes(key, 7));
+                else h = hashCombine(h, hashBytes(key, 11));  // 引用已删除的节点, ID 本身不可比较
+                continue;
+            }
+            h = hashCombine(h, hashCombine(hashBytes(key), hashBytes(value)));
+        }
+        form.colors[i] = h;
+    }
+    for (auto& entry : form.adjacency) std::sort(entry.second.begin(), entry.second.end());
+
+    // Weisfeiler-Lehman 细化, 直到颜色类数不再增加
+    auto count_classes = [](std::vector<uint64_t> colors) {
+        std::sort(colors.begin(), colors.end());
+        return static_cast<size_t>(std::unique(colors.begin(), colors.end()) - colors.begin());
+    };
+    size_t classes = count_classes(form.colors);
+    std::vector<uint64_t> signature;
+    while (true) {
+        std::vector<uint64_t> next(n);
+        for (size_t i = 0; i < n; ++i) {
+            signature.clear();
+            for (const auto& [j, label] : out[i]) signature.push_back(hashCombine(hashCombine(1, label), form.colors[j]));
+            for (const auto& [j, label] : in[i]) signature.push_back(hashCombine(hashCombine(2, label), form.colors[j]));
+            std::sort(signature.begin(), signature.end());
+            uint64_t h = form.colors[i];
+            for (uint64_t s : signature) h = hashCombine(h, s);
+            next[i] = h;
+        }
+        size_t next_classes = count_classes(next);
+        form.colors.swap(next);
+        form.rounds++;
+        if (next_classes <= classes) break;
+        classes = next_classes;
+    }
+
+    std::vector<uint64_t> sorted = form.colors;
+    std::sort(sorted.begin(), sorted.end());
+    form.hash = hashCombine(n, edges.size());
+    for (uint64_t c : sorted) form.hash = hashCombine(form.hash, c);
+    return form;
+}
+
+uint64_t AODGraph::canonicalHash() const {
+    return computeCanonicalForm().hash;
+}
+
+bool AODGraph::isIsomorphicTo(const AODGraph& other) const {
+    if (nodes.size() != other.nodes.size() || edges.size() != other.edges.size()) return false;
+    CanonicalForm a = computeCanonicalForm(), b = other.computeCanonicalForm();
+    if (a.hash != b.hash || a.rounds != b.rounds) return false;
+
+    // 哈希相同后做精确回溯匹配: 候选只在同色节点中选, 从颜色类最小的节点开始
+    const size_t n = nodes.size();
+    std::unordered_map<uint64_t, std::vector<uint32_t>> classes_b;
+    std::unordered_map<uint64_t, size_t> class_size;
+    for (uint32_t j = 0; j < n; ++j) classes_b[b.colors[j]].push_back(j);
+    for (uint32_t i = 0; i < n; ++i) class_size[a.colors[i]]++;
+    std::vector<uint32_t> order(n);
+    for (uint32_t i = 0; i < n; ++i) order[i] = i;
+    std::stable_sort(order.begin(), order.end(), [&](uint32_t x, uint32_t y) {
+        return class_size[a.colors[x]] < class_size[a.colors[y]];
+    });
+
+    static const std::vector<uint64_t> kNoEdges;
+    auto labels = [](const CanonicalForm& form, uint32_t from, uint32_t to) -> const std::vector<uint64_t>& {
+        auto it = form.adjacency.find((static_cast<uint64_t>(from) << 32) | to);
+        return it == form.adjacency.end() ? kNoEdges : it->second;
+    };
+    std::vector<int> map_a(n, -1), map_b(n, -1);
+    std::vector<uint32_t> mapped;
+    mapped.reserve(n);
+
+    std::function<bool(size_t)> extend = [&](size_t depth) {
+        if (depth == n) return true;
+        uint32_t x = order[depth];
+        for (uint32_t y : classes_b[a.colors[x]]) {
+            if (map_b[y] != -1) continue;
+            if (labels(a, x, x) != labels(b, y, y)) continue;
+            bool consistent = true;
+            for (uint32_t u : mapped) {
+                uint32_t v = static_cast<uint32_t>(map_a[u]);
+                if (labels(a, x, u) != labels(b, y, v) || labels(a, u, x) != labels(b, v, y)) {
+                    consistent = false;
+                    break;
+                }
+            }
+            if (!consistent) continue;
+            map_a[x] = static_cast<int>(y);
+            map_b[y] = static_cast<int>(x);
+            mapped.push_back(x);
+            if (extend(depth + 1)) return true;
+            mapped.pop_back();
+            map_a[x] = map_b[y] = -1;
+        }
+        return false;
+    };
+    return extend(0);
+}
+
+// ============================================
+// 分析: 按目标延迟加权的关键路径与指令级并行度
+// 数据流 DAG 只取操作数边 (init/arg_N); 以变量名标记的 CPG 数据边可能是循环携带依赖, 不计入.
+// 循环携带依赖单独按 assigns 标记的写入语句计算 (见 recurrence_latency)
+// ============================================
+
+std::vector<AODCriticalPathReport> AODGraph::analyzeCriticalPaths(const std::string& target_arch) const {
+    std::unordered_map<int, int> latency;
+    for (const auto& node : nodes) {
+        latency[node->getId()] = getOperationLatency(target_arch, node->getProperty("op_name"), node->getProperty("value_type"));
+    }
+    std::unordered_map<int, std::vector<int>> operands;
+    for (const auto& edge : edges) {
+        if (isOperandEdge(*edge)) operands[edge->getTarget()->getId()].push_back(edge->getSource()->getId());
+    }
+    std::vector<int> order = operandTopologicalOrder();
+
+    // 节点所属的最内层循环: 语句看自身, 表达式看所属语句
+    auto loop_of = [&](const std::shared_ptr<AODNode>& node) {
+        int anchor = node->getId();
+        int owner = getStatementAnchor(*node);
+        if (!node->isStatement() && owner >= 0) anchor = owner;
+        const AODLoop* loop = getLoopOf(anchor);
+        return loop ? loop->id : -1;
+    };
+
+    // 读取变量 v 的节点都以 v 的 define 节点为操作数
+    std::unordered_map<std::string, std::vector<std::shared_ptr<AODNode>>> defines;
+    std::unordered_map<int, std::vector<int>> users;
+    for (const auto& node : nodes) {
+        if (node->getProperty("op_name") == "define" && !node->getProperty("var_name").empty()) {
+            defines[node->getProperty("var_name")].push_back(node);
+        }
+    }
+    for (const auto& edge : edges) {
+        if (isOperandEdge(*edge)) users[edge->getSource()->getId()].push_back(edge->getTarget()->getId());
+    }
+    std::unordered_map<int, int> node_loop;
+    for (const auto& node : nodes) node_loop[node->getId()] = loop_of(node);
+
+    // 循环内写入变量 v 的语句 S (assigns), v 在循环外定义: 本次迭代首次写入前读取 v 的节点读到的是上次迭代的值,
+    // 从这些节点沿操作数链到 S 的最长延迟 (含复合赋值自身的运算) 是一个递推环
+    auto recurrence = [&](int loop_id, AODCriticalPathReport& report) {
+        std::map<std::string, std::vector<std::shared_ptr<AODNode>>> writers;
+        for (const auto& node : nodes) {
+            if (node->isStatement() && node_loop[node->getId()] == loop_id && !node->getProperty("assigns").empty()) {
+                writers[node->getProperty("assigns")].push_back(node);
+            }
+        }
+        for (const auto& [var, stmts] : writers) {
+            auto defs = defines.find(var);
+            if (defs == defines.end()) continue;
+            bool local = false;
+            for (const auto& def : defs->second) local = local || node_loop[def->getId()] == loop_id;
+            if (local) continue;  // 每次迭代重新定义, 不跨迭代
+            int first_write = stmts.front()->getId();
+            for (const auto& stmt : stmts) first_write = std::min(first_write, stmt->getId());
+
+            std::unordered_map<int, int> finish, from;
+            for (const auto& def : defs->second) {
+                for (int user : users[def->getId()]) {
+                    auto node = getNode(user);
+                    if (!node || node_loop[user] != loop_id) continue;
+                    int anchor = node->isStatement() ? user : getStatementAnchor(*node);
+                    if (anchor < 0 || anchor > first_write) continue;
+                    finish[user] = latency[user];
+                    from[user] = -1;
+                }
+            }
+            if (finish.empty()) continue;
+            for (int id : order) {
+                if (node_loop[id] != loop_id) continue;
+                for (int src : operands[id]) {
+                    auto it = finish.find(src);
+                    if (it == finish.end()) continue;
+                    auto current = finish.find(id);
+                    if (current == finish.end() || it->second + latency[id] > current->second) {
+                        finish[id] = it->second + latency[id];
+                        from[id] = src;
+                    }
+                }
+            }
+            for (const auto& stmt : stmts) {
+                auto it = finish.find(stmt->getId());
+                if (it == finish.end()) continue;
+                int cycle = it->second;
+                if (!stmt->getProperty("assign_op").empty()) {
+                    cycle += getOperationLatency(target_arch, stmt->getProperty("assign_op"), stmt->getProperty("assign_type"));
+                }
+                if (cycle <= report.recurrence_latency) continue;
+                report.recurrence_latency = cycle;
+                report.recurrence_path.clear();
+                for (int id = stmt->getId(); id != -1; id = from[id]) report.recurrence_path.push_back(id);
+                std::reverse(report.recurrence_path.begin(), report.recurrence_path.end());
+            }
+        }
+    };
+
+    auto analyze = [&](int loop_id, const std::function<bool(int)>& member) {
+        AODCriticalPathReport report;
+        report.target_arch = target_arch;
+        report.loop_id = loop_id;
+        report.issue_width = getTargetIssueWidth(target_arch);
+        if (loop_id >= 0) {
+            report.loop_header = getLoops()[loop_id].header;
+            recurrence(loop_id, report);
+        }
+
+        std::unordered_map<int, int> finish, from;
+        int last = -1;
+        for (int id : order) {
+            if (!member(id)) continue;
+            int start = 0, pred = -1;
+            for (int src : operands[id]) {
+                auto it = finish.find(src);
+                if (it != finish.end() && it->second > start) {
+                    start = it->second;
+                    pred = src;
+                }
+            }
+            finish[id] = start + latency[id];
+            from[id] = pred;
+            if (latency[id] > 0) {
+                report.total_latency += latency[id];
+                report.operation_count++;
+            }
+            if (last == -1 || finish[id] > finish[last]) last = id;
+        }
+        if (last == -1) return report;
+
+        report.critical_latency = finish[last];
+        for (int id = last; id != -1; id = from[id]) report.path.push_back(id);
+        std::reverse(report.path.begin(), report.path.end());
+        if (report.critical_latency > 0) {
+            report.ilp = static_cast<double>(report.total_latency) / report.critical_latency;
+            // 并行度低于发射宽度时依赖链是瓶颈, 展开/交错 k 份独立迭代可补足
+            report.latency_bound = report.ilp < report.issue_width;
+            report.suggested_interleave = report.latency_bound
+                ? std::min(8, static_cast<int>(std::ceil(report.issue_width / report.ilp))) : 1;
+        }
+        // 递推环限制相邻迭代的重叠: 超过资源下限时交错无效, 需要拆开递推 (如多累加器)
+        double resource = static_cast<double>(report.total_latency) / report.issue_width;
+        if (report.recurrence_latency > resource) {
+            report.recurrence_bound = true;
+            report.latency_bound = true;
+            report.suggested_interleave = 1;
+        }
+        // 受递推限制时迭代中不在环上的部分仍可与相邻迭代重叠
+        double chain = report.recurrence_bound ? 0.0 : static_cast<double>(report.critical_latency) / report.suggested_interleave;
+        report.cycles_per_iteration = std::max({static_cast<double>(report.recurrence_latency), resource, chain});
+        return report;
+    };
+
+    std::vector<AODCriticalPathReport> reports;
+    reports.push_back(analyze(-1, [](int) { return true; }));
+    for (const auto& loop : getLoops()) {
+        if (!loop.children.empty()) continue;
+        auto report = analyze(loop.id, [&](int id) { return node_loop[id] == loop.id; });
+        if (report.operation_count > 0) reports.push_back(report);
+    }
+    return reports;
+}
+
+void AODGraph::annotateLatencies(const std::string& target_arch) {
+    auto reports = analyzeCriticalPaths(target_arch);
+    std::set<std::pair<int, int>> critical;
+    for (const auto& report : reports) {
+        for (size_t i = 1; i < report.path.size(); ++i) critical.insert({report.path[i - 1], report.path[i]});
+    }
+    for (auto& edge : edges) {
+        if (!isOperandEdge(*edge)) continue;
+        auto source = edge->getSource();
+        edge->setWeight(getOperationLatency(target_arch, source->getProperty("op_name"), source->getProperty("value_type")));
+        edge->setCritical(critical.count({source->getId(), edge->getTarget()->getId()}) > 0);
+    }
+}
+
+void AODGraph::inferElementTypes(const std::string& target_arch) {
+    std::unordered_map<int, std::map<int, int>> operands;       // 节点 -> 操作数下标 -> 源节点
+    std::unordered_map<int, std::vector<int>> users;
+    for (const auto& edge : edges) {
+        if (!isOperandEdge(*edge)) continue;
+        operands[edge->getTarget()->getId()][getOperandIndex(*edge)] = edge->getSource()->getId();
+        users[edge->getSource()->getId()].push_back(edge->getTarget()->getId());
+    }
+
+    // 种子不再改变: intrinsic 名称决定的类型优先于 QualType (AVX2 的 __m256i 本身不带通道宽度)
+    std::unordered_map<int, std::string> elem;
+    std::unordered_map<int, std::shared_ptr<AODNode>> by_id;
+    for (const auto& node : nodes) {
+        by_id[node->getId()] = node;
+        std::string seed = elementTypeOfIntrinsic(node->getProperty("op_name"));
+        if (seed.empty()) seed = node->getProperty("elem_type");
+        if (!seed.empty()) elem[node->getId()] = seed;
+    }
+
+    // 前向: define 取初值类型, 宽度无关的运算 (and/or/load) 取操作数类型, 掩码与数据混合时取数据类型
+    auto forward = [&](int id) -> std::string {
+        std::string mask;
+        for (const auto& [index, source] : operands[id]) {
+            auto it = elem.find(source);
+            if (it == elem.end()) continue;
+            if (it->second[0] != 'b') return it->second;
+            if (mask.empty()) mask = it->second;
+        }
+        return mask;
+    };
+    // 后向: 由使用者的解释决定; 比较的操作数是同宽度的有符号数据
+    auto backward = [&](int id) -> std::string {
+        for (int user : users[id]) {
+            auto it = elem.find(user);
+            if (it == elem.end()) continue;
+            if (it->second[0] != 'b') return it->second;
+            return "s" + it->second.substr(1);
+        }
+        return "";
+    };
+
+    // 最后退回到转换器按操作数 QualType (指针目标类型、转换前的类型) 记录的提示
+    auto hint = [&](int id) -> std::string {
+        const auto& node = by_id[id];
+        int count = std::atoi(node->getProperty("operand_count", "0").c_str());
+        for (int i = 0; i < count; ++i) {
+            std::string type = node->getProperty("operand_elem_" + std::to_string(i));
+            if (!type.empty()) return type;
+        }
+        return "";
+    };
+
+    // 每轮按 前向 -> 后向 -> 提示 的优先级只用第一个有进展的规则, 前向传播总是先到达不动点
+    std::vector<std::function<std::string(int)>> rules = {forward, backward, hint};
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (const auto& infer : rules) {
+            for (const auto& node : nodes) {
+                int id = node->getId();
+                if (elem.count(id)) continue;
+                std::string type = infer(id);
+                if (type.empty()) continue;
+                elem[id] = type;
+                changed = true;
+            }
+            if (changed) break;
+        }
+    }
+
+    for (const auto& node : nodes) {
+        auto it = elem.find(node->getId());
+        if (it == elem.end()) continue;
+        node->setProperty("elem_type", it->second);
+        if (!target_arch.empty()) node->setProperty("lanes", laneCount(target_arch, it->second));
+    }
+}
+
+std::vector<int> AODGraph::getCriticalPath() const {
+    return analyzeCriticalPaths("").front().path;
+}
+
+AODGraph::GraphStatistics AODGraph::getStatistics() const {
+    GraphStatistics stats;
+    stats.node_count = nodes.size();
+    stats.edge_count = edges.size();
+    for (const auto& node : nodes) {
+        if (node->isSIMDNode()) stats.simd_nodes++;
+        else if (node->isControlNode()) stats.control_nodes++;
+        else if (node->isDataNode()) stats.data_nodes++;
+        else if (node->isCallNode()) stats.call_nodes++;
+        stats.complexity_score += node->getComplexity();
+    }
+    stats.loop_count = static_cast<int>(getLoops().size());
+    stats.critical_path_length = analyzeCriticalPaths("").front().critical_latency;
+    return stats;
+}
+
+void AODGraph::printStatistics() const {
+    auto stats = getStatistics();
+    std::cout << "Graph Stats: " << stats.node_count << " nodes, " << stats.edge_count << " edges." << std::endl;
+}
+
+// 缺少的接口空实现以通过链接
+void AODGraph::topologicalSort() const {}
+std::vector<int> AODGraph::getPath(int, int) const { return {}; }
+bool AODGraph::hasPath(int, int) const { return false; }
+
+// ============================================
+// AODGraphAnalyzer 循环识别
+// ============================================
+
+void AODGraphAnalyzer::identifyLoops() {
+    if (!graph) return;
+    graph->computeDominators();
+
+    for (const auto& loop : graph->getLoops()) {
+        if (auto header = graph->getNode(loop.header)) {
+            header->setProperty("loop_header", "true");
+            if (loop.irreducible) header->setProperty("loop_irreducible", "true");
+        }
+    }
+    // 语句与其表达式节点都标注最内层循环
+    for (const auto& node : graph->getNodes()) {
+        const AODLoop* loop = graph->getLoopOf(node->getId());
+        if (!loop) continue;
+        node->setProperty("loop_id", std::to_string(loop->id));
+        node->setProperty("loop_depth", std::to_string(loop->depth));
+    }
+}
+
+void AODGraphAnalyzer::identifyNestedLoops() {
+    if (!graph) return;
+    identifyLoops();
+
+    for (const auto& loop : graph->getLoops()) {
+        auto header = graph->getNode(loop.header);
+        if (!header) continue;
+        if (loop.parent >= 0) {
+            header->setProperty("loop_parent", std::to_string(loop.parent));
+        }
+        if (!loop.children.empty()) {
+            std::string children;
+            for (int child : loop.children) {
+                if (!children.empty()) children += ",";
+                children += std::to_string(child);
+            }
+            header->setProperty("loop_children", children);
+        }
+    }
+}
 
 } // namespace aodsolve
@@ -9,6 +9,8 @@
 #include <functional>
 #include <optional>
 #include <unordered_map>
+#include <cstdint>
+#include <string_view>
 
 namespace aodsolve {
 
@@ -65,6 +67,128 @@ public:
     std::string getDOTLabel() const;
 };
 
+// 图优化 Pass 的执行报告
+struct AODPassReport {
+    std::string pass_name;
+    int nodes_before = 0;
+    int nodes_after = 0;
+    int nodes_changed = 0;          // 被合并/折叠/移动的节点数
+    int instructions_saved = 0;     // 估计减少的指令数
+    std::vector<std::string> details;
+};
+
+// 循环嵌套森林中的一个自然循环
+struct AODLoop {
+    int id = -1;
+    int header = -1;               // 循环头节点ID
+    int parent = -1;               // 外层循环ID, -1 表示最外层
+    int depth = 1;                 // 嵌套深度, 最外层为1
+    std::vector<int> body;         // 循环内全部控制流节点ID(含头节点与内层循环)
+    std::vector<int> latches;      // 回边源节点ID
+    std::vector<int> children;     // 直接内层循环ID
+    bool irreducible = false;      // 存在不经过头节点的入口
+};
+
+// AOD 图的二进制镜像 (.aodg)
+// 布局: 文件头 | 字符串偏移表 | 节点表 | 边表 | 属性表 | 字符串池
+// 各表为定长记录的平坦数组, 字符串全部去重后以下标引用; 镜像可直接 mmap 只读访问, 不逐节点分配
+class AODGraphImage {
+public:
+    static constexpr uint32_t kVersion = 1;
+
+    struct NodeRecord {
+        uint32_t id;
+        uint16_t type;             // AODNodeType
+        uint16_t flags;            // kNodeStatement | kNodeSideEffects
+        uint32_t name;             // 以下均为字符串下标
+        uint32_t type_name;
+        uint32_t location;
+        int32_t complexity;
+        uint32_t attribute_begin;  // 属性表区间, 按键有序
+        uint32_t attribute_count;
+    };
+    struct EdgeRecord {
+        uint32_t source;           // 节点表下标
+        uint32_t target;
+        uint16_t type;             // AODEdgeType
+        uint16_t flags;            // kEdgeCritical
+        uint32_t variable_name;
+        int32_t weight;
+        uint32_t attribute_begin;
+        uint32_t attribute_count;
+    };
+    struct AttributeRecord {
+        uint32_t key;
+        uint32_t value;
+    };
+    static constexpr uint16_t kNodeStatement = 1;
+    static constexpr uint16_t kNodeSideEffects = 2;
+    static constexpr uint16_t kEdgeCritical = 1;
+
+    // 校验整个镜像后引用 data, 调用方保证其生命周期; 格式错误 (含重复的节点ID) 抛出 std::runtime_error
+    AODGraphImage(const char* data, size_t size);
+    ~AODGraphImage();
+    AODGraphImage(const AODGraphImage&) = delete;
+    AODGraphImage& operator=(const AODGraphImage&) = delete;
+
+    // 以只读方式映射文件, 映射随返回对象释放
+    static std::shared_ptr<const AODGraphImage> mapFile(const std::string& filename);
+
+    uint32_t nodeCount() const { return node_count; }
+    uint32_t edgeCount() const { return edge_count; }
+    NodeRecord node(uint32_t index) const;
+    EdgeRecord edge(uint32_t index) const;
+    AttributeRecord attribute(uint32_t index) const;
+    std::string_view string(uint32_t index) const;
+    std::string_view graphName() const { return string(graph_name); }
+    // 在节点属性区间内二分查找, 不存在时返回空串
+    std::string_view findAttribute(const NodeRecord& node, std::string_view key) const;
+
+private:
+    const char* data = nullptr;
+    size_t size = 0;
+    void* mapping = nullptr;       // mapFile 持有的映射
+    uint32_t graph_name = 0;
+    uint32_t string_count = 0;
+    uint32_t node_count = 0;
+    uint32_t edge_count = 0;
+    uint32_t attribute_count = 0;
+    size_t offsets_at = 0, nodes_at = 0, edges_at = 0, attributes_at = 0, strings_at = 0;
+
+    uint32_t read32(size_t offset) const;
+};
+
+// 等式饱和的资源上限, 任一项达到即停止改写并按当前 e-graph 提取
+struct AODSaturationLimits {
+    size_t max_enodes = 20000;
+    int max_iterations = 16;
+    double time_limit_ms = 20.0;
+};
+
+// 目标能否生成一个运算: op_name 在目标上有代码模板, 且模板的通道位宽等于 lane_bits (0 表示按类型特化的标量运算)
+// 改写类的 pass 只引入能通过该判断的运算, 为空时不做改写
+using AODLowerable = std::function<bool(const std::string& op_name, int lane_bits)>;
+
+// 延迟加权关键路径分析结果 (函数整体或一个最内层循环)
+struct AODCriticalPathReport {
+    std::string target_arch;
+    int loop_id = -1;                   // -1 表示整个函数
+    int loop_header = -1;               // 循环头节点ID, 优化前后的图按它对应同一个循环
+    int critical_latency = 0;           // 最长依赖链的延迟 (周期)
+    int total_latency = 0;              // 全部运算延迟之和
+    int operation_count = 0;
+    double ilp = 0.0;                   // total / critical, 不限资源时的平均并行度
+    int issue_width = 1;
+    bool latency_bound = false;         // ilp 低于发射宽度
+    int suggested_interleave = 1;       // 建议展开/交错的独立迭代数
+    std::vector<int> path;              // 关键路径节点ID (含零延迟的 define), 按依赖方向
+    // 循环携带依赖: 上一次迭代写入的变量在本次迭代写入前被读取, 读到写的最长链即每次迭代的最小间隔
+    int recurrence_latency = 0;
+    std::vector<int> recurrence_path;
+    bool recurrence_bound = false;      // 递推延迟超过发射宽度给出的下限, 交错独立迭代无法缩短
+    double cycles_per_iteration = 0.0;  // 稳态估计: max(递推延迟, 总延迟 / 发射宽度, 未受递推限制时关键路径 / 交错数)
+};
+
 // å¢žå¼ºçš„AODå›¾ç±»
 class AODGraph {
 private:
@@ -75,10 +199,29 @@ private:
     std::map<std::string, std::shared_ptr<AODNode>> nodes_by_name;
 
     // åˆ†æžç»“æžœç¼“å­˜
-    std::map<int, std::set<int>> dominator_map; // ä¿®æ”¹ä¸ºä½¿ç”¨èŠ‚ç‚¹ID
+    // 控制流分析缓存: 以紧凑下标存储, 节点ID经 index 映射
+    struct DominatorTree {
+        std::vector<int> idom;     // 直接支配者下标, 虚拟根为自身, 不可达为 -1
+        std::vector<int> pre;      // 支配树 DFS 进入序号
+        std::vector<int> post;     // 支配树 DFS 离开序号
+    };
+    struct ControlFlowInfo {
+        bool valid = false;
+        std::unordered_map<int, int> index;        // 节点ID -> 下标
+        std::vector<int> ids;                      // 下标 -> 节点ID
+        std::vector<std::vector<int>> succs;
+        std::vector<std::vector<int>> preds;
+        std::vector<int> roots;
+        DominatorTree dom;
+        DominatorTree pdom;
+        std::vector<int> loop_of;                  // 最内层循环ID, -1 表示不在循环中
+        std::vector<AODLoop> loops;
+    };
+    mutable ControlFlowInfo cfg_info;
     std::map<std::string, std::set<std::shared_ptr<AODNode>>> variable_defs_map;
     std::map<std::string, std::set<std::shared_ptr<AODNode>>> variable_uses_map;
     mutable std::vector<std::vector<int>> topological_order;
+    std::vector<AODPassReport> pass_reports;
 
     // åˆ†æžæ ‡å¿—
     bool is_analyzed = false;
@@ -106,6 +249,16 @@ public:
     std::vector<std::shared_ptr<AODEdge>> getEdgesTo(int node_id) const;
     std::vector<std::shared_ptr<AODEdge>> getIncomingEdges(int node_id) const { return getEdgesTo(node_id); }
 
+    // 操作数边: "init" 与 "arg_N" 数据边, 描述表达式树结构
+    static bool isOperandEdge(const AODEdge& edge);
+    static int getOperandIndex(const AODEdge& edge);
+    // 表达式节点的 stmt_anchor (所属语句ID); 没有或不合法时返回 -1
+    static int getStatementAnchor(const AODNode& node);
+    std::shared_ptr<AODNode> getOperand(int node_id, int index) const;
+    std::vector<std::shared_ptr<AODNode>> getOperandUsers(int node_id) const;
+    // 把 from 的全部操作数使用改为使用 to, 返回改写的边数
+    int replaceAllUsesWith(const std::shared_ptr<AODNode>& from, const std::shared_ptr<AODNode>& to);
+
     // æ‹“æ‰‘æ“ä½œ
     // void topologicalSort() const;
     void topologicalSort() const;
@@ -143,18 +296,42 @@ public:
     std::vector<int> getEntryNodes() const;
     std::vector<int> getExitNodes() const;
     std::vector<int> getCriticalPath() const;
+    // [0] 为整个函数, 其后为每个最内层循环; target_arch 为空时按 AVX2 延迟
+    std::vector<AODCriticalPathReport> analyzeCriticalPaths(const std::string& target_arch) const;
+    // 操作数边权重设为源节点延迟, 关键路径上的边标记 is_critical
+    void annotateLatencies(const std::string& target_arch);
+    // 通道类型推断: 以 intrinsic 后缀与转换器按 QualType 标注的 elem_type 为种子, 沿操作数边前向/后向传播,
+    // 结果写入 elem_type, 并按目标架构写入 lanes
+    void inferElementTypes(const std::string& target_arch);
     bool isCyclic() const;
     std::vector<int> getLoopHeaders() const;
+    int getImmediateDominator(int node_id) const;
+    const std::vector<AODLoop>& getLoops() const;
+    const AODLoop* getLoopOf(int node_id) const;
+    int getLoopDepth(int node_id) const;
+    bool isInLoop(int node_id, int loop_id) const;
 
     // ä¼˜åŒ–æ“ä½œ
     void eliminateDeadCode();
     void constantPropagation();
     void commonSubexpressionElimination();
     void loopInvariantCodeMotion();
-    void strengthReduction();
+    // SVE: 固定步长向量循环改为 svcntb() 步进与 svwhilelt_b8 谓词, 并删除可证明等价的标量尾循环
+    void vectorLengthAgnosticLoops(const std::string& target_arch = "");
+    // 循环内只含无副作用赋值的 if 语句标记为 if_converted (select / max / min), 由代码生成器输出为无分支的选择
+    void ifConversion();
+    // NEON / SVE: 工作集不少于 streaming_bytes 的固定步长循环, 只写的指针标记 nontemporal, 读取的指针按 prefetch_distance 预取
+    void memoryHierarchy(const std::string& target_arch, int64_t streaming_bytes, int64_t prefetch_distance);
+    void strengthReduction(const std::string& target_arch = "", const AODLowerable& lowerable = nullptr);
+    // 提取只选用 lowerable 的运算, 为空时不做改写
+    void equalitySaturation(const std::string& target_arch = "", const AODLowerable& lowerable = nullptr,
+                            const AODSaturationLimits& limits = {});
     void removePhiNodes();
     void compressGraph();
 
+    const std::vector<AODPassReport>& getPassReports() const { return pass_reports; }
+    void clearPassReports() { pass_reports.clear(); }
+
     // éªŒè¯å’Œè°ƒè¯•
     bool isValid() const;
     std::vector<std::string> getValidationErrors() const;
@@ -164,7 +341,9 @@ public:
     // å¯è§†åŒ–
     std::string toDOT() const;
     std::string toGraphML() const;
+    // 按扩展名选择格式: .dot / .graphml, 其余写二进制镜像; 只有二进制镜像能载入 (loadFromFile)
     void saveToFile(const std::string& filename) const;
+    static AODGraph loadFromFile(const std::string& filename);
 
     // ç»Ÿè®¡ä¿¡æ¯
     struct GraphStatistics {
@@ -186,11 +365,17 @@ public:
     // åˆå¹¶å’Œæ¯”è¾ƒ
     void merge(const AODGraph& other);
     void intersect(const AODGraph& other);
+    // 结构同构: 忽略变量名与节点ID, 比较算子/类型/常量与边标签
     bool isIsomorphicTo(const AODGraph& other) const;
+    // Weisfeiler-Lehman 规范哈希, 同构图哈希必然相同
+    uint64_t canonicalHash() const;
 
     // åºåˆ—åŒ–
+    // 二进制镜像 (见 AODGraphImage); AST 指针与分析缓存不保存.
+    // 载入的图只能用于分析、比较与可视化, 不能驱动代码生成 (生成器按节点的 AST 输出回退代码与操作数)
     std::string serialize() const;
     static AODGraph deserialize(const std::string& serialized);
+    static AODGraph fromImage(const AODGraphImage& image);
 
     // å·¥åŽ‚æ–¹æ³•
     static std::shared_ptr<AODGraph> createEmptyGraph(const std::string& name);
@@ -215,7 +400,7 @@ public:
     void resetAnalysis() {
         is_analyzed = false;
         is_optimized = false;
-        dominator_map.clear();
+        invalidateControlFlow();
         variable_defs_map.clear();
         variable_uses_map.clear();
         topological_order.clear();
@@ -229,10 +414,22 @@ private:
     // å†…éƒ¨è¾…åŠ©æ–¹æ³•
     void ensureAnalyzed();
     void computeTopologicalOrderDFS(int node_id, std::vector<bool>& visited, std::vector<int>& order) const;
-    void computeDominatorsDFS(int node_id, std::set<int>& visited, std::map<int, std::set<int>>& doms) const;
-    std::set<int> computeDominatorsOfNode(int node_id, const std::set<int>& initial_dom) const;
-    std::set<int> intersectDominatorSets(const std::set<int>& dom1, const std::set<int>& dom2) const;
+    void invalidateControlFlow() const { cfg_info.valid = false; }
+    void ensureControlFlow() const;
+    void buildControlFlowIndex() const;
+    void computeDominatorTree(bool post) const;
+    void computeLoopForest() const;
+    int cfgIndexOf(int node_id) const;
+    int removeDeadOperands(const std::vector<std::shared_ptr<AODNode>>& candidates);
+    std::vector<int> operandTopologicalOrder() const;
     int getMaxDepthFromNode(int node_id) const;
+    struct CanonicalForm {
+        uint64_t hash = 0;
+        int rounds = 0;
+        std::vector<uint64_t> colors;                                   // nodes 下标 -> 稳定后的颜色
+        std::unordered_map<uint64_t, std::vector<uint64_t>> adjacency;  // (源下标<<32|目标下标) -> 有序边标签
+    };
+    CanonicalForm computeCanonicalForm() const;
     int getMaxDepthFromNodeRecursive(int node_id, std::set<int>& visited) const;
 
     // éªŒè¯è¾…åŠ©æ–¹æ³•
@@ -2,6 +2,8 @@
 #include <sstream>
 #include <algorithm>
 #include <stdexcept>
+#include <map>
+#include <cstdlib>
 
 namespace aodsolve {
 
@@ -166,6 +168,185 @@ std::string nodeTypeToString(AODNodeType type) {
     }
 }
 
+// 无副作用且结果只由操作数决定的算子 (可参与值编号/常量折叠/外提)
+bool isPureOperationName(const std::string& op_name) {
+    if (op_name.empty() || op_name == "define") return false;
+    static const std::set<std::string> scalar_ops = {
+        "+", "-", "*", "/", "%", "&", "|", "^", "<<", ">>",
+        "<", ">", "<=", ">=", "==", "!="
+    };
+    if (scalar_ops.count(op_name)) return true;
+    if (op_name.rfind("_mm", 0) != 0) return false;
+
+    static const char* const memory_ops[] = {
+        "load", "store", "stream", "maskmov", "gather", "scatter",
+        "prefetch", "fence", "rdrand", "rdseed", "lddqu"
+    };
+    for (const char* m : memory_ops) {
+        if (op_name.find(m) != std::string::npos) return false;
+    }
+    return true;
+}
+
+bool isCommutativeOperationName(const std::string& op_name) {
+    static const std::set<std::string> scalar_ops = {"+", "*", "&", "|", "^", "==", "!="};
+    if (scalar_ops.count(op_name)) return true;
+    if (op_name.rfind("_mm", 0) != 0) return false;
+
+    // _mm256_<op>_<type>: 取中间的操作名
+    size_t first = op_name.find('_', 3);
+    size_t last = op_name.rfind('_');
+    if (first == std::string::npos || last <= first) return false;
+    std::string op = op_name.substr(first + 1, last - first - 1);
+    static const std::set<std::string> commutative = {
+        "add", "adds", "mul", "mullo", "mulhi", "and", "or", "xor",
+        "cmpeq", "min", "max", "avg"
+    };
+    return commutative.count(op) > 0;
+}
+
+int getTargetOperationCost(const std::string& target_arch, const std::string& op_class) {
+    // 数值取自各架构优化手册中典型核心的延迟 (Skylake / Cortex-A76 / Neoverse V1)
+    // 整数向量除法在三种目标上都没有硬件指令, 按逐通道标量除法估计
+    // store 不产生结果, 延迟记 1; SVE 的比较结果是谓词, movemask 在 NEON/SVE 上需多条指令模拟
+    static const std::map<std::string, std::map<std::string, int>> costs = {
+        {"AVX2", {{"add", 1}, {"logic", 1}, {"shift", 1}, {"mul", 10}, {"mulhi", 5}, {"div", 26},
+                  {"fadd", 4}, {"fmul", 4}, {"fma", 4}, {"fdiv", 11}, {"cmp", 1}, {"select", 2},
+                  {"shuffle", 3}, {"broadcast", 3}, {"convert", 4}, {"movemask", 3}, {"load", 7}, {"store", 1}}},
+        {"NEON", {{"add", 2}, {"logic", 2}, {"shift", 2}, {"mul", 4}, {"mulhi", 6}, {"div", 12},
+                  {"fadd", 2}, {"fmul", 3}, {"fma", 4}, {"fdiv", 10}, {"cmp", 2}, {"select", 2},
+                  {"shuffle", 2}, {"broadcast", 3}, {"convert", 3}, {"movemask", 6}, {"load", 6}, {"store", 1}}},
+        {"SVE",  {{"add", 2}, {"logic", 2}, {"shift", 2}, {"mul", 4}, {"mulhi", 5}, {"div", 20},
+                  {"fadd", 2}, {"fmul", 3}, {"fma", 4}, {"fdiv", 10}, {"cmp", 3}, {"select", 2},
+                  {"shuffle", 3}, {"broadcast", 3}, {"convert", 4}, {"movemask", 4}, {"load", 6}, {"store", 1}}},
+    };
+    auto arch = costs.find(target_arch);
+    if (arch == costs.end()) arch = costs.find("AVX2");
+    auto it = arch->second.find(op_class);
+    return it != arch->second.end() ? it->second : 1000;
+}
+
+int getTargetIssueWidth(const std::string& target_arch) {
+    // 每周期可发射的向量运算数: Skylake 3 个向量 ALU 端口, Cortex-A76 2 条 ASIMD 流水线, Neoverse V1 2 条 256 位 SVE 流水线
+    if (target_arch == "NEON" || target_arch == "SVE") return 2;
+    return 3;
+}
+
+std::string classifyOperationName(const std::string& op_name, const std::string& value_type) {
+    if (op_name.empty() || op_name == "define") return "";
+    bool is_float = value_type == "float" || value_type == "double";
+    if (op_name == "+" || op_name == "-") return is_float ? "fadd" : "add";
+    if (op_name == "*") return is_float ? "fmul" : "mul";
+    if (op_name == "/" || op_name == "%") return is_float ? "fdiv" : "div";
+    if (op_name == "&" || op_name == "|" || op_name == "^") return "logic";
+    if (op_name == "<<" || op_name == ">>") return "shift";
+    if (op_name == "<" || op_name == ">" || op_name == "<=" || op_name == ">=" || op_name == "==" || op_name == "!=") return "cmp";
+    if (op_name == "load_float") return "load";
+    if (op_name == "store_float") return "store";
+    if (op_name.rfind("_mm", 0) != 0) return "";
+
+    size_t first = op_name.find('_', 3);
+    size_t last = op_name.rfind('_');
+    if (first == std::string::npos) return "";
+    std::string op = last > first ? op_name.substr(first + 1, last - first - 1) : op_name.substr(first + 1);
+    std::string suffix = last > first ? op_name.substr(last + 1) : "";
+    bool float_lanes = suffix == "ps" || suffix == "pd" || suffix == "ss" || suffix == "sd";
+    auto starts = [&](const char* prefix) { return op.rfind(prefix, 0) == 0; };
+
+    if (starts("load") || starts("lddqu") || starts("maskload") || starts("stream_load") || starts("i32gather") || starts("i64gather")) return "load";
+    if (starts("store") || starts("stream") || starts("maskstore")) return "store";
+    if (starts("set") || starts("broadcast")) return op == "setzero" ? "logic" : "broadcast";
+    if (starts("movemask")) return "movemask";
+    if (starts("cmp")) return "cmp";
+    if (starts("blend")) return "select";
+    if (starts("fmadd") || starts("fmsub") || starts("fnmadd") || starts("fnmsub")) return "fma";
+    if (starts("cvt")) return "convert";
+    if (starts("shuffle") || starts("permute") || starts("unpack") || starts("alignr") || starts("pack") ||
+        starts("extract") || starts("insert")) return "shuffle";
+    if (starts("sll") || starts("srl") || starts("sra") || starts("bsll") || starts("bsrl")) return "shift";
+    if (starts("and") || starts("or") || starts("xor") || starts("test")) return "logic";
+    if (starts("div") || starts("rem")) return float_lanes ? "fdiv" : "div";
+    if (starts("mulhi") || starts("mulhrs") || (op == "mul" && !float_lanes)) return "mulhi";
+    if (starts("mul") || starts("madd")) return float_lanes ? "fmul" : "mul";
+    if (starts("add") || starts("sub") || starts("hadd") || starts("hsub")) return float_lanes ? "fadd" : "add";
+    if (starts("min") || starts("max") || starts("avg") || starts("abs") || starts("sad") || starts("sign")) return float_lanes ? "fadd" : "add";
+    return "";
+}
+
+int getOperationLatency(const std::string& target_arch, const std::string& op_name, const std::string& value_type) {
+    std::string op_class = classifyOperationName(op_name, value_type);
+    if (op_name.empty() || op_name == "define") return 0;
+    return op_class.empty() ? 1 : getTargetOperationCost(target_arch, op_class);
+}
+
+int elementTypeBits(const std::string& elem_type) {
+    if (elem_type.size() < 2 || std::string("sufb").find(elem_type[0]) == std::string::npos) return 0;
+    std::string width = elem_type.substr(1);
+    return width == "8" || width == "16" || width == "32" || width == "64" ? std::atoi(width.c_str()) : 0;
+}
+
+std::string elementTypeOfIntrinsic(const std::string& op_name) {
+    if (op_name.rfind("_mm", 0) != 0) return "";
+    size_t last = op_name.rfind('_');
+    std::string suffix = op_name.substr(last + 1);
+    std::string elem;
+    if (suffix == "ps" || suffix == "ss") elem = "f32";
+    else if (suffix == "pd" || suffix == "sd") elem = "f64";
+    else if (suffix == "epi64x") elem = "s64";
+    else if (suffix.rfind("epi", 0) == 0) elem = "s" + suffix.substr(3);
+    else if (suffix.rfind("epu", 0) == 0) elem = "u" + suffix.substr(3);
+    if (!elementTypeBits(elem)) return "";
+    if (classifyOperationName(op_name) == "cmp") return "b" + std::to_string(elementTypeBits(elem));
+    return elem;
+}
+
+std::string elementTypeOfScalar(const std::string& c_type) {
+    std::string type = c_type;
+    for (const std::string qualifier : {"const ", "volatile "}) {
+        size_t pos;
+        while ((pos = type.find(qualifier)) != std::string::npos) type.erase(pos, qualifier.size());
+    }
+    static const std::map<std::string, std::string> kTypes = {
+        {"float", "f32"}, {"double", "f64"},
+        {"char", "s8"}, {"signed char", "s8"}, {"int8_t", "s8"}, {"unsigned char", "u8"}, {"uint8_t", "u8"}, {"_Bool", "u8"}, {"bool", "u8"},
+        {"short", "s16"}, {"int16_t", "s16"}, {"unsigned short", "u16"}, {"uint16_t", "u16"},
+        {"int", "s32"}, {"int32_t", "s32"}, {"unsigned int", "u32"}, {"unsigned", "u32"}, {"uint32_t", "u32"},
+        {"long", "s64"}, {"long long", "s64"}, {"int64_t", "s64"}, {"ssize_t", "s64"}, {"ptrdiff_t", "s64"},
+        {"unsigned long", "u64"}, {"unsigned long long", "u64"}, {"uint64_t", "u64"}, {"size_t", "u64"},
+        {"__m256", "f32"}, {"__m128", "f32"}, {"__m256d", "f64"}, {"__m128d", "f64"},
+    };
+    auto it = kTypes.find(type);
+    return it != kTypes.end() ? it->second : "";
+}
+
+std::string vectorTypeName(const std::string& target_arch, const std::string& elem_type) {
+    int bits = elementTypeBits(elem_type);
+    if (!bits) return "";
+    std::string width = std::to_string(bits);
+    char kind = elem_type[0];
+    if (target_arch == "SVE") {
+        if (kind == 'b') return "svbool_t";
+        return std::string(kind == 'f' ? "svfloat" : kind == 'u' ? "svuint" : "svint") + width + "_t";
+    }
+    if (target_arch == "NEON") {
+        // NEON 比较结果为同宽度的无符号全 1/全 0 通道
+        std::string base = kind == 'f' ? "float" : kind == 's' ? "int" : "uint";
+        return base + width + "x" + std::to_string(128 / bits) + "_t";
+    }
+    if (kind == 'f') return bits == 32 ? "__m256" : "__m256d";
+    return "__m256i";
+}
+
+std::string laneCount(const std::string& target_arch, const std::string& elem_type) {
+    int bits = elementTypeBits(elem_type);
+    if (!bits) return "";
+    if (target_arch == "SVE") {
+        const char* count = bits == 8 ? "svcntb()" : bits == 16 ? "svcnth()" : bits == 32 ? "svcntw()" : "svcntd()";
+        return count;
+    }
+    return std::to_string((target_arch == "NEON" ? 128 : 256) / bits);
+}
+
 std::shared_ptr<AODNode> createNode(AODNodeType type, const std::string& name) {
     return std::make_shared<AODNode>(type, name);
 }
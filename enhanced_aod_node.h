@@ -55,6 +55,8 @@ protected:
     std::set<std::string> analysis_context;
     const clang::Stmt* original_ast_stmt = nullptr;
 
+    friend class AODGraph;  // 反序列化时恢复节点ID与属性
+
 public:
     AODNode(AODNodeType t, const std::string& name = "");
     virtual ~AODNode() = default;
@@ -215,6 +217,26 @@ public:
 
 // 工具函数
 std::string nodeTypeToString(AODNodeType type);
+bool isPureOperationName(const std::string& op_name);
+bool isCommutativeOperationName(const std::string& op_name);
+// 目标架构上各运算类别的估计延迟 (周期): add/logic/shift/mul/mulhi/div, 浮点 fadd/fmul/fdiv
+int getTargetOperationCost(const std::string& target_arch, const std::string& op_class);
+// 目标架构每周期可发射的向量运算数, 判断依赖链是否成为瓶颈
+int getTargetIssueWidth(const std::string& target_arch);
+// 算子名 (AVX2 intrinsic 或标量运算符) 对应的运算类别, 无法识别时返回空串
+std::string classifyOperationName(const std::string& op_name, const std::string& value_type = "");
+// 节点结果延迟: define 为 0, 未知算子按 1 周期估计
+int getOperationLatency(const std::string& target_arch, const std::string& op_name, const std::string& value_type = "");
+// 通道类型 elem_type: s8/u16/f32/f64 ..., 比较结果 (掩码) 为 b8/b16 ..., 空串表示未知
+int elementTypeBits(const std::string& elem_type);
+// AVX2 intrinsic 名称后缀决定的结果通道类型 (epi8 -> s8, epu16 -> u16, ps -> f32); si256 等按位运算与宽度无关, 返回空串
+std::string elementTypeOfIntrinsic(const std::string& op_name);
+// C 标量类型名 (float / int / uint8_t ...) 对应的通道类型
+std::string elementTypeOfScalar(const std::string& c_type);
+// 目标架构的向量类型: SVE svint8_t / svbool_t, NEON int8x16_t / uint8x16_t (掩码), AVX2 __m256i / __m256
+std::string vectorTypeName(const std::string& target_arch, const std::string& elem_type);
+// 每个向量的通道数; SVE 为运行时值 (svcntb() 等)
+std::string laneCount(const std::string& target_arch, const std::string& elem_type);
 std::shared_ptr<AODNode> createNode(AODNodeType type, const std::string& name);
 std::shared_ptr<AODNode> createLoadNode(const std::string& var, const std::string& type);
 std::shared_ptr<AODNode> createStoreNode(const std::string& var, const std::string& value);
@@ -1,6 +1,11 @@
 #include "generation/enhanced_code_generator.h"
+#include "aod/intrinsic_mapping_table.h"
 #include <sstream>
+#include <algorithm>
 #include <iostream>
+#include <cstdlib>
+#include <cctype>
+#include <functional>
 #include <clang/AST/Stmt.h>
 #include <clang/AST/Expr.h>
 #include <clang/AST/Decl.h>
@@ -10,7 +15,69 @@ namespace aodsolve {
 EnhancedCodeGenerator::EnhancedCodeGenerator(clang::ASTContext& ctx)
     : ast_context(ctx), target_architecture("SVE") {}
 
+// 标量运算符 (+ - * / 及 load_float 等) 的规则只写了一种通道类型, 生成时按推断类型特化
+static bool isTypeGenericOperation(const std::string& op_name) {
+    return !op_name.empty() && op_name != "define" && op_name.rfind("_mm", 0) != 0;
+}
+
+// 目标上是否存在该运算的通道类型变体: NEON 无整数除法与 64 位整数乘法, SVE 整数除法只有 32/64 位
+static bool hasElementVariant(const std::string& target_arch, const std::string& op_name, const std::string& elem) {
+    int bits = elementTypeBits(elem);
+    if (elem[0] == 'f') return bits >= 16;
+    if (op_name == "/" || op_name == "%") return target_arch == "SVE" && op_name == "/" && bits >= 32;
+    if (op_name == "*") return target_arch == "SVE" || bits < 64;
+    return true;
+}
+
+static std::string scalarTypeName(const std::string& elem) {
+    if (elem == "f32") return "float";
+    if (elem == "f64") return "double";
+    if (elem == "f16") return "float16_t";
+    return std::string(elem[0] == 'u' ? "uint" : "int") + elem.substr(1) + "_t";
+}
+
+// 模板中的 intrinsic 后缀 (_f32)、向量类型 (float32x4_t) 与指针元素类型 (float) 整词替换为目标通道类型
+static std::string specializeElementType(const std::string& code, const std::string& from, const std::string& to,
+                                         const std::string& target_arch) {
+    std::map<std::string, std::string> words = {
+        {vectorTypeName(target_arch, from), vectorTypeName(target_arch, to)},
+        {scalarTypeName(from), scalarTypeName(to)},
+    };
+    std::string suffix = "_" + from;
+    auto is_ident = [](char c) { return std::isalnum(static_cast<unsigned char>(c)) || c == '_'; };
+    std::string out;
+    for (size_t i = 0; i < code.size();) {
+        if (!is_ident(code[i])) {
+            out += code[i++];
+            continue;
+        }
+        size_t start = i;
+        while (i < code.size() && is_ident(code[i])) ++i;
+        std::string word = code.substr(start, i - start);
+        auto it = words.find(word);
+        if (it != words.end()) {
+            word = it->second;
+        } else if (word.size() > suffix.size() && word.compare(word.size() - suffix.size(), suffix.size(), suffix) == 0) {
+            word = word.substr(0, word.size() - from.size()) + to;
+        }
+        out += word;
+    }
+    return out;
+}
+
+// 转换器与图 pass 写入的逗号分隔列表
+static std::vector<std::string> splitList(const std::string& text) {
+    std::vector<std::string> items;
+    std::stringstream stream(text);
+    std::string item;
+    while (std::getline(stream, item, ',')) {
+        if (!item.empty()) items.push_back(item);
+    }
+    return items;
+}
+
 bool needsSemicolon(const clang::Stmt* stmt) {
+    if (!stmt) return true; // 优化 pass 新建的语句 (如外提的临时定义)
     if (llvm::isa<clang::CompoundStmt>(stmt)) return false;
     if (llvm::isa<clang::IfStmt>(stmt)) return false;
     if (llvm::isa<clang::WhileStmt>(stmt)) return false;
@@ -22,8 +89,31 @@ bool needsSemicolon(const clang::Stmt* stmt) {
 CodeGenerationResult EnhancedCodeGenerator::generateCodeFromGraph(const AODGraphPtr& graph) {
     CodeGenerationResult result;
     std::stringstream code;
+    function_constants.clear();
+    selected_tiles.clear();
+    // 优化后的图上推断通道类型, 决定 intrinsic 变体与向量类型
+    graph->inferElementTypes(target_architecture);
+    if (rule_db) {
+        selected_tiles = InstructionSelector(ruleIndex(), target_architecture).select(*graph);
+        int fused = 0;
+        for (const auto& [id, tile] : selected_tiles) {
+            if (!tile.covered.empty()) fused++;
+        }
+        result.info_messages.push_back("instruction selection: " + std::to_string(selected_tiles.size()) +
+                                       " expression nodes tiled, " + std::to_string(fused) + " multi-node tiles");
+    }
+    aligned_accesses.clear();
+    unlowered_ops.clear();
+    analyzeMaskDomain(graph);
+    if (!mask_nodes.empty()) {
+        result.info_messages.push_back("mask domain: " + std::to_string(mask_nodes.size()) + " predicate values, " +
+                                       std::to_string(predicated_uses.size()) + " predicated operations, " +
+                                       std::to_string(absorbed_defines.size()) + " masked values folded away");
+    }
 
-    for (const auto& node : graph->getNodes()) {
+    const auto& nodes = graph->getNodes();
+    for (size_t index = 0; index < nodes.size(); ++index) {
+        const auto& node = nodes[index];
         // Block End
         if (node->getType() == AODNodeType::BlockEnd) {
             code << "    }\n";
@@ -40,8 +130,42 @@ CodeGenerationResult EnhancedCodeGenerator::generateCodeFromGraph(const AODGraph
         }
         // 2. 控制流头部
         else if (node->getType() == AODNodeType::Control) {
+            // NEON / SVE 的 for 循环由循环生成器整体输出, 跳过区间内的其余节点
+            if ((target_architecture == "NEON" || target_architecture == "SVE") && node->getProperty("vectorize") == "true") {
+                std::string loop_code = generateVectorLoop(node, graph, result);
+                if (!loop_code.empty()) {
+                    code << loop_code;
+                    int region_end = std::atoi(node->getProperty("region_end").c_str());
+                    size_t last = index;
+                    for (size_t k = index + 1; k < nodes.size(); ++k) {
+                        if (nodes[k]->getId() > node->getId() && nodes[k]->getId() <= region_end) last = k;
+                    }
+                    index = last;
+                    continue;
+                }
+            }
+            if (!node->getProperty("if_converted").empty()) {
+                std::string selects = generateIfConversion(node);
+                if (!selects.empty()) {
+                    code << selects;
+                    int region_end = std::atoi(node->getProperty("region_end").c_str());
+                    size_t last = index;
+                    for (size_t k = index + 1; k < nodes.size(); ++k) {
+                        if (nodes[k]->getId() > node->getId() && nodes[k]->getId() <= region_end) last = k;
+                    }
+                    index = last;
+                    continue;
+                }
+            }
             // 这里我们只打印头部，不打印 Body
-            if (auto* whileStmt = llvm::dyn_cast<clang::WhileStmt>(node->getAstStmt())) {
+            if (target_architecture == "SVE" && node->getProperty("vla") == "true") {
+                // 长度无关循环: 每次迭代由 whilelt 谓词覆盖剩余元素, 不再需要标量尾循环
+                std::string count = node->getProperty("step_count");
+                std::string whilelt = node->getProperty("step_count_signed") == "true"
+                    ? "svwhilelt_b8_s64((int64_t)0, (int64_t)" + count + ")"
+                    : "svwhilelt_b8_u64((uint64_t)0, (uint64_t)" + count + ")";
+                line = "while (" + count + " > 0) {\n    svbool_t pg = " + whilelt + ";";
+            } else if (auto* whileStmt = llvm::dyn_cast<clang::WhileStmt>(node->getAstStmt())) {
                 std::string cond = generateFallbackCode(whileStmt->getCond());
                 line = "while (" + cond + ") {";
             } else if (auto* forStmt = llvm::dyn_cast<clang::ForStmt>(node->getAstStmt())) {
@@ -49,21 +173,20 @@ CodeGenerationResult EnhancedCodeGenerator::generateCodeFromGraph(const AODGraph
                 std::string init = generateFallbackCode(forStmt->getInit());
                 std::string cond = generateFallbackCode(forStmt->getCond());
                 std::string inc = generateFallbackCode(forStmt->getInc());
-
-                // 如果标记了 NEON 向量化
-                if (target_architecture == "NEON" && node->getProperty("vectorize") == "true") {
-                    line = "// Vector Loop (NEON)\n    for (" + init + " " + cond + "; " + inc + ") {";
-                    size_t pos = line.find("++");
-                    if (pos != std::string::npos) line.replace(pos, 2, " += 4");
-                } else {
-                    line = "for (" + init + " " + cond + "; " + inc + ") {";
-                }
+                line = "for (" + init + " " + cond + "; " + inc + ") {";
             } else if (auto* ifStmt = llvm::dyn_cast<clang::IfStmt>(node->getAstStmt())) {
                 std::string cond = generateFallbackCode(ifStmt->getCond());
                 line = "if (" + cond + ") {";
             }
+            if (!line.empty() && !node->getProperty("stream_min_count").empty()) {
+                line = streamingPrologue(node) + line + streamingPrefetches(node);
+            }
+        }
+        // 3. 长度无关循环的归纳语句: 固定步长改为本次迭代实际处理的元素数
+        else if (target_architecture == "SVE" && !node->getProperty("vla_header").empty()) {
+            line = generateInductionStep(node, graph);
         }
-        // 3. 独立语句 (SIMD Call 或 Generic)
+        // 4. 独立语句 (SIMD Call 或 Generic)
         else {
             // 先尝试应用规则 (可能是 SIMD Store 或 Scalar Calc)
             std::string rule_code = tryApplyRules(node, graph);
@@ -86,12 +209,131 @@ CodeGenerationResult EnhancedCodeGenerator::generateCodeFromGraph(const AODGraph
         }
     }
 
-    result.generated_code = code.str();
+    if (!aligned_accesses.empty()) {
+        result.info_messages.push_back("alignment: " + std::to_string(aligned_accesses.size()) + " SIMD accesses marked 16-byte aligned");
+    }
+
+    std::string preamble;
+    for (const auto& decl : function_constants) preamble += "    " + decl + "\n";
+    result.generated_code = preamble + code.str();
+    result.unlowered_operations.assign(unlowered_ops.begin(), unlowered_ops.end());
     result.successful = true;
     return result;
 }
 
+const std::shared_ptr<const CompiledRuleIndex>& EnhancedCodeGenerator::ruleIndex() {
+    // 规则库在生成期间只读; 规则变动 (generation 变化) 后才重建
+    if (!rule_index || rule_index->getGeneration() != rule_db->getGeneration()) {
+        rule_index = CompiledRuleIndex::build(*rule_db, {"simd_instruction", "scalar_vectorization"});
+    }
+    return rule_index;
+}
+
+std::string EnhancedCodeGenerator::requireFunctionConstant(const std::string& name, const std::string& declaration) {
+    if (std::find(function_constants.begin(), function_constants.end(), declaration) == function_constants.end()) {
+        function_constants.push_back(declaration);
+    }
+    return name;
+}
+
+std::string EnhancedCodeGenerator::generateInductionStep(const std::shared_ptr<AODNode>& node, const AODGraphPtr& graph) {
+    std::string line = node->getProperty("induction_var") + (node->getProperty("induction") == "-" ? " -= " : " += ") + "sv_step";
+    auto header = graph->getNode(std::atoi(node->getProperty("vla_header").c_str()));
+    if (!header || node->getProperty("vla_step_decl") != "true") return line;
+
+    // 最后一次迭代只处理剩余的 count 个元素, 指针与计数保持与原循环相同的终值
+    std::string vl = requireFunctionConstant("sv_vl_b8", "const uint64_t sv_vl_b8 = svcntb();");
+    std::string count = header->getProperty("step_count");
+    if (header->getProperty("step_count_signed") == "true") count = "(uint64_t)" + count;
+    return "const uint64_t sv_step = " + count + " < " + vl + " ? " + count + " : " + vl + ";\n    " + line;
+}
+
+std::string EnhancedCodeGenerator::generateVectorLoop(const std::shared_ptr<AODNode>& header, const AODGraphPtr& graph,
+                                                      CodeGenerationResult& result) {
+    std::vector<std::string>& messages = result.info_messages;
+    auto* loop = llvm::dyn_cast_or_null<clang::ForStmt>(header->getAstStmt());
+    if (!loop || header->getProperty("region_end").empty()) return "";
+
+    // 已含 intrinsic 的循环按节点逐条转换
+    int region_end = std::atoi(header->getProperty("region_end").c_str());
+    for (const auto& node : graph->getNodes()) {
+        if (node->getId() > header->getId() && node->getId() <= region_end && node->isSIMDNode()) return "";
+    }
+
+    const bool sve = target_architecture == "SVE";
+    VectorizedCodeGenerator generator;
+    std::string failure;
+    std::string code = sve ? generator.generateSveLoop(loop, ast_context, loop_options, failure)
+                           : generator.generateNeonLoop(loop, ast_context, loop_options, failure);
+    std::string name = target_architecture + " loop at node " + std::to_string(header->getId());
+    if (!code.empty()) {
+        messages.push_back(name + ": vectorized, unroll " + std::to_string(loop_options.unroll));
+        if (!generator.memoryNote().empty()) result.memory_notes.push_back(name + ": " + generator.memoryNote());
+        return code;
+    }
+    messages.push_back(name + " kept scalar: " + failure);
+
+    // 含内层循环时只输出头部, 让内层循环各自尝试向量化; 否则原样保留标量循环
+    for (const auto& node : graph->getNodes()) {
+        if (node->getId() <= header->getId() || node->getId() > region_end || node->getType() != AODNodeType::Control) continue;
+        const clang::Stmt* stmt = node->getAstStmt();
+        if (llvm::isa_and_nonnull<clang::ForStmt>(stmt) || llvm::isa_and_nonnull<clang::WhileStmt>(stmt)) return "";
+    }
+    return "    // " + target_architecture + ": loop kept scalar (" + failure + ")\n" + generator.generateScalarLoop(loop, ast_context);
+}
+
+std::string EnhancedCodeGenerator::generateIfConversion(const std::shared_ptr<AODNode>& node) {
+    auto* branch = llvm::dyn_cast_or_null<clang::IfStmt>(node->getAstStmt());
+    if (!branch || node->getProperty("region_end").empty()) return "";
+
+    // max / min 钳位 (if (x < c) x = c;): x = x < c ? c : x, 不经条件变量, 编译器对该形式直接生成 max / min 指令;
+    // 浮点用比较而非 fmax, NaN 与 -0.0 的结果与源码一致
+    std::string clamp = node->getProperty("if_converted");
+    if (clamp == "max" || clamp == "min") {
+        const clang::Stmt* then = branch->getThen();
+        if (auto* compound = llvm::dyn_cast<clang::CompoundStmt>(then)) then = compound->body_front();
+        auto* assign = llvm::cast<clang::BinaryOperator>(llvm::cast<clang::Expr>(then)->IgnoreParens());
+        auto* compare = llvm::cast<clang::BinaryOperator>(branch->getCond()->IgnoreParenImpCasts());
+        auto* lhs = llvm::dyn_cast<clang::DeclRefExpr>(compare->getLHS()->IgnoreParenImpCasts());
+        auto* var = llvm::cast<clang::DeclRefExpr>(assign->getLHS()->IgnoreParens())->getDecl();
+        std::string target = generateFallbackCode(assign->getLHS());
+        std::string bound = "clamp_" + std::to_string(node->getId());
+        // 保留源条件的比较符与操作数顺序 (< 与 <= 对 -0.0 / +0.0 的结果不同)
+        bool target_first = lhs && lhs->getDecl() == var;
+        std::string condition = (target_first ? target : bound) + " " + compare->getOpcodeStr().str() + " " + (target_first ? bound : target);
+        // 界值按比较时的公共类型保存, 比较与源码一致, 赋值时照常转换为 x 的类型
+        clang::QualType type = (target_first ? compare->getRHS() : compare->getLHS())->getType().getUnqualifiedType();
+        return "    const " + type.getAsString() + " " + bound + " = (" +
+               generateFallbackCode(assign->getRHS()) + ");\n    " + target + " = " + condition + " ? " + bound + " : " + target + ";\n";
+    }
+
+    // 先写的赋值可能改变条件中的变量, 条件只求值一次
+    std::string guard = "ifc_" + std::to_string(node->getId());
+    std::string code = "    const int " + guard + " = !!(" + generateFallbackCode(branch->getCond()) + ");\n";
+    std::function<void(const clang::Stmt*, bool)> lower = [&](const clang::Stmt* stmt, bool taken) {
+        if (!stmt) return;
+        if (auto* compound = llvm::dyn_cast<clang::CompoundStmt>(stmt)) {
+            for (const auto* child : compound->body()) lower(child, taken);
+            return;
+        }
+        auto* expr = llvm::dyn_cast<clang::Expr>(stmt);
+        auto* assign = expr ? llvm::dyn_cast<clang::BinaryOperator>(expr->IgnoreParens()) : nullptr;
+        if (!assign) return;
+        std::string target = generateFallbackCode(assign->getLHS());
+        std::string value = "(" + generateFallbackCode(assign->getRHS()) + ")";
+        if (auto* compound = llvm::dyn_cast<clang::CompoundAssignOperator>(assign)) {
+            auto opcode = clang::BinaryOperator::getOpForCompoundAssignment(compound->getOpcode());
+            value = "(" + target + " " + clang::BinaryOperator::getOpcodeStr(opcode).str() + " " + value + ")";
+        }
+        code += "    " + target + " = " + guard + " ? " + (taken ? value : target) + " : " + (taken ? target : value) + ";\n";
+    };
+    lower(branch->getThen(), true);
+    lower(branch->getElse(), false);
+    return code;
+}
+
 std::string EnhancedCodeGenerator::generateDefineNode(const std::shared_ptr<AODNode>& node, const AODGraphPtr& graph) {
+    if (absorbed_defines.count(node->getId())) return "";
     std::string var_name = node->getProperty("var_name");
     std::string rhs_code;
     std::string type = "auto";
@@ -114,45 +356,32 @@ std::string EnhancedCodeGenerator::generateDefineNode(const std::shared_ptr<AODN
         }
     }
 
-    if (init_src) {
+    if (!node->getProperty("alias_of").empty()) {
+        // 值编号合并后的冗余定义, 直接引用代表变量
+        rhs_code = node->getProperty("alias_of");
+        type = "auto";
+    } else if (init_src && init_src->isStatement()) {
+        rhs_code = init_src->getProperty("var_name");
+    } else if (init_src) {
         rhs_code = tryApplyRules(init_src, graph);
 
-        // 类型推断逻辑
-        if (rule_db) {
-            std::string op = init_src->getProperty("op_name");
-            auto rules = rule_db->queryRules("simd_instruction");
-            // 尝试查询 scalar 规则，以防万一
-            auto scalar_rules = rule_db->queryRules("scalar_vectorization");
-            rules.insert(rules.end(), scalar_rules.begin(), scalar_rules.end());
-
-            for (auto* r : rules) {
-                for (auto& req : r->source_pattern.required_operations) {
-                    if (req == op) {
-                        if (r->target_templates.count(target_architecture)) {
-                            auto& tmpl = r->target_templates.at(target_architecture);
-                            if (tmpl.performance_hints.count("return_type")) {
-                                type = tmpl.performance_hints.at("return_type");
-                            }
-                        }
-                        goto found_type;
-                    }
-                }
-            }
+        // 类型推断逻辑: 按通道类型特化的标量规则取推断出的向量类型, 否则以规则声明的返回类型为准
+        std::string init_elem = init_src->getProperty("elem_type");
+        auto tile = selected_tiles.find(init_src->getId());
+        if (isTypeGenericOperation(init_src->getProperty("op_name")) && !vectorTypeName(target_architecture, init_elem).empty()) {
+            type = vectorTypeName(target_architecture, init_elem);
+        } else if (tile != selected_tiles.end() && tile->second.target->performance_hints.count("return_type")) {
+            type = tile->second.target->performance_hints.at("return_type");
+        } else if (rule_db) {
+            auto handle = ruleIndex()->lookup(init_src->getProperty("op_name"), target_architecture);
+            if (handle && handle.return_type) type = *handle.return_type;
         }
-        found_type:;
-
-        // Heuristics (如果在规则中未找到)
+        // 外部规则文件可能不带 return_type, 按内置映射表补齐
         if (type == "auto" || type.find("__m256") != std::string::npos) {
-            if (target_architecture == "SVE") {
-                if (rhs_code.find("svbool") != std::string::npos || rhs_code.find("svptrue") != std::string::npos || rhs_code.find("svcmp") != std::string::npos)
-                    type = "svbool_t";
-                else
-                    type = "svint8_t"; // Default SVE type
-            } else if (target_architecture == "NEON") {
-                if (rhs_code.find("vaddq") != std::string::npos) type = "float32x4_t";
+            if (auto* mapping = findIntrinsicMapping(init_src->getProperty("op_name"), target_architecture)) {
+                if (!mapping->return_type.empty()) type = std::string(mapping->return_type);
             }
         }
-
     } else {
         // Fallback to original init expr
         if (auto* declStmt = llvm::dyn_cast<clang::DeclStmt>(node->getAstStmt())) {
@@ -164,43 +393,121 @@ std::string EnhancedCodeGenerator::generateDefineNode(const std::shared_ptr<AODN
 
     if (rhs_code.empty()) return ""; // No definition body
 
+    // 掩码域的值: 谓词或按掩码选出的数据, 类型与单指令规则的返回类型不同
+    if (mask_nodes.count(node->getId())) type = "svbool_t";
+    else if (masked_values.count(node->getId())) type = vectorTypeName(target_architecture, node->getProperty("elem_type"));
+
+    // 规则未给出类型时用推断出的通道类型; 仍未知则交给 auto, 不再猜测宽度
+    if (target_architecture != "AVX2" && (type == "auto" || type.find("__m256") != std::string::npos)) {
+        std::string inferred = vectorTypeName(target_architecture, node->getProperty("elem_type"));
+        if (!inferred.empty()) type = inferred;
+        else if (type.find("__m256") != std::string::npos) type = "auto";
+    }
+
     // 修复：仅当 type 中不包含 const 时才添加 const，避免 double const
     if (is_const && type.find("const") == std::string::npos) type = "const " + type;
     return type + " " + var_name + " = " + rhs_code;
 }
 
+std::string EnhancedCodeGenerator::materializeConstant(const std::shared_ptr<AODNode>& node) {
+    std::string kind = node->getProperty("const_kind");
+    std::string value = node->getProperty("const_value");
+    std::string lane = node->getProperty("const_lane");
+
+    std::string elem = node->getProperty("elem_type");
+
+    if (kind == "scalar") {
+        // NEON 路径把标量浮点运算整体向量化, 常量同样需要广播
+        if (target_architecture == "NEON" && !elem.empty() && elem[0] == 'f') return "vdupq_n_" + elem + "(" + value + ")";
+        return value;
+    }
+    if (kind == "vector_float") {
+        std::string suffix = lane == "32" ? "f32" : "f64";
+        if (target_architecture == "SVE") return "svdup_" + suffix + "(" + value + ")";
+        if (target_architecture == "NEON") return "vdupq_n_" + suffix + "(" + value + ")";
+        return std::string(lane == "32" ? "_mm256_set1_ps(" : "_mm256_set1_pd(") + value + ")";
+    }
+
+    // 整数向量: 按模式宽度广播, 与使用者推断出的通道类型不同时重新解释 (未知时按 8 位通道)
+    std::string want = !elem.empty() && (elem[0] == 's' || elem[0] == 'u') ? elem : "s8";
+    std::string native = std::string(want[0] == 'u' ? "u" : "s") + lane;
+    if (target_architecture == "SVE") {
+        std::string dup = "svdup_" + native + "(" + value + ")";
+        return native == want ? dup : "svreinterpret_" + want + "_" + native + "(" + dup + ")";
+    }
+    if (target_architecture == "NEON") {
+        std::string dup = "vdupq_n_" + native + "(" + value + ")";
+        return native == want ? dup : "vreinterpretq_" + want + "_" + native + "(" + dup + ")";
+    }
+    if (lane == "8") return "_mm256_set1_epi8((char)" + value + ")";
+    if (lane == "16") return "_mm256_set1_epi16((short)" + value + ")";
+    if (lane == "32") return "_mm256_set1_epi32(" + value + ")";
+    return "_mm256_set1_epi64x(" + value + "LL)";
+}
+
+// 按槽号单遍展开模板; 未经 RuleDatabase 加载的模板 (无预编译结果) 现场编译
+static std::string expandTemplate(const TransformTemplate& tmpl, const std::map<int, std::string>& inputs, const std::string* predicate) {
+    CodeTemplate local;
+    const CodeTemplate* compiled = tmpl.compiled.get();
+    if (!compiled) {
+        if (!CodeTemplate::compile(tmpl.code_template, local)) return tmpl.code_template;
+        compiled = &local;
+    }
+    CodeTemplate::Values values(compiled->slotCount(), nullptr);
+    for (const auto& [index, value] : inputs) {
+        int slot = compiled->inputSlot(index);
+        if (slot >= 0) values[slot] = &value;
+    }
+    int predicate_slot = predicate ? compiled->slotOf("predicate") : -1;
+    if (predicate_slot >= 0) values[predicate_slot] = predicate;
+    std::string code;
+    compiled->expand(values, code);
+    return code;
+}
+
 std::string EnhancedCodeGenerator::tryApplyRules(const std::shared_ptr<AODNode>& node, const AODGraphPtr& graph) {
+    if (!node->getProperty("const_kind").empty()) return materializeConstant(node);
     if (!rule_db) return generateFallbackCode(node->getAstStmt());
 
     std::string op_name = node->getProperty("op_name");
     // 如果没有 op_name，说明不是识别出的算子，回退
     if (op_name.empty()) return generateFallbackCode(node->getAstStmt());
 
-    // 查找规则
-    std::vector<OptimizationRule*> rules;
-    auto simd_rules = rule_db->queryRules("simd_instruction");
-    auto scalar_rules = rule_db->queryRules("scalar_vectorization"); // 确保也能查到标量规则
-    rules.insert(rules.end(), simd_rules.begin(), simd_rules.end());
-    rules.insert(rules.end(), scalar_rules.begin(), scalar_rules.end());
-
-    OptimizationRule* matched_rule = nullptr;
-    for (auto* rule : rules) {
-        for (const auto& req : rule->source_pattern.required_operations) {
-            if (req == op_name) { matched_rule = rule; break; }
-        }
-        if (matched_rule) break;
+    // 指令选择已为该节点选出最便宜的规则; 多节点 tile 整体展开
+    const TransformTemplate* target = nullptr;
+    // 谓词逻辑优先于按数据向量选出的 tile; 吸收掩码值的谓词化运算优先于单指令规则
+    bool is_mask = mask_nodes.count(node->getId()) > 0;
+    std::string mask_code = is_mask ? tryApplyMaskRules(node, graph) : "";
+    if (!mask_code.empty()) return mask_code;
+    auto tile = selected_tiles.find(node->getId());
+    if (tile != selected_tiles.end() && !tile->second.rule->source_pattern.tree_pattern.empty()) return emitTile(tile->second, graph);
+    mask_code = is_mask ? "" : tryApplyMaskRules(node, graph);
+    if (!mask_code.empty()) return mask_code;
+    if (tile != selected_tiles.end()) {
+        target = tile->second.target;
+    } else if (auto handle = ruleIndex()->lookup(op_name, target_architecture)) {
+        target = handle.target;
     }
 
     // 无规则 -> 回退
-    if (!matched_rule) return generateFallbackCode(node->getAstStmt());
-
-    if (matched_rule->target_templates.find(target_architecture) == matched_rule->target_templates.end()) {
+    if (!target) {
+        if (op_name.rfind("_mm", 0) == 0) unlowered_ops.insert(op_name);
         return generateFallbackCode(node->getAstStmt());
     }
 
-    const auto& tmpl = matched_rule->target_templates.at(target_architecture);
-    std::string code = tmpl.code_template;
-    std::map<std::string, std::string> bindings;
+    // 标量运算符规则按推断出的通道类型特化 (vaddq_f32 -> vaddq_f64 / vaddq_s32); 目标上没有的变体回退
+    std::string elem = node->getProperty("elem_type");
+    TransformTemplate specialized;
+    if (isTypeGenericOperation(op_name) && target->performance_hints.count("element_type")) {
+        const std::string& rule_elem = target->performance_hints.at("element_type");
+        if (elementTypeBits(elem) && elem[0] != 'b' && elem != rule_elem) {
+            if (!hasElementVariant(target_architecture, op_name, elem)) return generateFallbackCode(node->getAstStmt());
+            specialized.code_template = specializeElementType(target->code_template, rule_elem, elem, target_architecture);
+            target = &specialized;
+        }
+    }
+
+    std::map<int, std::string> inputs;
 
     // 处理参数
     auto edges = graph->getIncomingEdges(node->getId());
@@ -215,14 +522,28 @@ std::string EnhancedCodeGenerator::tryApplyRules(const std::shared_ptr<AODNode>&
                 // Clean cast
                 size_t pos;
                 while ((pos = s.find("(__m256i *)")) != std::string::npos) s.replace(pos, 11, "(int8_t *)");
-                bindings["{{input_" + std::to_string(i) + "}}"] = s;
+                inputs[i] = s;
             }
         } else if (auto* bo = llvm::dyn_cast<clang::BinaryOperator>(expr_ptr->IgnoreParenCasts())) {
-            bindings["{{input_0}}"] = generateFallbackCode(bo->getLHS());
-            bindings["{{input_1}}"] = generateFallbackCode(bo->getRHS());
+            inputs[0] = generateFallbackCode(bo->getLHS());
+            inputs[1] = generateFallbackCode(bo->getRHS());
         }
     }
 
+    // 图改写后的操作数 (强度削减等) 以节点属性为准, AST 只对应改写前的形式
+    int operand_count = std::atoi(node->getProperty("operand_count", "0").c_str());
+    for (int i = 0; i < operand_count; ++i) {
+        std::string text = node->getProperty("text_" + std::to_string(i));
+        if (text.empty()) continue;
+        size_t pos;
+        while ((pos = text.find("(__m256i *)")) != std::string::npos) text.replace(pos, 11, "(int8_t *)");
+        // NEON 上标量浮点运算整体向量化, 立即数操作数需要广播
+        if (target_architecture == "NEON" && op_name.find("_mm") != 0 && !node->getProperty("imm_" + std::to_string(i)).empty()) {
+            text = "vdupq_n_" + (elementTypeBits(elem) && elem[0] != 'b' ? elem : std::string("f32")) + "(" + text + ")";
+        }
+        inputs[i] = text;
+    }
+
     // 图数据流覆盖
     for (auto& edge : edges) {
         std::string var_name = edge->getProperties().variable_name;
@@ -237,31 +558,282 @@ std::string EnhancedCodeGenerator::tryApplyRules(const std::shared_ptr<AODNode>&
                 val = tryApplyRules(src, graph);
             }
 
-            // SVE 类型适配 (Predicate -> Data)
-            if (target_architecture == "SVE" && op_name.find("and") != std::string::npos) {
-                std::string src_op = src->getProperty("op_name");
-                if (src_op.find("cmp") != std::string::npos) {
-                    val = "svsel_s8(" + val + ", svdup_s8(0xFF), svdup_s8(0x00))";
-                }
+            // 谓词只在需要数据的使用者处物化为全 1/全 0 向量
+            auto mask = mask_nodes.find(src->getId());
+            if (mask != mask_nodes.end()) val = materializeMask(val, mask->second);
+
+            inputs[idx] = val;
+        }
+    }
+
+    // 已知对齐的访存: Arm 上没有对齐形式的 ld1/st1, 给指针加 __builtin_assume_aligned 提示;
+    // 长度无关循环逐 svcntb() 字节步进, 提示最多 16 字节
+    int alignment = std::atoi(node->getProperty("alignment", "0").c_str());
+    if (alignment >= 16 && inputs.count(0) && (target_architecture == "SVE" || target_architecture == "NEON")) {
+        const std::string& pointer = inputs[0];
+        inputs[0] = "(__typeof__(" + pointer + "))__builtin_assume_aligned(" + pointer + ", 16)";
+        aligned_accesses.insert(node->getId());
+    }
+
+    const std::string predicate = "pg";
+    std::string code = expandTemplate(*target, inputs, target_architecture == "SVE" ? &predicate : nullptr);
+    if (node->getProperty("nontemporal") == "true") return nontemporalStore(node, code);
+    return code;
+}
+
+std::string EnhancedCodeGenerator::streamingPrologue(const std::shared_ptr<AODNode>& header) const {
+    // 计数只减不增, 进入循环时的判断决定整个循环的形式
+    return "const bool mem_stream_" + std::to_string(header->getId()) + " = " + header->getProperty("step_count") + " >= " +
+           header->getProperty("stream_min_count") + ";\n    ";
+}
+
+std::string EnhancedCodeGenerator::streamingPrefetches(const std::shared_ptr<AODNode>& header) const {
+    std::string flag = "mem_stream_" + std::to_string(header->getId());
+    std::string distance = header->getProperty("prefetch_distance");
+    auto pointers = splitList(header->getProperty("step_pointers"));
+    auto sizes = splitList(header->getProperty("step_pointer_bytes"));
+    int64_t width = std::atoll(header->getProperty("step_width", "1").c_str());
+    std::string code;
+    for (const auto& pointer : splitList(header->getProperty("prefetch_pointers"))) {
+        std::string base = "(const char*)(" + pointer + ") + " + distance;
+        if (target_architecture == "SVE") {
+            // svprfb 按谓词预取一整个向量的字节
+            std::string pg = header->getProperty("vla") == "true" ? "pg" : "svptrue_b8()";
+            code += "\n    if (" + flag + ") svprfb(" + pg + ", " + base + ", SV_PLDL1STRM);";
+            continue;
+        }
+        // 每次迭代读过的每条缓存行 (按 64 字节计) 预取一次
+        int64_t bytes = width;
+        for (size_t i = 0; i < pointers.size() && i < sizes.size(); ++i) {
+            if (pointers[i] == pointer) bytes = width * std::atoll(sizes[i].c_str());
+        }
+        for (int64_t offset = 0; offset < bytes; offset += 64) {
+            code += "\n    if (" + flag + ") __builtin_prefetch(" + base + (offset ? " + " + std::to_string(offset) : "") + ", 0, 0);";
+        }
+    }
+    return code;
+}
+
+std::string EnhancedCodeGenerator::nontemporalStore(const std::shared_ptr<AODNode>& node, const std::string& code) const {
+    std::string store = code;
+    while (!store.empty() && (store.back() == ';' || std::isspace(static_cast<unsigned char>(store.back())))) store.pop_back();
+    std::string flag = "mem_stream_" + node->getProperty("stream_header");
+    if (target_architecture == "SVE" && store.rfind("svst1_", 0) == 0) {
+        return "if (" + flag + ") svstnt1_" + store.substr(6) + "; else " + store + ";";
+    }
+    if (target_architecture != "NEON" || store.rfind("vst1q_", 0) != 0 || store.back() != ')') return code;
+
+    // vst1q_T(ptr, value) -> __builtin_nontemporal_store(value, (VT*)(ptr)); 向量指针要求 16 字节对齐, 未知时运行时检查
+    size_t open = store.find('(');
+    size_t comma = std::string::npos;
+    int depth = 0;
+    for (size_t i = open; i < store.size() && comma == std::string::npos; ++i) {
+        if (store[i] == '(') depth++;
+        else if (store[i] == ')') depth--;
+        else if (store[i] == ',' && depth == 1) comma = i;
+    }
+    std::string type = vectorTypeName("NEON", store.substr(6, open - 6));
+    if (comma == std::string::npos || type.empty()) return code;
+    std::string pointer = store.substr(open + 1, comma - open - 1);
+    std::string value = store.substr(comma + 1, store.size() - comma - 2);
+    while (!value.empty() && value[0] == ' ') value.erase(0, 1);
+    std::string guard = flag;
+    if (std::atoi(node->getProperty("alignment", "0").c_str()) < 16) guard += " && (uintptr_t)(" + pointer + ") % 16 == 0";
+    return "if (" + guard + ") __builtin_nontemporal_store(" + value + ", (" + type + "*)(" + pointer + ")); else " + store + ";";
+}
+
+void EnhancedCodeGenerator::analyzeMaskDomain(const AODGraphPtr& graph) {
+    mask_nodes.clear();
+    masked_values.clear();
+    predicated_uses.clear();
+    absorbed_defines.clear();
+    if (target_architecture != "SVE") return;
+
+    std::map<int, std::map<int, std::shared_ptr<AODNode>>> operands;
+    std::map<int, std::vector<std::shared_ptr<AODNode>>> users;
+    for (const auto& edge : graph->getEdges()) {
+        if (!AODGraph::isOperandEdge(*edge)) continue;
+        operands[edge->getTarget()->getId()][AODGraph::getOperandIndex(*edge)] = edge->getSource();
+        users[edge->getSource()->getId()].push_back(edge->getTarget());
+    }
+    // 多节点 tile 自带谓词化形式, 其根与内部节点不参与掩码值的吸收 (谓词本身仍按掩码域生成)
+    std::set<int> tiled;
+    for (const auto& [id, tile] : selected_tiles) {
+        if (tile.rule->source_pattern.tree_pattern.empty()) continue;
+        tiled.insert(id);
+        for (const auto& covered : tile.covered) tiled.insert(covered->getId());
+    }
+
+    auto operand = [&](int id, int index) -> std::shared_ptr<AODNode> {
+        auto it = operands[id].find(index);
+        return it != operands[id].end() ? it->second : nullptr;
+    };
+    auto mask_width = [&](const std::shared_ptr<AODNode>& node) {
+        auto it = node ? mask_nodes.find(node->getId()) : mask_nodes.end();
+        return it != mask_nodes.end() ? it->second : 0;
+    };
+    auto all_ones = [&](const std::shared_ptr<AODNode>& user, int index) {
+        auto src = operand(user->getId(), index);
+        if (!src) return user->getProperty("imm_" + std::to_string(index)) == "-1";
+        if (src->getProperty("op_name") == "define") src = operand(src->getId(), 0);
+        return src && (src->getProperty("const_value") == "-1" ||
+                       (src->getProperty("op_name").rfind("_mm256_set1_epi", 0) == 0 && src->getProperty("imm_0") == "-1"));
+    };
+    auto logic = [](const std::string& op, const char* name) { return op == std::string("_mm256_") + name + "_si256"; };
+
+    // 谓词: 比较结果, 以及经 define / and / or / andnot / xor (含与全 1 异或即取反) 组合的谓词
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (const auto& node : graph->getNodes()) {
+            int id = node->getId();
+            if (mask_nodes.count(id)) continue;
+            std::string op = node->getProperty("op_name");
+            int width = 0;
+            std::string elem = elementTypeOfIntrinsic(op);
+            if (!elem.empty() && elem[0] == 'b') {
+                width = elementTypeBits(elem);
+            } else if (op == "define") {
+                width = mask_width(operand(id, 0));
+            } else if (logic(op, "and") || logic(op, "or") || logic(op, "andnot") || logic(op, "xor")) {
+                int a = mask_width(operand(id, 0)), b = mask_width(operand(id, 1));
+                if (a && a == b) width = a;
+                else if (logic(op, "xor") && a && all_ones(node, 1)) width = a;
+                else if (logic(op, "xor") && b && all_ones(node, 0)) width = b;
             }
+            if (!width) continue;
+            mask_nodes[id] = width;
+            changed = true;
+        }
+    }
+
+    // and(mask, data) 与其 define (define 节点先于初值表达式创建, 分两遍): 数据只在掩码为真的通道保留
+    for (const auto& node : graph->getNodes()) {
+        int id = node->getId();
+        std::string elem = node->getProperty("elem_type");
+        if (mask_nodes.count(id) || tiled.count(id) || !logic(node->getProperty("op_name"), "and")) continue;
+        if (elem.empty() || (elem[0] != 's' && elem[0] != 'u')) continue;
+        for (int k = 0; k < 2; ++k) {
+            if (mask_width(operand(id, k)) == elementTypeBits(elem) && !mask_width(operand(id, 1 - k))) {
+                masked_values[id] = {node, k};
+                break;
+            }
+        }
+    }
+    for (const auto& node : graph->getNodes()) {
+        auto init = node->getProperty("op_name") == "define" ? operand(node->getId(), 0) : nullptr;
+        if (init && masked_values.count(init->getId())) masked_values[node->getId()] = masked_values[init->getId()];
+    }
 
-            bindings["{{input_" + std::to_string(idx) + "}}"] = val;
+    // 使用者吸收掩码: x + (m & d) = svadd_m(m, x, d), 同理 sub (仅被减数以外) / or / xor, x & (m & d) = svand_z(m, x, d)
+    for (const auto& node : graph->getNodes()) {
+        int id = node->getId();
+        if (mask_nodes.count(id) || masked_values.count(id) || tiled.count(id)) continue;
+        std::string op = node->getProperty("op_name");
+        std::string elem = node->getProperty("elem_type");
+        bool arithmetic = op.rfind("_mm256_add_epi", 0) == 0 || op.rfind("_mm256_sub_epi", 0) == 0;
+        if (!(arithmetic || logic(op, "and") || logic(op, "or") || logic(op, "xor")) || elem.empty() || elem[0] == 'f') continue;
+        for (int k = op.rfind("_mm256_sub", 0) == 0 ? 1 : 0; k < 2; ++k) {
+            auto value = operand(id, k);
+            if (!value || !masked_values.count(value->getId())) continue;
+            const auto& [owner, mask_index] = masked_values[value->getId()];
+            if (mask_width(operand(owner->getId(), mask_index)) != elementTypeBits(elem)) continue;
+            predicated_uses[id] = k;
+            break;
+        }
+    }
+
+    // 所有使用者都已吸收且源码中没有其它引用的掩码值定义不再输出
+    for (const auto& [id, value] : masked_values) {
+        auto node = graph->getNode(id);
+        if (!node || node->getProperty("op_name") != "define" || node->getProperty("opaque_refs") != "0" || users[id].empty()) continue;
+        bool absorbed = true;
+        for (const auto& user : users[id]) {
+            auto use = predicated_uses.find(user->getId());
+            absorbed = absorbed && use != predicated_uses.end() && operand(user->getId(), use->second) == node;
         }
+        if (absorbed) absorbed_defines.insert(id);
     }
+}
+
+std::string EnhancedCodeGenerator::operandCode(const std::shared_ptr<AODNode>& user, int index, const AODGraphPtr& graph) {
+    if (auto src = graph->getOperand(user->getId(), index)) {
+        return src->isStatement() ? src->getProperty("var_name") : tryApplyRules(src, graph);
+    }
+    std::string text = user->getProperty("text_" + std::to_string(index));
+    return text.empty() ? user->getProperty("imm_" + std::to_string(index)) : text;
+}
 
-    if (target_architecture == "SVE") bindings["{{predicate}}"] = "pg";
+std::string EnhancedCodeGenerator::materializeMask(const std::string& predicate, int width) {
+    std::string elem = "s" + std::to_string(width);
+    std::string type = vectorTypeName("SVE", elem);
+    std::string ones = requireFunctionConstant("sv_all_ones_" + elem, "const " + type + " sv_all_ones_" + elem + " = svdup_" + elem + "(-1);");
+    std::string zeros = requireFunctionConstant("sv_all_zeros_" + elem, "const " + type + " sv_all_zeros_" + elem + " = svdup_" + elem + "(0);");
+    return "svsel_" + elem + "(" + predicate + ", " + ones + ", " + zeros + ")";
+}
 
-    // 模板替换
-    for (const auto& [k, v] : bindings) {
-        std::string ph = k;
-        size_t pos = 0;
-        while ((pos = code.find(ph, pos)) != std::string::npos) {
-            code.replace(pos, ph.length(), v);
-            pos += v.length();
+std::string EnhancedCodeGenerator::tryApplyMaskRules(const std::shared_ptr<AODNode>& node, const AODGraphPtr& graph) {
+    int id = node->getId();
+    std::string op = node->getProperty("op_name");
+    std::string elem = node->getProperty("elem_type");
+
+    // 谓词间逻辑; 比较本身由映射规则生成
+    auto mask = mask_nodes.find(id);
+    if (mask != mask_nodes.end()) {
+        if (op == "define" || classifyOperationName(op) == "cmp") return "";
+        auto is_mask = [&](int index) {
+            auto src = graph->getOperand(id, index);
+            return src && mask_nodes.count(src->getId());
+        };
+        if (op == "_mm256_xor_si256" && !(is_mask(0) && is_mask(1))) {
+            return "svnot_b_z(pg, " + operandCode(node, is_mask(0) ? 0 : 1, graph) + ")";
         }
+        std::string a = operandCode(node, 0, graph), b = operandCode(node, 1, graph);
+        if (op == "_mm256_and_si256") return "svand_b_z(pg, " + a + ", " + b + ")";
+        if (op == "_mm256_or_si256") return "svorr_b_z(pg, " + a + ", " + b + ")";
+        if (op == "_mm256_xor_si256") return "sveor_b_z(pg, " + a + ", " + b + ")";
+        return "svbic_b_z(pg, " + b + ", " + a + ")";  // andnot(a, b) = ~a & b
     }
 
-    return code;
+    // 谓词化运算: 掩码为假的通道保持 x (and 为 0)
+    auto use = predicated_uses.find(id);
+    if (use != predicated_uses.end()) {
+        int k = use->second;
+        const auto& [owner, mask_index] = masked_values[graph->getOperand(id, k)->getId()];
+        std::string predicate = operandCode(owner, mask_index, graph);
+        std::string data = operandCode(owner, 1 - mask_index, graph);
+        std::string x = operandCode(node, 1 - k, graph);
+        std::string name = op.rfind("_mm256_add", 0) == 0 ? "svadd" : op.rfind("_mm256_sub", 0) == 0 ? "svsub"
+                         : op == "_mm256_or_si256" ? "svorr" : op == "_mm256_xor_si256" ? "sveor" : "svand";
+        return name + "_" + elem + (name == "svand" ? "_z(" : "_m(") + predicate + ", " + x + ", " + data + ")";
+    }
+
+    // 仍需数据形式的 and(mask, data): 一条 svsel
+    auto masked = masked_values.find(id);
+    if (masked != masked_values.end() && op != "define") {
+        int mask_index = masked->second.second;
+        std::string zeros = requireFunctionConstant("sv_all_zeros_" + elem, "const " + vectorTypeName("SVE", elem) + " sv_all_zeros_" +
+                                                    elem + " = svdup_" + elem + "(0);");
+        return "svsel_" + elem + "(" + operandCode(node, mask_index, graph) + ", " + operandCode(node, 1 - mask_index, graph) + ", " + zeros + ")";
+    }
+    return "";
+}
+
+std::string EnhancedCodeGenerator::emitTile(const TileSelection& tile, const AODGraphPtr& graph) {
+    std::map<int, std::string> inputs;
+    for (const auto& [k, leaf] : tile.leaf_nodes) {
+        inputs[k] = leaf->isStatement() ? leaf->getProperty("var_name") : tryApplyRules(leaf, graph);
+        auto mask = mask_nodes.find(leaf->getId());
+        if (mask != mask_nodes.end()) inputs[k] = materializeMask(inputs[k], mask->second);
+    }
+    for (const auto& [k, text] : tile.leaf_texts) {
+        std::string value = text;
+        size_t pos;
+        while ((pos = value.find("(__m256i *)")) != std::string::npos) value.replace(pos, 11, "(int8_t *)");
+        inputs[k] = value;
+    }
+    const std::string predicate = "pg";
+    return expandTemplate(*tile.target, inputs, target_architecture == "SVE" ? &predicate : nullptr);
 }
 
 std::string EnhancedCodeGenerator::generateFallbackCode(const clang::Stmt* stmt) {
@@ -1,10 +1,12 @@
 #pragma once
 #include "aod/enhanced_aod_graph.h"
 #include "aod/optimization_rule_system.h"
+#include "analysis/loop_vectorization_analyzer.h"
 #include "clang/AST/ASTContext.h"
 
 #include <memory>
 #include <map>
+#include <set>
 #include <vector>
 #include <string>
 
@@ -16,6 +18,10 @@ namespace aodsolve {
         double estimated_speedup = 0.0;
         int simd_intrinsics = 0;
         std::vector<std::string> info_messages;
+        // 访存层次改写 (非临时存储 / 预取) 的循环, 每个循环一行
+        std::vector<std::string> memory_notes;
+        // 目标上没有模板、只能按源码原样输出的 x86 intrinsic (结果在目标上无法编译)
+        std::vector<std::string> unlowered_operations;
         std::string target_architecture;
     };
 
@@ -24,13 +30,41 @@ namespace aodsolve {
         clang::ASTContext& ast_context;
         std::string target_architecture;
         RuleDatabase* rule_db = nullptr;
+        // rule_db 的只读编译索引, 首次使用或规则变动后构建
+        std::shared_ptr<const CompiledRuleIndex> rule_index;
+        // 函数级常量 (如 SVE 掩码物化用的全 0/全 1 向量), 在函数体开头只生成一次
+        std::vector<std::string> function_constants;
+        // 指令选择结果 (节点ID -> tile), 每次生成前对整图重新计算
+        std::map<int, TileSelection> selected_tiles;
+        // NEON 循环的展开参数
+        VectorLoopOptions loop_options;
+        // SVE 掩码域分析 (analyzeMaskDomain) 的结果:
+        // 以 svbool_t 谓词表示的节点 -> 谓词通道宽度
+        std::map<int, int> mask_nodes;
+        // and(mask, data) 形式的值 (and 节点及其 define) -> (and 节点, 掩码操作数下标)
+        std::map<int, std::pair<std::shared_ptr<AODNode>, int>> masked_values;
+        // 吸收掩码值的谓词化运算 -> 掩码值所在的操作数下标
+        std::map<int, int> predicated_uses;
+        // 掩码值全部被谓词化运算吸收、不再输出的定义
+        std::set<int> absorbed_defines;
+        // 本次生成中加了对齐提示的 SIMD 访存节点
+        std::set<int> aligned_accesses;
+        // 本次生成中回退到源码打印的 x86 intrinsic
+        std::set<std::string> unlowered_ops;
 
     public:
         explicit EnhancedCodeGenerator(clang::ASTContext& ctx);
         ~EnhancedCodeGenerator() = default;
 
         void setTargetArchitecture(const std::string& arch) { target_architecture = arch; }
-        void setRuleDatabase(RuleDatabase* db) { rule_db = db; }
+        void setRuleDatabase(RuleDatabase* db) { rule_db = db; rule_index.reset(); }
+        // 共享预先构建的索引 (须来自同一 rule_db)
+        void setRuleIndex(std::shared_ptr<const CompiledRuleIndex> index) { rule_index = std::move(index); }
+        void setUnrollFactor(int factor) { loop_options.unroll = factor; }
+        void setFPReassociation(bool allow) { loop_options.reassociate_fp = allow; }
+        void setAlignPeelThreshold(int64_t trip) { loop_options.align_peel_trip = trip; }
+        void setStreamingThreshold(int64_t bytes) { loop_options.streaming_bytes = bytes; }
+        void setPrefetchDistance(int64_t distance) { loop_options.prefetch_distance = distance; }
 
         CodeGenerationResult generateCodeFromGraph(const AODGraphPtr& graph);
 
@@ -38,12 +72,39 @@ namespace aodsolve {
         std::string generateLoopFromTemplate(const std::map<std::string, std::string>&, const std::string&) { return ""; }
 
     private:
+        const std::shared_ptr<const CompiledRuleIndex>& ruleIndex();
         std::string tryApplyRules(const std::shared_ptr<AODNode>& node, const AODGraphPtr& graph);
         std::string generateFallbackCode(const clang::Stmt* stmt);
         std::string generateOutputVar(const std::shared_ptr<AODNode>& node);
 
         // 新增声明: 修复编译错误
         std::string generateDefineNode(const std::shared_ptr<AODNode>& node, const AODGraphPtr& graph);
+        // 长度无关循环中的归纳语句: 按 min(count, svcntb()) 步进, 首条归纳语句负责声明 sv_step
+        std::string generateInductionStep(const std::shared_ptr<AODNode>& node, const AODGraphPtr& graph);
+        // NEON / SVE 上整体生成 [头节点, region_end] 区间的 for 循环; 返回空串表示按节点逐条生成
+        std::string generateVectorLoop(const std::shared_ptr<AODNode>& header, const AODGraphPtr& graph,
+                                       CodeGenerationResult& result);
+        // 访存层次 pass 标记的固定步长循环: 进入前按计数求一次流式标志, 循环头之后按标志预取
+        std::string streamingPrologue(const std::shared_ptr<AODNode>& header) const;
+        std::string streamingPrefetches(const std::shared_ptr<AODNode>& header) const;
+        // nontemporal 存储: 流式标志成立时改用非临时存储, 否则保持 code
+        std::string nontemporalStore(const std::shared_ptr<AODNode>& node, const std::string& code) const;
+        // if-conversion 标记的分支: 条件求值一次, 两个分支的赋值改为按条件选择的无条件赋值
+        std::string generateIfConversion(const std::shared_ptr<AODNode>& node);
+        // 常量传播折叠出的值 (const_kind/const_lane/const_value) 按目标架构物化
+        std::string materializeConstant(const std::shared_ptr<AODNode>& node);
+        std::string requireFunctionConstant(const std::string& name, const std::string& declaration);
+        // 多节点 tile: 按叶子绑定展开目标模板, 被吸收的内部节点不再单独生成
+        std::string emitTile(const TileSelection& tile, const AODGraphPtr& graph);
+        // AVX2 比较结果保持为谓词: 谓词间逻辑用 svand_b_z 等, and(mask, delta) 并入使用者的 _m/_z 形式,
+        // 只有真正需要数据的使用者才物化为字节向量
+        void analyzeMaskDomain(const AODGraphPtr& graph);
+        // 掩码域内的节点按谓词形式生成; 不适用时返回空串
+        std::string tryApplyMaskRules(const std::shared_ptr<AODNode>& node, const AODGraphPtr& graph);
+        // user 第 index 个操作数的代码: 图中节点按规则生成, 否则取源码文本
+        std::string operandCode(const std::shared_ptr<AODNode>& user, int index, const AODGraphPtr& graph);
+        // 谓词 -> 同宽度的全 1/全 0 有符号数据向量
+        std::string materializeMask(const std::string& predicate, int width);
     };
 
 } // namespace aodsolve
@@ -1,18 +1,61 @@
 #include "conversion/enhanced_cpg_to_aod_converter.h"
+#include "analysis/loop_vectorization_analyzer.h"
 #include <sstream>
 #include <algorithm>
 #include <iostream>
+#include <cctype>
+#include <functional>
+#include <set>
 #include <clang/AST/RecursiveASTVisitor.h>
+#include <clang/AST/ParentMapContext.h>
 #include <clang/AST/Stmt.h>
 #include <clang/AST/Expr.h>
 
 namespace aodsolve {
 
-EnhancedCPGToAODConverter::EnhancedCPGToAODConverter(clang::ASTContext& ctx, IntegratedCPGAnalyzer& a)
-    : source_manager(ctx.getSourceManager()), analyzer(&a) {
-    (void)ctx;
+// 初始化表达式中除 SIMD 纯运算/加载以外的调用、赋值和自增自减都视为可观察副作用
+static bool hasObservableSideEffects(const clang::Stmt* stmt) {
+    if (!stmt) return false;
+    if (auto* call = llvm::dyn_cast<clang::CallExpr>(stmt)) {
+        auto* callee = call->getDirectCallee();
+        std::string name = callee ? callee->getNameAsString() : "";
+        bool simd_value = isPureOperationName(name) ||
+                          (name.rfind("_mm", 0) == 0 && name.find("load") != std::string::npos);
+        if (!simd_value) return true;
+    } else if (auto* bo = llvm::dyn_cast<clang::BinaryOperator>(stmt)) {
+        if (bo->isAssignmentOp()) return true;
+    } else if (auto* uo = llvm::dyn_cast<clang::UnaryOperator>(stmt)) {
+        if (uo->isIncrementDecrementOp()) return true;
+    }
+    for (const auto* child : stmt->children()) {
+        if (hasObservableSideEffects(child)) return true;
+    }
+    return false;
 }
 
+// 语句直接写入的局部变量 (x = ..., x op= ..., ++x / x--), 没有时返回 nullptr;
+// 复合赋值与自增自减本身含一次运算, op 为该运算符, 普通赋值为空
+static const clang::VarDecl* assignedVariable(const clang::Stmt* stmt, std::string& op) {
+    const clang::Expr* target = nullptr;
+    op.clear();
+    if (auto* compound = llvm::dyn_cast<clang::CompoundAssignOperator>(stmt)) {
+        target = compound->getLHS();
+        op = clang::BinaryOperator::getOpcodeStr(clang::BinaryOperator::getOpForCompoundAssignment(compound->getOpcode())).str();
+    } else if (auto* bo = llvm::dyn_cast<clang::BinaryOperator>(stmt)) {
+        if (bo->isAssignmentOp()) target = bo->getLHS();
+    } else if (auto* uo = llvm::dyn_cast<clang::UnaryOperator>(stmt)) {
+        if (uo->isIncrementDecrementOp()) {
+            target = uo->getSubExpr();
+            op = uo->isIncrementOp() ? "+" : "-";
+        }
+    }
+    auto* ref = target ? llvm::dyn_cast<clang::DeclRefExpr>(target->IgnoreParenCasts()) : nullptr;
+    return ref ? llvm::dyn_cast<clang::VarDecl>(ref->getDecl()) : nullptr;
+}
+
+EnhancedCPGToAODConverter::EnhancedCPGToAODConverter(clang::ASTContext& ctx, IntegratedCPGAnalyzer& a)
+    : ast_context(ctx), source_manager(ctx.getSourceManager()), analyzer(&a) {}
+
 ConversionResult EnhancedCPGToAODConverter::convertWithOperators(
     const clang::FunctionDecl* func,
     const std::string&, const std::string& target_arch) {
@@ -20,9 +63,10 @@ ConversionResult EnhancedCPGToAODConverter::convertWithOperators(
     ConversionResult result;
     result.aod_graph = std::make_shared<AODGraph>(func->getNameAsString());
     stmt_to_node_map.clear();
+    collectModifiedVars(func);
 
     // 简单的上下文标记：是否在向量化模式
-    bool enable_autovec = (target_arch == "NEON"); // 简单开关
+    bool enable_autovec = (target_arch == "NEON" || target_arch == "SVE"); // 简单开关
 
     try {
         buildFullAODGraph(func, *result.aod_graph);
@@ -42,6 +86,12 @@ ConversionResult EnhancedCPGToAODConverter::convertWithOperators(
         }
 
         connectDataFlow(func, *result.aod_graph);
+        connectControlFlow(func, *result.aod_graph);
+        annotateReferenceCounts(*result.aod_graph);
+        annotateShapes(func, *result.aod_graph);
+        annotateFixedStepLoops(func, *result.aod_graph);
+        annotateBranches(*result.aod_graph);
+        annotateAlignment(func, *result.aod_graph);
         result.successful = true;
         result.converted_node_count = result.aod_graph->getNodeCount();
     } catch (const std::exception& e) {
@@ -54,10 +104,13 @@ ConversionResult EnhancedCPGToAODConverter::convertWithOperators(
 
 void EnhancedCPGToAODConverter::buildFullAODGraph(const clang::FunctionDecl* func, AODGraph& graph) {
     if (!func || !func->hasBody()) return;
+    graph.addNode(std::make_shared<AODNode>(AODNodeType::Entry, "Entry"));
     traverseAndBuild(func->getBody(), graph, true);
+    graph.addNode(std::make_shared<AODNode>(AODNodeType::Exit, "Exit"));
 }
 
-void EnhancedCPGToAODConverter::traverseExpressionTree(const clang::Stmt* stmt, AODGraph& graph) {
+void EnhancedCPGToAODConverter::traverseExpressionTree(const clang::Stmt* stmt, AODGraph& graph,
+                                                       const std::shared_ptr<AODNode>& owner) {
     if (!stmt) return;
 
     const clang::Expr* expr = llvm::dyn_cast<clang::Expr>(stmt);
@@ -81,8 +134,10 @@ void EnhancedCPGToAODConverter::traverseExpressionTree(const clang::Stmt* stmt,
             node->setAstStmt(stmt);
             node->setIsStatement(false);
         }
+        if (node) annotateOperands(node, expr_clean);
 
         if (node) {
+            if (owner) node->setProperty("stmt_anchor", std::to_string(owner->getId()));
             graph.addNode(node);
             // 映射所有相关的 Expr 指针
             if (expr) stmt_to_node_map[expr] = node;
@@ -92,7 +147,7 @@ void EnhancedCPGToAODConverter::traverseExpressionTree(const clang::Stmt* stmt,
     }
 
     for (const auto* child : stmt->children()) {
-        if (child) traverseExpressionTree(child, graph);
+        if (child) traverseExpressionTree(child, graph, owner);
     }
 }
 
@@ -121,18 +176,32 @@ void EnhancedCPGToAODConverter::traverseAndBuild(const clang::Stmt* stmt, AODGra
         graph.addNode(node);
         stmt_to_node_map[stmt] = node;
 
+        const clang::Expr* cond = nullptr;
+        if (auto* whileStmt = llvm::dyn_cast<clang::WhileStmt>(stmt)) cond = whileStmt->getCond();
+        else if (auto* forStmt = llvm::dyn_cast<clang::ForStmt>(stmt)) cond = forStmt->getCond();
+        else if (auto* ifStmt = llvm::dyn_cast<clang::IfStmt>(stmt)) cond = ifStmt->getCond();
+        bool cond_value = false;
+        if (cond && !cond->isValueDependent() && cond->EvaluateAsBooleanCondition(cond_value, ast_context)) {
+            node->setProperty("cond_value", cond_value ? "true" : "false");
+        }
+
         if (auto* whileStmt = llvm::dyn_cast<clang::WhileStmt>(stmt)) {
-            traverseExpressionTree(whileStmt->getCond(), graph);
+            traverseExpressionTree(whileStmt->getCond(), graph, node);
             traverseAndBuild(whileStmt->getBody(), graph, true);
         } else if (auto* forStmt = llvm::dyn_cast<clang::ForStmt>(stmt)) {
-            traverseExpressionTree(forStmt->getInit(), graph);
-            traverseExpressionTree(forStmt->getCond(), graph);
+            traverseExpressionTree(forStmt->getInit(), graph, node);
+            traverseExpressionTree(forStmt->getCond(), graph, node);
             traverseAndBuild(forStmt->getBody(), graph, true);
         } else if (auto* ifStmt = llvm::dyn_cast<clang::IfStmt>(stmt)) {
-            traverseExpressionTree(ifStmt->getCond(), graph);
+            traverseExpressionTree(ifStmt->getCond(), graph, node);
             traverseAndBuild(ifStmt->getThen(), graph, true);
             if (ifStmt->getElse()) traverseAndBuild(ifStmt->getElse(), graph, true);
         }
+        if (cond && stmt_to_node_map.count(cond->IgnoreParenCasts())) {
+            node->setProperty("cond_node", std::to_string(stmt_to_node_map[cond->IgnoreParenCasts()]->getId()));
+        }
+        // 控制语句在节点序列中占据 [头节点, region_end] 的连续区间
+        node->setProperty("region_end", std::to_string(graph.getNodes().back()->getId()));
         return;
     }
 
@@ -153,12 +222,16 @@ void EnhancedCPGToAODConverter::traverseAndBuild(const clang::Stmt* stmt, AODGra
                     // 标记为 SIMD 相关的定义
                     node = createSIMDNode(stmt);
                 }
+                std::string elem = elementTypeOf(var->getType(), ast_context);
+                if (!elem.empty()) node->setProperty("elem_type", elem);
+                if (modified_vars.count(var)) node->setProperty("reassigned", "true");
+                if (init && hasObservableSideEffects(init)) node->setProperty("init_side_effects", "true");
 
                 graph.addNode(node);
                 stmt_to_node_map[stmt] = node;
 
                 if (init) {
-                    traverseExpressionTree(init, graph);
+                    traverseExpressionTree(init, graph, node);
                 }
                 return;
             }
@@ -173,11 +246,20 @@ void EnhancedCPGToAODConverter::traverseAndBuild(const clang::Stmt* stmt, AODGra
         node->setAstStmt(stmt);
         node->setIsStatement(is_top_level);
     }
+    // 循环内写入的变量若在写入前被读取, 构成循环携带依赖 (关键路径分析据此估计递推延迟)
+    std::string assign_op;
+    if (auto* var = assignedVariable(stmt, assign_op)) {
+        node->setProperty("assigns", var->getNameAsString());
+        if (!assign_op.empty()) {
+            node->setProperty("assign_op", assign_op);
+            node->setProperty("assign_type", var->getType().getAsString());
+        }
+    }
     graph.addNode(node);
     stmt_to_node_map[stmt] = node;
 
     for (const auto* child : stmt->children()) {
-        if (child) traverseExpressionTree(child, graph);
+        if (child) traverseExpressionTree(child, graph, node);
     }
 }
 
@@ -227,6 +309,837 @@ std::shared_ptr<AODNode> EnhancedCPGToAODConverter::createAODNodeFromStmt(const
     return node;
 }
 
+std::string EnhancedCPGToAODConverter::elementTypeOf(clang::QualType type, const clang::ASTContext& ctx) {
+    if (type.isNull()) return "";
+    type = type.getNonReferenceType().getCanonicalType();
+    if (type->isPointerType()) type = type->getPointeeType().getCanonicalType();
+    else if (type->isArrayType()) type = clang::QualType(type->getArrayElementTypeNoTypeQual(), 0).getCanonicalType();
+    if (auto* vector = type->getAs<clang::VectorType>()) {
+        if (!vector->getElementType()->isRealFloatingType()) return "";
+        type = vector->getElementType().getCanonicalType();
+    }
+    if (type->isBooleanType()) return "u8";
+    std::string bits = std::to_string(ctx.getTypeSize(type));
+    if (type->isRealFloatingType()) return "f" + bits;
+    if (type->isIntegerType()) return (type->isSignedIntegerType() ? "s" : "u") + bits;
+    return "";
+}
+
+void EnhancedCPGToAODConverter::annotateOperands(const std::shared_ptr<AODNode>& node, const clang::Expr* expr) {
+    if (!expr) return;
+    node->setProperty("value_type", expr->getType().getAsString());
+    // intrinsic 的通道宽度由名称决定 (推断时优先), 标量运算取表达式类型, 比较结果为操作数宽度的掩码
+    auto* compare = llvm::dyn_cast<clang::BinaryOperator>(expr);
+    std::string result_elem = compare && compare->isComparisonOp()
+        ? elementTypeOf(compare->getLHS()->getType(), ast_context) : elementTypeOf(expr->getType(), ast_context);
+    if (compare && compare->isComparisonOp() && !result_elem.empty()) result_elem = "b" + result_elem.substr(1);
+    if (!result_elem.empty()) node->setProperty("elem_type", result_elem);
+
+    std::vector<const clang::Expr*> operands;
+    if (auto* call = llvm::dyn_cast<clang::CallExpr>(expr)) {
+        for (const auto* arg : call->arguments()) operands.push_back(arg);
+    } else if (auto* bo = llvm::dyn_cast<clang::BinaryOperator>(expr)) {
+        operands = {bo->getLHS(), bo->getRHS()};
+    } else {
+        return;
+    }
+    node->setProperty("operand_count", std::to_string(operands.size()));
+
+    for (size_t i = 0; i < operands.size(); ++i) {
+        const clang::Expr* op = operands[i];
+        std::string text;
+        llvm::raw_string_ostream text_os(text);
+        op->printPretty(text_os, nullptr, ast_context.getPrintingPolicy());
+        node->setProperty("text_" + std::to_string(i), text_os.str());
+        // 操作数类型提示: 逐层剥开转换, 取第一个带通道宽度的类型 ((__m256i *)src 取 src 的元素类型)
+        for (const clang::Expr* inner = op; inner;) {
+            std::string elem = elementTypeOf(inner->getType(), ast_context);
+            if (!elem.empty()) {
+                node->setProperty("operand_elem_" + std::to_string(i), elem);
+                break;
+            }
+            auto* cast = llvm::dyn_cast<clang::CastExpr>(inner->IgnoreParens());
+            inner = cast ? cast->getSubExpr() : nullptr;
+        }
+        if (op->isValueDependent()) continue;
+        std::string key = "imm_" + std::to_string(i);
+
+        // 函数内从未被修改的形参在整个函数中取值不变
+        if (auto* dre = llvm::dyn_cast<clang::DeclRefExpr>(op->IgnoreParenCasts())) {
+            auto* param = llvm::dyn_cast<clang::ParmVarDecl>(dre->getDecl());
+            if (param && !modified_vars.count(param)) node->setProperty("stable_" + std::to_string(i), "true");
+        }
+
+        clang::Expr::EvalResult result;
+        if (op->getType()->isIntegralOrEnumerationType() && op->EvaluateAsInt(result, ast_context)) {
+            node->setProperty(key, std::to_string(result.Val.getInt().getExtValue()));
+            continue;
+        }
+        llvm::APFloat value(0.0);
+        if (op->getType()->isRealFloatingType() && op->EvaluateAsFloat(value, ast_context)) {
+            bool lost = false;
+            value.convert(llvm::APFloat::IEEEdouble(), llvm::APFloat::rmNearestTiesToEven, &lost);
+            std::ostringstream oss;
+            oss.precision(17);
+            oss << value.convertToDouble();
+            node->setProperty(key, oss.str());
+        }
+    }
+}
+
+void EnhancedCPGToAODConverter::collectModifiedVars(const clang::FunctionDecl* func) {
+    modified_vars.clear();
+    if (!func || !func->hasBody()) return;
+
+    struct ModifiedVarVisitor : public clang::RecursiveASTVisitor<ModifiedVarVisitor> {
+        std::set<const clang::VarDecl*>& vars;
+        explicit ModifiedVarVisitor(std::set<const clang::VarDecl*>& v) : vars(v) {}
+
+        void record(const clang::Expr* e) {
+            if (auto* dre = llvm::dyn_cast<clang::DeclRefExpr>(e->IgnoreParenCasts())) {
+                if (auto* var = llvm::dyn_cast<clang::VarDecl>(dre->getDecl())) vars.insert(var);
+            }
+        }
+        bool VisitBinaryOperator(clang::BinaryOperator* bo) {
+            if (bo->isAssignmentOp()) record(bo->getLHS());
+            return true;
+        }
+        bool VisitUnaryOperator(clang::UnaryOperator* uo) {
+            if (uo->isIncrementDecrementOp() || uo->getOpcode() == clang::UO_AddrOf) record(uo->getSubExpr());
+            return true;
+        }
+    };
+
+    struct ReferenceVisitor : public clang::RecursiveASTVisitor<ReferenceVisitor> {
+        std::map<std::string, int>& refs;
+        explicit ReferenceVisitor(std::map<std::string, int>& r) : refs(r) {}
+        bool VisitDeclRefExpr(clang::DeclRefExpr* dre) {
+            if (llvm::isa<clang::VarDecl>(dre->getDecl())) refs[dre->getDecl()->getNameAsString()]++;
+            return true;
+        }
+    };
+
+    ModifiedVarVisitor visitor(modified_vars);
+    visitor.TraverseStmt(func->getBody());
+    var_references.clear();
+    linked_references.clear();
+    ReferenceVisitor refs(var_references);
+    refs.TraverseStmt(func->getBody());
+}
+
+void EnhancedCPGToAODConverter::annotateReferenceCounts(AODGraph& graph) {
+    for (auto& node : graph.getNodes()) {
+        if (node->getProperty("op_name") != "define") continue;
+        std::string name = node->getProperty("var_name");
+        int opaque = var_references[name] - linked_references[name];
+        node->setProperty("opaque_refs", std::to_string(std::max(opaque, 0)));
+    }
+}
+
+std::vector<std::string> EnhancedCPGToAODConverter::collectVariableNames(const clang::FunctionDecl* func) {
+    std::vector<std::string> names;
+    if (!func) return names;
+    std::set<std::string> seen;
+    auto add = [&](const clang::NamedDecl* decl) {
+        std::string name = decl->getNameAsString();
+        if (!name.empty() && seen.insert(name).second) names.push_back(name);
+    };
+    for (const auto* param : func->parameters()) add(param);
+
+    struct NameVisitor : public clang::RecursiveASTVisitor<NameVisitor> {
+        std::function<void(const clang::NamedDecl*)> add;
+        bool VisitVarDecl(clang::VarDecl* var) {
+            add(var);
+            return true;
+        }
+        bool VisitDeclRefExpr(clang::DeclRefExpr* dre) {
+            if (llvm::isa<clang::VarDecl>(dre->getDecl())) add(dre->getDecl());
+            return true;
+        }
+    };
+    if (func->hasBody()) {
+        NameVisitor visitor;
+        visitor.add = add;
+        visitor.TraverseStmt(func->getBody());
+    }
+    return names;
+}
+
+std::string EnhancedCPGToAODConverter::renameIdentifiers(const std::string& text, const std::map<std::string, std::string>& renames) {
+    auto is_ident = [](char c) { return std::isalnum(static_cast<unsigned char>(c)) || c == '_'; };
+    std::string out;
+    out.reserve(text.size());
+    // 从 text[i] 的引号起跳过字符/字符串字面量 (含转义与原始字符串), 返回字面量之后的位置
+    auto skip_literal = [&](size_t i, bool raw) {
+        const char quote = text[i++];
+        if (raw) {
+            size_t open = text.find('(', i);
+            if (open == std::string::npos) return text.size();
+            std::string close = ")" + text.substr(i, open - i) + "\"";
+            size_t end = text.find(close, open + 1);
+            return end == std::string::npos ? text.size() : end + close.size();
+        }
+        while (i < text.size() && text[i] != quote && text[i] != '\n') i += text[i] == '\\' ? 2 : 1;
+        return std::min(i + 1, text.size());
+    };
+    size_t i = 0;
+    while (i < text.size()) {
+        if (text[i] == '"' || text[i] == '\'') {
+            size_t start = i;
+            i = skip_literal(i, false);
+            out.append(text, start, i - start);
+            continue;
+        }
+        if (!is_ident(text[i]) || std::isdigit(static_cast<unsigned char>(text[i]))) {
+            // 数字字面量整体跳过, 避免 1e5 / 0x1f 中的字母被当作标识符; 数位分隔符 1'000 不是字符字面量
+            size_t start = i++;
+            if (std::isdigit(static_cast<unsigned char>(text[start]))) {
+                while (i < text.size() && (is_ident(text[i]) || (text[i] == '\'' && i + 1 < text.size() && is_ident(text[i + 1])))) ++i;
+            }
+            out.append(text, start, i - start);
+            continue;
+        }
+        size_t start = i;
+        while (i < text.size() && is_ident(text[i])) ++i;
+        std::string word = text.substr(start, i - start);
+        // 编码前缀 L'x', u8"s", R"(s)" 与字面量一起保留
+        static const std::set<std::string> prefixes = {"L", "u", "U", "u8", "R", "LR", "uR", "UR", "u8R"};
+        const bool raw = !word.empty() && word.back() == 'R';
+        if (i < text.size() && (text[i] == '"' || (text[i] == '\'' && !raw)) && prefixes.count(word)) {
+            i = skip_literal(i, raw);
+            out.append(text, start, i - start);
+            continue;
+        }
+        auto it = renames.find(word);
+        out += it != renames.end() ? it->second : word;
+    }
+    return out;
+}
+
+void EnhancedCPGToAODConverter::annotateShapes(const clang::FunctionDecl* func, AODGraph& graph) {
+    std::map<std::string, std::string> placeholders;
+    auto names = collectVariableNames(func);
+    for (size_t i = 0; i < names.size(); ++i) placeholders[names[i]] = "$" + std::to_string(i);
+
+    for (auto& node : graph.getNodes()) {
+        const clang::Stmt* stmt = node->getAstStmt();
+        if (!stmt || !node->isStatement()) continue;
+        std::string text;
+        llvm::raw_string_ostream os(text);
+        stmt->printPretty(os, nullptr, ast_context.getPrintingPolicy());
+        node->setProperty("shape", renameIdentifiers(os.str(), placeholders));
+    }
+}
+
+namespace {
+
+// 归纳语句: p += W, n -= W, p++, --n 等, step 为带符号步长
+bool matchInduction(const clang::Stmt* stmt, clang::ASTContext& ctx, const clang::VarDecl*& var, int64_t& step) {
+    const clang::Expr* target = nullptr;
+    if (auto* uo = llvm::dyn_cast<clang::UnaryOperator>(stmt)) {
+        if (!uo->isIncrementDecrementOp()) return false;
+        target = uo->getSubExpr();
+        step = uo->isIncrementOp() ? 1 : -1;
+    } else if (auto* cao = llvm::dyn_cast<clang::CompoundAssignOperator>(stmt)) {
+        if (cao->getOpcode() != clang::BO_AddAssign && cao->getOpcode() != clang::BO_SubAssign) return false;
+        clang::Expr::EvalResult result;
+        if (cao->getRHS()->isValueDependent() || !cao->getRHS()->EvaluateAsInt(result, ctx)) return false;
+        target = cao->getLHS();
+        step = result.Val.getInt().getExtValue();
+        if (cao->getOpcode() == clang::BO_SubAssign) step = -step;
+    } else {
+        return false;
+    }
+    auto* dre = llvm::dyn_cast<clang::DeclRefExpr>(target->IgnoreParenImpCasts());
+    var = dre ? llvm::dyn_cast<clang::VarDecl>(dre->getDecl()) : nullptr;
+    return var != nullptr && step != 0;
+}
+
+// 计数循环: while (n >= K) / while (n > K - 1), 循环体末尾是计数变量与若干字节指针的归纳语句
+struct StepLoop {
+    const clang::VarDecl* count = nullptr;
+    int64_t min_count = 0;                       // 进入循环所需的最小计数
+    int64_t width = 0;                           // 每次迭代处理的元素数
+    std::vector<const clang::VarDecl*> pointers;
+    std::vector<const clang::Stmt*> body;        // 归纳语句之前的语句
+    std::vector<const clang::Stmt*> inductions;
+};
+
+bool matchStepLoop(const clang::WhileStmt* loop, clang::ASTContext& ctx, StepLoop& out) {
+    auto* cond = llvm::dyn_cast<clang::BinaryOperator>(loop->getCond()->IgnoreParenImpCasts());
+    auto* block = llvm::dyn_cast<clang::CompoundStmt>(loop->getBody());
+    if (!cond || !block || (cond->getOpcode() != clang::BO_GE && cond->getOpcode() != clang::BO_GT)) return false;
+    auto* count_ref = llvm::dyn_cast<clang::DeclRefExpr>(cond->getLHS()->IgnoreParenImpCasts());
+    clang::Expr::EvalResult bound;
+    if (!count_ref || cond->getRHS()->isValueDependent() || !cond->getRHS()->EvaluateAsInt(bound, ctx)) return false;
+    out.count = llvm::dyn_cast<clang::VarDecl>(count_ref->getDecl());
+    if (!out.count || !out.count->getType()->isIntegerType()) return false;
+    out.min_count = bound.Val.getInt().getExtValue() + (cond->getOpcode() == clang::BO_GT ? 1 : 0);
+
+    std::vector<const clang::Stmt*> stmts(block->body_begin(), block->body_end());
+    size_t split = stmts.size();
+    while (split > 0) {
+        const clang::VarDecl* var = nullptr;
+        int64_t step = 0;
+        if (!matchInduction(stmts[split - 1], ctx, var, step)) break;
+        --split;
+    }
+    out.body.assign(stmts.begin(), stmts.begin() + split);
+    out.inductions.assign(stmts.begin() + split, stmts.end());
+
+    bool count_seen = false;
+    for (const auto* stmt : out.inductions) {
+        const clang::VarDecl* var = nullptr;
+        int64_t step = 0;
+        matchInduction(stmt, ctx, var, step);
+        if (var == out.count) {
+            if (count_seen || step >= 0) return false;
+            count_seen = true;
+            if (out.width && out.width != -step) return false;
+            out.width = -step;
+            continue;
+        }
+        // 只处理按字节寻址的指针, 元素个数与字节数一致
+        if (!var->getType()->isPointerType() || ctx.getTypeSize(var->getType()->getPointeeType()) != 8) return false;
+        if (std::find(out.pointers.begin(), out.pointers.end(), var) != out.pointers.end()) return false;
+        if (out.width && out.width != step) return false;
+        out.width = step;
+        out.pointers.push_back(var);
+    }
+    return count_seen && !out.pointers.empty();
+}
+
+// 按 C 的整数转换规则把值截断到类型 type
+bool convertInteger(clang::ASTContext& ctx, clang::QualType type, int64_t value, int64_t& out) {
+    if (type->isBooleanType()) { out = value != 0; return true; }
+    if (!type->isIntegerType()) return false;
+    uint64_t width = ctx.getTypeSize(type);
+    if (width >= 64) { out = value; return true; }
+    uint64_t bits = static_cast<uint64_t>(value) & ((1ULL << width) - 1);
+    uint64_t sign = 1ULL << (width - 1);
+    out = type->isSignedIntegerType() ? static_cast<int64_t>((bits ^ sign) - sign) : static_cast<int64_t>(bits);
+    return true;
+}
+
+// 对标量尾循环体做逐字节求值: 从一个指针读 *p, 向一个指针写 *q, 其余只允许体内局部整数变量
+class ElementwiseInterpreter {
+public:
+    ElementwiseInterpreter(clang::ASTContext& c, const std::vector<const clang::VarDecl*>& p) : ctx(c), pointers(p) {}
+
+    const clang::VarDecl* in = nullptr;
+    const clang::VarDecl* out = nullptr;
+
+    bool run(const std::vector<const clang::Stmt*>& stmts, uint8_t byte, uint8_t& result) {
+        input = byte;
+        written = false;
+        locals.clear();
+        for (const auto* stmt : stmts) {
+            if (!exec(stmt)) return false;
+        }
+        if (!written) return false;  // 向量体每个元素都会写出
+        result = static_cast<uint8_t>(output);
+        return true;
+    }
+
+private:
+    clang::ASTContext& ctx;
+    std::vector<const clang::VarDecl*> pointers;
+    std::map<const clang::VarDecl*, int64_t> locals;
+    uint8_t input = 0;
+    int64_t output = 0;
+    bool written = false;
+
+    // *p 或 p[0] 中的指针变量
+    const clang::VarDecl* element(const clang::Expr* expr) const {
+        expr = expr->IgnoreParens();
+        const clang::Expr* base = nullptr;
+        if (auto* uo = llvm::dyn_cast<clang::UnaryOperator>(expr)) {
+            if (uo->getOpcode() == clang::UO_Deref) base = uo->getSubExpr();
+        } else if (auto* sub = llvm::dyn_cast<clang::ArraySubscriptExpr>(expr)) {
+            clang::Expr::EvalResult index;
+            if (!sub->getIdx()->isValueDependent() && sub->getIdx()->EvaluateAsInt(index, ctx) &&
+                index.Val.getInt() == 0) base = sub->getBase();
+        }
+        auto* dre = base ? llvm::dyn_cast<clang::DeclRefExpr>(base->IgnoreParenImpCasts()) : nullptr;
+        auto* var = dre ? llvm::dyn_cast<clang::VarDecl>(dre->getDecl()) : nullptr;
+        return std::find(pointers.begin(), pointers.end(), var) != pointers.end() ? var : nullptr;
+    }
+
+    bool exec(const clang::Stmt* stmt) {
+        if (llvm::isa<clang::NullStmt>(stmt)) return true;
+        if (auto* block = llvm::dyn_cast<clang::CompoundStmt>(stmt)) {
+            for (const auto* child : block->body()) {
+                if (!exec(child)) return false;
+            }
+            return true;
+        }
+        if (auto* ifStmt = llvm::dyn_cast<clang::IfStmt>(stmt)) {
+            int64_t cond = 0;
+            if (ifStmt->getInit() || ifStmt->getConditionVariable() || !eval(ifStmt->getCond(), cond)) return false;
+            if (cond) return exec(ifStmt->getThen());
+            return !ifStmt->getElse() || exec(ifStmt->getElse());
+        }
+        if (auto* declStmt = llvm::dyn_cast<clang::DeclStmt>(stmt)) {
+            auto* var = declStmt->isSingleDecl() ? llvm::dyn_cast<clang::VarDecl>(declStmt->getSingleDecl()) : nullptr;
+            int64_t value = 0;
+            if (!var || !var->getInit() || !eval(var->getInit(), value)) return false;
+            return convertInteger(ctx, var->getType(), value, locals[var]);
+        }
+        auto* assign = llvm::dyn_cast<clang::BinaryOperator>(stmt);
+        if (!assign || assign->getOpcode() != clang::BO_Assign) return false;
+        int64_t value = 0;
+        if (!eval(assign->getRHS(), value)) return false;
+        if (auto* dre = llvm::dyn_cast<clang::DeclRefExpr>(assign->getLHS()->IgnoreParens())) {
+            auto it = locals.find(llvm::dyn_cast<clang::VarDecl>(dre->getDecl()));
+            return it != locals.end() && convertInteger(ctx, dre->getType(), value, it->second);
+        }
+        const clang::VarDecl* target = element(assign->getLHS());
+        if (!target || (out && out != target)) return false;
+        out = target;
+        written = true;
+        return convertInteger(ctx, target->getType()->getPointeeType(), value, output);
+    }
+
+    bool eval(const clang::Expr* expr, int64_t& value) {
+        clang::Expr::EvalResult folded;
+        if (!expr->isValueDependent() && expr->getType()->isIntegralOrEnumerationType() && expr->EvaluateAsInt(folded, ctx)) {
+            value = folded.Val.getInt().getExtValue();
+            return true;
+        }
+        expr = expr->IgnoreParens();
+        if (const clang::VarDecl* source = element(expr)) {
+            // 写出后再读同一位置需要建模存储, 不支持
+            if ((in && in != source) || (written && source == out)) return false;
+            in = source;
+            return convertInteger(ctx, source->getType()->getPointeeType(), input, value);
+        }
+        if (auto* dre = llvm::dyn_cast<clang::DeclRefExpr>(expr)) {
+            auto it = locals.find(llvm::dyn_cast<clang::VarDecl>(dre->getDecl()));
+            if (it == locals.end()) return false;
+            value = it->second;
+            return true;
+        }
+        if (auto* cast = llvm::dyn_cast<clang::CastExpr>(expr)) {
+            int64_t sub = 0;
+            if (!eval(cast->getSubExpr(), sub)) return false;
+            switch (cast->getCastKind()) {
+                case clang::CK_LValueToRValue: case clang::CK_NoOp:
+                    value = sub;
+                    return true;
+                case clang::CK_IntegralCast: case clang::CK_IntegralToBoolean:
+                    return convertInteger(ctx, cast->getType(), sub, value);
+                default:
+                    return false;
+            }
+        }
+        if (auto* uo = llvm::dyn_cast<clang::UnaryOperator>(expr)) {
+            int64_t sub = 0;
+            if (!eval(uo->getSubExpr(), sub)) return false;
+            switch (uo->getOpcode()) {
+                case clang::UO_Plus: break;
+                case clang::UO_Minus: sub = -sub; break;
+                case clang::UO_Not: sub = ~sub; break;
+                case clang::UO_LNot: sub = !sub; break;
+                default: return false;
+            }
+            return convertInteger(ctx, uo->getType(), sub, value);
+        }
+        if (auto* co = llvm::dyn_cast<clang::ConditionalOperator>(expr)) {
+            int64_t cond = 0;
+            if (!eval(co->getCond(), cond)) return false;
+            return eval(cond ? co->getTrueExpr() : co->getFalseExpr(), value);
+        }
+        auto* bo = llvm::dyn_cast<clang::BinaryOperator>(expr);
+        if (!bo) return false;
+        int64_t x = 0, y = 0;
+        if (!eval(bo->getLHS(), x)) return false;
+        if (bo->getOpcode() == clang::BO_LAnd || bo->getOpcode() == clang::BO_LOr) {
+            bool decided = bo->getOpcode() == clang::BO_LAnd ? !x : x != 0;
+            if (!decided && !eval(bo->getRHS(), y)) return false;
+            value = decided ? bo->getOpcode() == clang::BO_LOr : y != 0;
+            return true;
+        }
+        if (!eval(bo->getRHS(), y)) return false;
+        // 操作数已按 C 规则提升, 在 64 位上计算后截断到结果类型
+        int64_t r = 0;
+        switch (bo->getOpcode()) {
+            case clang::BO_Add: r = x + y; break;
+            case clang::BO_Sub: r = x - y; break;
+            case clang::BO_Mul: r = x * y; break;
+            case clang::BO_Div: if (y == 0) return false; r = x / y; break;
+            case clang::BO_Rem: if (y == 0) return false; r = x % y; break;
+            case clang::BO_And: r = x & y; break;
+            case clang::BO_Or: r = x | y; break;
+            case clang::BO_Xor: r = x ^ y; break;
+            case clang::BO_Shl: if (y < 0 || y >= 32) return false; r = static_cast<int64_t>(static_cast<uint64_t>(x) << y); break;
+            case clang::BO_Shr: if (y < 0 || y >= 32) return false; r = x >> y; break;
+            case clang::BO_LT: r = x < y; break;
+            case clang::BO_GT: r = x > y; break;
+            case clang::BO_LE: r = x <= y; break;
+            case clang::BO_GE: r = x >= y; break;
+            case clang::BO_EQ: r = x == y; break;
+            case clang::BO_NE: r = x != y; break;
+            default: return false;
+        }
+        return convertInteger(ctx, bo->getType(), r, value);
+    }
+};
+
+std::string joinNames(const std::vector<const clang::VarDecl*>& vars) {
+    std::string names;
+    for (const auto* var : vars) names += (names.empty() ? "" : ",") + var->getNameAsString();
+    return names;
+}
+
+}  // namespace
+
+void EnhancedCPGToAODConverter::annotateFixedStepLoops(const clang::FunctionDecl* func, AODGraph&) {
+    if (!func || !func->hasBody()) return;
+
+    struct BlockVisitor : public clang::RecursiveASTVisitor<BlockVisitor> {
+        std::vector<const clang::CompoundStmt*> blocks;
+        bool VisitCompoundStmt(clang::CompoundStmt* block) {
+            blocks.push_back(block);
+            return true;
+        }
+    };
+    struct UseVisitor : public clang::RecursiveASTVisitor<UseVisitor> {
+        std::map<const clang::VarDecl*, int> refs;
+        std::set<const clang::VarDecl*> declared;
+        std::set<const clang::DeclRefExpr*> addresses;  // load/store 内建函数的地址操作数
+        bool VisitDeclRefExpr(clang::DeclRefExpr* dre) {
+            if (auto* var = llvm::dyn_cast<clang::VarDecl>(dre->getDecl())) refs[var]++;
+            return true;
+        }
+        bool VisitVarDecl(clang::VarDecl* var) {
+            declared.insert(var);
+            return true;
+        }
+        bool VisitCallExpr(clang::CallExpr* call) {
+            auto* callee = call->getDirectCallee();
+            std::string name = callee ? callee->getNameAsString() : "";
+            bool memory = name.find("load") != std::string::npos || name.find("store") != std::string::npos;
+            if (memory && name.rfind("_mm", 0) == 0 && call->getNumArgs() > 0) {
+                if (auto* dre = llvm::dyn_cast<clang::DeclRefExpr>(call->getArg(0)->IgnoreParenCasts())) addresses.insert(dre);
+            }
+            return true;
+        }
+    };
+
+    BlockVisitor blocks;
+    blocks.TraverseStmt(func->getBody());
+    for (const auto* block : blocks.blocks) {
+        std::vector<const clang::Stmt*> children(block->body_begin(), block->body_end());
+        for (size_t i = 0; i < children.size(); ++i) {
+            auto* loop = llvm::dyn_cast<clang::WhileStmt>(children[i]);
+            StepLoop vector_loop;
+            if (!loop || !stmt_to_node_map.count(loop) || !matchStepLoop(loop, ast_context, vector_loop)) continue;
+            if (vector_loop.width < 2 || vector_loop.min_count != vector_loop.width) continue;
+
+            // 向量体只含局部定义与 SIMD 调用; 计数只出现在归纳语句, 指针只作为 load/store 地址
+            bool straight = std::all_of(vector_loop.body.begin(), vector_loop.body.end(), [&](const clang::Stmt* stmt) {
+                return llvm::isa<clang::DeclStmt>(stmt) || (llvm::isa<clang::CallExpr>(stmt) && isSIMDIntrinsic(stmt));
+            });
+            if (!straight) continue;
+            UseVisitor uses;
+            for (const auto* stmt : vector_loop.body) uses.TraverseStmt(const_cast<clang::Stmt*>(stmt));
+            if (uses.refs[vector_loop.count] != 0) continue;
+            bool addressed = std::all_of(vector_loop.pointers.begin(), vector_loop.pointers.end(), [&](const clang::VarDecl* ptr) {
+                int address_uses = static_cast<int>(std::count_if(uses.addresses.begin(), uses.addresses.end(),
+                    [&](const clang::DeclRefExpr* dre) { return dre->getDecl() == ptr; }));
+                return !uses.declared.count(ptr) && uses.refs[ptr] == address_uses;
+            });
+            if (!addressed) continue;
+
+            auto header = stmt_to_node_map[loop];
+            header->setProperty("step_count", vector_loop.count->getNameAsString());
+            header->setProperty("step_count_signed", vector_loop.count->getType()->isSignedIntegerType() ? "true" : "false");
+            header->setProperty("step_width", std::to_string(vector_loop.width));
+            header->setProperty("step_pointers", joinNames(vector_loop.pointers));
+            // 计数每减 1 各指针前进一个元素, 用于按字节估计工作集与预取的缓存行数
+            int64_t unit_bytes = 0;
+            std::string pointer_bytes;
+            for (const auto* ptr : vector_loop.pointers) {
+                clang::QualType pointee = ptr->getType()->getPointeeType();
+                int64_t bytes = pointee.isNull() || pointee->isIncompleteType() ? 1 : ast_context.getTypeSizeInChars(pointee).getQuantity();
+                unit_bytes += bytes;
+                pointer_bytes += (pointer_bytes.empty() ? "" : ",") + std::to_string(bytes);
+            }
+            header->setProperty("step_unit_bytes", std::to_string(unit_bytes));
+            header->setProperty("step_pointer_bytes", pointer_bytes);
+            for (const auto* stmt : vector_loop.inductions) {
+                const clang::VarDecl* var = nullptr;
+                int64_t step = 0;
+                matchInduction(stmt, ast_context, var, step);
+                if (!stmt_to_node_map.count(stmt)) continue;
+                stmt_to_node_map[stmt]->setProperty("induction", step < 0 ? "-" : "+");
+                stmt_to_node_map[stmt]->setProperty("induction_var", var->getNameAsString());
+            }
+
+            // 紧随其后的逐元素标量尾循环: 相同计数与指针, 步长为 1
+            auto* tail = i + 1 < children.size() ? llvm::dyn_cast<clang::WhileStmt>(children[i + 1]) : nullptr;
+            StepLoop tail_loop;
+            if (!tail || !stmt_to_node_map.count(tail) || !matchStepLoop(tail, ast_context, tail_loop)) continue;
+            auto sorted = [](std::vector<const clang::VarDecl*> vars) { std::sort(vars.begin(), vars.end()); return vars; };
+            if (tail_loop.count != vector_loop.count || tail_loop.width != 1 || tail_loop.min_count != 1 ||
+                sorted(tail_loop.pointers) != sorted(vector_loop.pointers)) continue;
+
+            ElementwiseInterpreter interpreter(ast_context, tail_loop.pointers);
+            std::string map;
+            static const char* kHex = "0123456789abcdef";
+            for (int byte = 0; byte < 256; ++byte) {
+                uint8_t result = 0;
+                if (!interpreter.run(tail_loop.body, static_cast<uint8_t>(byte), result)) { map.clear(); break; }
+                map += kHex[result >> 4];
+                map += kHex[result & 15];
+            }
+            if (map.empty() || !interpreter.in) continue;
+
+            auto tail_node = stmt_to_node_map[tail];
+            tail_node->setProperty("tail_of", std::to_string(header->getId()));
+            tail_node->setProperty("elementwise_in", interpreter.in->getNameAsString());
+            tail_node->setProperty("elementwise_out", interpreter.out->getNameAsString());
+            tail_node->setProperty("elementwise_map", map);
+        }
+    }
+}
+
+namespace {
+
+struct BranchShape {
+    int assigns = 0;
+    int stores = 0;
+    std::string blocker;
+};
+
+bool isMemoryAccess(const clang::Expr* expr) {
+    expr = expr->IgnoreParens();
+    if (llvm::isa<clang::ArraySubscriptExpr>(expr)) return true;
+    if (auto* unary = llvm::dyn_cast<clang::UnaryOperator>(expr)) return unary->getOpcode() == clang::UO_Deref;
+    if (auto* member = llvm::dyn_cast<clang::MemberExpr>(expr)) return member->isArrow();
+    return false;
+}
+
+llvm::FoldingSetNodeID profileOf(const clang::Expr* expr, const clang::ASTContext& ctx) {
+    llvm::FoldingSetNodeID id;
+    expr->IgnoreParenImpCasts()->Profile(id, ctx, true);
+    return id;
+}
+
+// 条件中读取的内存位置; 条件总会求值, 这些位置在分支前已被访问
+void collectMemoryReads(const clang::Stmt* stmt, const clang::ASTContext& ctx, std::vector<llvm::FoldingSetNodeID>& reads) {
+    if (!stmt) return;
+    if (auto* expr = llvm::dyn_cast<clang::Expr>(stmt); expr && isMemoryAccess(expr)) reads.push_back(profileOf(expr, ctx));
+    for (const auto* child : stmt->children()) collectMemoryReads(child, ctx, reads);
+}
+
+bool inLocations(const clang::Expr* expr, const clang::ASTContext& ctx, const std::vector<llvm::FoldingSetNodeID>& locations) {
+    return std::find(locations.begin(), locations.end(), profileOf(expr, ctx)) != locations.end();
+}
+
+// 语句中被赋值或自增减的变量; 含函数调用时无法确定, 返回 false
+bool collectModifiedVars(const clang::Stmt* stmt, std::set<const clang::Decl*>& vars) {
+    if (!stmt) return true;
+    if (llvm::isa<clang::CallExpr>(stmt)) return false;
+    const clang::Expr* target = nullptr;
+    if (auto* binary = llvm::dyn_cast<clang::BinaryOperator>(stmt); binary && binary->isAssignmentOp()) target = binary->getLHS();
+    if (auto* unary = llvm::dyn_cast<clang::UnaryOperator>(stmt); unary && unary->isIncrementDecrementOp()) target = unary->getSubExpr();
+    if (auto* ref = target ? llvm::dyn_cast<clang::DeclRefExpr>(target->IgnoreParenImpCasts()) : nullptr) vars.insert(ref->getDecl());
+    for (const auto* child : stmt->children()) {
+        if (!collectModifiedVars(child, vars)) return false;
+    }
+    return true;
+}
+
+bool referencesAny(const clang::Stmt* stmt, const std::set<const clang::Decl*>& vars) {
+    if (!stmt) return false;
+    if (auto* ref = llvm::dyn_cast<clang::DeclRefExpr>(stmt); ref && vars.count(ref->getDecl())) return true;
+    for (const auto* child : stmt->children()) {
+        if (referencesAny(child, vars)) return true;
+    }
+    return false;
+}
+
+// 分支之前, 同一复合语句中无条件写入且地址到分支处未变的内存位置
+std::vector<llvm::FoldingSetNodeID> collectPriorStores(const clang::IfStmt* branch, clang::ASTContext& ctx) {
+    std::vector<llvm::FoldingSetNodeID> result;
+    auto parents = ctx.getParents(*branch);
+    auto* block = parents.size() == 1 ? parents[0].get<clang::CompoundStmt>() : nullptr;
+    if (!block) return result;
+    std::vector<const clang::Expr*> stores;
+    for (const auto* child : block->body()) {
+        if (child == branch) break;
+        std::set<const clang::Decl*> modified;
+        if (!collectModifiedVars(child, modified) || !llvm::isa<clang::Expr>(child)) {
+            stores.clear();
+            continue;
+        }
+        stores.erase(std::remove_if(stores.begin(), stores.end(),
+                                    [&](const clang::Expr* target) { return referencesAny(target, modified); }),
+                     stores.end());
+        auto* assign = llvm::dyn_cast<clang::BinaryOperator>(llvm::cast<clang::Expr>(child)->IgnoreParens());
+        if (assign && assign->isAssignmentOp() && isMemoryAccess(assign->getLHS()) && !assign->getLHS()->HasSideEffects(ctx) &&
+            !referencesAny(assign->getLHS(), modified)) {
+            stores.push_back(assign->getLHS());
+        }
+    }
+    for (const auto* target : stores) result.push_back(profileOf(target, ctx));
+    return result;
+}
+
+// 无条件求值后是否仍与原分支等价: 不调用函数、不做整数除法、不读 volatile, 只读条件已读过的内存
+std::string speculationBlocker(const clang::Stmt* stmt, const clang::ASTContext& ctx, const std::vector<llvm::FoldingSetNodeID>& reads) {
+    if (!stmt) return "";
+    if (llvm::isa<clang::CallExpr>(stmt)) return "calls a function";
+    if (auto* binary = llvm::dyn_cast<clang::BinaryOperator>(stmt)) {
+        auto opcode = binary->getOpcode();
+        bool division = opcode == clang::BO_Div || opcode == clang::BO_Rem || opcode == clang::BO_DivAssign || opcode == clang::BO_RemAssign;
+        if (division && binary->getType()->isIntegerType()) return "divides integers";
+    }
+    if (auto* expr = llvm::dyn_cast<clang::Expr>(stmt)) {
+        if (expr->getType().isVolatileQualified()) return "accesses volatile data";
+        if (isMemoryAccess(expr)) {
+            if (!inLocations(expr, ctx, reads)) return "reads memory only when taken";
+            return "";
+        }
+    }
+    for (const auto* child : stmt->children()) {
+        std::string blocker = speculationBlocker(child, ctx, reads);
+        if (!blocker.empty()) return blocker;
+    }
+    return "";
+}
+
+void inspectBranchBody(const clang::Stmt* stmt, const clang::ASTContext& ctx, const std::vector<llvm::FoldingSetNodeID>& reads,
+                       const std::vector<llvm::FoldingSetNodeID>& stores, BranchShape& shape) {
+    if (!stmt || !shape.blocker.empty()) return;
+    if (auto* compound = llvm::dyn_cast<clang::CompoundStmt>(stmt)) {
+        for (const auto* child : compound->body()) inspectBranchBody(child, ctx, reads, stores, shape);
+        return;
+    }
+    if (llvm::isa<clang::NullStmt>(stmt)) return;
+    auto* expr = llvm::dyn_cast<clang::Expr>(stmt);
+    auto* assign = expr ? llvm::dyn_cast<clang::BinaryOperator>(expr->IgnoreParens()) : nullptr;
+    if (!assign || !assign->isAssignmentOp()) {
+        shape.blocker = std::string("branch contains ") + (llvm::isa<clang::IfStmt>(stmt) ? "a nested if" : stmt->getStmtClassName());
+        return;
+    }
+    const clang::Expr* target = assign->getLHS()->IgnoreParens();
+    if (target->getType().isVolatileQualified() || assign->getLHS()->HasSideEffects(ctx)) {
+        shape.blocker = "assigns a volatile or side-effecting target";
+        return;
+    }
+    auto* ref = llvm::dyn_cast<clang::DeclRefExpr>(target);
+    auto* var = ref ? llvm::dyn_cast<clang::VarDecl>(ref->getDecl()) : nullptr;
+    if (var && var->hasLocalStorage() && !var->getType()->isReferenceType()) {
+        shape.assigns++;
+    } else if (isMemoryAccess(target) && inLocations(target, ctx, stores)) {
+        // 分支前已无条件写过该位置, 无条件写回原值不会越界, 也不会引入源码没有的写 (只读过的位置写回会与其它线程竞争)
+        shape.stores++;
+    } else {
+        shape.blocker = "stores to a location not written unconditionally before the branch";
+        return;
+    }
+    shape.blocker = assign->getRHS()->HasSideEffects(ctx) ? "has side effects" : speculationBlocker(assign->getRHS(), ctx, reads);
+}
+
+// if (x < c) x = c; 为 max, if (x > c) x = c; 为 min
+std::string clampKind(const clang::IfStmt* branch, const clang::ASTContext& ctx) {
+    if (branch->getElse()) return "";
+    const clang::Stmt* then = branch->getThen();
+    if (auto* compound = llvm::dyn_cast<clang::CompoundStmt>(then)) then = compound->size() == 1 ? compound->body_front() : nullptr;
+    auto* expr = llvm::dyn_cast_or_null<clang::Expr>(then);
+    auto* assign = expr ? llvm::dyn_cast<clang::BinaryOperator>(expr->IgnoreParens()) : nullptr;
+    auto* compare = llvm::dyn_cast<clang::BinaryOperator>(branch->getCond()->IgnoreParenImpCasts());
+    if (!assign || assign->getOpcode() != clang::BO_Assign || !compare || !compare->isRelationalOp()) return "";
+    auto* target = llvm::dyn_cast<clang::DeclRefExpr>(assign->getLHS()->IgnoreParens());
+    auto refersToTarget = [&](const clang::Expr* side) {
+        auto* ref = llvm::dyn_cast<clang::DeclRefExpr>(side->IgnoreParenImpCasts());
+        return target && ref && ref->getDecl() == target->getDecl();
+    };
+    auto sameAsValue = [&](const clang::Expr* side) { return profileOf(side, ctx) == profileOf(assign->getRHS(), ctx); };
+    bool less = compare->getOpcode() == clang::BO_LT || compare->getOpcode() == clang::BO_LE;
+    if (refersToTarget(compare->getLHS()) && sameAsValue(compare->getRHS())) return less ? "max" : "min";
+    if (sameAsValue(compare->getLHS()) && refersToTarget(compare->getRHS())) return less ? "min" : "max";
+    return "";
+}
+
+}  // namespace
+
+void EnhancedCPGToAODConverter::annotateBranches(AODGraph&) {
+    for (const auto& [stmt, node] : stmt_to_node_map) {
+        auto* branch = llvm::dyn_cast<clang::IfStmt>(stmt);
+        if (!branch || node->getType() != AODNodeType::Control) continue;
+        BranchShape shape;
+        std::vector<llvm::FoldingSetNodeID> reads;
+        if (branch->getInit() || branch->getConditionVariable() || branch->isConstexpr()) {
+            shape.blocker = "unsupported if form";
+        } else if (branch->getCond()->HasSideEffects(ast_context)) {
+            shape.blocker = "condition has side effects";
+        } else {
+            collectMemoryReads(branch->getCond(), ast_context, reads);
+            auto stores = collectPriorStores(branch, ast_context);
+            inspectBranchBody(branch->getThen(), ast_context, reads, stores, shape);
+            inspectBranchBody(branch->getElse(), ast_context, reads, stores, shape);
+            if (shape.blocker.empty() && shape.assigns + shape.stores == 0) shape.blocker = "empty branch";
+        }
+        if (!shape.blocker.empty()) {
+            node->setProperty("branch_blocker", shape.blocker);
+            continue;
+        }
+        node->setProperty("branch_assigns", std::to_string(shape.assigns));
+        node->setProperty("branch_stores", std::to_string(shape.stores));
+        std::string clamp = clampKind(branch, ast_context);
+        if (!clamp.empty()) node->setProperty("branch_clamp", clamp);
+    }
+}
+
+namespace {
+
+// 语句中引用的变量, 按首次出现的顺序
+void collectReferencedVars(const clang::Stmt* stmt, std::vector<const clang::VarDecl*>& vars) {
+    if (!stmt) return;
+    if (auto* ref = llvm::dyn_cast<clang::DeclRefExpr>(stmt)) {
+        auto* var = llvm::dyn_cast<clang::VarDecl>(ref->getDecl());
+        if (var && std::find(vars.begin(), vars.end(), var) == vars.end()) vars.push_back(var);
+    }
+    for (const auto* child : stmt->children()) collectReferencedVars(child, vars);
+}
+
+}  // namespace
+
+void EnhancedCPGToAODConverter::annotateAlignment(const clang::FunctionDecl* func, AODGraph&) {
+    AlignmentAnalyzer analyzer(ast_context, func);
+    for (const auto& [stmt, node] : stmt_to_node_map) {
+        // SIMD 访存: 指针实参的已知对齐字节数
+        if (auto* call = llvm::dyn_cast<clang::CallExpr>(stmt); call && node->isSIMDNode() && call->getNumArgs() > 0) {
+            auto* callee = call->getDirectCallee();
+            std::string name = callee ? callee->getNameAsString() : "";
+            bool access = name.find("load") != std::string::npos || name.find("store") != std::string::npos;
+            if (access && call->getArg(0)->getType()->isPointerType()) {
+                node->setProperty("alignment", std::to_string(analyzer.alignmentOf(call->getArg(0))));
+            }
+            continue;
+        }
+        // 整体生成的 for 循环: 按变量出现顺序记录指针对齐与整数倍数, 结构相同但对齐不同的循环不共用生成结果
+        if (llvm::isa<clang::ForStmt>(stmt) && node->getType() == AODNodeType::Control) {
+            std::vector<const clang::VarDecl*> vars;
+            collectReferencedVars(stmt, vars);
+            std::string facts;
+            for (const auto* var : vars) {
+                int64_t value = 1;
+                if (var->getType()->isPointerType() || var->getType()->isArrayType()) {
+                    value = analyzer.alignmentOf(var);
+                } else if (var->getType()->isIntegerType() && var->getInit()) {
+                    value = analyzer.multipleOf(var->getInit());
+                }
+                facts += (facts.empty() ? "" : ",") + std::to_string(value);
+            }
+            node->setProperty("alignment_facts", facts);
+        }
+    }
+}
+
 AODNodeType EnhancedCPGToAODConverter::mapStmtToNodeType(const clang::Stmt* stmt) {
     if (isSIMDIntrinsic(stmt)) return AODNodeType::SIMD_Intrinsic;
     if (llvm::isa<clang::CompoundStmt>(stmt)) return AODNodeType::Control;
@@ -279,6 +1192,7 @@ void EnhancedCPGToAODConverter::connectDataFlow(const clang::FunctionDecl*, AODG
                         if (potential_src->getProperty("op_name") == "define" &&
                             potential_src->getProperty("var_name") == var_name) {
                             try { graph.addEdge(potential_src, node, AODEdgeType::Data, "arg_" + std::to_string(arg_idx)); } catch(...) {}
+                            linked_references[var_name]++;
                             break;
                         }
                     }
@@ -299,6 +1213,7 @@ void EnhancedCPGToAODConverter::connectDataFlow(const clang::FunctionDecl*, AODG
                      for (auto& src : graph.getNodes()) {
                          if (src->getProperty("op_name") == "define" && src->getProperty("var_name") == var_name) {
                              try { graph.addEdge(src, node, AODEdgeType::Data, "arg_" + std::to_string(idx)); } catch(...) {}
+                             linked_references[var_name]++;
                              break;
                          }
                      }
@@ -323,4 +1238,90 @@ void EnhancedCPGToAODConverter::connectDataFlow(const clang::FunctionDecl*, AODG
     }
 }
 
+void EnhancedCPGToAODConverter::connectControlFlow(const clang::FunctionDecl* func, AODGraph& graph) {
+    if (!func || !func->hasBody()) return;
+
+    std::shared_ptr<AODNode> entry, exit;
+    for (const auto& node : graph.getNodes()) {
+        if (node->getType() == AODNodeType::Entry && !entry) entry = node;
+        if (node->getType() == AODNodeType::Exit) exit = node;
+    }
+    if (!entry || !exit) return;
+
+    ControlFlowContext ctx;
+    ctx.exit = exit;
+    auto exits = linkControlFlow(func->getBody(), {entry}, graph, ctx);
+    for (auto& pred : exits) graph.addEdge(pred, exit, AODEdgeType::Control);
+}
+
+// 返回 stmt 执行完后落到下一条语句的节点集合
+std::vector<std::shared_ptr<AODNode>> EnhancedCPGToAODConverter::linkControlFlow(
+    const clang::Stmt* stmt,
+    const std::vector<std::shared_ptr<AODNode>>& preds,
+    AODGraph& graph,
+    ControlFlowContext& ctx,
+    const std::string& entry_label) {
+
+    if (!stmt) return preds;
+
+    auto connect = [&](const std::vector<std::shared_ptr<AODNode>>& from,
+                       const std::shared_ptr<AODNode>& to, const std::string& label) {
+        for (const auto& pred : from) graph.addEdge(pred, to, AODEdgeType::Control, label);
+    };
+
+    if (llvm::isa<clang::CompoundStmt>(stmt)) {
+        std::vector<std::shared_ptr<AODNode>> current = preds;
+        bool first = true;
+        for (const auto* child : stmt->children()) {
+            current = linkControlFlow(child, current, graph, ctx, first ? entry_label : "");
+            first = false;
+        }
+        return current;
+    }
+
+    auto it = stmt_to_node_map.find(stmt);
+    if (it == stmt_to_node_map.end()) return preds;
+    auto node = it->second;
+    connect(preds, node, entry_label);
+
+    if (auto* whileStmt = llvm::dyn_cast<clang::WhileStmt>(stmt)) {
+        ctx.loops.push_back({node, {}});
+        auto body_exits = linkControlFlow(whileStmt->getBody(), {node}, graph, ctx, "true");
+        connect(body_exits, node, "back");
+        auto breaks = std::move(ctx.loops.back().second);
+        ctx.loops.pop_back();
+        breaks.push_back(node);
+        return breaks;
+    }
+    if (auto* forStmt = llvm::dyn_cast<clang::ForStmt>(stmt)) {
+        ctx.loops.push_back({node, {}});
+        auto body_exits = linkControlFlow(forStmt->getBody(), {node}, graph, ctx, "true");
+        connect(body_exits, node, "back");
+        auto breaks = std::move(ctx.loops.back().second);
+        ctx.loops.pop_back();
+        breaks.push_back(node);
+        return breaks;
+    }
+    if (auto* ifStmt = llvm::dyn_cast<clang::IfStmt>(stmt)) {
+        auto then_exits = linkControlFlow(ifStmt->getThen(), {node}, graph, ctx, "true");
+        std::vector<std::shared_ptr<AODNode>> else_exits = {node};
+        if (ifStmt->getElse()) else_exits = linkControlFlow(ifStmt->getElse(), {node}, graph, ctx, "false");
+        then_exits.insert(then_exits.end(), else_exits.begin(), else_exits.end());
+        return then_exits;
+    }
+    if (llvm::isa<clang::ReturnStmt>(stmt)) {
+        graph.addEdge(node, ctx.exit, AODEdgeType::Control);
+        return {};
+    }
+    if (llvm::isa<clang::BreakStmt>(stmt) && !ctx.loops.empty()) {
+        ctx.loops.back().second.push_back(node);
+        return {};
+    }
+    if (llvm::isa<clang::ContinueStmt>(stmt) && !ctx.loops.empty()) {
+        graph.addEdge(node, ctx.loops.back().first, AODEdgeType::Control, "back");
+        return {};
+    }
+    return {node};
+}
+
 } // namespace aodsolve
@@ -37,11 +37,17 @@ struct ConversionResult {
 
 class EnhancedCPGToAODConverter {
 private:
+    clang::ASTContext& ast_context;
     clang::SourceManager& source_manager;
     IntegratedCPGAnalyzer* analyzer;
 
     // 转换状态
     std::map<const clang::Stmt*, std::shared_ptr<AODNode>> stmt_to_node_map;
+    // 函数体内被重新赋值或取地址的局部变量 (值编号时不能视为单一值)
+    std::set<const clang::VarDecl*> modified_vars;
+    // 变量名 -> 源码中的引用次数 / 已表示为图中数据边的引用次数
+    std::map<std::string, int> var_references;
+    std::map<std::string, int> linked_references;
 
 public:
     explicit EnhancedCPGToAODConverter(clang::ASTContext& ctx, IntegratedCPGAnalyzer& a);
@@ -57,13 +63,23 @@ public:
 
     const IntegratedCPGAnalyzer& getAnalyzer() const { return *analyzer; }
 
+    // 函数中引用到的变量名 (形参在前, 其余按首次出现顺序), 结构相同的函数按下标一一对应
+    static std::vector<std::string> collectVariableNames(const clang::FunctionDecl* func);
+    // 按整词替换标识符, 所有替换同时生效 (a<->b 交换安全); 字符/字符串字面量 (含转义与原始字符串) 原样保留
+    static std::string renameIdentifiers(const std::string& text, const std::map<std::string, std::string>& renames);
+    // QualType 的通道类型 (s8/u16/f32 ...): 指针与数组取元素类型, 浮点向量取元素类型,
+    // 不带宽度的整数向量 (__m256i) 返回空串
+    static std::string elementTypeOf(clang::QualType type, const clang::ASTContext& ctx);
+
 private:
     // 递归遍历 AST
     // is_top_level: 标记当前遍历的节点是否应视为独立语句
     void traverseAndBuild(const clang::Stmt* stmt, AODGraph& graph, bool is_top_level = true);
 
     // 新增：遍历表达式树（用于构建非语句节点）
-    void traverseExpressionTree(const clang::Stmt* expr, AODGraph& graph);
+    // owner: 表达式所属的语句节点, 记录为 stmt_anchor 供控制流分析使用
+    void traverseExpressionTree(const clang::Stmt* expr, AODGraph& graph,
+                                const std::shared_ptr<AODNode>& owner = nullptr);
 
     // 节点创建辅助
     std::shared_ptr<AODNode> createAODNodeFromStmt(const clang::Stmt* stmt, bool is_stmt);
@@ -75,6 +91,39 @@ private:
     // 连接数据流
     void connectDataFlow(const clang::FunctionDecl* func, AODGraph& graph);
 
+    // 连接控制流: 语句间顺序边、分支边与循环回边 (AODEdgeType::Control)
+    void connectControlFlow(const clang::FunctionDecl* func, AODGraph& graph);
+
+    struct ControlFlowContext {
+        std::shared_ptr<AODNode> exit;
+        // 当前所在循环的头节点及其 break 语句
+        std::vector<std::pair<std::shared_ptr<AODNode>, std::vector<std::shared_ptr<AODNode>>>> loops;
+    };
+    std::vector<std::shared_ptr<AODNode>> linkControlFlow(
+        const clang::Stmt* stmt,
+        const std::vector<std::shared_ptr<AODNode>>& preds,
+        AODGraph& graph,
+        ControlFlowContext& ctx,
+        const std::string& entry_label = "");
+
+    // 记录操作数个数、结果类型与常量操作数 (operand_count / value_type / imm_N), 供值编号使用;
+    // 同时记录结果与操作数的通道类型 (elem_type / operand_elem_N), 作为类型推断的种子
+    void annotateOperands(const std::shared_ptr<AODNode>& node, const clang::Expr* expr);
+    void collectModifiedVars(const clang::FunctionDecl* func);
+    // 记录未被数据边覆盖的变量引用 (opaque_refs), 死代码消除据此判断定义是否仍被原文本使用
+    void annotateReferenceCounts(AODGraph& graph);
+    // 记录语句的源码形状 (shape): 变量名替换为 $N, 规范哈希据此区分按原文本输出的语句
+    void annotateShapes(const clang::FunctionDecl* func, AODGraph& graph);
+    // 识别固定步长的向量循环 (while (n >= W) { ...; p += W; n -= W; }) 及紧随其后的标量尾循环,
+    // 记录步进变量 (step_*) 与尾循环逐元素语义 (elementwise_*), 供长度无关循环改写使用
+    void annotateFixedStepLoops(const clang::FunctionDecl* func, AODGraph& graph);
+    // if 语句能否改写为无分支的选择: 可以时记录分支内的赋值/存储条数 (branch_assigns / branch_stores)
+    // 与 clamp 形式 (branch_clamp = max/min), 否则记录原因 (branch_blocker), 供 if-conversion pass 使用
+    void annotateBranches(AODGraph& graph);
+    // 指针对齐: SIMD 访存节点记录指针实参的已知对齐 (alignment), for 循环记录所引用变量的对齐与倍数
+    // (alignment_facts), 供生成对齐提示与区分可复用的内核
+    void annotateAlignment(const clang::FunctionDecl* func, AODGraph& graph);
+
     // AST 类型映射
     AODNodeType mapStmtToNodeType(const clang::Stmt* stmt);
 };
@@ -1,13 +1,21 @@
 #include "tools/aodsolve_main_analyzer.h"
 #include "conversion/enhanced_cpg_to_aod_converter.h"
 #include "generation/enhanced_code_generator.h"
+#include "aod/simd_instruction_rules.h"
 #include <iostream>
 #include <fstream>
 #include <vector>
+#include <map>
 #include <string>
+#include <cstdlib>
+#include <chrono>
+#include <iomanip>
+#include <stdexcept>
+#include <algorithm>
 #include <clang/Tooling/CommonOptionsParser.h>
 #include <clang/Tooling/Tooling.h>
 #include <llvm/Support/CommandLine.h>
+#include <llvm/Support/FileSystem.h>
 
 using namespace aodsolve;
 
@@ -22,7 +30,45 @@ public:
     // 案例 5: 跨函数标量向量化 (内联 + NEON)
     void runCrossFunctionVectorizationDemo();
 
+    // 案例 6: 经非 const 引用改写的指针不再按分配时的对齐处理 (对齐分析回归)
+    void runReferenceAlignmentDemo();
+
+    // 案例 7: 8 位像素拆分与结构体数组字段 (交错组访问); 8 位运算需要加宽, 保持标量并给出原因
+    void runInterleavedRecordDemo();
+
+    // 二进制图镜像自检: serialize -> deserialize 往返, 并与 DOT / GraphML 比较大小和耗时
+    bool runGraphImageCheck(int node_count);
+
+    // 规则系统自检: 规则包覆盖映射表项等
+    bool runRuleSystemCheck();
+
+    // 标识符重命名自检: 字符/字符串字面量中与变量同名的文本保持不变
+    bool runRenameCheck();
+
+    // NEON 循环展开路数, 0 表示使用分析器默认值
+    void setUnrollFactor(int factor) { unroll_factor = factor; }
+
+    // 输出 SVE / NEON / 基线多版本实现和运行时分发器
+    void enableMultiVersioning(bool enable) { multi_version = enable; }
+
+    // 浮点 sum/product 归约允许重结合 (多累加器); 默认按源顺序, 结果与标量一致
+    void enableFPReassociation(bool enable) { fp_reassociate = enable; }
+
+    // 剩余迭代数不少于 trip 的向量循环先标量剥离到对齐, 0 表示不剥离
+    void setAlignPeelThreshold(long long trip) { align_peel_trip = trip; }
+
+    // 工作集不少于 bytes 的循环使用非临时存储与预取, 0 表示关闭; distance 为预取提前的字节数
+    void setStreamingThreshold(long long bytes) { streaming_bytes = bytes; }
+    void setPrefetchDistance(long long distance) { prefetch_distance = distance; }
+
 private:
+    int unroll_factor = 0;
+    bool multi_version = false;
+    bool fp_reassociate = false;
+    long long align_peel_trip = 0;
+    long long streaming_bytes = 0;
+    long long prefetch_distance = 512;
+
     void saveToFile(const std::string& content, const std::string& filename);
     void runClangAnalysis(const std::string& code, const std::string& filename, const std::string& target_arch);
 };
@@ -59,6 +105,18 @@ void lower_case_avx2(uint8_t* dst, const uint8_t* src, size_t len) {
         q += 32;
         len -= 32;
     }
+
+    while (len > 0) {
+        if (*src >= 'A' && *src <= 'Z') {
+            *q = *src + ('a' - 'A');
+        }
+        else {
+            *q = *src;
+        }
+        src++;
+        q++;
+        len--;
+    }
 #endif
 }
 )";
@@ -73,11 +131,12 @@ void AODSolveDemo::runScalarLoopVectorizationDemo() {
     std::cout << "   Case 4: Scalar Loop Vectorization (Scalar -> NEON)" << std::endl;
     std::cout << std::string(60, '=') << std::endl;
 
+    // 原基准中的 volatile 只为防止编译器删掉循环; volatile 访问不能向量化 (分析器会拒绝), 这里用普通指针
     std::string case4_code = R"(
 #include <stddef.h>
 
-void Test(float volatile* xNorms, int i, float volatile* yNorms,
-          float volatile* ipLine, size_t ny) {
+void Test(float* xNorms, int i, float* yNorms,
+          float* ipLine, size_t ny) {
     for (size_t j = 0; j < ny; j++) {
         float ip = *ipLine;
         float dis = xNorms[i] + yNorms[j] - 2 * ip;
@@ -100,18 +159,19 @@ void AODSolveDemo::runCrossFunctionVectorizationDemo() {
     std::cout << "   Case 5: Cross-Function Vectorization (Scalar -> NEON)" << std::endl;
     std::cout << std::string(60, '=') << std::endl;
 
+    // 同案例 4, 不使用 volatile 指针
     std::string case5_code = R"(
 #include <stddef.h>
 
 // 被调用的辅助函数
-float cal_call(float volatile* xNorms, int i, int j,
-               float volatile* yNorms, float ip) {
+float cal_call(float* xNorms, int i, int j,
+               float* yNorms, float ip) {
     return xNorms[i] + yNorms[j] - 2 * ip;
 }
 
 // 主循环函数 - 包含函数调用
-void Test_call(float volatile* xNorms, int i, float volatile* yNorms,
-               float volatile* ipLine, size_t ny) {
+void Test_call(float* xNorms, int i, float* yNorms,
+               float* ipLine, size_t ny) {
     for (size_t j = 0; j < ny; j++) {
         float ip = *ipLine;
         float dis = cal_call(xNorms, i, j, yNorms, ip);
@@ -126,6 +186,315 @@ void Test_call(float volatile* xNorms, int i, float volatile* yNorms,
     runClangAnalysis(case5_code, "case5_cross_func.cpp", "NEON");
 }
 
+// ========================================================
+// 案例 6 实现: 经引用改写的指针 (Scalar -> NEON)
+// ========================================================
+void AODSolveDemo::runReferenceAlignmentDemo() {
+    std::cout << "\n" << std::string(60, '=') << std::endl;
+    std::cout << "   Case 6: Pointers Modified Through References (Scalar -> NEON)" << std::endl;
+    std::cout << std::string(60, '=') << std::endl;
+
+    std::string case6_code = R"(
+#include <stdlib.h>
+#include <stddef.h>
+
+// 经 float*& 形参前移一个元素
+static void skip_header(float*& p) {
+    p += 1;
+}
+
+// in / dst 由 aligned_alloc 分配, 但之后分别经引用形参和引用变量前移,
+// 循环中的访存不能带 16 字节对齐提示
+void scale_records(float* out, size_t n) {
+    float* in = (float*)aligned_alloc(64, (n + 4) * sizeof(float));
+    float* dst = (float*)aligned_alloc(64, (n + 4) * sizeof(float));
+    skip_header(in);
+    float*& cursor = dst;
+    cursor += 3;
+    for (size_t j = 0; j < n; j++) {
+        out[j] = in[j] * 2.0f + dst[j];
+    }
+}
+)";
+    runClangAnalysis(case6_code, "case6_reference_alignment.cpp", "NEON");
+}
+
+// ========================================================
+// 案例 7 实现: 像素平面拆分与结构体数组字段 (Scalar -> NEON)
+// ========================================================
+void AODSolveDemo::runInterleavedRecordDemo() {
+    std::cout << "\n" << std::string(60, '=') << std::endl;
+    std::cout << "   Case 7: RGB Planes and Struct-Array Fields (Scalar -> NEON)" << std::endl;
+    std::cout << std::string(60, '=') << std::endl;
+
+    // 8 位 RGB 拆成三个平面: 步长 3 的交错组, vld3q_u8 整组读出
+    std::string split_code = R"(
+#include <stdint.h>
+#include <stddef.h>
+
+void split_rgb(uint8_t* r, uint8_t* g, uint8_t* b, const uint8_t* rgb, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        r[i] = rgb[3 * i];
+        g[i] = rgb[3 * i + 1];
+        b[i] = rgb[3 * i + 2];
+    }
+}
+)";
+    runClangAnalysis(split_code, "case7_split_rgb.cpp", "NEON");
+
+    // 结构体数组的字段 p[i].x / p[i].z: 按 float 重新解释为步长 3 的交错组
+    std::string field_code = R"(
+#include <stddef.h>
+
+typedef struct { float x, y, z; } point3;
+
+void project_x(float* out, const point3* p, float scale, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        out[i] = p[i].x * scale + p[i].z;
+    }
+}
+)";
+    runClangAnalysis(field_code, "case7_struct_fields.cpp", "NEON");
+
+    // 灰度转换: 8 位数据先提升为 int 再运算, 需要加宽到 16/32 位通道, 目前保持标量并输出原因
+    std::string gray_code = R"(
+#include <stdint.h>
+#include <stddef.h>
+
+void rgb_to_gray(uint8_t* gray, const uint8_t* rgb, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        gray[i] = (77 * rgb[3 * i] + 150 * rgb[3 * i + 1] + 29 * rgb[3 * i + 2]) >> 8;
+    }
+}
+)";
+    runClangAnalysis(gray_code, "case7_rgb_to_gray.cpp", "NEON");
+}
+
+// ========================================================
+// 二进制图镜像自检
+// ========================================================
+bool AODSolveDemo::runGraphImageCheck(int node_count) {
+    std::cout << "\n" << std::string(60, '=') << std::endl;
+    std::cout << "   Graph image round trip (" << node_count << " nodes)" << std::endl;
+    std::cout << std::string(60, '=') << std::endl;
+
+    // 与转换器输出相近的图: 语句/表达式交替, 带 op_name/stmt_anchor/操作数属性, 数据边与控制边
+    AODGraph graph("graph_image_check");
+    std::vector<std::shared_ptr<AODNode>> nodes;
+    for (int i = 0; i < node_count; ++i) {
+        auto node = std::make_shared<AODNode>(i % 3 ? AODNodeType::SIMD_Intrinsic : AODNodeType::Control, "n" + std::to_string(i % 50));
+        node->setProperty("op_name", i % 2 ? "_mm256_add_epi8" : "define");
+        node->setProperty("operand_count", "2");
+        node->setProperty("text_0", "v" + std::to_string(i % 97));
+        node->setProperty("stmt_anchor", std::to_string(i / 2));
+        node->setIsStatement(i % 2 == 0);
+        node->setSideEffects(i % 7 == 0);
+        node->setComplexity(i % 5);
+        graph.addNode(node);
+        nodes.push_back(node);
+        if (i > 0) graph.addEdge(nodes[i - 1], node, i % 2 ? AODEdgeType::Data : AODEdgeType::Control, i % 2 ? "arg_0" : "");
+    }
+
+    using Clock = std::chrono::steady_clock;
+    auto ms = [](Clock::time_point from, Clock::time_point to) { return std::chrono::duration<double, std::milli>(to - from).count(); };
+    std::vector<std::string> failures;
+    auto expect = [&](bool ok, const std::string& what) {
+        if (!ok) failures.push_back(what);
+    };
+
+    auto t0 = Clock::now();
+    std::string image = graph.serialize();
+    auto t1 = Clock::now();
+    AODGraph loaded = AODGraph::deserialize(image);
+    auto t2 = Clock::now();
+    std::string dot = graph.toDOT();
+    auto t3 = Clock::now();
+    std::string graphml = graph.toGraphML();
+    auto t4 = Clock::now();
+
+    // 往返后节点/边逐项一致, 再次序列化的字节完全相同
+    expect(loaded.getName() == graph.getName(), "graph name");
+    expect(loaded.getNodes().size() == graph.getNodes().size(), "node count");
+    expect(loaded.getEdges().size() == graph.getEdges().size(), "edge count");
+    for (size_t i = 0; i < loaded.getNodes().size() && i < graph.getNodes().size(); ++i) {
+        const auto& a = graph.getNodes()[i];
+        const auto& b = loaded.getNodes()[i];
+        if (a->getId() != b->getId() || a->getType() != b->getType() || a->getName() != b->getName() ||
+            a->isStatement() != b->isStatement() || a->getAttributes() != b->getAttributes()) {
+            expect(false, "node " + std::to_string(a->getId()));
+            break;
+        }
+        // 镜像不保存 AST 指针, 载入的图不能驱动代码生成
+        expect(b->getAstStmt() == nullptr, "node " + std::to_string(b->getId()) + " has an AST pointer");
+    }
+    auto edges = graph.getEdges(), loaded_edges = loaded.getEdges();
+    for (size_t i = 0; i < loaded_edges.size() && i < edges.size(); ++i) {
+        const auto& a = edges[i];
+        const auto& b = loaded_edges[i];
+        if (a->getSource()->getId() != b->getSource()->getId() || a->getTarget()->getId() != b->getTarget()->getId() ||
+            a->getType() != b->getType() || a->getProperties().variable_name != b->getProperties().variable_name) {
+            expect(false, "edge " + std::to_string(i));
+            break;
+        }
+    }
+    expect(loaded.serialize() == image, "re-serialized bytes differ");
+
+    // 文件映射载入 (临时文件, 用后删除)
+    llvm::SmallString<128> image_path;
+    if (llvm::sys::fs::createTemporaryFile("aodsolve_graph_check", "aodg", image_path)) {
+        expect(false, "cannot create a temporary image file");
+    } else {
+        std::string path = image_path.str().str();
+        try {
+            graph.saveToFile(path);
+            expect(AODGraph::loadFromFile(path).serialize() == image, "mapped file round trip");
+        } catch (const std::runtime_error& e) {
+            expect(false, std::string("mapped file round trip: ") + e.what());
+        }
+        llvm::sys::fs::remove(path);
+    }
+
+    // 截断的镜像与重复的节点ID须被拒绝
+    auto rejects = [](const std::string& bytes) {
+        try {
+            AODGraph::deserialize(bytes);
+        } catch (const std::runtime_error&) {
+            return true;
+        }
+        return false;
+    };
+    expect(rejects(image.substr(0, image.size() - 1)), "truncated image accepted");
+    AODGraph duplicated("duplicate_ids");
+    duplicated.addNode(nodes[0]);
+    duplicated.addNode(nodes[0]);
+    expect(rejects(duplicated.serialize()), "image with duplicate node ids accepted");
+
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << std::left << std::setw(10) << "Format" << std::setw(12) << "Bytes" << std::setw(11) << "Write (ms)" << "Loadable" << std::endl;
+    auto row = [](const char* format, size_t bytes, double time, const char* loadable) {
+        std::cout << std::left << std::setw(10) << format << std::setw(12) << bytes << std::setw(11) << time << loadable << std::endl;
+    };
+    row("binary", image.size(), ms(t0, t1), "yes");
+    row("DOT", dot.size(), ms(t2, t3), "no (labels only)");
+    row("GraphML", graphml.size(), ms(t3, t4), "no loader");
+    std::cout << "Binary load: " << ms(t1, t2) << " ms" << std::endl;
+    std::cout.unsetf(std::ios::fixed);
+
+    for (const auto& failure : failures) std::cout << "FAILED: " << failure << std::endl;
+    std::cout << (failures.empty() ? "Graph image round trip passed." : "Graph image round trip failed.") << std::endl;
+    return failures.empty();
+}
+
+// ========================================================
+// 规则系统自检
+// ========================================================
+bool AODSolveDemo::runRuleSystemCheck() {
+    std::cout << "\n" << std::string(60, '=') << std::endl;
+    std::cout << "   Rule system check" << std::endl;
+    std::cout << std::string(60, '=') << std::endl;
+
+    std::vector<std::string> failures;
+    auto expect = [&](bool ok, const std::string& what) {
+        if (!ok) failures.push_back(what);
+    };
+
+    // 规则包覆盖映射表项: 未给 cost 时估计代价与表项相同, 仍须选中规则包中的规则
+    llvm::SmallString<128> pack_path;
+    if (llvm::sys::fs::createTemporaryFile("aodsolve_rule_check", "json", pack_path)) {
+        expect(false, "cannot create a temporary rule pack");
+    } else {
+        std::string path = pack_path.str().str();
+        saveToFile(R"json({"format": 1, "pack": "override_check", "rules": [
+  {"rule_id": "pack_and_si256", "category": "simd_instruction",
+   "pattern": {"required_operations": ["_mm256_and_si256"]},
+   "targets": {"SVE": {"code_template": "svand_s8_x(pg, {{input_0}}, {{input_1}})"}}}]})json", path);
+
+        RuleRegistry registry([](RuleDatabase& db) { SIMDInstructionRuleBuilder(&db).buildAllRules(); }, {"simd_instruction"});
+        registry.addRuleFile(path);
+        std::string error;
+        bool loaded = registry.reload(&error);
+        expect(loaded, "rule pack rejected: " + error);
+        if (loaded) {
+            auto index = registry.current()->index;
+            auto pack = index->lookup("_mm256_and_si256", "SVE");
+            expect(pack && pack.rule->rule_id == "pack_and_si256", "rule pack does not override _mm256_and_si256 -> SVE");
+            auto table = index->lookup("_mm256_or_si256", "SVE");
+            expect(table && table.rule->rule_id == "avx2_or_si256", "mapping table entry _mm256_or_si256 -> SVE lost");
+        }
+        llvm::sys::fs::remove(pack_path);
+    }
+
+    // 重载中抛出的异常与越界的整数只让本次重载失败, 保留上一快照
+    bool throw_on_load = false;
+    RuleRegistry reloading([&](RuleDatabase& db) {
+        if (throw_on_load) throw std::runtime_error("injected loader failure");
+        SIMDInstructionRuleBuilder(&db).buildAllRules();
+    }, {"simd_instruction"});
+    std::string reload_error;
+    expect(reloading.reload(&reload_error), "builtin reload: " + reload_error);
+    auto previous = reloading.current();
+    throw_on_load = true;
+    bool reloaded = true;
+    try {
+        reloaded = reloading.reload(&reload_error);
+    } catch (const std::exception& e) {
+        reload_error = std::string("escaped exception: ") + e.what();
+    }
+    expect(!reloaded && reloading.current() == previous, "reload after loader exception: " + reload_error);
+    RuleDatabase overflow;
+    llvm::SmallString<128> overflow_path;
+    if (!llvm::sys::fs::createTemporaryFile("aodsolve_rule_check", "json", overflow_path)) {
+        saveToFile(R"json({"format": 99999999999999999999, "rules": []})json", overflow_path.str().str());
+        expect(!overflow.loadRulesFromJSON(overflow_path.str().str(), &reload_error) &&
+               reload_error.find("out of range") != std::string::npos, "out-of-range integer accepted");
+        llvm::sys::fs::remove(overflow_path);
+    }
+
+    // 模板编译: 越界的输入下标与非标识符占位符报告错误, 不抛异常
+    for (const char* text : {"f({{input_99999999999999999999}})", "f({{input_3000000000}})", "int a[1][1] = {{0}};"}) {
+        CodeTemplate compiled;
+        std::string error;
+        bool compiles = true;
+        try {
+            compiles = CodeTemplate::compile(text, compiled, &error);
+        } catch (const std::exception& e) {
+            error = e.what();
+        }
+        expect(!compiles && error.find("at offset") != std::string::npos, std::string("template ") + text + ": " + error);
+    }
+    CodeTemplate highest;
+    expect(CodeTemplate::compile("f({{input_64}})", highest) && highest.inputCount() == 65, "template f({{input_64}})");
+
+    // 映射表导入规则库: 按分类查询、分类统计与模式匹配都能看到单运算映射
+    RuleDatabase db;
+    SIMDInstructionRuleBuilder(&db).buildAllRules();
+    auto category = db.queryRules("simd_instruction");
+    bool has_mapping = std::any_of(category.begin(), category.end(),
+                                   [](const OptimizationRule* rule) { return rule->rule_id == "avx2_add_epi8"; });
+    expect(has_mapping, "queryRules(\"simd_instruction\") lacks the mapping table");
+    expect(db.getCategoryStatistics()["simd_instruction"] == static_cast<int>(category.size()), "category statistics");
+
+    AODGraph graph("rule_check");
+    auto add = std::make_shared<AODNode>(AODNodeType::SIMD_Intrinsic, "_mm256_add_epi8");
+    add->setProperty("op_name", "_mm256_add_epi8");
+    graph.addNode(add);
+    auto matches = PatternMatcher(&db).matchInAOD(graph, "simd_instruction");
+    bool matched = std::any_of(matches.begin(), matches.end(),
+                               [](const PatternMatch& match) { return match.rule->rule_id == "avx2_add_epi8"; });
+    expect(matched, "matchInAOD does not find avx2_add_epi8");
+
+    // 管道以匹配结果的操作数展开目标模板
+    add->setProperty("operand_count", "2");
+    add->setProperty("text_0", "lhs");
+    add->setProperty("text_1", "rhs");
+    std::string optimized = OptimizationPipeline(&db).runOptimization(graph, "SVE", {"simd_instruction"});
+    expect(optimized.find("svadd_s8_z(pg, lhs, rhs)") != std::string::npos, "pipeline does not expand avx2_add_epi8 for SVE");
+
+    for (const auto& failure : failures) std::cout << "FAILED: " << failure << std::endl;
+    std::cout << (failures.empty() ? "Rule system check passed." : "Rule system check failed.") << std::endl;
+    return failures.empty();
+}
+
 // ========================================================
 // 核心分析执行逻辑
 // ========================================================
@@ -178,6 +547,12 @@ void AODSolveDemo::runClangAnalysis(const std::string& code, const std::string&
         // 创建分析器并执行
         AODSolveMainAnalyzer analyzer(ast_context);
         analyzer.setTargetArchitecture(target_arch);
+        if (unroll_factor > 0) analyzer.setUnrollFactor(unroll_factor);
+        analyzer.enableMultiVersioning(multi_version);
+        analyzer.enableFPReassociation(fp_reassociate);
+        analyzer.setAlignPeelThreshold(align_peel_trip);
+        analyzer.setStreamingThreshold(streaming_bytes);
+        analyzer.setPrefetchDistance(prefetch_distance);
 
         // 分析找到的最后一个函数（通常是主入口或外层函数）
         // 对于 Case 5，我们需要分析 Test_call，它会触发对 cal_call 的跨过程分析
@@ -199,6 +574,33 @@ void AODSolveDemo::runClangAnalysis(const std::string& code, const std::string&
     }
 }
 
+// ========================================================
+// 标识符重命名自检
+// ========================================================
+bool AODSolveDemo::runRenameCheck() {
+    std::cout << "\n" << std::string(60, '=') << std::endl;
+    std::cout << "   Identifier rename check" << std::endl;
+    std::cout << std::string(60, '=') << std::endl;
+
+    std::vector<std::string> failures;
+    // 内联器把被调函数的形参 A / s / n / L 改名为实参; 字面量中的同名文本不得改写
+    const std::map<std::string, std::string> renames = {{"A", "a_0"}, {"s", "s_0"}, {"n", "n_0"}, {"L", "l_0"}};
+    auto expect = [&](const std::string& text, const std::string& wanted) {
+        std::string got = EnhancedCPGToAODConverter::renameIdentifiers(text, renames);
+        if (got != wanted) failures.push_back(text + " -> " + got + " (expected " + wanted + ")");
+    };
+    expect("s[n] == 'A' ? A : s[n]", "s_0[n_0] == 'A' ? a_0 : s_0[n_0]");
+    expect("A == '\\'' || A == '\\\\'", "a_0 == '\\'' || a_0 == '\\\\'");
+    expect("puts(\"A \\\"s\\\" n\") + n", "puts(\"A \\\"s\\\" n\") + n_0");
+    expect("L'A' + L + u8\"n\"", "L'A' + l_0 + u8\"n\"");
+    expect("R\"x(A \")s)x\" + s", "R\"x(A \")s)x\" + s_0");
+    expect("1'000 + 0x1fu * n", "1'000 + 0x1fu * n_0");
+
+    for (const auto& failure : failures) std::cout << "FAILED: " << failure << std::endl;
+    std::cout << (failures.empty() ? "Identifier rename check passed." : "Identifier rename check failed.") << std::endl;
+    return failures.empty();
+}
+
 void AODSolveDemo::saveToFile(const std::string& content, const std::string& filename) {
     std::ofstream file(filename);
     if (file.is_open()) {
@@ -218,26 +620,75 @@ int main(int argc, char* argv[]) {
 
     AODSolveDemo demo;
 
-    if (argc > 1) {
-        std::string command = argv[1];
+    // --unroll=N / --multi-version / --fp-reassociate / --align-peel=N / --streaming-threshold=BYTES / --prefetch-distance=BYTES
+    // 可出现在任意位置, 其余参数按位置解析
+    std::vector<std::string> args;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg.rfind("--unroll=", 0) == 0) {
+            demo.setUnrollFactor(std::atoi(arg.c_str() + 9));
+        } else if (arg == "--multi-version") {
+            demo.enableMultiVersioning(true);
+        } else if (arg == "--fp-reassociate") {
+            demo.enableFPReassociation(true);
+        } else if (arg.rfind("--align-peel=", 0) == 0) {
+            demo.setAlignPeelThreshold(std::atoll(arg.c_str() + 13));
+        } else if (arg.rfind("--streaming-threshold=", 0) == 0) {
+            demo.setStreamingThreshold(std::atoll(arg.c_str() + 22));
+        } else if (arg.rfind("--prefetch-distance=", 0) == 0) {
+            demo.setPrefetchDistance(std::atoll(arg.c_str() + 20));
+        } else {
+            args.push_back(arg);
+        }
+    }
+
+    if (!args.empty()) {
+        std::string command = args[0];
         if (command == "case1" || command == "string") {
             demo.runStringProcessingDemo();
         } else if (command == "case4" || command == "scalar") {
             demo.runScalarLoopVectorizationDemo();
         } else if (command == "case5" || command == "crossfunc") {
             demo.runCrossFunctionVectorizationDemo();
+        } else if (command == "case6" || command == "refalign") {
+            demo.runReferenceAlignmentDemo();
+        } else if (command == "case7" || command == "records") {
+            demo.runInterleavedRecordDemo();
+        } else if (command == "export-rules") {
+            // 导出当前规则 (内置 + AODSOLVE_RULES) 为 JSON, 便于编辑和 diff
+            std::string path = args.size() > 1 ? args[1] : "aodsolve_rules.json";
+            RuleRegistry& registry = AODSolveMainAnalyzer::ruleRegistry();
+            std::string error;
+            if (!registry.current() && !registry.reload(&error)) {
+                std::cerr << "Error: " << error << std::endl;
+                return 1;
+            }
+            auto snapshot = registry.current();
+            if (!snapshot->db->exportRulesToJSON(path)) return 1;
+            std::cout << "Exported " << snapshot->db->getRuleCount() << " rules to " << path << std::endl;
+            return 0;
+        } else if (command == "graph-image") {
+            return demo.runGraphImageCheck(args.size() > 1 ? std::atoi(args[1].c_str()) : 20000) ? 0 : 1;
+        } else if (command == "rules-check") {
+            return demo.runRuleSystemCheck() ? 0 : 1;
+        } else if (command == "rename-check") {
+            return demo.runRenameCheck() ? 0 : 1;
         } else if (command == "all") {
             demo.runStringProcessingDemo();
             demo.runScalarLoopVectorizationDemo();
             demo.runCrossFunctionVectorizationDemo();
+            demo.runReferenceAlignmentDemo();
+            demo.runInterleavedRecordDemo();
         } else {
-            std::cout << "Unknown command. Usage: ./vectorization_demo [case1|case4|case5|all]" << std::endl;
+            std::cout << "Unknown command. Usage: ./vectorization_demo [case1|case4|case5|case6|case7|all|export-rules [file]|graph-image [nodes]|rules-check|rename-check] [--unroll=N] [--multi-version] [--fp-reassociate] [--align-peel=N] [--streaming-threshold=BYTES] [--prefetch-distance=BYTES]" << std::endl;
         }
     } else {
         // 默认运行所有案例
         demo.runStringProcessingDemo();
         demo.runScalarLoopVectorizationDemo();
         demo.runCrossFunctionVectorizationDemo();
+        demo.runReferenceAlignmentDemo();
+        demo.runInterleavedRecordDemo();
     }
 
     std::cout << "\nDemo completed successfully." << std::endl;
@@ -29,6 +29,7 @@ namespace aodsolve {
         }
 
         result.conversion_log.push_back("Analyzing function: " + func->getNameAsString());
+        current_function = func;
 
         // 【关键】使用CPGBuilder构建CPG - 这是正确的方式!
         cpg::CPGBuilder::buildForFunction(func, cpg_context);
@@ -635,11 +636,95 @@ namespace aodsolve {
         return cse;
     }
 
-    // ✅ 修复第614行: 添加 (void)loop_id
     std::vector<std::string> IntegratedCPGAnalyzer::findLoopInvariantCode(int loop_id) {
-        (void)loop_id;  // Unused parameter
-        // Would need to track which expressions don't change across loop iterations
-        return {};
+        std::vector<std::string> invariants;
+        if (!current_function || !current_function->hasBody()) return invariants;
+
+        // 与 findLoopsWithCPG 相同的先序编号
+        int current_id = 0;
+        const clang::Stmt* loop_stmt = nullptr;
+        std::function<void(const clang::Stmt*)> findLoop;
+        findLoop = [&](const clang::Stmt* stmt) {
+            if (!stmt || loop_stmt) return;
+            if (clang::isa<clang::ForStmt>(stmt) || clang::isa<clang::WhileStmt>(stmt) || clang::isa<clang::DoStmt>(stmt)) {
+                if (current_id++ == loop_id) {
+                    loop_stmt = stmt;
+                    return;
+                }
+            }
+            for (auto* child : stmt->children()) findLoop(child);
+        };
+        findLoop(current_function->getBody());
+        if (!loop_stmt) return invariants;
+
+        // 循环内被写入、取地址或声明的变量
+        std::set<const clang::ValueDecl*> modified;
+        std::function<void(const clang::Stmt*)> collectWrites;
+        collectWrites = [&](const clang::Stmt* stmt) {
+            if (!stmt) return;
+            auto record = [&](const clang::Expr* e) {
+                if (auto* dre = clang::dyn_cast<clang::DeclRefExpr>(e->IgnoreParenCasts())) modified.insert(dre->getDecl());
+            };
+            if (auto* bo = clang::dyn_cast<clang::BinaryOperator>(stmt)) {
+                if (bo->isAssignmentOp()) record(bo->getLHS());
+            } else if (auto* uo = clang::dyn_cast<clang::UnaryOperator>(stmt)) {
+                if (uo->isIncrementDecrementOp() || uo->getOpcode() == clang::UO_AddrOf) record(uo->getSubExpr());
+            } else if (auto* ds = clang::dyn_cast<clang::DeclStmt>(stmt)) {
+                for (auto* d : ds->decls()) {
+                    if (auto* vd = clang::dyn_cast<clang::VarDecl>(d)) modified.insert(vd);
+                }
+            }
+            for (auto* child : stmt->children()) collectWrites(child);
+        };
+        collectWrites(loop_stmt);
+
+        // 表达式不读内存、无副作用, 且引用的变量在循环内都不变
+        std::function<bool(const clang::Stmt*)> isInvariant;
+        isInvariant = [&](const clang::Stmt* stmt) -> bool {
+            if (!stmt) return true;
+            if (clang::isa<clang::ArraySubscriptExpr>(stmt) || clang::isa<clang::MemberExpr>(stmt)) return false;
+            if (auto* uo = clang::dyn_cast<clang::UnaryOperator>(stmt)) {
+                if (uo->getOpcode() == clang::UO_Deref || uo->isIncrementDecrementOp()) return false;
+            }
+            if (auto* bo = clang::dyn_cast<clang::BinaryOperator>(stmt)) {
+                if (bo->isAssignmentOp()) return false;
+            }
+            if (auto* call = clang::dyn_cast<clang::CallExpr>(stmt)) {
+                auto* callee = call->getDirectCallee();
+                if (!callee || !isPureOperationName(callee->getNameAsString())) return false;
+            }
+            if (auto* dre = clang::dyn_cast<clang::DeclRefExpr>(stmt)) {
+                if (clang::isa<clang::VarDecl>(dre->getDecl()) && modified.count(dre->getDecl())) return false;
+            }
+            for (auto* child : stmt->children()) {
+                if (!isInvariant(child)) return false;
+            }
+            return true;
+        };
+
+        std::function<void(const clang::Stmt*)> scan;
+        scan = [&](const clang::Stmt* stmt) {
+            if (!stmt) return;
+            if (auto* expr = clang::dyn_cast<clang::Expr>(stmt)) {
+                const clang::Expr* e = expr->IgnoreParenImpCasts();
+                bool candidate = clang::isa<clang::CallExpr>(e) ||
+                                 (clang::isa<clang::BinaryOperator>(e) && !clang::cast<clang::BinaryOperator>(e)->isAssignmentOp());
+                // 编译期常量交给常量折叠, 这里只报告需要运行时计算的不变式
+                if (candidate && !e->isValueDependent() && !e->isEvaluatable(ast_context) && isInvariant(e)) {
+                    std::string text;
+                    llvm::raw_string_ostream stream(text);
+                    e->printPretty(stream, nullptr, ast_context.getPrintingPolicy());
+                    invariants.push_back("Loop-invariant: " + stream.str());
+                    return;
+                }
+            }
+            for (auto* child : stmt->children()) scan(child);
+        };
+
+        if (auto* for_stmt = clang::dyn_cast<clang::ForStmt>(loop_stmt)) scan(for_stmt->getBody());
+        else if (auto* while_stmt = clang::dyn_cast<clang::WhileStmt>(loop_stmt)) scan(while_stmt->getBody());
+        else if (auto* do_stmt = clang::dyn_cast<clang::DoStmt>(loop_stmt)) scan(do_stmt->getBody());
+        return invariants;
     }
 
     std::vector<std::string> IntegratedCPGAnalyzer::generateOptimizationSuggestions(const clang::FunctionDecl* func) {
@@ -51,6 +51,9 @@ private:
     std::shared_ptr<AODGraph> global_graph;
     std::map<std::string, std::shared_ptr<AODGraph>> module_graphs;
 
+    // 最近一次 analyzeFunctionWithCPG 分析的函数, 按 loop_id 查询的接口以它为准
+    const clang::FunctionDecl* current_function = nullptr;
+
 public:
     explicit IntegratedCPGAnalyzer(clang::ASTContext& ctx);
     ~IntegratedCPGAnalyzer() = default;
@@ -0,0 +1,184 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <string_view>
+
+namespace aodsolve {
+
+// ============================================================================
+// 编译期 intrinsic 映射表 - 单条源运算到目标指令的映射, 以 (源运算, 目标架构) 完美哈希查找
+// ============================================================================
+
+/**
+ * 一条源运算 -> 目标指令映射
+ *
+ * operands 为操作数签名, 每个字符一个操作数: v 向量, s 标量, i 立即数, p 指针.
+ * cost 为目标指令延迟 (周期, 与 getTargetOperationCost 的目标核心一致), 指令选择据此比较单指令与 tile.
+ */
+struct IntrinsicMapping {
+    std::string_view source;            // 源 intrinsic 或标量运算符
+    std::string_view target_arch;       // SVE / NEON
+    std::string_view rule_id;           // 导入 RuleDatabase 时的规则ID, 同ID的多目标合并为一条规则
+    std::string_view operands;
+    std::string_view element_type;      // 通道类型: s8/u16/f32 ...
+    std::string_view code;              // {{input_N}} / {{predicate}} 占位符模板
+    std::string_view return_type;
+    int cost;
+};
+
+// srli/mulhi 是无符号语义, SVE 上经 reinterpret 到 uW 再转回; andnot(a, b) = ~a & b, 对应 bic(b, a)
+inline constexpr IntrinsicMapping kIntrinsicMappings[] = {
+    // AVX2 -> SVE: 访存与比较
+    {"_mm256_loadu_si256", "SVE", "avx2_loadu_si256", "p", "s8", "svld1_s8(pg, (const int8_t*){{input_0}})", "svint8_t", 6},
+    {"_mm256_storeu_si256", "SVE", "avx2_storeu_si256", "pv", "s8", "svst1_s8(pg, (int8_t*){{input_0}}, {{input_1}})", "void", 1},
+    {"_mm256_cmpgt_epi8", "SVE", "avx2_cmpgt_epi8", "vv", "s8", "svcmpgt_s8(pg, {{input_0}}, {{input_1}})", "svbool_t", 3},
+    {"_mm256_cmpeq_epi8", "SVE", "avx2_cmpeq_epi8", "vv", "s8", "svcmpeq_s8(pg, {{input_0}}, {{input_1}})", "svbool_t", 3},
+
+    // AVX2 -> SVE: 按位运算与常量 (等式饱和提取出的掩码代数)
+    {"_mm256_and_si256", "SVE", "avx2_and_si256", "vv", "s8", "svand_s8_z(pg, {{input_0}}, {{input_1}})", "svint8_t", 2},
+    {"_mm256_or_si256", "SVE", "avx2_or_si256", "vv", "s8", "svorr_s8_z(pg, {{input_0}}, {{input_1}})", "svint8_t", 2},
+    {"_mm256_xor_si256", "SVE", "avx2_xor_si256", "vv", "s8", "sveor_s8_z(pg, {{input_0}}, {{input_1}})", "svint8_t", 2},
+    {"_mm256_andnot_si256", "SVE", "avx2_andnot_si256", "vv", "s8", "svbic_s8_z(pg, {{input_1}}, {{input_0}})", "svint8_t", 2},
+    {"_mm256_setzero_si256", "SVE", "avx2_setzero_si256", "", "s8", "svdup_s8(0)", "svint8_t", 2},
+
+    // AVX2 -> SVE: 逐通道宽度的整数运算 (强度削减的产物)
+    {"_mm256_set1_epi8", "SVE", "avx2_set1_epi8", "s", "s8", "svdup_s8({{input_0}})", "svint8_t", 3},
+    {"_mm256_set1_epi16", "SVE", "avx2_set1_epi16", "s", "s16", "svdup_s16({{input_0}})", "svint16_t", 3},
+    {"_mm256_set1_epi32", "SVE", "avx2_set1_epi32", "s", "s32", "svdup_s32({{input_0}})", "svint32_t", 3},
+    {"_mm256_add_epi8", "SVE", "avx2_add_epi8", "vv", "s8", "svadd_s8_z(pg, {{input_0}}, {{input_1}})", "svint8_t", 2},
+    {"_mm256_add_epi16", "SVE", "avx2_add_epi16", "vv", "s16", "svadd_s16_z(pg, {{input_0}}, {{input_1}})", "svint16_t", 2},
+    {"_mm256_add_epi32", "SVE", "avx2_add_epi32", "vv", "s32", "svadd_s32_z(pg, {{input_0}}, {{input_1}})", "svint32_t", 2},
+    {"_mm256_sub_epi8", "SVE", "avx2_sub_epi8", "vv", "s8", "svsub_s8_z(pg, {{input_0}}, {{input_1}})", "svint8_t", 2},
+    {"_mm256_sub_epi16", "SVE", "avx2_sub_epi16", "vv", "s16", "svsub_s16_z(pg, {{input_0}}, {{input_1}})", "svint16_t", 2},
+    {"_mm256_sub_epi32", "SVE", "avx2_sub_epi32", "vv", "s32", "svsub_s32_z(pg, {{input_0}}, {{input_1}})", "svint32_t", 2},
+    {"_mm256_slli_epi16", "SVE", "avx2_slli_epi16", "vi", "s16", "svlsl_n_s16_z(pg, {{input_0}}, {{input_1}})", "svint16_t", 2},
+    {"_mm256_slli_epi32", "SVE", "avx2_slli_epi32", "vi", "s32", "svlsl_n_s32_z(pg, {{input_0}}, {{input_1}})", "svint32_t", 2},
+    {"_mm256_srli_epi16", "SVE", "avx2_srli_epi16", "vi", "u16",
+     "svreinterpret_s16_u16(svlsr_n_u16_z(pg, svreinterpret_u16_s16({{input_0}}), {{input_1}}))", "svint16_t", 2},
+    {"_mm256_srli_epi32", "SVE", "avx2_srli_epi32", "vi", "u32",
+     "svreinterpret_s32_u32(svlsr_n_u32_z(pg, svreinterpret_u32_s32({{input_0}}), {{input_1}}))", "svint32_t", 2},
+    {"_mm256_mulhi_epu16", "SVE", "avx2_mulhi_epu16", "vv", "u16",
+     "svreinterpret_s16_u16(svmulh_u16_z(pg, svreinterpret_u16_s16({{input_0}}), svreinterpret_u16_s16({{input_1}})))", "svint16_t", 5},
+    {"_mm256_mullo_epi16", "SVE", "avx2_mullo_epi16", "vv", "s16", "svmul_s16_z(pg, {{input_0}}, {{input_1}})", "svint16_t", 4},
+    {"_mm256_mullo_epi32", "SVE", "avx2_mullo_epi32", "vv", "s32", "svmul_s32_z(pg, {{input_0}}, {{input_1}})", "svint32_t", 4},
+
+    // 标量 -> NEON (循环自动向量化)
+    {"+", "NEON", "scalar_add_float", "vv", "f32", "vaddq_f32({{input_0}}, {{input_1}})", "float32x4_t", 2},
+    {"-", "NEON", "scalar_sub_float", "vv", "f32", "vsubq_f32({{input_0}}, {{input_1}})", "float32x4_t", 2},
+    {"*", "NEON", "scalar_mul_float", "vv", "f32", "vmulq_f32({{input_0}}, {{input_1}})", "float32x4_t", 3},
+    {"/", "NEON", "scalar_div_float", "vv", "f32", "vdivq_f32({{input_0}}, {{input_1}})", "float32x4_t", 10},
+    {"load_float", "NEON", "scalar_load_float", "p", "f32", "vld1q_f32((const float*){{input_0}})", "float32x4_t", 6},
+    {"store_float", "NEON", "scalar_store_float", "pv", "f32", "vst1q_f32((float*){{input_0}}, {{input_1}})", "void", 1},
+};
+
+/**
+ * 编译期构造的完美哈希 (hash-and-displace)
+ *
+ * 键先按一级哈希分桶, 桶按大小降序依次寻找位移 d, 使桶内所有键在二级哈希下落入互不冲突的空槽.
+ * 槽数取不小于 2N 的 2 的幂, 平均每桶 4 个键, 表增长到数千项时构造仍在常量求值的步数限制内.
+ * 查找为一次字符串哈希 + 两次取模 + 一次键比较. 键重复时构造失败, valid() 为 false.
+ */
+template <size_t N>
+class IntrinsicMappingIndex {
+public:
+    static constexpr size_t kSlots = [] {
+        size_t slots = 1;
+        while (slots < 2 * N) slots <<= 1;
+        return slots;
+    }();
+    static constexpr size_t kBuckets = (N + 3) / 4;
+    static constexpr uint32_t kMaxDisplacement = 1u << 20;
+
+    constexpr explicit IntrinsicMappingIndex(const IntrinsicMapping (&entries)[N]) : entries(entries) {
+        std::array<uint64_t, N> hashes{};
+        std::array<size_t, kBuckets + 1> bucket_start{};
+        std::array<size_t, N> by_bucket{};
+        for (size_t i = 0; i < N; ++i) {
+            hashes[i] = hash(entries[i].source, entries[i].target_arch);
+            ++bucket_start[bucketOf(hashes[i]) + 1];
+        }
+        for (size_t b = 0; b < kBuckets; ++b) bucket_start[b + 1] += bucket_start[b];
+        std::array<size_t, kBuckets> fill{};
+        for (size_t i = 0; i < N; ++i) {
+            size_t b = bucketOf(hashes[i]);
+            by_bucket[bucket_start[b] + fill[b]++] = i;
+        }
+
+        size_t largest = 0;
+        for (size_t b = 0; b < kBuckets; ++b) largest = fill[b] > largest ? fill[b] : largest;
+        for (size_t size = largest; size > 0; --size) {
+            for (size_t b = 0; b < kBuckets; ++b) {
+                if (fill[b] != size) continue;
+                uint32_t d = 1;
+                for (; d < kMaxDisplacement; ++d) {
+                    if (tryPlace(hashes, by_bucket, bucket_start[b], size, d)) break;
+                }
+                if (d == kMaxDisplacement) return;      // valid_ 保持 false
+                displacement[b] = d;
+            }
+        }
+        valid_ = true;
+    }
+
+    constexpr bool valid() const { return valid_; }
+
+    constexpr const IntrinsicMapping* find(std::string_view source, std::string_view target_arch) const {
+        uint64_t h = hash(source, target_arch);
+        uint32_t index = slots[slotOf(h, displacement[bucketOf(h)])];
+        if (index == 0) return nullptr;
+        const IntrinsicMapping& entry = entries[index - 1];
+        return entry.source == source && entry.target_arch == target_arch ? &entry : nullptr;
+    }
+
+private:
+    const IntrinsicMapping (&entries)[N];
+    std::array<uint32_t, kBuckets> displacement{};
+    std::array<uint32_t, kSlots> slots{};               // 条目下标 + 1, 0 为空
+    bool valid_ = false;
+
+    static constexpr uint64_t hash(std::string_view source, std::string_view target_arch) {
+        uint64_t h = 1469598103934665603ull;            // FNV-1a
+        for (char c : source) h = (h ^ static_cast<unsigned char>(c)) * 1099511628211ull;
+        h = (h ^ '@') * 1099511628211ull;
+        for (char c : target_arch) h = (h ^ static_cast<unsigned char>(c)) * 1099511628211ull;
+        return h;
+    }
+
+    static constexpr uint64_t mix(uint64_t h) {
+        h ^= h >> 33;
+        h *= 0xff51afd7ed558ccdull;
+        h ^= h >> 33;
+        return h;
+    }
+
+    static constexpr size_t bucketOf(uint64_t h) { return static_cast<size_t>(mix(h) % kBuckets); }
+    static constexpr size_t slotOf(uint64_t h, uint32_t d) {
+        return static_cast<size_t>(mix(h ^ (d * 0x9e3779b97f4a7c15ull)) & (kSlots - 1));
+    }
+
+    constexpr bool tryPlace(const std::array<uint64_t, N>& hashes, const std::array<size_t, N>& by_bucket,
+                            size_t start, size_t size, uint32_t d) {
+        for (size_t k = 0; k < size; ++k) {
+            size_t slot = slotOf(hashes[by_bucket[start + k]], d);
+            if (slots[slot] != 0) {
+                for (size_t j = 0; j < k; ++j) slots[slotOf(hashes[by_bucket[start + j]], d)] = 0;
+                return false;
+            }
+            slots[slot] = static_cast<uint32_t>(by_bucket[start + k] + 1);
+        }
+        return true;
+    }
+};
+
+inline constexpr IntrinsicMappingIndex<std::size(kIntrinsicMappings)> kIntrinsicMappingIndex{kIntrinsicMappings};
+static_assert(kIntrinsicMappingIndex.valid(), "kIntrinsicMappings contains duplicate (source, target_arch) keys");
+
+// 未收录时返回 nullptr
+constexpr const IntrinsicMapping* findIntrinsicMapping(std::string_view source, std::string_view target_arch) {
+    return kIntrinsicMappingIndex.find(source, target_arch);
+}
+
+} // namespace aodsolve
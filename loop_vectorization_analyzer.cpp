@@ -1,5 +1,15 @@
 #include "analysis/loop_vectorization_analyzer.h"
+#include <clang/AST/ParentMapContext.h>
+#include <clang/AST/RecordLayout.h>
 #include <clang/AST/RecursiveASTVisitor.h>
+#include <clang/Basic/TargetInfo.h>
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <functional>
+#include <iomanip>
+#include <map>
+#include <set>
 #include <sstream>
 
 namespace aodsolve {
@@ -134,6 +144,21 @@ namespace aodsolve {
                 : iterator(it), ctx(c) {
             }
 
+            // 赋值左侧与自增自减的数组元素是写入; 父节点先于子节点访问, 先记下再在 VisitArraySubscriptExpr 中查
+            bool VisitBinaryOperator(const clang::BinaryOperator *op) {
+                if (op->isAssignmentOp()) {
+                    written[op->getLHS()->IgnoreParenImpCasts()] = op->isCompoundAssignmentOp();
+                }
+                return true;
+            }
+
+            bool VisitUnaryOperator(const clang::UnaryOperator *op) {
+                if (op->isIncrementDecrementOp()) {
+                    written[op->getSubExpr()->IgnoreParenImpCasts()] = true;
+                }
+                return true;
+            }
+
             bool VisitArraySubscriptExpr(const clang::ArraySubscriptExpr *expr) {
                 ArrayAccess access;
                 access.ast_expr = expr;
@@ -143,27 +168,99 @@ namespace aodsolve {
                     access.array_name = base->getDecl()->getNameAsString();
                 }
 
-                // 获取索引表达式
+                // 获取索引表达式并分类
                 if (auto *idx = expr->getIdx()) {
                     access.index_expr = getExprAsString(idx);
-                    access.is_sequential = (access.index_expr == iterator);
+                    classify(idx, access);
                 }
+                access.is_sequential = (access.kind == "contiguous");
 
                 // 判断读/写
-                // 简化版本：需要检查父节点
-                access.is_read = true;
+                auto it = written.find(expr);
+                access.is_write = it != written.end();
+                access.is_read = !access.is_write || it->second;
 
                 accesses.push_back(access);
                 return true;
             }
 
         private:
+            std::map<const clang::Expr *, bool> written;    // 写入的数组元素 -> 是否同时读取
+
             std::string getExprAsString(const clang::Expr *expr) {
                 if (auto *decl_ref = clang::dyn_cast<clang::DeclRefExpr>(expr->IgnoreImpCasts())) {
                     return decl_ref->getDecl()->getNameAsString();
                 }
                 return "complex_expr";
             }
+
+            bool isIterator(const clang::Expr *expr) {
+                auto *ref = clang::dyn_cast<clang::DeclRefExpr>(expr->IgnoreParenImpCasts());
+                return ref && ref->getDecl()->getNameAsString() == iterator;
+            }
+
+            bool mentionsIterator(const clang::Expr *expr) {
+                if (isIterator(expr)) return true;
+                for (const auto *child : expr->children()) {
+                    auto *sub = clang::dyn_cast_or_null<clang::Expr>(child);
+                    if (sub && mentionsIterator(sub)) return true;
+                }
+                return false;
+            }
+
+            // 下标按 scale * i + offset 解析: 支持 +, - 常量, * 常量, << 常量
+            bool parseAffine(const clang::Expr *expr, int64_t &scale, int64_t &offset) {
+                expr = expr->IgnoreParenImpCasts();
+                clang::Expr::EvalResult value;
+                if (!expr->isValueDependent() && expr->EvaluateAsInt(value, ctx)) {
+                    scale = 0;
+                    offset = value.Val.getInt().getSExtValue();
+                    return true;
+                }
+                if (isIterator(expr)) {
+                    scale = 1;
+                    offset = 0;
+                    return true;
+                }
+                auto *binary = clang::dyn_cast<clang::BinaryOperator>(expr);
+                if (!binary) return false;
+                int64_t ls = 0, lo = 0, rs = 0, ro = 0;
+                if (!parseAffine(binary->getLHS(), ls, lo) || !parseAffine(binary->getRHS(), rs, ro)) return false;
+                switch (binary->getOpcode()) {
+                    case clang::BO_Add: scale = ls + rs; offset = lo + ro; return true;
+                    case clang::BO_Sub: scale = ls - rs; offset = lo - ro; return true;
+                    case clang::BO_Mul:
+                        if (ls != 0 && rs != 0) return false;
+                        scale = ls * ro + rs * lo;
+                        offset = lo * ro;
+                        return true;
+                    case clang::BO_Shl:
+                        if (rs != 0 || ro < 0 || ro > 16) return false;
+                        scale = ls << ro;
+                        offset = lo << ro;
+                        return true;
+                    default: return false;
+                }
+            }
+
+            void classify(const clang::Expr *idx, ArrayAccess &access) {
+                int64_t scale = 0, offset = 0;
+                if (!mentionsIterator(idx)) {
+                    access.kind = "invariant";
+                } else if (parseAffine(idx, scale, offset) && scale > 0) {
+                    access.kind = scale == 1 ? "contiguous" : scale <= 4 ? "interleaved" : "strided";
+                    access.stride = scale;
+                    access.offset = offset;
+                } else if (auto *inner = clang::dyn_cast<clang::ArraySubscriptExpr>(idx->IgnoreParenImpCasts());
+                           inner && parseAffine(inner->getIdx(), scale, offset) && scale == 1) {
+                    auto *base = clang::dyn_cast<clang::DeclRefExpr>(inner->getBase()->IgnoreImpCasts());
+                    access.kind = base ? "indexed" : "irregular";
+                    access.offset = offset;
+                    if (base) access.index_array = base->getDecl()->getNameAsString();
+                } else {
+                    access.kind = "irregular";
+                }
+            }
         };
 
         ArrayAccessFinder finder(iterator, ast_context);
@@ -210,68 +307,299 @@ namespace aodsolve {
         return finder.operations;
     }
 
-    bool LoopVectorizationAnalyzer::detectReductionPattern(const clang::ForStmt *loop,
-                                                           LoopVectorizationPattern &pattern) {
-        // 检测归约模式: sum += array[i]
-        // 简化版本：查找形如 var += expr 的模式
+    // ============================================================================
+    // 归约识别
+    // ============================================================================
 
-        class ReductionFinder : public clang::RecursiveASTVisitor<ReductionFinder> {
-        public:
-            bool found_reduction = false;
-            std::string reduction_var;
-            std::string reduction_op;
+    namespace {
+
+        // 一条归约更新语句:
+        //   s op= v, s = s op v (op 为 + * & | ^), s = v < s ? v : s, s = fmin(s, v), if (v < s) s = v;
+        //   argmin/argmax: if (v < s) { s = v; k = i; }
+        struct ReductionUpdate {
+            const clang::VarDecl* var = nullptr;
+            std::string op;
+            const clang::Expr* value = nullptr;
+            const clang::VarDecl* index = nullptr;      // argmin/argmax 的位置变量
+            const clang::Expr* position = nullptr;      // 写入位置变量的值
+            bool strict = true;                         // min/max 条件是否为严格比较
+        };
 
-            bool VisitBinaryOperator(const clang::BinaryOperator *op) {
-                if (op->getOpcode() == clang::BO_AddAssign) {
-                    if (auto *lhs = clang::dyn_cast<clang::DeclRefExpr>(op->getLHS()->IgnoreImpCasts())) {
-                        reduction_var = lhs->getDecl()->getNameAsString();
-                        reduction_op = "sum";
-                        found_reduction = true;
-                    }
-                }
+        const clang::VarDecl* referencedVariable(const clang::Expr* expr) {
+            auto* ref = expr ? llvm::dyn_cast<clang::DeclRefExpr>(expr->IgnoreParenImpCasts()) : nullptr;
+            return ref ? llvm::dyn_cast<clang::VarDecl>(ref->getDecl()) : nullptr;
+        }
+
+        int countReferences(const clang::Stmt* stmt, const clang::VarDecl* var) {
+            if (!stmt) return 0;
+            int count = 0;
+            if (auto* ref = llvm::dyn_cast<clang::DeclRefExpr>(stmt)) count += ref->getDecl() == var;
+            for (const auto* child : stmt->children()) count += countReferences(child, var);
+            return count;
+        }
+
+        bool isSameExpression(const clang::Expr* a, const clang::Expr* b, clang::ASTContext& ctx) {
+            if (a->HasSideEffects(ctx) || b->HasSideEffects(ctx)) return false;
+            llvm::FoldingSetNodeID first, second;
+            a->IgnoreParenImpCasts()->Profile(first, ctx, true);
+            b->IgnoreParenImpCasts()->Profile(second, ctx, true);
+            return first == second;
+        }
+
+        // 条件是 var 与另一个值的大小比较时, 另一值较小则更新为 min, 较大则为 max
+        bool matchMinMaxCondition(const clang::Expr* cond, const clang::VarDecl* var, ReductionUpdate& out) {
+            auto* compare = llvm::dyn_cast<clang::BinaryOperator>(cond->IgnoreParenImpCasts());
+            if (!compare) return false;
+            const clang::Expr* smaller = nullptr;
+            const clang::Expr* larger = nullptr;
+            switch (compare->getOpcode()) {
+                case clang::BO_LT: case clang::BO_LE:
+                    smaller = compare->getLHS();
+                    larger = compare->getRHS();
+                    break;
+                case clang::BO_GT: case clang::BO_GE:
+                    smaller = compare->getRHS();
+                    larger = compare->getLHS();
+                    break;
+                default:
+                    return false;
+            }
+            out.strict = compare->getOpcode() == clang::BO_LT || compare->getOpcode() == clang::BO_GT;
+            if (referencedVariable(larger) == var && referencedVariable(smaller) != var) {
+                out.value = smaller;
+                out.op = "min";
                 return true;
             }
-        };
+            if (referencedVariable(smaller) == var && referencedVariable(larger) != var) {
+                out.value = larger;
+                out.op = "max";
+                return true;
+            }
+            return false;
+        }
 
-        if (!loop->getBody()) {
+        bool matchReductionAssignment(const clang::BinaryOperator* assign, clang::ASTContext& ctx, ReductionUpdate& out) {
+            if (!llvm::isa<clang::DeclRefExpr>(assign->getLHS()->IgnoreParens())) return false;
+            const clang::VarDecl* var = referencedVariable(assign->getLHS());
+            if (!var) return false;
+            out.var = var;
+
+            if (auto* compound = llvm::dyn_cast<clang::CompoundAssignOperator>(assign)) {
+                switch (compound->getOpcode()) {
+                    case clang::BO_AddAssign: out.op = "sum"; break;
+                    case clang::BO_MulAssign: out.op = "product"; break;
+                    case clang::BO_AndAssign: out.op = "and"; break;
+                    case clang::BO_OrAssign: out.op = "or"; break;
+                    case clang::BO_XorAssign: out.op = "xor"; break;
+                    default: return false;
+                }
+                out.value = compound->getRHS();
+                return true;
+            }
+            if (assign->getOpcode() != clang::BO_Assign) return false;
+
+            const clang::Expr* rhs = assign->getRHS()->IgnoreParenImpCasts();
+            if (auto* binary = llvm::dyn_cast<clang::BinaryOperator>(rhs)) {
+                switch (binary->getOpcode()) {
+                    case clang::BO_Add: out.op = "sum"; break;
+                    case clang::BO_Mul: out.op = "product"; break;
+                    case clang::BO_And: out.op = "and"; break;
+                    case clang::BO_Or: out.op = "or"; break;
+                    case clang::BO_Xor: out.op = "xor"; break;
+                    default: return false;
+                }
+                // 单次二元运算满足交换律, s = v + s 与 s = s + v 结果相同
+                if (referencedVariable(binary->getLHS()) == var) {
+                    out.value = binary->getRHS();
+                } else if (referencedVariable(binary->getRHS()) == var) {
+                    out.value = binary->getLHS();
+                } else {
+                    return false;
+                }
+                return true;
+            }
+            if (auto* select = llvm::dyn_cast<clang::ConditionalOperator>(rhs)) {
+                if (!matchMinMaxCondition(select->getCond(), var, out)) return false;
+                // v < s ? v : s 取较小者为 min; v < s ? s : v 取较大者为 max
+                bool picks_value = isSameExpression(select->getTrueExpr(), out.value, ctx) && referencedVariable(select->getFalseExpr()) == var;
+                bool picks_var = referencedVariable(select->getTrueExpr()) == var && isSameExpression(select->getFalseExpr(), out.value, ctx);
+                if (!picks_value && !picks_var) return false;
+                if (picks_var) out.op = out.op == "min" ? "max" : "min";
+                return true;
+            }
+            if (auto* call = llvm::dyn_cast<clang::CallExpr>(rhs)) {
+                const clang::FunctionDecl* callee = call->getDirectCallee();
+                if (!callee || call->getNumArgs() != 2) return false;
+                std::string name = callee->getQualifiedNameAsString();
+                if (name == "fmin" || name == "fminf" || name == "std::fmin" || name == "std::min") {
+                    out.op = "min";
+                } else if (name == "fmax" || name == "fmaxf" || name == "std::fmax" || name == "std::max") {
+                    out.op = "max";
+                } else {
+                    return false;
+                }
+                if (referencedVariable(call->getArg(0)) == var) {
+                    out.value = call->getArg(1);
+                } else if (referencedVariable(call->getArg(1)) == var) {
+                    out.value = call->getArg(0);
+                } else {
+                    return false;
+                }
+                return true;
+            }
             return false;
         }
 
-        ReductionFinder finder;
-        finder.TraverseStmt(const_cast<clang::Stmt *>(loop->getBody()));
+        // if (v < s) s = v; 以及同时记录位置的 if (v < s) { s = v; k = i; }
+        bool matchConditionalUpdate(const clang::IfStmt* branch, clang::ASTContext& ctx, ReductionUpdate& out) {
+            if (branch->getElse() || branch->getInit() || branch->getConditionVariable() || branch->isConstexpr()) return false;
+            std::vector<const clang::Stmt*> body;
+            if (auto* compound = llvm::dyn_cast<clang::CompoundStmt>(branch->getThen())) {
+                body.assign(compound->body_begin(), compound->body_end());
+            } else {
+                body.push_back(branch->getThen());
+            }
+            if (body.empty() || body.size() > 2) return false;
 
-        if (finder.found_reduction) {
-            pattern.reduction_var = finder.reduction_var;
-            pattern.reduction_op = finder.reduction_op;
+            for (const auto* stmt : body) {
+                auto* expr = llvm::dyn_cast<clang::Expr>(stmt);
+                auto* assign = expr ? llvm::dyn_cast<clang::BinaryOperator>(expr->IgnoreParens()) : nullptr;
+                if (!assign || assign->getOpcode() != clang::BO_Assign || !llvm::isa<clang::DeclRefExpr>(assign->getLHS()->IgnoreParens())) {
+                    return false;
+                }
+                const clang::VarDecl* target = referencedVariable(assign->getLHS());
+                if (!target) return false;
+                ReductionUpdate candidate;
+                if (!out.var && matchMinMaxCondition(branch->getCond(), target, candidate) &&
+                    isSameExpression(assign->getRHS(), candidate.value, ctx)) {
+                    out.var = target;
+                    out.op = candidate.op;
+                    out.value = assign->getRHS();
+                    out.strict = candidate.strict;
+                } else if (!out.index) {
+                    out.index = target;
+                    out.position = assign->getRHS();
+                } else {
+                    return false;
+                }
+            }
+            if (!out.var) return false;
+            if (out.index) out.op = "arg" + out.op;
+            return true;
         }
 
-        return finder.found_reduction;
-    }
+        bool matchReductionUpdate(const clang::Stmt* stmt, clang::ASTContext& ctx, ReductionUpdate& out) {
+            out = ReductionUpdate();
+            bool matched = false;
+            if (auto* branch = llvm::dyn_cast<clang::IfStmt>(stmt)) {
+                matched = matchConditionalUpdate(branch, ctx, out);
+            } else if (auto* expr = llvm::dyn_cast<clang::Expr>(stmt)) {
+                auto* assign = llvm::dyn_cast<clang::BinaryOperator>(expr->IgnoreParens());
+                matched = assign && assign->isAssignmentOp() && matchReductionAssignment(assign, ctx, out);
+            }
+            if (!matched || countReferences(out.value, out.var) > 0) return false;
+            if (out.index && (out.index == out.var || countReferences(out.position, out.var) > 0 ||
+                              countReferences(out.position, out.index) > 0)) {
+                return false;
+            }
+            return true;
+        }
 
-    bool LoopVectorizationAnalyzer::hasLoopCarriedDependencies(
-        const LoopVectorizationPattern &pattern) {
-        // 检查是否有循环携带依赖
-        // 简化版本：检查是否有 a[i] = f(a[i-1]) 这样的模式
+        // 循环体是否只通过这条更新语句读写归约变量 (及位置变量)
+        bool isIsolatedReduction(const clang::Stmt* body, const clang::Stmt* stmt, const ReductionUpdate& update) {
+            if (countReferences(body, update.var) != countReferences(stmt, update.var)) return false;
+            return !update.index || countReferences(body, update.index) == countReferences(stmt, update.index);
+        }
 
-        for (const auto &access: pattern.array_accesses) {
-            if (!access.is_sequential) {
-                // 非顺序访问可能有依赖
-                return true;
+        // 归约变量的标量类型名; 不支持的类型返回空串
+        std::string reductionScalarName(clang::QualType type, clang::ASTContext& ctx) {
+            type = type.getCanonicalType().getUnqualifiedType();
+            if (type->isSpecificBuiltinType(clang::BuiltinType::Float)) return "float";
+            if (type->isSpecificBuiltinType(clang::BuiltinType::Double)) return "double";
+            if (!type->isIntegerType() || type->isBooleanType() || type->isEnumeralType()) return "";
+            uint64_t bits = ctx.getTypeSize(type);
+            if (bits != 8 && bits != 16 && bits != 32 && bits != 64) return "";
+            return std::string(type->isSignedIntegerType() ? "int" : "uint") + std::to_string(bits) + "_t";
+        }
+
+        // 两两合并 count 个部分累加器的顺序: (0,1) (2,3) ... 然后 (0,2) ...; 结果在 0 号
+        std::vector<std::pair<int, int>> treePairs(int count) {
+            std::vector<std::pair<int, int>> pairs;
+            for (int stride = 1; stride < count; stride *= 2) {
+                for (int k = 0; k + stride < count; k += 2 * stride) pairs.push_back({k, k + stride});
             }
+            return pairs;
         }
 
-        // 归约操作本身不阻止向量化（需要特殊处理）
-        if (pattern.is_reduction) {
+    }  // namespace
+
+    bool LoopVectorizationAnalyzer::detectReductionPattern(const clang::ForStmt *loop,
+                                                           LoopVectorizationPattern &pattern) {
+        // 循环体顶层的一条归约更新语句, 归约变量 (及 argmin/argmax 的位置变量) 不在别处读写
+        const clang::Stmt* body = loop->getBody();
+        if (!body) {
             return false;
         }
+        std::vector<const clang::Stmt*> top;
+        if (auto* compound = llvm::dyn_cast<clang::CompoundStmt>(body)) {
+            top.assign(compound->body_begin(), compound->body_end());
+        } else {
+            top.push_back(body);
+        }
+
+        for (const auto* stmt : top) {
+            ReductionUpdate update;
+            if (!matchReductionUpdate(stmt, ast_context, update) || !isIsolatedReduction(body, stmt, update)) {
+                continue;
+            }
+            // argmin/argmax 记录的须是循环变量, 且只支持首次出现 (严格比较)
+            if (update.index) {
+                const clang::VarDecl* position = referencedVariable(update.position);
+                if (!update.strict || !position || position->getNameAsString() != pattern.iterator_name) continue;
+            }
+            std::string scalar = reductionScalarName(update.var->getType(), ast_context);
+            if (scalar.empty()) continue;
+
+            pattern.reduction_var = update.var->getNameAsString();
+            pattern.reduction_op = update.op;
+            pattern.reduction_index_var = update.index ? update.index->getNameAsString() : "";
+            pattern.data_type = scalar;
+            pattern.element_size = static_cast<int>(ast_context.getTypeSize(update.var->getType()) / 8);
+            pattern.reduction_source.clear();
+            auto* subscript = llvm::dyn_cast<clang::ArraySubscriptExpr>(update.value->IgnoreParenImpCasts());
+            if (subscript && update.value->IgnoreParenImpCasts()->getType().getCanonicalType().getUnqualifiedType() ==
+                                 update.var->getType().getCanonicalType().getUnqualifiedType()) {
+                const clang::VarDecl* base = referencedVariable(subscript->getBase());
+                const clang::VarDecl* index = referencedVariable(subscript->getIdx());
+                if (base && index && index->getNameAsString() == pattern.iterator_name) pattern.reduction_source = base->getNameAsString();
+            }
+            return true;
+        }
+        return false;
+    }
 
+    bool LoopVectorizationAnalyzer::hasLoopCarriedDependencies(
+        const LoopVectorizationPattern &pattern) {
+        // 写入的数组: 同一数组上步长或偏移不同的访问跨迭代相交 (a[i] = f(a[i-1]));
+        // 间接写入与同数组的读取之间、下标不定或不含迭代变量的写入都视为依赖.
+        // 同一交错组内的成员 (a[2*i] 与 a[2*i+1]) 不相交
+        for (const auto &write: pattern.array_accesses) {
+            if (!write.is_write) continue;
+            if (write.kind == "irregular" || write.kind == "invariant") return true;
+            for (const auto &other: pattern.array_accesses) {
+                if (&other == &write || other.array_name != write.array_name) continue;
+                if (write.kind == "indexed" || other.kind != write.kind || other.stride != write.stride) return true;
+                if (write.kind == "interleaved" && other.offset / write.stride != write.offset / write.stride) return true;
+                if (write.kind != "interleaved" && other.offset != write.offset) return true;
+            }
+        }
         return false;
     }
 
     bool LoopVectorizationAnalyzer::isVectorizable(const LoopVectorizationPattern &pattern) {
         // 向量化条件:
         // 1. 循环步长为1
-        // 2. 所有数组访问都是顺序的或是归约
+        // 2. 数组访问为连续、交错、常量步长或间接访问 (后两者按 gather/scatter 处理)
         // 3. 没有循环携带依赖(除非是归约)
 
         if (pattern.step != 1) {
@@ -283,14 +611,17 @@ namespace aodsolve {
         }
 
         // 检查所有数组访问
-        bool has_sequential_access = false;
+        bool has_vector_access = false;
         for (const auto &access: pattern.array_accesses) {
-            if (access.is_sequential) {
-                has_sequential_access = true;
+            if (access.kind == "irregular") {
+                return false;
+            }
+            if (access.kind != "invariant") {
+                has_vector_access = true;
             }
         }
 
-        if (!has_sequential_access && !pattern.is_reduction) {
+        if (!has_vector_access && !pattern.is_reduction) {
             return false;
         }
 
@@ -299,9 +630,10 @@ namespace aodsolve {
 
     std::string LoopVectorizationAnalyzer::generateVectorizedCode(
         const LoopVectorizationPattern &pattern,
-        const std::string &target_arch) {
+        const std::string &target_arch,
+        const VectorLoopOptions &options) {
         std::stringstream code;
-        VectorizedCodeGenerator generator;
+        VectorizedCodeGenerator generator(options);
 
         code << "// 向量化循环: " << pattern.iterator_name << " = " << pattern.start_value
                 << " to " << pattern.end_variable << "\n";
@@ -325,130 +657,2908 @@ namespace aodsolve {
     }
 
     // ============================================================================
-    // VectorizedCodeGenerator 实现
+    // 指针对齐分析
     // ============================================================================
 
-    std::string VectorizedCodeGenerator::generateInitialization(
-        const LoopVectorizationPattern &pattern,
-        const std::string &target_arch) {
-        std::stringstream code;
-
-        if (target_arch == "SVE") {
-            code << "svbool_t pg = svptrue_b32();\n";
-            code << "uint64_t vl = svcntw();\n";
-            code << "size_t i = 0;\n";
+    namespace {
 
-            if (pattern.is_reduction) {
-                code << "svint32_t sum_vec = svdup_n_s32(0);\n";
-            }
-        } else if (target_arch == "AVX2") {
-            code << "size_t i = 0;\n";
-            code << "const size_t vl = 8;  // AVX2 处理8个int32\n";
+        const int64_t kMaxAlignment = 4096;     // 超过一页的对齐对向量访问没有意义
 
-            if (pattern.is_reduction) {
-                code << "__m256i sum_vec = _mm256_setzero_si256();\n";
-            }
+        // 最低位的 1 (x 的最大 2 的幂因子); 0 是任何数的倍数
+        int64_t lowestBit(int64_t value) {
+            if (value == 0) return kMaxAlignment;
+            uint64_t bits = static_cast<uint64_t>(value);
+            return static_cast<int64_t>(std::min<uint64_t>(bits & (~bits + 1), kMaxAlignment));
         }
 
-        return code.str();
-    }
-
-    std::string VectorizedCodeGenerator::generateMainLoop(
-        const LoopVectorizationPattern &pattern,
-        const std::string &target_arch) {
-        std::stringstream code;
+        // 按变量收集定义与步进; 作为 posix_memalign 第一个实参的 &p 不算逃逸
+        class AlignmentFactFinder : public clang::RecursiveASTVisitor<AlignmentFactFinder> {
+        public:
+            std::map<const clang::VarDecl*, std::vector<const clang::Expr*>> definitions;
+            std::map<const clang::VarDecl*, const clang::Expr*> allocation_sizes;
+            std::map<const clang::VarDecl*, std::vector<const clang::Expr*>> steps;   // 步进量, 空指针表示 ++ / --
+            std::set<const clang::VarDecl*> escaped;
+            std::set<const clang::Expr*> allocated_refs;
+
+            static const clang::VarDecl* variable(const clang::Expr* expr) {
+                auto* ref = llvm::dyn_cast<clang::DeclRefExpr>(expr->IgnoreParenImpCasts());
+                auto* var = ref ? llvm::dyn_cast<clang::VarDecl>(ref->getDecl()) : nullptr;
+                return var && (var->getType()->isPointerType() || var->getType()->isIntegerType()) ? var : nullptr;
+            }
 
-        if (target_arch == "SVE") {
-            code << "// 主向量化循环\n";
-            code << "while (i + vl <= " << pattern.end_variable << ") {\n";
+            // 绑定到非 const 引用的变量可经引用改写 (T*& r = p; r += 3; 或传给 T*& 形参), 与取地址一样视为逃逸
+            void bindReference(clang::QualType type, const clang::Expr* expr) {
+                if (type.isNull() || !type->isReferenceType() || type->getPointeeType().isConstQualified()) return;
+                if (const clang::VarDecl* var = variable(expr)) escaped.insert(var);
+            }
 
-            // 生成加载指令
-            for (const auto &access: pattern.array_accesses) {
-                if (access.is_read && access.is_sequential) {
-                    code << "    svint32_t " << access.array_name << "_vec = svld1_s32(pg, "
-                            << access.array_name << " + i);\n";
+            bool VisitVarDecl(const clang::VarDecl* var) {
+                if (var->getInit() && (var->getType()->isPointerType() || var->getType()->isIntegerType())) {
+                    definitions[var].push_back(var->getInit());
                 }
+                if (var->getInit()) bindReference(var->getType(), var->getInit());
+                return true;
             }
 
-            // 生成操作指令
-            for (const auto &op: pattern.operations) {
-                if (op.op_type == "add") {
-                    code << "    svint32_t result_vec = svadd_s32_z(pg, vec_a, vec_b);\n";
-                } else if (op.op_type == "add_assign" && pattern.is_reduction) {
-                    code << "    sum_vec = svadd_s32_m(pg, sum_vec, "
-                            << pattern.array_accesses[0].array_name << "_vec);\n";
+            bool VisitCXXConstructExpr(const clang::CXXConstructExpr* construct) {
+                const clang::CXXConstructorDecl* ctor = construct->getConstructor();
+                for (unsigned i = 0; ctor && i < construct->getNumArgs() && i < ctor->getNumParams(); ++i) {
+                    bindReference(ctor->getParamDecl(i)->getType(), construct->getArg(i));
                 }
+                return true;
             }
 
-            // 生成存储指令
-            for (const auto &access: pattern.array_accesses) {
-                if (!access.is_read && access.is_sequential) {
-                    code << "    svst1_s32(pg, " << access.array_name << " + i, result_vec);\n";
+            bool VisitBinaryOperator(const clang::BinaryOperator* op) {
+                const clang::VarDecl* var = variable(op->getLHS());
+                if (!var) return true;
+                if (op->getOpcode() == clang::BO_Assign) {
+                    definitions[var].push_back(op->getRHS());
+                } else if (op->getOpcode() == clang::BO_AddAssign || op->getOpcode() == clang::BO_SubAssign) {
+                    steps[var].push_back(op->getRHS());
+                } else if (op->isCompoundAssignmentOp()) {
+                    escaped.insert(var);    // *= / <<= 等不跟踪
                 }
+                return true;
             }
 
-            code << "    i += vl;\n";
-            code << "}\n";
-        } else if (target_arch == "AVX2") {
-            code << "// 主向量化循环\n";
-            code << "for (; i + vl <= " << pattern.end_variable << "; i += vl) {\n";
+            bool VisitUnaryOperator(const clang::UnaryOperator* op) {
+                const clang::VarDecl* var = variable(op->getSubExpr());
+                if (!var) return true;
+                if (op->isIncrementDecrementOp()) steps[var].push_back(nullptr);
+                if (op->getOpcode() == clang::UO_AddrOf && !allocated_refs.count(op)) escaped.insert(var);
+                return true;
+            }
 
-            // AVX2 类似逻辑
-            for (const auto &access: pattern.array_accesses) {
-                if (access.is_read && access.is_sequential) {
-                    code << "    __m256i " << access.array_name << "_vec = _mm256_loadu_si256"
-                            << "((__m256i*)(" << access.array_name << " + i));\n";
+            // 调用先于其实参访问
+            bool VisitCallExpr(const clang::CallExpr* call) {
+                auto* callee = call->getDirectCallee();
+                // 引用形参: 直接调用按声明, 间接调用按函数指针的原型; 成员运算符的第一个实参是对象本身
+                clang::QualType callee_type = call->getCallee()->getType();
+                if (callee_type->isPointerType()) callee_type = callee_type->getPointeeType();
+                auto* proto = callee_type->getAs<clang::FunctionProtoType>();
+                unsigned first = llvm::isa<clang::CXXOperatorCallExpr>(call) && llvm::isa_and_nonnull<clang::CXXMethodDecl>(callee) ? 1 : 0;
+                for (unsigned i = first; i < call->getNumArgs(); ++i) {
+                    unsigned param = i - first;
+                    if (callee && param < callee->getNumParams()) bindReference(callee->getParamDecl(param)->getType(), call->getArg(i));
+                    else if (!callee && proto && param < proto->getNumParams()) bindReference(proto->getParamType(param), call->getArg(i));
                 }
+                if (!callee || callee->getNameAsString() != "posix_memalign" || call->getNumArgs() < 2) return true;
+                auto* addr = llvm::dyn_cast<clang::UnaryOperator>(call->getArg(0)->IgnoreParenImpCasts());
+                if (!addr || addr->getOpcode() != clang::UO_AddrOf) return true;
+                if (const clang::VarDecl* var = variable(addr->getSubExpr())) {
+                    allocated_refs.insert(addr);
+                    allocation_sizes[var] = call->getArg(1);
+                }
+                return true;
             }
+        };
 
-            if (pattern.is_reduction) {
-                code << "    sum_vec = _mm256_add_epi32(sum_vec, "
-                        << pattern.array_accesses[0].array_name << "_vec);\n";
+    }  // namespace
+
+    AlignmentAnalyzer::AlignmentAnalyzer(clang::ASTContext& ctx, const clang::FunctionDecl* func) : ctx(ctx) {
+        if (!func || !func->hasBody()) return;
+        AlignmentFactFinder finder;
+        finder.TraverseStmt(func->getBody());
+        definitions = std::move(finder.definitions);
+        escaped = std::move(finder.escaped);
+
+        // 步进与分配的对齐在这里一次算好; 整数的步进是倍数, 指针的步进换算成字节.
+        // 步进量引用的其它变量先按最保守的步进 1 计算
+        Visiting none;
+        for (const auto& [var, amounts] : finder.steps) steps[var] = 1;
+        std::map<const clang::VarDecl*, int64_t> computed;
+        for (const auto& [var, amounts] : finder.steps) {
+            int64_t step = kMaxAlignment;
+            for (const auto* amount : amounts) {
+                int64_t multiple = amount ? integerMultiple(amount, none) : 1;
+                if (var->getType()->isPointerType()) multiple = lowestBit(multiple * elementBytes(var->getType()));
+                step = std::min(step, multiple);
+            }
+            computed[var] = step;
+        }
+        steps = std::move(computed);
+        for (const auto& [var, size] : finder.allocation_sizes) {
+            clang::Expr::EvalResult result;
+            if (!size->isValueDependent() && size->EvaluateAsInt(result, ctx)) {
+                allocations[var] = std::max<int64_t>(1, lowestBit(result.Val.getInt().getExtValue()));
+            } else {
+                escaped.insert(var);
             }
+        }
+    }
 
-            code << "}\n";
+    const clang::FunctionDecl* AlignmentAnalyzer::enclosingFunction(const clang::Stmt* stmt, clang::ASTContext& ctx) {
+        clang::DynTypedNode node = clang::DynTypedNode::create(*stmt);
+        while (true) {
+            auto parents = ctx.getParents(node);
+            if (parents.empty()) return nullptr;
+            node = parents[0];
+            if (auto* func = node.get<clang::FunctionDecl>()) return func;
         }
+    }
 
-        return code.str();
+    int64_t AlignmentAnalyzer::alignmentOf(const clang::Expr* expr) const {
+        Visiting visiting;
+        return std::max<int64_t>(1, pointerAlignment(expr, visiting));
     }
 
-    std::string VectorizedCodeGenerator::generateTailLoop(
-        const LoopVectorizationPattern &pattern,
-        const std::string &target_arch) {
-        std::stringstream code;
+    int64_t AlignmentAnalyzer::alignmentOf(const clang::VarDecl* var) const {
+        Visiting visiting;
+        return std::max<int64_t>(1, variableAlignment(var, visiting));
+    }
 
-        if (target_arch == "SVE") {
-            code << "// 尾部处理\n";
-            code << "if (i < " << pattern.end_variable << ") {\n";
-            code << "    svbool_t pg_tail = svwhilelt_b32(i, " << pattern.end_variable << ");\n";
-            code << "    // 使用 pg_tail 处理剩余元素\n";
-            code << "}\n";
-        } else if (target_arch == "AVX2") {
-            code << "// 标量尾部处理\n";
-            code << "for (; i < " << pattern.end_variable << "; i++) {\n";
-            code << "    // 标量处理\n";
-            code << "}\n";
+    int64_t AlignmentAnalyzer::multipleOf(const clang::Expr* expr) const {
+        Visiting visiting;
+        return std::max<int64_t>(1, integerMultiple(expr, visiting));
+    }
+
+    // 所指类型的自然对齐; 向量类型的指针常被用于非对齐的 loadu/storeu, 不据此推断
+    int64_t AlignmentAnalyzer::naturalAlignment(clang::QualType pointer) const {
+        if (!pointer->isPointerType()) return 1;
+        clang::QualType pointee = pointer->getPointeeType();
+        if (pointee->isIncompleteType() || pointee->isVectorType() || pointee->isFunctionType()) return 1;
+        return std::min<int64_t>(ctx.getTypeAlignInChars(pointee).getQuantity(), kMaxAlignment);
+    }
+
+    int64_t AlignmentAnalyzer::elementBytes(clang::QualType pointer) const {
+        if (!pointer->isPointerType()) return 1;
+        clang::QualType pointee = pointer->getPointeeType();
+        if (pointee->isVoidType()) return 1;    // GNU 扩展: void* 按字节运算
+        if (pointee->isIncompleteType() || pointee->isFunctionType()) return 1;
+        return ctx.getTypeSizeInChars(pointee).getQuantity();
+    }
+
+    int64_t AlignmentAnalyzer::pointerAlignment(const clang::Expr* expr, Visiting& visiting) const {
+        expr = expr->IgnoreParens();
+        // 指针间的转换不改变地址, 也不因目标类型获得更高的对齐
+        if (auto* cast = llvm::dyn_cast<clang::CastExpr>(expr)) {
+            switch (cast->getCastKind()) {
+            case clang::CK_BitCast:
+            case clang::CK_NoOp:
+            case clang::CK_LValueToRValue:
+            case clang::CK_ArrayToPointerDecay:
+                return pointerAlignment(cast->getSubExpr(), visiting);
+            default:
+                return naturalAlignment(expr->getType());
+            }
+        }
+        if (auto* ref = llvm::dyn_cast<clang::DeclRefExpr>(expr)) {
+            auto* var = llvm::dyn_cast<clang::VarDecl>(ref->getDecl());
+            return var ? variableAlignment(var, visiting) : 1;
+        }
+        if (auto* unary = llvm::dyn_cast<clang::UnaryOperator>(expr)) {
+            if (unary->getOpcode() != clang::UO_AddrOf) return naturalAlignment(expr->getType());
+            const clang::Expr* target = unary->getSubExpr()->IgnoreParens();
+            if (auto* subscript = llvm::dyn_cast<clang::ArraySubscriptExpr>(target)) {
+                // &a[k]: 基址对齐与偏移字节数的公共部分
+                const clang::Expr* base = subscript->getBase();
+                int64_t bytes = lowestBit(integerMultiple(subscript->getIdx(), visiting) * elementBytes(base->getType()));
+                return std::min(pointerAlignment(base, visiting), bytes);
+            }
+            if (auto* ref = llvm::dyn_cast<clang::DeclRefExpr>(target)) {
+                return std::min<int64_t>(ctx.getDeclAlign(ref->getDecl()).getQuantity(), kMaxAlignment);
+            }
+            return naturalAlignment(expr->getType());
+        }
+        if (auto* binary = llvm::dyn_cast<clang::BinaryOperator>(expr)) {
+            if (binary->getOpcode() != clang::BO_Add && binary->getOpcode() != clang::BO_Sub) return naturalAlignment(expr->getType());
+            bool pointer_left = binary->getLHS()->getType()->isPointerType();
+            const clang::Expr* base = pointer_left ? binary->getLHS() : binary->getRHS();
+            const clang::Expr* offset = pointer_left ? binary->getRHS() : binary->getLHS();
+            if (!base->getType()->isPointerType() || offset->getType()->isPointerType()) return 1;
+            int64_t bytes = lowestBit(integerMultiple(offset, visiting) * elementBytes(base->getType()));
+            return std::min(pointerAlignment(base, visiting), bytes);
         }
+        if (auto* choice = llvm::dyn_cast<clang::ConditionalOperator>(expr)) {
+            return std::min(pointerAlignment(choice->getTrueExpr(), visiting), pointerAlignment(choice->getFalseExpr(), visiting));
+        }
+        if (llvm::isa<clang::CXXNewExpr>(expr)) {
+            int64_t global = ctx.getTargetInfo().getNewAlign() / 8;
+            return std::min(std::max(global, naturalAlignment(expr->getType())), kMaxAlignment);
+        }
+        if (auto* call = llvm::dyn_cast<clang::CallExpr>(expr)) {
+            auto* callee = call->getDirectCallee();
+            std::string name = callee ? callee->getNameAsString() : "";
+            auto constantArg = [&](unsigned index) -> int64_t {
+                clang::Expr::EvalResult result;
+                const clang::Expr* arg = index < call->getNumArgs() ? call->getArg(index) : nullptr;
+                if (!arg || arg->isValueDependent() || !arg->EvaluateAsInt(result, ctx)) return 1;
+                return std::max<int64_t>(1, lowestBit(result.Val.getInt().getExtValue()));
+            };
+            if (name == "__builtin_assume_aligned") {
+                // 第三个实参为偏移: (p - off) 按 N 对齐
+                int64_t align = constantArg(1);
+                if (call->getNumArgs() > 2) align = std::min(align, lowestBit(integerMultiple(call->getArg(2), visiting)));
+                return std::max(align, pointerAlignment(call->getArg(0), visiting));
+            }
+            if (name == "aligned_alloc" || name == "memalign") return constantArg(0);
+            if (name == "_mm_malloc") return constantArg(1);
+            if (name == "malloc" || name == "calloc" || name == "realloc") {
+                return std::min<int64_t>(ctx.getTargetInfo().getNewAlign() / 8, kMaxAlignment);
+            }
+        }
+        return naturalAlignment(expr->getType());
+    }
 
-        return code.str();
+    int64_t AlignmentAnalyzer::variableAlignment(const clang::VarDecl* var, Visiting& visiting) const {
+        // 数组的首地址就是对象地址, 对齐含 alignas
+        if (var->getType()->isArrayType()) return std::min<int64_t>(ctx.getDeclAlign(var).getQuantity(), kMaxAlignment);
+        if (!var->getType()->isPointerType()) return 1;
+        int64_t natural = naturalAlignment(var->getType());
+        if (escaped.count(var) || var->hasGlobalStorage()) return natural;
+        // 环上的定义 (p = p + 16) 取乐观值, 由环外的定义限定
+        if (!visiting.insert(var).second) return kMaxAlignment;
+
+        int64_t align = kMaxAlignment;
+        auto defs = definitions.find(var);
+        bool defined = defs != definitions.end() && !defs->second.empty();
+        if (defined) {
+            for (const auto* def : defs->second) align = std::min(align, pointerAlignment(def, visiting));
+        }
+        auto allocation = allocations.find(var);
+        if (allocation != allocations.end()) {
+            align = defined ? std::min(align, allocation->second) : allocation->second;
+            defined = true;
+        }
+        if (auto* param = llvm::dyn_cast<clang::ParmVarDecl>(var)) {
+            int64_t entry = 1;
+            if (auto* attr = param->getAttr<clang::AlignValueAttr>()) {
+                clang::Expr::EvalResult result;
+                if (attr->getAlignment()->EvaluateAsInt(result, ctx)) entry = lowestBit(result.Val.getInt().getExtValue());
+            }
+            align = std::min(align, entry);
+            defined = true;
+        }
+        if (!defined) align = 1;
+        auto step = steps.find(var);
+        if (step != steps.end()) align = std::min(align, step->second);
+        visiting.erase(var);
+        return std::max(align, natural);
     }
 
-    std::string VectorizedCodeGenerator::generateReduction(
-        const LoopVectorizationPattern &pattern,
-        const std::string &target_arch) {
-        std::stringstream code;
+    int64_t AlignmentAnalyzer::integerMultiple(const clang::Expr* expr, Visiting& visiting) const {
+        expr = expr->IgnoreParenImpCasts();
+        clang::Expr::EvalResult result;
+        if (!expr->isValueDependent() && expr->EvaluateAsInt(result, ctx)) return lowestBit(result.Val.getInt().getExtValue());
+        if (auto* cast = llvm::dyn_cast<clang::CastExpr>(expr)) {
+            return cast->getType()->isIntegerType() ? integerMultiple(cast->getSubExpr(), visiting) : 1;
+        }
+        if (auto* ref = llvm::dyn_cast<clang::DeclRefExpr>(expr)) {
+            auto* var = llvm::dyn_cast<clang::VarDecl>(ref->getDecl());
+            return var ? variableMultiple(var, visiting) : 1;
+        }
+        if (auto* binary = llvm::dyn_cast<clang::BinaryOperator>(expr)) {
+            int64_t lhs = integerMultiple(binary->getLHS(), visiting);
+            switch (binary->getOpcode()) {
+            case clang::BO_Add:
+            case clang::BO_Sub:
+                return std::min(lhs, integerMultiple(binary->getRHS(), visiting));
+            case clang::BO_Mul:
+                return std::min(lhs * integerMultiple(binary->getRHS(), visiting), kMaxAlignment);
+            case clang::BO_Shl: {
+                if (binary->getRHS()->isValueDependent() || !binary->getRHS()->EvaluateAsInt(result, ctx)) return 1;
+                int64_t shift = result.Val.getInt().getExtValue();
+                return shift < 0 || shift > 12 ? 1 : std::min(lhs << shift, kMaxAlignment);
+            }
+            case clang::BO_And:
+                return std::max(lhs, integerMultiple(binary->getRHS(), visiting));
+            default:
+                return 1;
+            }
+        }
+        return 1;
+    }
 
-        if (target_arch == "SVE") {
-            code << "// 水平归约\n";
-            code << pattern.reduction_var << " = svaddv_s32(svptrue_b32(), sum_vec);\n";
-        } else if (target_arch == "AVX2") {
-            code << "// 水平归约\n";
-            code << "int temp[8];\n";
-            code << "_mm256_storeu_si256((__m256i*)temp, sum_vec);\n";
-            code << pattern.reduction_var << " = 0;\n";
-            code << "for (int j = 0; j < 8; j++) " << pattern.reduction_var << " += temp[j];\n";
+    int64_t AlignmentAnalyzer::variableMultiple(const clang::VarDecl* var, Visiting& visiting) const {
+        if (!var->getType()->isIntegerType() || escaped.count(var) || var->hasGlobalStorage() || llvm::isa<clang::ParmVarDecl>(var)) return 1;
+        auto defs = definitions.find(var);
+        if (defs == definitions.end() || defs->second.empty()) return 1;
+        if (!visiting.insert(var).second) return kMaxAlignment;
+        int64_t multiple = kMaxAlignment;
+        for (const auto* def : defs->second) multiple = std::min(multiple, integerMultiple(def, visiting));
+        auto step = steps.find(var);
+        if (step != steps.end()) multiple = std::min(multiple, step->second);
+        visiting.erase(var);
+        return multiple;
+    }
+
+    // ============================================================================
+    // NEON / SVE 循环生成
+    // ============================================================================
+
+    namespace {
+
+        // 向量寄存器中的元素类型 (NEON 128 位, SVE 长度无关).
+        // 8/16 位整数在 C 中先提升为 int 再运算, 这些通道只做不经运算的搬移 (读写、交错拆分与合并、常量与不变量、按条件选择),
+        // 提升后的运算需要加宽到更宽的通道, 暂不支持
+        struct VectorElementType {
+            const char* scalar;
+            const char* vector;
+            const char* suffix;
+            const char* mask;           // 比较结果: 每通道全 0 / 全 1
+            const char* mask_suffix;
+            const char* sve_vector;
+            int bits;
+            bool is_float;
+            bool is_signed;
+        };
+
+        const VectorElementType kVectorElementTypes[] = {
+            {"float", "float32x4_t", "f32", "uint32x4_t", "u32", "svfloat32_t", 32, true, true},
+            {"double", "float64x2_t", "f64", "uint64x2_t", "u64", "svfloat64_t", 64, true, true},
+            {"int32_t", "int32x4_t", "s32", "uint32x4_t", "u32", "svint32_t", 32, false, true},
+            {"uint32_t", "uint32x4_t", "u32", "uint32x4_t", "u32", "svuint32_t", 32, false, false},
+            {"int8_t", "int8x16_t", "s8", "uint8x16_t", "u8", "svint8_t", 8, false, true},
+            {"uint8_t", "uint8x16_t", "u8", "uint8x16_t", "u8", "svuint8_t", 8, false, false},
+            {"int16_t", "int16x8_t", "s16", "uint16x8_t", "u16", "svint16_t", 16, false, true},
+            {"uint16_t", "uint16x8_t", "u16", "uint16x8_t", "u16", "svuint16_t", 16, false, false},
+        };
+        const int kNeonRegisterBits = 128;
+        const int kSveMinimumBits = 128;        // 代价估计按最短的 SVE 向量计
+        const int64_t kMaxInterleave = 4;       // vld2q..vld4q / svld2..svld4 的最大组宽
+        const int64_t kVectorAlignment = 16;    // 对齐提示按 128 位; SVE 的向量字节数是其整数倍, 逐向量步进不破坏对齐
+
+        const VectorElementType* vectorElementType(clang::QualType type, clang::ASTContext& ctx) {
+            type = type.getCanonicalType().getUnqualifiedType();
+            if (type->isSpecificBuiltinType(clang::BuiltinType::Float)) return &kVectorElementTypes[0];
+            if (type->isSpecificBuiltinType(clang::BuiltinType::Double)) return &kVectorElementTypes[1];
+            if (type->isIntegerType() && !type->isBooleanType() && !type->isEnumeralType()) {
+                const int bits = static_cast<int>(ctx.getTypeSize(type));
+                for (const auto& candidate : kVectorElementTypes) {
+                    if (!candidate.is_float && candidate.bits == bits && candidate.is_signed == type->isSignedIntegerType()) return &candidate;
+                }
+            }
+            return nullptr;
         }
 
-        return code.str();
+        // NEON 运算名到 SVE 的对应; SVE 形式另带谓词与 _x 后缀
+        const char* sveName(const std::string& neon) {
+            static const std::map<std::string, const char*> names = {
+                {"vaddq", "svadd"}, {"vsubq", "svsub"}, {"vmulq", "svmul"}, {"vdivq", "svdiv"},
+                {"vandq", "svand"}, {"vorrq", "svorr"}, {"veorq", "sveor"}, {"vmvnq", "svnot"}, {"vnegq", "svneg"},
+                {"vminq", "svmin"}, {"vmaxq", "svmax"}, {"vminnmq", "svminnm"}, {"vmaxnmq", "svmaxnm"},
+                {"vcltq", "svcmplt"}, {"vcgtq", "svcmpgt"}, {"vcleq", "svcmple"}, {"vcgeq", "svcmpge"}, {"vceqq", "svcmpeq"},
+            };
+            auto it = names.find(neon);
+            return it == names.end() ? "" : it->second;
+        }
+
+        std::string printExpr(const clang::Stmt* stmt, clang::ASTContext& ctx) {
+            std::string text;
+            llvm::raw_string_ostream os(text);
+            stmt->printPretty(os, nullptr, ctx.getPrintingPolicy());
+            return os.str();
+        }
+
+        // 在第 level 层 (每层 4 空格) 打印一条语句, 表达式语句补分号
+        // StmtPrinter 每个缩进单位输出 2 个空格, 默认策略的嵌套步长为 2 个单位
+        std::string printStatement(const clang::Stmt* stmt, clang::ASTContext& ctx, unsigned level) {
+            std::string text;
+            llvm::raw_string_ostream os(text);
+            if (llvm::isa<clang::Expr>(stmt)) {
+                os << std::string(level * 4, ' ');
+                stmt->printPretty(os, nullptr, ctx.getPrintingPolicy());
+                os << ";\n";
+            } else {
+                stmt->printPretty(os, nullptr, ctx.getPrintingPolicy(), level * 2);
+            }
+            return os.str();
+        }
+
+        // 原循环体逐条打印到 level 层缩进
+        std::string printLoopBody(const clang::Stmt* body, clang::ASTContext& ctx, unsigned level) {
+            std::string text;
+            if (auto* compound = llvm::dyn_cast_or_null<clang::CompoundStmt>(body)) {
+                for (const auto* child : compound->body()) text += printStatement(child, ctx, level);
+            } else if (body) {
+                text += printStatement(body, ctx, level);
+            }
+            return text;
+        }
+
+        // 整数除法/取模在条件分支外提前求值可能触发除零
+        bool hasIntegerDivision(const clang::Stmt* stmt) {
+            if (!stmt) return false;
+            if (auto* binary = llvm::dyn_cast<clang::BinaryOperator>(stmt)) {
+                auto opcode = binary->getOpcode();
+                bool division = opcode == clang::BO_Div || opcode == clang::BO_Rem || opcode == clang::BO_DivAssign || opcode == clang::BO_RemAssign;
+                if (division && binary->getType()->isIntegerType()) return true;
+            }
+            for (const auto* child : stmt->children()) {
+                if (hasIntegerDivision(child)) return true;
+            }
+            return false;
+        }
+
+        bool isSimpleOperand(const std::string& text) {
+            return !text.empty() && std::all_of(text.begin(), text.end(), [](char c) {
+                return std::isalnum(static_cast<unsigned char>(c)) || c == '_' || c == '.';
+            });
+        }
+
+        // 地址拆成基址与下标: base + index, base (index 为空)
+        void splitAddress(const clang::Expr* addr, const clang::Expr*& base, const clang::Expr*& index) {
+            addr = addr->IgnoreParenImpCasts();
+            auto* add = llvm::dyn_cast<clang::BinaryOperator>(addr);
+            if (add && add->getOpcode() == clang::BO_Add) {
+                bool pointer_left = add->getLHS()->getType()->isPointerType();
+                base = pointer_left ? add->getLHS() : add->getRHS();
+                index = pointer_left ? add->getRHS() : add->getLHS();
+            } else {
+                base = addr;
+            }
+        }
+
+        // 内存访问拆成基址与下标: base[index], *(base + index), *base (index 为空);
+        // 结构体成员 p[j].x, (p + j)->x, p->x 拆出记录数组的基址与下标
+        bool splitAccess(const clang::Expr* expr, const clang::Expr*& base, const clang::Expr*& index) {
+            base = nullptr;
+            index = nullptr;
+            if (auto* subscript = llvm::dyn_cast<clang::ArraySubscriptExpr>(expr)) {
+                base = subscript->getBase();
+                index = subscript->getIdx();
+            } else if (auto* unary = llvm::dyn_cast<clang::UnaryOperator>(expr); unary && unary->getOpcode() == clang::UO_Deref) {
+                splitAddress(unary->getSubExpr(), base, index);
+            } else if (auto* member = llvm::dyn_cast<clang::MemberExpr>(expr)) {
+                const clang::Expr* object = member->getBase()->IgnoreParens();
+                if (member->isArrow()) splitAddress(object, base, index);
+                else if (!llvm::isa<clang::MemberExpr>(object)) splitAccess(object, base, index);
+            }
+            return base != nullptr;
+        }
+
+        // 间接访问的两个基址不重叠: 一方是 restrict 指针, 或两者都是数组对象 (非形参)
+        bool provablyDisjoint(const clang::VarDecl* a, const clang::VarDecl* b) {
+            if (a == b) return false;
+            if (a->getType().isRestrictQualified() || b->getType().isRestrictQualified()) return true;
+            return a->getType()->isArrayType() && b->getType()->isArrayType() &&
+                   !llvm::isa<clang::ParmVarDecl>(a) && !llvm::isa<clang::ParmVarDecl>(b);
+        }
+
+        class VectorLoopEmitter {
+        public:
+            VectorLoopEmitter(const clang::ForStmt* loop, clang::ASTContext& ctx, const VectorLoopOptions& options, bool sve)
+                : loop(loop), ctx(ctx), unroll(std::max(1, options.unroll)), reassociate_fp(options.reassociate_fp),
+                  align_peel_trip(options.align_peel_trip), streaming_bytes(options.streaming_bytes),
+                  prefetch_distance(options.prefetch_distance), sve(sve), prefix(sve ? "sve_" : "neon_"),
+                  alignment(ctx, AlignmentAnalyzer::enclosingFunction(loop, ctx)) {}
+
+            std::string emit(std::string& reason);
+
+            std::string memory_note;                // 访存层次改写的说明 (非临时存储 / 预取), 未改写时为空
+
+        private:
+            // 内联展开时形参 -> 实参 (实参在外层绑定中求值)
+            struct Bindings {
+                std::map<const clang::ParmVarDecl*, const clang::Expr*> args;
+                const Bindings* parent = nullptr;
+            };
+            // 访问流: 归纳指针 base[offset], 或不变基址 base[stride * j + offset];
+            // stride 为 2..4 时是交错组 (offset 为组起点, 成员整组读写), 更大的步长逐元素 gather/scatter;
+            // index 非空为间接访问 base[index[j + offset]], induction 此时指下标数组
+            struct Stream {
+                const clang::VarDecl* base = nullptr;
+                int64_t offset = 0;
+                int64_t stride = 1;
+                const clang::VarDecl* index = nullptr;
+                int index_bits = 0;
+                bool index_signed = false;
+                bool induction = false;
+                bool loaded = false;
+                bool stored = false;
+            };
+            struct Value {
+                std::string code;
+                bool mask = false;
+            };
+            // 顶层归约语句: 每个展开副本一个部分累加器 (name_vN), argmin/argmax 另有位置累加器 name_idx_vN;
+            // ordered 为 SVE 上不重结合的浮点 sum, 用 svadda 直接按元素顺序累加到原变量
+            struct Reduction {
+                const clang::Stmt* stmt;
+                ReductionUpdate update;
+                std::string name;
+                bool ordered = false;
+            };
+
+            const clang::ForStmt* loop;
+            clang::ASTContext& ctx;
+            int unroll;
+            bool reassociate_fp;
+            int64_t align_peel_trip;
+            int64_t streaming_bytes;
+            int64_t prefetch_distance;
+            const bool sve;
+            const std::string prefix;               // 生成名字的前缀: neon_ / sve_
+            AlignmentAnalyzer alignment;
+            const VectorElementType* element = nullptr;
+            int lanes = 0;                          // NEON 通道数; SVE 为最短向量的通道数, 只用于代价估计
+
+            const clang::VarDecl* iterator = nullptr;
+            bool declares_iterator = false;
+            std::string start_text;
+            int64_t start_multiple = 1;             // 起始值必为其倍数的 2 的幂
+            std::string remaining;                  // 剩余迭代数 (仅在 j < n 时求值)
+            std::set<const clang::VarDecl*> locals;
+            std::set<const clang::VarDecl*> modified;
+            std::map<const clang::VarDecl*, int64_t> inductions;    // 指针归纳变量 -> 每次迭代的步长
+            std::vector<Stream> streams;
+            std::vector<Reduction> reductions;
+            std::vector<std::string> points;        // 外提读取的不变内存位置, 须与写入流不重叠
+            // 流的位置 (基址, 偏移, 步长, 下标数组); 条件执行的整向量加载只允许落在每次迭代都无条件访问的位置上,
+            // 混合存储会写回未选中的通道, 只允许落在每次迭代都无条件写入的位置上 (只读的位置整向量写回会与其它线程的写入竞争)
+            using Location = std::tuple<const clang::VarDecl*, int64_t, int64_t, const clang::VarDecl*>;
+            std::set<Location> touched;
+            std::set<Location> written;
+            std::map<Location, std::string> guarded;   // 条件访问的位置 -> load / store (有条件存储时记 store)
+            std::map<Location, std::set<int64_t>> members;     // 交错组中被无条件访问的成员
+            struct Hoisted {
+                std::string value;
+                std::string name;
+                std::string type;
+            };
+            std::vector<Hoisted> hoisted;           // 进入向量循环前广播一次的常量与不变量
+            std::map<const clang::VarDecl*, std::string> local_names;
+            std::string failure;
+            // gather/scatter 的代价检查: 副本 0 的向量运算数与每次标量迭代的运算数
+            bool irregular = false;
+            int vector_work = 0;
+            int scalar_work = 0;
+
+            // 当前展开副本的翻译状态
+            int copy = 0;
+            int temp_count = 0;
+            int conditional = 0;                    // >0 表示处于 ?: / && / || 的条件求值分支
+            int depth = 0;
+            std::string mask;                       // 当前 if 嵌套的执行掩码, 空表示全部通道
+            std::map<const clang::VarDecl*, int64_t> advanced;   // 本次迭代中归纳指针已自增的次数
+            std::map<std::pair<Location, std::string>, std::string> group_loads;   // 交错组整组读取 (按谓词区分)
+            std::map<Location, std::map<int64_t, std::string>> group_stores;        // 交错组中等待整组写出的成员
+            std::vector<std::string> lines;
+
+            bool fail(const std::string& reason) {
+                if (failure.empty()) failure = reason;
+                return false;
+            }
+            // 8/16 位整数通道: C 中的运算先提升为 int, 只能做搬移
+            bool promotes() const { return !element->is_float && element->bits < 32; }
+            bool failPromoted() {
+                return fail("computes on " + std::to_string(element->bits) + "-bit lanes after integer promotion (widening to wider lanes is not supported)");
+            }
+
+            bool analyzeControl();
+            bool analyzeBody();
+            bool isInductionStep(const clang::Stmt* stmt, const clang::VarDecl*& var, int64_t& step) const;
+            bool translateStatement(const clang::Stmt* stmt);
+            bool translateAssignment(const clang::BinaryOperator* assign);
+            bool translateReduction(const Reduction& reduction);
+            bool translateClamp(const clang::IfStmt* branch, bool& matched);
+            void recordAccess(const Stream& stream, int64_t member, const std::string& kind);
+            bool isReductionVariable(const clang::VarDecl* var) const;
+            std::string reductionSetup(const std::string& indent) const;
+            std::string reductionCombine(const std::string& indent);
+            const char* reductionStep(const std::string& kind) const;
+            std::string laneFold(const std::string& vector, const std::string& suffix, int count, const char* symbol) const;
+            bool translate(const clang::Expr* expr, const Bindings* bindings, Value& out);
+            bool translateBinary(const clang::BinaryOperator* binary, const Bindings* bindings, Value& out);
+            bool translateCall(const clang::CallExpr* call, const Bindings* bindings, Value& out);
+            bool divideByConstant(const clang::Expr* divisor, const std::string& dividend, bool remainder, Value& out);
+            bool isInvariant(const clang::Expr* expr, const Bindings* bindings, std::vector<std::string>& reads);
+            bool classifyAccess(const clang::Expr* expr, const Bindings* bindings, Stream& stream, int64_t& member);
+            bool classifyIndexed(const clang::VarDecl* var, const clang::Expr* index, const Bindings* bindings, Stream& stream);
+            bool parseIndex(const clang::Expr* expr, const Bindings* bindings, int64_t& scale, int64_t& offset);
+            const clang::VarDecl* resolveVariable(const clang::Expr* expr, const Bindings* bindings) const;
+            bool lookupBinding(const clang::VarDecl* var, const Bindings* bindings, const clang::Expr*& arg, const Bindings*& outer) const;
+            std::string render(const clang::Expr* expr, const Bindings* bindings);
+            bool constant(const clang::Expr* expr, Value& out);
+            std::string hoist(const std::string& value, const std::string& type);
+            std::string temporary(const std::string& type, const std::string& value);
+            void registerStream(const Stream& stream);
+            Stream indexStream(const Stream& stream) const;
+            std::string baseName(const Stream& stream) const;
+            std::string address(const Stream& stream, int copy_index) const;
+            std::string elementAt(const Stream& stream, int copy_index, int lane) const;
+            bool load(Stream stream, int64_t member, Value& out);
+            bool store(Stream stream, int64_t member, const std::string& value);
+            bool storeGroup(const Stream& stream, int64_t member, const std::string& value);
+            bool gatherIndices(const Stream& stream, std::string& form, std::string& indices);
+            std::string aliasCheck() const;
+            // 连续流在循环入口的已知对齐字节数; 归纳指针与间接访问返回 1
+            int64_t entryAlignment(const Stream& stream) const;
+            // 入口已对齐的连续流在副本中的地址加 __builtin_assume_aligned; 按选项生成剥离循环, 返回其代码
+            std::string alignStreams(std::vector<std::vector<std::string>>& copies, std::string& summary) const;
+            // 工作集达到 streaming_bytes 时的主循环: 只写的连续流改为非临时存储, 读取流提前 prefetch_distance 字节预取.
+            // 改写 copies 中的存储, 填写进入条件与每次迭代的预取语句; 不适用时返回 false
+            bool planStreaming(std::vector<std::vector<std::string>>& copies, std::string& guard,
+                               std::vector<std::string>& prefetches, std::string& summary);
+            bool isElement(clang::QualType type) const;
+
+            static Location locationOf(const Stream& stream) {
+                return Location(stream.base, stream.offset, stream.stride, stream.index);
+            }
+            void charge(int units) {
+                if (copy == 0) vector_work += units;
+            }
+
+            const char* target() const { return sve ? "SVE" : "NEON"; }
+
+            // 指令按目标拼写: NEON 为 q 寄存器形式; SVE 数据运算带循环谓词 (_x), 比较结果为 svbool_t
+            std::string vectorType() const { return sve ? element->sve_vector : element->vector; }
+            std::string maskType() const { return sve ? "svbool_t" : element->mask; }
+            std::string predicate() const { return mask.empty() ? prefix + "pg" : mask; }
+            std::string groupType(int64_t count) const {
+                std::string type = vectorType();
+                return type.substr(0, type.size() - 2) + "x" + std::to_string(count) + "_t";
+            }
+            std::string op(const char* name) const { return std::string(name) + "_" + element->suffix; }
+            std::string maskOp(const char* name) const { return std::string(name) + "_" + element->mask_suffix; }
+            std::string arith(const char* name, const std::string& a, const std::string& b) {
+                charge(1);
+                if (sve) return std::string(sveName(name)) + "_" + element->suffix + "_x(" + prefix + "pg, " + a + ", " + b + ")";
+                return op(name) + "(" + a + ", " + b + ")";
+            }
+            std::string unary(const char* name, const std::string& a) {
+                charge(1);
+                if (sve) return std::string(sveName(name)) + "_" + element->suffix + "_x(" + prefix + "pg, " + a + ")";
+                return op(name) + "(" + a + ")";
+            }
+            std::string compare(const char* name, const std::string& a, const std::string& b) {
+                charge(1);
+                if (sve) return std::string(sveName(name)) + "_" + element->suffix + "(" + prefix + "pg, " + a + ", " + b + ")";
+                return op(name) + "(" + a + ", " + b + ")";
+            }
+            std::string select(const std::string& m, const std::string& a, const std::string& b) {
+                charge(1);
+                return (sve ? std::string("svsel_") + element->suffix : op("vbslq")) + "(" + m + ", " + a + ", " + b + ")";
+            }
+            std::string maskSelect(const std::string& m, const std::string& a, const std::string& b) {
+                charge(1);
+                return (sve ? std::string("svsel_b") : maskOp("vbslq")) + "(" + m + ", " + a + ", " + b + ")";
+            }
+            // SVE 的谓词运算取零 (_z) 形式, 结果不超出循环谓词
+            std::string maskAnd(const std::string& a, const std::string& b) {
+                charge(1);
+                return sve ? "svand_b_z(" + prefix + "pg, " + a + ", " + b + ")" : maskOp("vandq") + "(" + a + ", " + b + ")";
+            }
+            std::string maskOr(const std::string& a, const std::string& b) {
+                charge(1);
+                return sve ? "svorr_b_z(" + prefix + "pg, " + a + ", " + b + ")" : maskOp("vorrq") + "(" + a + ", " + b + ")";
+            }
+            std::string maskNot(const std::string& value) {
+                charge(1);
+                if (sve) return "svnot_b_z(" + prefix + "pg, " + value + ")";
+                if (element->bits != 64) return maskOp("vmvnq") + "(" + value + ")";
+                return "vreinterpretq_u64_u32(vmvnq_u32(vreinterpretq_u32_u64(" + value + ")))";
+            }
+            // 掩码通道全 1 的常量
+            std::string allOnes() const {
+                switch (element->bits) {
+                    case 8: return "0xFFu";
+                    case 16: return "0xFFFFu";
+                    case 32: return "0xFFFFFFFFu";
+                    default: return "~0ULL";
+                }
+            }
+            std::string sveCount() const {
+                switch (element->bits) {
+                    case 8: return "svcntb";
+                    case 16: return "svcnth";
+                    case 32: return "svcntw";
+                    default: return "svcntd";
+                }
+            }
+            std::string splat(const std::string& value) const {
+                return (sve ? std::string("svdup_n_") + element->suffix : op("vdupq_n")) + "(" + value + ")";
+            }
+            // 布尔不变量广播为掩码; SVE 的谓词在使用处与循环谓词相与
+            std::string maskSplat(const std::string& value) const {
+                if (sve) return "svdup_n_b" + std::to_string(element->bits) + "(" + value + ")";
+                return maskOp("vdupq_n") + "(" + value + " ? " + allOnes() + " : 0)";
+            }
+            std::string shift(bool left, const std::string& a, int64_t bits) {
+                charge(1);
+                if (!sve) return op(left ? "vshlq_n" : "vshrq_n") + "(" + a + ", " + std::to_string(bits) + ")";
+                const char* name = left ? "svlsl_n_" : element->is_signed ? "svasr_n_" : "svlsr_n_";
+                return name + std::string(element->suffix) + "_x(" + prefix + "pg, " + a + ", " + std::to_string(bits) + ")";
+            }
+        };
+
+        bool VectorLoopEmitter::isElement(clang::QualType type) const {
+            return vectorElementType(type, ctx) == element;
+        }
+
+        bool VectorLoopEmitter::analyzeControl() {
+            // for (T j = start; j < n; j++), n 为循环不变量
+            const clang::Stmt* init = loop->getInit();
+            if (auto* decl = llvm::dyn_cast_or_null<clang::DeclStmt>(init)) {
+                auto* var = decl->isSingleDecl() ? llvm::dyn_cast<clang::VarDecl>(decl->getSingleDecl()) : nullptr;
+                if (var && var->hasInit()) {
+                    iterator = var;
+                    declares_iterator = true;
+                    start_text = printExpr(var->getInit(), ctx);
+                    start_multiple = alignment.multipleOf(var->getInit());
+                }
+            } else if (auto* assign = llvm::dyn_cast_or_null<clang::BinaryOperator>(init)) {
+                auto* ref = llvm::dyn_cast<clang::DeclRefExpr>(assign->getLHS()->IgnoreParenImpCasts());
+                if (assign->getOpcode() == clang::BO_Assign && ref) {
+                    iterator = llvm::dyn_cast<clang::VarDecl>(ref->getDecl());
+                    start_text = printExpr(assign->getRHS(), ctx);
+                    start_multiple = alignment.multipleOf(assign->getRHS());
+                }
+            }
+            if (!iterator || !iterator->getType()->isIntegerType()) return fail("loop init is not 'i = start'");
+
+            auto refersToIterator = [this](const clang::Expr* expr) {
+                auto* ref = llvm::dyn_cast<clang::DeclRefExpr>(expr->IgnoreParenImpCasts());
+                return ref && ref->getDecl() == iterator;
+            };
+            auto* cond = loop->getCond() ? llvm::dyn_cast<clang::BinaryOperator>(loop->getCond()->IgnoreParenImpCasts()) : nullptr;
+            if (!cond || cond->getOpcode() != clang::BO_LT || !refersToIterator(cond->getLHS())) {
+                return fail("loop condition is not 'i < n'");
+            }
+
+            const clang::Stmt* inc = loop->getInc();
+            bool unit_step = false;
+            if (auto* unary = llvm::dyn_cast_or_null<clang::UnaryOperator>(inc)) {
+                unit_step = unary->isIncrementOp() && refersToIterator(unary->getSubExpr());
+            } else if (auto* add = llvm::dyn_cast_or_null<clang::CompoundAssignOperator>(inc)) {
+                clang::Expr::EvalResult step;
+                unit_step = add->getOpcode() == clang::BO_AddAssign && refersToIterator(add->getLHS()) &&
+                            add->getRHS()->EvaluateAsInt(step, ctx) && step.Val.getInt() == 1;
+            }
+            if (!unit_step) return fail("loop step is not 1");
+            if (!analyzeBody()) return false;
+
+            std::vector<std::string> reads;
+            if (!isInvariant(cond->getRHS(), nullptr, reads)) return fail("loop bound changes inside the loop");
+            points.insert(points.end(), reads.begin(), reads.end());
+
+            // 比较与减法的常用算术转换相同: 无符号公共类型下 n - j 直接是剩余次数,
+            // 有符号时经 uint64_t 做模减, j < n 保证结果不溢出
+            std::string bound = printExpr(cond->getRHS(), ctx);
+            std::string it = iterator->getNameAsString();
+            if (cond->getLHS()->getType()->isUnsignedIntegerType()) {
+                remaining = "(" + bound + " - " + it + ")";
+            } else {
+                remaining = "((uint64_t)(" + bound + ") - (uint64_t)(" + it + "))";
+            }
+            return true;
+        }
+
+        // 顶层的 p++ / p += c (c 为正常量) 是指针归纳步进, step 为每次的元素数
+        bool VectorLoopEmitter::isInductionStep(const clang::Stmt* stmt, const clang::VarDecl*& var, int64_t& step) const {
+            const clang::Expr* target = nullptr;
+            step = 1;
+            if (auto* unary = llvm::dyn_cast<clang::UnaryOperator>(stmt)) {
+                if (unary->isIncrementOp()) target = unary->getSubExpr();
+            } else if (auto* add = llvm::dyn_cast<clang::CompoundAssignOperator>(stmt)) {
+                clang::Expr::EvalResult amount;
+                if (add->getOpcode() == clang::BO_AddAssign && add->getRHS()->EvaluateAsInt(amount, ctx) && amount.Val.getInt().isStrictlyPositive()) {
+                    target = add->getLHS();
+                    step = amount.Val.getInt().getSExtValue();
+                }
+            }
+            auto* ref = target ? llvm::dyn_cast<clang::DeclRefExpr>(target->IgnoreParenImpCasts()) : nullptr;
+            var = ref ? llvm::dyn_cast<clang::VarDecl>(ref->getDecl()) : nullptr;
+            return var && var->getType()->isPointerType();
+        }
+
+        bool VectorLoopEmitter::analyzeBody() {
+            const clang::Stmt* body = loop->getBody();
+            std::vector<const clang::Stmt*> top;
+            if (auto* compound = llvm::dyn_cast_or_null<clang::CompoundStmt>(body)) {
+                top.assign(compound->body_begin(), compound->body_end());
+            } else if (body) {
+                top.push_back(body);
+            }
+
+            // 顶层的 p++ 是指针归纳变量; 其余对外部变量的写入都是跨迭代依赖
+            std::map<const clang::VarDecl*, int> writes;
+            std::vector<clang::QualType> value_types;
+            std::function<bool(const clang::Stmt*)> scan = [&](const clang::Stmt* stmt) -> bool {
+                if (!stmt) return true;
+                if (llvm::isa<clang::ForStmt>(stmt) || llvm::isa<clang::WhileStmt>(stmt) || llvm::isa<clang::DoStmt>(stmt)) {
+                    return fail("contains a nested loop");
+                }
+                if (llvm::isa<clang::BreakStmt>(stmt) || llvm::isa<clang::ContinueStmt>(stmt) || llvm::isa<clang::ReturnStmt>(stmt) ||
+                    llvm::isa<clang::GotoStmt>(stmt) || llvm::isa<clang::SwitchStmt>(stmt)) {
+                    return fail("has early exits or a switch");
+                }
+                if (auto* decl = llvm::dyn_cast<clang::DeclStmt>(stmt)) {
+                    for (const auto* d : decl->decls()) {
+                        auto* var = llvm::dyn_cast<clang::VarDecl>(d);
+                        if (!var || var->isStaticLocal()) return fail("declares a non-automatic variable");
+                        locals.insert(var);
+                        value_types.push_back(var->getType());
+                    }
+                }
+                // 标量侧的代价: 每个运算与访存计 1
+                auto* unary_op = llvm::dyn_cast<clang::UnaryOperator>(stmt);
+                if ((llvm::isa<clang::BinaryOperator>(stmt) && llvm::cast<clang::BinaryOperator>(stmt)->getOpcode() != clang::BO_Comma) ||
+                    llvm::isa<clang::ArraySubscriptExpr>(stmt) || llvm::isa<clang::ConditionalOperator>(stmt) ||
+                    (unary_op && unary_op->getOpcode() != clang::UO_AddrOf && unary_op->getOpcode() != clang::UO_Plus)) {
+                    scalar_work++;
+                }
+                const clang::Expr* target = nullptr;
+                if (auto* binary = llvm::dyn_cast<clang::BinaryOperator>(stmt)) {
+                    if (binary->isAssignmentOp()) target = binary->getLHS()->IgnoreParens();
+                } else if (auto* unary = llvm::dyn_cast<clang::UnaryOperator>(stmt)) {
+                    if (unary->isIncrementDecrementOp() || unary->getOpcode() == clang::UO_AddrOf) target = unary->getSubExpr()->IgnoreParens();
+                }
+                if (target) {
+                    // 取地址视为可能被修改; 对内存的写入决定元素类型
+                    if (auto* ref = llvm::dyn_cast<clang::DeclRefExpr>(target->IgnoreImpCasts())) {
+                        if (auto* var = llvm::dyn_cast<clang::VarDecl>(ref->getDecl())) {
+                            modified.insert(var);
+                            writes[var]++;
+                        }
+                    } else if (!llvm::isa<clang::UnaryOperator>(stmt) || llvm::cast<clang::UnaryOperator>(stmt)->getOpcode() != clang::UO_AddrOf) {
+                        value_types.push_back(target->getType());
+                    }
+                }
+                for (const auto* child : stmt->children()) {
+                    if (!scan(child)) return false;
+                }
+                return true;
+            };
+            for (const auto* stmt : top) {
+                if (!scan(stmt)) return false;
+            }
+            for (const auto* stmt : top) {
+                const clang::VarDecl* var = nullptr;
+                int64_t step = 1;
+                if (isInductionStep(stmt, var, step) && !locals.count(var) && writes[var] == 1) inductions[var] = step;
+            }
+            if (modified.count(iterator)) return fail("modifies the loop counter");
+
+            // 只在一条顶层更新语句中出现的外部自动变量按归约处理, 由部分累加器在循环后合并
+            auto isAccumulator = [this](const clang::VarDecl* var) {
+                return var && !locals.count(var) && var->hasLocalStorage() && !var->getType()->isReferenceType();
+            };
+            for (const auto* stmt : top) {
+                ReductionUpdate update;
+                if (!matchReductionUpdate(stmt, ctx, update) || !isIsolatedReduction(body, stmt, update) || !isAccumulator(update.var)) continue;
+                if (update.index) {
+                    // 只支持记录首次出现的位置 (严格比较), 位置为循环变量
+                    if (!update.strict || !isAccumulator(update.index) || !update.index->getType()->isIntegerType() ||
+                        referencedVariable(update.position) != iterator) {
+                        continue;
+                    }
+                }
+                reductions.push_back({stmt, update, prefix + update.var->getNameAsString()});
+                value_types.push_back(update.var->getType());
+            }
+            for (const auto* var : modified) {
+                if (!locals.count(var) && !inductions.count(var) && !isReductionVariable(var)) {
+                    return fail("updates '" + var->getNameAsString() + "' across iterations (recurrence)");
+                }
+            }
+
+            // 元素类型取自局部变量与存储目标, 通道数 = 寄存器位宽 / 元素位宽
+            for (const auto& type : value_types) {
+                const VectorElementType* candidate = vectorElementType(type, ctx);
+                if (!candidate) return fail("uses element type '" + type.getAsString() + "' which has no vector lane mapping here");
+                if (element && candidate != element) return fail("mixes element types");
+                element = candidate;
+            }
+            if (!element) return fail("has no vectorizable work");
+            lanes = (sve ? kSveMinimumBits : kNeonRegisterBits) / element->bits;
+            if (promotes() && !reductions.empty()) return failPromoted();
+
+            // 浮点 sum/product 重结合会改变舍入; SVE 的 sum 可用 svadda 按序累加, NEON 没有按序归约指令, 有序模式下保持标量
+            for (auto& reduction : reductions) {
+                const std::string& kind = reduction.update.op;
+                std::string var = reduction.update.var->getNameAsString();
+                if (sve && reduction.update.index) return fail("records the position of the " + kind.substr(3) + " of '" + var + "' (only lowered for NEON)");
+                if (sve && kind == "product") return fail("reduces '" + var + "' with a product (SVE has no across-lane multiply)");
+                if (element->is_float && (kind == "sum" || kind == "product") && !reassociate_fp) {
+                    if (sve && kind == "sum") {
+                        reduction.ordered = true;
+                        continue;
+                    }
+                    return fail("reduces '" + var + "' with a floating-point " + kind + " (ordered mode; allow reassociation to vectorize)");
+                }
+            }
+            return true;
+        }
+
+        bool VectorLoopEmitter::isReductionVariable(const clang::VarDecl* var) const {
+            for (const auto& reduction : reductions) {
+                if (reduction.update.var == var || reduction.update.index == var) return true;
+            }
+            return false;
+        }
+
+        bool VectorLoopEmitter::lookupBinding(const clang::VarDecl* var, const Bindings* bindings,
+                                              const clang::Expr*& arg, const Bindings*& outer) const {
+            auto* parm = llvm::dyn_cast<clang::ParmVarDecl>(var);
+            if (!parm || !bindings) return false;
+            auto it = bindings->args.find(parm);
+            if (it == bindings->args.end()) return false;
+            arg = it->second;
+            outer = bindings->parent;
+            return true;
+        }
+
+        const clang::VarDecl* VectorLoopEmitter::resolveVariable(const clang::Expr* expr, const Bindings* bindings) const {
+            auto* ref = llvm::dyn_cast<clang::DeclRefExpr>(expr->IgnoreParenImpCasts());
+            auto* var = ref ? llvm::dyn_cast<clang::VarDecl>(ref->getDecl()) : nullptr;
+            const clang::Expr* arg = nullptr;
+            const Bindings* outer = nullptr;
+            if (var && lookupBinding(var, bindings, arg, outer)) return resolveVariable(arg, outer);
+            return var;
+        }
+
+        std::string VectorLoopEmitter::render(const clang::Expr* expr, const Bindings* bindings) {
+            std::string text = printExpr(expr, ctx);
+            if (!bindings) return text;
+            std::map<std::string, std::string> renames;
+            for (const auto& [parm, arg] : bindings->args) {
+                std::string value = render(arg, bindings->parent);
+                renames[parm->getNameAsString()] = isSimpleOperand(value) ? value : "(" + value + ")";
+            }
+            return EnhancedCPGToAODConverter::renameIdentifiers(text, renames);
+        }
+
+        bool VectorLoopEmitter::isInvariant(const clang::Expr* expr, const Bindings* bindings, std::vector<std::string>& reads) {
+            expr = expr->IgnoreParens();
+            if (llvm::isa<clang::IntegerLiteral>(expr) || llvm::isa<clang::FloatingLiteral>(expr) ||
+                llvm::isa<clang::CharacterLiteral>(expr) || llvm::isa<clang::CXXBoolLiteralExpr>(expr) ||
+                llvm::isa<clang::UnaryExprOrTypeTraitExpr>(expr)) {
+                return true;
+            }
+            if (auto* ref = llvm::dyn_cast<clang::DeclRefExpr>(expr)) {
+                if (llvm::isa<clang::EnumConstantDecl>(ref->getDecl())) return true;
+                auto* var = llvm::dyn_cast<clang::VarDecl>(ref->getDecl());
+                if (!var) return false;
+                const clang::Expr* arg = nullptr;
+                const Bindings* outer = nullptr;
+                if (lookupBinding(var, bindings, arg, outer)) return isInvariant(arg, outer, reads);
+                return var != iterator && !locals.count(var) && !modified.count(var);
+            }
+            if (auto* cast = llvm::dyn_cast<clang::CastExpr>(expr)) {
+                if (!isInvariant(cast->getSubExpr(), bindings, reads)) return false;
+                // volatile 读取每次迭代都要执行, 不能外提
+                if (cast->getCastKind() == clang::CK_LValueToRValue && cast->getSubExpr()->getType().isVolatileQualified()) return false;
+                // 内存读取 (及全局变量) 可能被循环中的存储改写, 记录其位置供运行时重叠检查
+                if (cast->getCastKind() == clang::CK_LValueToRValue) {
+                    const clang::Expr* source = cast->getSubExpr()->IgnoreParens();
+                    auto* ref = llvm::dyn_cast<clang::DeclRefExpr>(source);
+                    auto* var = ref ? llvm::dyn_cast<clang::VarDecl>(ref->getDecl()) : nullptr;
+                    const clang::Expr* arg = nullptr;
+                    const Bindings* outer = nullptr;
+                    bool bound = var && lookupBinding(var, bindings, arg, outer);
+                    if (!ref || (!bound && var && var->hasGlobalStorage())) reads.push_back(render(source, bindings));
+                }
+                return true;
+            }
+            if (auto* subscript = llvm::dyn_cast<clang::ArraySubscriptExpr>(expr)) {
+                return isInvariant(subscript->getBase(), bindings, reads) && isInvariant(subscript->getIdx(), bindings, reads);
+            }
+            if (auto* member = llvm::dyn_cast<clang::MemberExpr>(expr)) {
+                return isInvariant(member->getBase(), bindings, reads);
+            }
+            if (auto* unary = llvm::dyn_cast<clang::UnaryOperator>(expr)) {
+                if (unary->isIncrementDecrementOp() || unary->getOpcode() == clang::UO_AddrOf) return false;
+                return isInvariant(unary->getSubExpr(), bindings, reads);
+            }
+            if (auto* binary = llvm::dyn_cast<clang::BinaryOperator>(expr)) {
+                if (binary->isAssignmentOp() || binary->getOpcode() == clang::BO_Comma) return false;
+                return isInvariant(binary->getLHS(), bindings, reads) && isInvariant(binary->getRHS(), bindings, reads);
+            }
+            if (auto* select = llvm::dyn_cast<clang::ConditionalOperator>(expr)) {
+                return isInvariant(select->getCond(), bindings, reads) && isInvariant(select->getTrueExpr(), bindings, reads) &&
+                       isInvariant(select->getFalseExpr(), bindings, reads);
+            }
+            return false;
+        }
+
+        // 下标按 scale * j + offset 解析, 系数与偏移须为常量: j + 1, 2 * j, (j + 1) * 3, j << 1
+        bool VectorLoopEmitter::parseIndex(const clang::Expr* expr, const Bindings* bindings, int64_t& scale, int64_t& offset) {
+            expr = expr->IgnoreParenImpCasts();
+            clang::Expr::EvalResult value;
+            if (!expr->isValueDependent() && expr->EvaluateAsInt(value, ctx)) {
+                offset += value.Val.getInt().getSExtValue();
+                return true;
+            }
+            if (auto* ref = llvm::dyn_cast<clang::DeclRefExpr>(expr)) {
+                auto* var = llvm::dyn_cast<clang::VarDecl>(ref->getDecl());
+                const clang::Expr* arg = nullptr;
+                const Bindings* outer = nullptr;
+                if (var && lookupBinding(var, bindings, arg, outer)) return parseIndex(arg, outer, scale, offset);
+                if (var != iterator) return false;
+                scale += 1;
+                return true;
+            }
+            auto* binary = llvm::dyn_cast<clang::BinaryOperator>(expr);
+            if (!binary) return false;
+            switch (binary->getOpcode()) {
+                case clang::BO_Add:
+                    return parseIndex(binary->getLHS(), bindings, scale, offset) && parseIndex(binary->getRHS(), bindings, scale, offset);
+                case clang::BO_Sub:
+                    if (!binary->getRHS()->EvaluateAsInt(value, ctx)) return false;
+                    offset -= value.Val.getInt().getSExtValue();
+                    return parseIndex(binary->getLHS(), bindings, scale, offset);
+                case clang::BO_Mul:
+                case clang::BO_Shl: {
+                    const clang::Expr* factor = binary->getRHS();
+                    const clang::Expr* term = binary->getLHS();
+                    if (binary->getOpcode() == clang::BO_Mul && !factor->EvaluateAsInt(value, ctx)) std::swap(factor, term);
+                    if (!factor->EvaluateAsInt(value, ctx)) return false;
+                    int64_t k = value.Val.getInt().getSExtValue();
+                    if (binary->getOpcode() == clang::BO_Shl) {
+                        if (k < 0 || k > 30) return false;
+                        k = int64_t(1) << k;
+                    }
+                    int64_t inner_scale = 0;
+                    int64_t inner_offset = 0;
+                    if (!parseIndex(term, bindings, inner_scale, inner_offset)) return false;
+                    scale += k * inner_scale;
+                    offset += k * inner_offset;
+                    return true;
+                }
+                default:
+                    return false;
+            }
+        }
+
+        bool VectorLoopEmitter::classifyAccess(const clang::Expr* expr, const Bindings* bindings, Stream& stream, int64_t& member) {
+            expr = expr->IgnoreParens();
+            if (!isElement(expr->getType())) return fail("accesses memory of a different element type");
+            const clang::Expr* base = nullptr;
+            const clang::Expr* index = nullptr;
+            splitAccess(expr, base, index);
+            const clang::VarDecl* var = base ? resolveVariable(base, bindings) : nullptr;
+            if (!var || locals.count(var)) return fail("accesses memory through an unsupported base");
+            std::string name = var->getNameAsString();
+            member = 0;
+            // volatile 访问须逐元素保留, 也不能经去掉限定的向量指针读写
+            if (expr->getType().isVolatileQualified() || var->getType().isVolatileQualified()) {
+                return fail("accesses volatile memory through '" + name + "'");
+            }
+
+            // 结构体数组的字段按元素重新解释: 每个记录 record 个元素, 字段在记录内偏移 field 个元素
+            int64_t record = 1;
+            int64_t field = 0;
+            if (auto* member_expr = llvm::dyn_cast<clang::MemberExpr>(expr)) {
+                auto* decl = llvm::dyn_cast<clang::FieldDecl>(member_expr->getMemberDecl());
+                if (!decl || decl->isBitField() || decl->getParent()->isUnion()) {
+                    return fail("accesses '" + name + "' through a bit-field or union member");
+                }
+                const int64_t bits = element->bits;
+                const int64_t size = static_cast<int64_t>(ctx.getTypeSize(ctx.getRecordType(decl->getParent())));
+                const int64_t at = static_cast<int64_t>(ctx.getASTRecordLayout(decl->getParent()).getFieldOffset(decl->getFieldIndex()));
+                if (size % bits != 0 || at % bits != 0) {
+                    return fail("accesses field '" + decl->getNameAsString() + "' of '" + name + "' whose record does not split into " +
+                                element->scalar + " elements");
+                }
+                record = size / bits;
+                field = at / bits;
+            }
+
+            // 下标本身是内存读取 (x[idx[j]]) 时按 gather / scatter 处理
+            const clang::Expr* inner_base = nullptr;
+            const clang::Expr* inner_index = nullptr;
+            if (index && splitAccess(index->IgnoreParenImpCasts(), inner_base, inner_index)) {
+                if (record != 1 || field != 0) return fail("indexes records of '" + name + "' indirectly");
+                return classifyIndexed(var, index->IgnoreParenImpCasts(), bindings, stream);
+            }
+
+            int64_t scale = 0;
+            int64_t offset = 0;
+            if (index && !parseIndex(index, bindings, scale, offset)) return fail("has a non-affine index into '" + name + "'");
+            stream.base = var;
+            stream.index = nullptr;
+            if (inductions.count(var)) {
+                if (scale != 0) return fail("indexes pointer induction '" + name + "' by the loop counter");
+                stream.stride = inductions[var] * record;
+                stream.offset = (advanced[var] * inductions[var] + offset) * record + field;
+                stream.induction = true;
+            } else {
+                if (scale == 0 || modified.count(var)) return fail("has a non-contiguous access through '" + name + "'");
+                if (scale < 0) return fail("walks '" + name + "' backwards");
+                stream.stride = scale * record;
+                stream.offset = offset * record + field;
+                stream.induction = false;
+            }
+            // 步长 2..4 按组访问: 组起点向下取整到步长的倍数, 余数为组内成员
+            if (stream.stride > 1 && stream.stride <= kMaxInterleave) {
+                member = ((stream.offset % stream.stride) + stream.stride) % stream.stride;
+                stream.offset -= member;
+            }
+            return true;
+        }
+
+        bool VectorLoopEmitter::classifyIndexed(const clang::VarDecl* var, const clang::Expr* index, const Bindings* bindings, Stream& stream) {
+            std::string name = var->getNameAsString();
+            const clang::Expr* base = nullptr;
+            const clang::Expr* position = nullptr;
+            splitAccess(index, base, position);
+            const clang::VarDecl* table = base ? resolveVariable(base, bindings) : nullptr;
+            clang::QualType type = index->getType().getCanonicalType();
+            if (!table || locals.count(table) || !type->isIntegerType() || type->isBooleanType() || llvm::isa<clang::MemberExpr>(index)) {
+                return fail("indexes '" + name + "' through an unsupported index expression");
+            }
+            if (modified.count(var)) return fail("indexes '" + name + "' indirectly while advancing it");
+            if (index->getType().isVolatileQualified() || table->getType().isVolatileQualified()) {
+                return fail("reads indices for '" + name + "' from volatile memory");
+            }
+
+            int64_t scale = 0;
+            int64_t offset = 0;
+            if (position && !parseIndex(position, bindings, scale, offset)) return fail("reads indices for '" + name + "' at a non-affine position");
+            if (inductions.count(table)) {
+                if (scale != 0 || inductions[table] != 1) return fail("reads indices for '" + name + "' with a non-unit stride");
+                stream.offset = advanced[table] + offset;
+                stream.induction = true;
+            } else {
+                if (scale != 1 || modified.count(table)) return fail("reads indices for '" + name + "' with a non-unit stride");
+                stream.offset = offset;
+                stream.induction = false;
+            }
+            stream.base = var;
+            stream.stride = 1;
+            stream.index = table;
+            stream.index_bits = static_cast<int>(ctx.getTypeSize(type));
+            stream.index_signed = type->isSignedIntegerType();
+            return true;
+        }
+
+        void VectorLoopEmitter::registerStream(const Stream& stream) {
+            for (auto& known : streams) {
+                if (locationOf(known) == locationOf(stream) && known.induction == stream.induction) {
+                    known.loaded = known.loaded || stream.loaded;
+                    known.stored = known.stored || stream.stored;
+                    return;
+                }
+            }
+            streams.push_back(stream);
+        }
+
+        // 间接访问的下标数组按连续流读取
+        VectorLoopEmitter::Stream VectorLoopEmitter::indexStream(const Stream& stream) const {
+            Stream indices;
+            indices.base = stream.index;
+            indices.offset = stream.offset;
+            indices.induction = stream.induction;
+            indices.loaded = true;
+            return indices;
+        }
+
+        // 第 copy 个向量的首地址; SVE 的向量长度运行时才知道, 副本偏移写成 sve_vl 的倍数
+        std::string VectorLoopEmitter::address(const Stream& stream, int copy_index) const {
+            int64_t offset = stream.offset;
+            int64_t vectors = static_cast<int64_t>(copy_index) * stream.stride;
+            if (!sve) offset += vectors * lanes;
+            std::string text = baseName(stream);
+            if (!stream.induction) {
+                text += " + " + (stream.stride == 1 ? std::string() : std::to_string(stream.stride) + " * ") + iterator->getNameAsString();
+            }
+            if (offset > 0) text += " + " + std::to_string(offset);
+            if (offset < 0) text += " - " + std::to_string(-offset);
+            if (sve && vectors > 0) text += " + " + (vectors == 1 ? std::string() : std::to_string(vectors) + " * ") + prefix + "vl";
+            return text;
+        }
+
+        // 第 copy 个向量第 lane 个通道对应的标量元素 (仅 NEON): x[3 * j + 7], p[5]
+        std::string VectorLoopEmitter::elementAt(const Stream& stream, int copy_index, int lane) const {
+            int64_t offset = stream.offset + (static_cast<int64_t>(copy_index) * lanes + lane) * stream.stride;
+            std::string text;
+            if (!stream.induction) {
+                text = (stream.stride == 1 ? std::string() : std::to_string(stream.stride) + " * ") + iterator->getNameAsString();
+                if (offset > 0) text += " + " + std::to_string(offset);
+                if (offset < 0) text += " - " + std::to_string(-offset);
+            } else {
+                text = std::to_string(offset);
+            }
+            return baseName(stream) + "[" + text + "]";
+        }
+
+        // 流基址的文本; 结构体数组按元素指针重新解释, 流的偏移与步长已按元素计
+        std::string VectorLoopEmitter::baseName(const Stream& stream) const {
+            std::string name = stream.base->getNameAsString();
+            clang::QualType type = stream.base->getType().getCanonicalType();
+            clang::QualType pointee = type->isPointerType() ? type->getPointeeType() : clang::QualType();
+            if (auto* array = ctx.getAsArrayType(type)) pointee = array->getElementType();
+            if (pointee.isNull() || isElement(pointee)) return name;
+            return std::string("((") + (pointee.isConstQualified() ? "const " : "") + element->scalar + "*)" + name + ")";
+        }
+
+        std::string VectorLoopEmitter::hoist(const std::string& value, const std::string& type) {
+            for (const auto& known : hoisted) {
+                if (known.value == value) return known.name;
+            }
+            std::string name = prefix + "inv" + std::to_string(hoisted.size());
+            hoisted.push_back({value, name, type});
+            return name;
+        }
+
+        std::string VectorLoopEmitter::temporary(const std::string& type, const std::string& value) {
+            std::string name = prefix + "t" + std::to_string(temp_count++) + "_v" + std::to_string(copy);
+            lines.push_back("const " + type + " " + name + " = " + value + ";");
+            return name;
+        }
+
+        bool VectorLoopEmitter::constant(const clang::Expr* expr, Value& out) {
+            clang::Expr::EvalResult result;
+            if (expr->isValueDependent() || !expr->EvaluateAsRValue(result, ctx) || result.HasSideEffects) return false;
+            if (expr->getType()->isBooleanType()) {
+                if (!result.Val.isInt()) return false;
+                bool set = result.Val.getInt().getBoolValue();
+                std::string value = sve ? hoist("svdup_n_b" + std::to_string(element->bits) + "(" + (set ? "1" : "0") + ")", maskType())
+                                        : hoist(maskOp("vdupq_n") + "(" + (set ? allOnes() : "0") + ")", maskType());
+                out = {sve ? maskAnd(value, value) : value, true};
+                return true;
+            }
+            if (!isElement(expr->getType())) return false;
+            std::string literal;
+            if (element->is_float) {
+                if (!result.Val.isFloat()) return false;
+                llvm::APFloat value = result.Val.getFloat();
+                bool lost = false;
+                value.convert(llvm::APFloat::IEEEdouble(), llvm::APFloat::rmNearestTiesToEven, &lost);
+                double number = value.convertToDouble();
+                if (!std::isfinite(number)) return false;
+                std::ostringstream os;
+                os << std::setprecision(element->bits == 32 ? 9 : 17) << number;
+                literal = os.str();
+                if (literal.find_first_of(".e") == std::string::npos) literal += ".0";
+                if (element->bits == 32) literal += "f";
+            } else {
+                if (!result.Val.isInt()) return false;
+                literal = element->is_signed ? std::to_string(result.Val.getInt().getSExtValue())
+                                             : std::to_string(result.Val.getInt().getZExtValue()) + "u";
+            }
+            out = {hoist(splat(literal), vectorType()), false};
+            return true;
+        }
+
+        bool VectorLoopEmitter::translate(const clang::Expr* expr, const Bindings* bindings, Value& out) {
+            expr = expr->IgnoreParens();
+            // 同时限制递归内联的深度
+            if (++depth > 64) return fail("expression is too deep");
+            struct DepthGuard {
+                int& depth;
+                ~DepthGuard() { --depth; }
+            } guard{depth};
+
+            bool is_value = isElement(expr->getType()) || expr->getType()->isBooleanType();
+            if (is_value && constant(expr, out)) return true;
+
+            // 循环不变量在进入向量循环前广播一次; 读内存的不变量只能在无条件执行的位置外提
+            std::vector<std::string> reads;
+            if (is_value && isInvariant(expr, bindings, reads)) {
+                if ((!reads.empty() || hasIntegerDivision(expr)) && (!mask.empty() || conditional > 0)) {
+                    return fail("has a conditional invariant load or division");
+                }
+                std::string text = render(expr, bindings);
+                if (expr->getType()->isBooleanType()) {
+                    std::string value = hoist(maskSplat("(" + text + ")"), maskType());
+                    out = {sve ? maskAnd(value, value) : value, true};
+                } else {
+                    out = {hoist(splat(text), vectorType()), false};
+                }
+                points.insert(points.end(), reads.begin(), reads.end());
+                return true;
+            }
+
+            if (auto* cast = llvm::dyn_cast<clang::ImplicitCastExpr>(expr)) {
+                if (cast->getCastKind() == clang::CK_LValueToRValue || cast->getCastKind() == clang::CK_NoOp) {
+                    return translate(cast->getSubExpr(), bindings, out);
+                }
+                if (promotes()) return failPromoted();
+                return fail("converts between element types inside the loop");
+            }
+            if (auto* ref = llvm::dyn_cast<clang::DeclRefExpr>(expr)) {
+                auto* var = llvm::dyn_cast<clang::VarDecl>(ref->getDecl());
+                const clang::Expr* arg = nullptr;
+                const Bindings* outer = nullptr;
+                if (var && lookupBinding(var, bindings, arg, outer)) return translate(arg, outer, out);
+                if (var == iterator) return fail("uses the loop counter as a value");
+                auto name = local_names.find(var);
+                if (name == local_names.end()) return fail("reads '" + ref->getNameInfo().getAsString() + "' which is not vectorizable");
+                out = {name->second + "_v" + std::to_string(copy), false};
+                return true;
+            }
+            if (llvm::isa<clang::ArraySubscriptExpr>(expr) || llvm::isa<clang::MemberExpr>(expr) ||
+                (llvm::isa<clang::UnaryOperator>(expr) && llvm::cast<clang::UnaryOperator>(expr)->getOpcode() == clang::UO_Deref)) {
+                Stream stream;
+                int64_t member = 0;
+                if (!classifyAccess(expr, bindings, stream, member)) return false;
+                return load(stream, member, out);
+            }
+            if (auto* binary = llvm::dyn_cast<clang::BinaryOperator>(expr)) return translateBinary(binary, bindings, out);
+            if (auto* unary_expr = llvm::dyn_cast<clang::UnaryOperator>(expr)) {
+                Value operand;
+                switch (unary_expr->getOpcode()) {
+                    case clang::UO_Plus:
+                        return translate(unary_expr->getSubExpr(), bindings, out);
+                    case clang::UO_Minus:
+                        if (!translate(unary_expr->getSubExpr(), bindings, operand) || operand.mask) return fail("negates a non-value");
+                        out.code = element->is_signed ? unary("vnegq", operand.code) : arith("vsubq", splat("0"), operand.code);
+                        out.mask = false;
+                        return true;
+                    case clang::UO_LNot:
+                        if (!translate(unary_expr->getSubExpr(), bindings, operand)) return false;
+                        if (!operand.mask) return fail("applies '!' to a non-condition");
+                        out = {maskNot(operand.code), true};
+                        return true;
+                    case clang::UO_Not:
+                        if (element->is_float || !translate(unary_expr->getSubExpr(), bindings, operand) || operand.mask) {
+                            return fail("applies '~' to a non-integer");
+                        }
+                        out = {unary("vmvnq", operand.code), false};
+                        return true;
+                    default:
+                        return fail("has an unsupported unary operator");
+                }
+            }
+            if (auto* choice = llvm::dyn_cast<clang::ConditionalOperator>(expr)) {
+                Value cond, yes, no;
+                if (!translate(choice->getCond(), bindings, cond)) return false;
+                if (!cond.mask) return fail("selects on a non-condition");
+                conditional++;
+                bool ok = translate(choice->getTrueExpr(), bindings, yes) && translate(choice->getFalseExpr(), bindings, no);
+                conditional--;
+                if (!ok) return false;
+                if (yes.mask != no.mask) return fail("selects between mixed values");
+                out = {yes.mask ? maskSelect(cond.code, yes.code, no.code) : select(cond.code, yes.code, no.code), yes.mask};
+                return true;
+            }
+            if (auto* call = llvm::dyn_cast<clang::CallExpr>(expr)) return translateCall(call, bindings, out);
+            return fail(std::string("has an unsupported expression (") + expr->getStmtClassName() + ")");
+        }
+
+        bool VectorLoopEmitter::translateBinary(const clang::BinaryOperator* binary, const Bindings* bindings, Value& out) {
+            auto opcode = binary->getOpcode();
+            Value lhs, rhs;
+            if (opcode == clang::BO_LAnd || opcode == clang::BO_LOr) {
+                if (!translate(binary->getLHS(), bindings, lhs)) return false;
+                conditional++;
+                bool ok = translate(binary->getRHS(), bindings, rhs);
+                conditional--;
+                if (!ok) return false;
+                if (!lhs.mask || !rhs.mask) return fail("combines non-conditions with '&&'/'||'");
+                out = {opcode == clang::BO_LAnd ? maskAnd(lhs.code, rhs.code) : maskOr(lhs.code, rhs.code), true};
+                return true;
+            }
+            if (opcode == clang::BO_Shl || opcode == clang::BO_Shr) {
+                clang::Expr::EvalResult amount;
+                if (element->is_float || !binary->getRHS()->EvaluateAsInt(amount, ctx)) return fail("shifts by a non-constant amount");
+                int64_t bits = amount.Val.getInt().getSExtValue();
+                if (bits < 0 || bits >= element->bits) return fail("shifts out of range");
+                if (!translate(binary->getLHS(), bindings, lhs) || lhs.mask) return false;
+                out = bits == 0 ? lhs : Value{shift(opcode == clang::BO_Shl, lhs.code, bits), false};
+                return true;
+            }
+            if ((opcode == clang::BO_Div || opcode == clang::BO_Rem) && !element->is_float && isElement(binary->getType())) {
+                if (!translate(binary->getLHS(), bindings, lhs) || lhs.mask) return false;
+                return divideByConstant(binary->getRHS(), lhs.code, opcode == clang::BO_Rem, out);
+            }
+            if (!translate(binary->getLHS(), bindings, lhs) || !translate(binary->getRHS(), bindings, rhs)) return false;
+
+            if (binary->isComparisonOp()) {
+                if (lhs.mask || rhs.mask || !isElement(binary->getLHS()->getType())) return fail("compares non-element values");
+                const char* name = nullptr;
+                switch (opcode) {
+                    case clang::BO_LT: name = "vcltq"; break;
+                    case clang::BO_GT: name = "vcgtq"; break;
+                    case clang::BO_LE: name = "vcleq"; break;
+                    case clang::BO_GE: name = "vcgeq"; break;
+                    default: name = "vceqq"; break;
+                }
+                if (opcode == clang::BO_NE && sve) {
+                    charge(1);
+                    out = {std::string("svcmpne_") + element->suffix + "(" + prefix + "pg, " + lhs.code + ", " + rhs.code + ")", true};
+                    return true;
+                }
+                std::string code = compare(name, lhs.code, rhs.code);
+                out = {opcode == clang::BO_NE ? maskNot(code) : code, true};
+                return true;
+            }
+
+            if (lhs.mask || rhs.mask || !isElement(binary->getType())) return fail("mixes conditions and values in arithmetic");
+            const char* name = nullptr;
+            switch (opcode) {
+                case clang::BO_Add: name = "vaddq"; break;
+                case clang::BO_Sub: name = "vsubq"; break;
+                case clang::BO_Mul: name = "vmulq"; break;
+                case clang::BO_Div: name = element->is_float ? "vdivq" : nullptr; break;
+                case clang::BO_And: name = element->is_float ? nullptr : "vandq"; break;
+                case clang::BO_Or: name = element->is_float ? nullptr : "vorrq"; break;
+                case clang::BO_Xor: name = element->is_float ? nullptr : "veorq"; break;
+                default: break;
+            }
+            if (!name) return fail("uses operator '" + binary->getOpcodeStr().str() + "' which has no lane-wise " + target() + " form");
+            out = {arith(name, lhs.code, rhs.code), false};
+            return true;
+        }
+
+        // 无符号整数除以常量: 2 的幂为移位/掩码, 其余按 Granlund-Montgomery 乘高位
+        //   m = floor(2^W * (2^l - d) / d) + 1, l = ceil(log2 d)
+        //   t = mulhi(x, m), q = (t + ((x - t) >> 1)) >> (l - 1), r = x - q * d
+        // NEON 无 32 位乘高位指令, 按 vmull_u32 / vmull_high_u32 扩展相乘后 vshrn_n_u64 取高半部分; SVE 直接用 svmulh
+        bool VectorLoopEmitter::divideByConstant(const clang::Expr* divisor, const std::string& dividend, bool remainder, Value& out) {
+            clang::Expr::EvalResult amount;
+            if (!divisor->EvaluateAsInt(amount, ctx)) return fail("divides by a non-constant amount");
+            if (element->is_signed || element->bits != 32) {
+                return fail(std::string("divides signed lanes, which have no lane-wise ") + target() + " form");
+            }
+            uint64_t d = amount.Val.getInt().getZExtValue();
+            if (d == 0 || d > 0xFFFFFFFFull) return fail("divides by a constant out of range");
+            out.mask = false;
+            if ((d & (d - 1)) == 0) {
+                int bits = 0;
+                while ((uint64_t(1) << bits) < d) ++bits;
+                if (remainder) {
+                    out.code = arith("vandq", dividend, hoist(splat(std::to_string(d - 1) + "u"), vectorType()));
+                } else {
+                    out.code = bits == 0 ? dividend : shift(false, dividend, bits);
+                }
+                return true;
+            }
+            int l = 0;
+            while ((uint64_t(1) << l) < d) ++l;
+            uint64_t magic = ((uint64_t(1) << 32) * ((uint64_t(1) << l) - d)) / d + 1;
+            std::string x = temporary(vectorType(), dividend);
+            std::string m = hoist(splat(std::to_string(magic) + "u"), vectorType());
+            std::string high;
+            if (sve) {
+                charge(1);
+                high = "svmulh_u32_x(" + prefix + "pg, " + x + ", " + m + ")";
+            } else {
+                charge(3);
+                high = "vcombine_u32(vshrn_n_u64(vmull_u32(vget_low_u32(" + x + "), vget_low_u32(" + m + ")), 32), "
+                       "vshrn_n_u64(vmull_high_u32(" + x + ", " + m + "), 32))";
+            }
+            std::string t = temporary(vectorType(), high);
+            std::string q = shift(false, arith("vaddq", t, shift(false, arith("vsubq", x, t), 1)), l - 1);
+            if (remainder) {
+                q = arith("vsubq", x, arith("vmulq", q, hoist(splat(std::to_string(d) + "u"), vectorType())));
+            }
+            out.code = q;
+            return true;
+        }
+
+        bool VectorLoopEmitter::translateCall(const clang::CallExpr* call, const Bindings* bindings, Value& out) {
+            // 只含一条 return 表达式的函数按形参绑定内联
+            const clang::FunctionDecl* callee = call->getDirectCallee();
+            const clang::FunctionDecl* definition = nullptr;
+            std::string name = callee ? callee->getNameAsString() : "indirect call";
+            if (!callee || !callee->hasBody(definition) || definition->isVariadic() || definition->getNumParams() != call->getNumArgs()) {
+                return fail("calls '" + name + "' which cannot be inlined");
+            }
+            auto* body = llvm::dyn_cast<clang::CompoundStmt>(definition->getBody());
+            auto* ret = body && body->size() == 1 ? llvm::dyn_cast<clang::ReturnStmt>(body->body_front()) : nullptr;
+            if (!ret || !ret->getRetValue()) return fail("calls '" + name + "' whose body is not a single return");
+
+            Bindings inner;
+            inner.parent = bindings;
+            for (unsigned i = 0; i < call->getNumArgs(); ++i) {
+                const clang::ParmVarDecl* parm = definition->getParamDecl(i);
+                if (parm->getType()->isReferenceType() || call->getArg(i)->HasSideEffects(ctx)) {
+                    return fail("calls '" + name + "' with by-reference or side-effecting arguments");
+                }
+                inner.args[parm] = call->getArg(i);
+            }
+            return translate(ret->getRetValue(), &inner, out);
+        }
+
+        bool VectorLoopEmitter::translateAssignment(const clang::BinaryOperator* assign) {
+            const clang::Expr* target = assign->getLHS()->IgnoreParens();
+            if (!isElement(target->getType())) return fail("assigns a non-element value");
+            Value value;
+            auto opcode = assign->getOpcode();
+            auto* compound = llvm::dyn_cast<clang::CompoundAssignOperator>(assign);
+            bool divides = (opcode == clang::BO_DivAssign || opcode == clang::BO_RemAssign) && !element->is_float;
+            if (divides) {
+                // 整数除数须为常量, 不单独翻译右侧
+                if (!isElement(compound->getComputationResultType())) return promotes() ? failPromoted() : fail("compound assignment changes the element type");
+                Value current;
+                if (!translate(target, nullptr, current)) return false;
+                if (!divideByConstant(assign->getRHS(), current.code, opcode == clang::BO_RemAssign, value)) return false;
+            } else if (!translate(assign->getRHS(), nullptr, value)) {
+                return false;
+            }
+            if (value.mask) return fail("stores a condition");
+
+            // 复合赋值按 x = x op v 展开, 运算类型须与元素类型一致
+            if (compound && !divides) {
+                if (!isElement(compound->getComputationResultType())) return promotes() ? failPromoted() : fail("compound assignment changes the element type");
+                Value current;
+                if (!translate(target, nullptr, current)) return false;
+                const char* name = nullptr;
+                switch (opcode) {
+                    case clang::BO_AddAssign: name = "vaddq"; break;
+                    case clang::BO_SubAssign: name = "vsubq"; break;
+                    case clang::BO_MulAssign: name = "vmulq"; break;
+                    case clang::BO_DivAssign: name = element->is_float ? "vdivq" : nullptr; break;
+                    default: break;
+                }
+                if (!name) return fail(std::string("uses a compound assignment without a lane-wise ") + this->target() + " form");
+                value.code = arith(name, current.code, value.code);
+            }
+
+            if (auto* ref = llvm::dyn_cast<clang::DeclRefExpr>(target)) {
+                auto name = local_names.find(llvm::dyn_cast<clang::VarDecl>(ref->getDecl()));
+                if (name == local_names.end()) return fail("assigns a non-local variable");
+                std::string var = name->second + "_v" + std::to_string(copy);
+                lines.push_back(var + " = " + (mask.empty() ? value.code : select(mask, value.code, var)) + ";");
+                return true;
+            }
+            Stream stream;
+            int64_t member = 0;
+            if (!classifyAccess(target, nullptr, stream, member)) return false;
+            return store(stream, member, value.code);
+        }
+
+        // SVE gather/scatter 的下标向量: 间接访问读下标数组 (位宽须与元素相同), 常量步长用外提的 svindex
+        bool VectorLoopEmitter::gatherIndices(const Stream& stream, std::string& form, std::string& indices) {
+            std::string bits = std::to_string(element->bits);
+            if (element->bits < 32) {
+                return fail("gathers or scatters " + bits + "-bit elements of '" + stream.base->getNameAsString() +
+                            "' (SVE gathers take 32- or 64-bit elements)");
+            }
+            if (!stream.index) {
+                form = "s" + bits;
+                indices = hoist("svindex_s" + bits + "(0, " + std::to_string(stream.stride) + ")", "svint" + bits + "_t");
+                return true;
+            }
+            if (stream.index_bits != element->bits) {
+                return fail("indexes '" + stream.base->getNameAsString() + "' with " + std::to_string(stream.index_bits) +
+                            "-bit indices (SVE gathers of this element type take " + bits + "-bit indices)");
+            }
+            charge(1);
+            form = (stream.index_signed ? "s" : "u") + bits;
+            std::string type = std::string(stream.index_signed ? "int" : "uint") + bits + "_t";
+            indices = "svld1_" + form + "(" + predicate() + ", (const " + type + "*)(" + address(indexStream(stream), copy) + "))";
+            return true;
+        }
+
+        // 读出一个向量: 连续流 vld1q / svld1, 交错组整组读出后取成员, 间接与大步长访问逐元素 gather
+        bool VectorLoopEmitter::load(Stream stream, int64_t member, Value& out) {
+            stream.loaded = true;
+            registerStream(stream);
+            recordAccess(stream, member, "load");
+            if (stream.index) {
+                registerStream(indexStream(stream));
+                recordAccess(indexStream(stream), 0, "load");
+            }
+            std::string scalar = element->scalar;
+            std::string sfx = element->suffix;
+            std::string where = "(const " + scalar + "*)(" + address(stream, copy) + ")";
+            out.mask = false;
+
+            if (stream.index || stream.stride > kMaxInterleave) {
+                irregular = true;
+                if (sve) {
+                    std::string form, indices;
+                    if (!gatherIndices(stream, form, indices)) return false;
+                    charge(2 * lanes);
+                    std::string base = stream.index ? "(const " + scalar + "*)(" + stream.base->getNameAsString() + ")" : where;
+                    out.code = "svld1_gather_" + form + "index_" + sfx + "(" + predicate() + ", " + base + ", " + indices + ")";
+                    return true;
+                }
+                // NEON 没有 gather: 首通道 vld1q_dup, 其余通道逐个 vld1q_lane 插入
+                charge(3 * lanes);
+                auto lane = [&](int k) {
+                    std::string target = stream.index ? stream.base->getNameAsString() + "[" + elementAt(indexStream(stream), copy, k) + "]"
+                                                      : elementAt(stream, copy, k);
+                    return "(const " + scalar + "*)&" + target;
+                };
+                out.code = op("vld1q_dup") + "(" + lane(0) + ")";
+                for (int k = 1; k < lanes; ++k) out.code = op("vld1q_lane") + "(" + lane(k) + ", " + out.code + ", " + std::to_string(k) + ")";
+                return true;
+            }
+
+            if (stream.stride > 1) {
+                // 同一副本中同组的成员共用一次整组读取; 已暂存未写出的成员直接取暂存值
+                Location location = locationOf(stream);
+                auto pending = group_stores.find(location);
+                if (pending != group_stores.end() && pending->second.count(member)) {
+                    out.code = pending->second[member];
+                    return true;
+                }
+                std::string count = std::to_string(stream.stride);
+                std::string& group = group_loads[{location, sve ? predicate() : std::string()}];
+                if (group.empty()) {
+                    charge(static_cast<int>(stream.stride));
+                    group = temporary(groupType(stream.stride), sve ? "svld" + count + "_" + sfx + "(" + predicate() + ", " + where + ")"
+                                                                    : "vld" + count + "q_" + sfx + "(" + where + ")");
+                }
+                out.code = sve ? "svget" + count + "_" + sfx + "(" + group + ", " + std::to_string(member) + ")"
+                               : group + ".val[" + std::to_string(member) + "]";
+                return true;
+            }
+
+            charge(1);
+            out.code = sve ? "svld1_" + sfx + "(" + predicate() + ", " + where + ")" : op("vld1q") + "(" + where + ")";
+            return true;
+        }
+
+        // 写回一个向量: SVE 按谓词写; NEON 没有带掩码的存储, 条件存储读出原值按掩码混合后整向量写回
+        bool VectorLoopEmitter::store(Stream stream, int64_t member, const std::string& value) {
+            stream.stored = true;
+            registerStream(stream);
+            recordAccess(stream, member, "store");
+            if (stream.index) {
+                registerStream(indexStream(stream));
+                recordAccess(indexStream(stream), 0, "load");
+            }
+            std::string scalar = element->scalar;
+            std::string sfx = element->suffix;
+            std::string name = stream.base->getNameAsString();
+            std::string where = "(" + scalar + "*)(" + address(stream, copy) + ")";
+
+            if (stream.index || stream.stride > kMaxInterleave) {
+                irregular = true;
+                if (sve) {
+                    // 下标重复时 scatter 按通道顺序写入, 与标量循环一样后写的生效
+                    std::string form, indices;
+                    if (!gatherIndices(stream, form, indices)) return false;
+                    charge(2 * lanes);
+                    std::string base = stream.index ? "(" + scalar + "*)(" + name + ")" : where;
+                    lines.push_back("svst1_scatter_" + form + "index_" + sfx + "(" + predicate() + ", " + base + ", " + indices + ", " + value + ");");
+                    return true;
+                }
+                if (!mask.empty()) return fail("has a conditional scatter through '" + name + "' (NEON has no masked scatter)");
+                // 逐通道 vst1q_lane 按通道顺序写出
+                charge(3 * lanes);
+                std::string source = isSimpleOperand(value) ? value : temporary(vectorType(), value);
+                for (int k = 0; k < lanes; ++k) {
+                    std::string target = stream.index ? name + "[" + elementAt(indexStream(stream), copy, k) + "]" : elementAt(stream, copy, k);
+                    lines.push_back(op("vst1q_lane") + "((" + scalar + "*)&" + target + ", " + source + ", " + std::to_string(k) + ");");
+                }
+                return true;
+            }
+            if (stream.stride > 1) return storeGroup(stream, member, value);
+
+            charge(1);
+            if (sve) {
+                lines.push_back("svst1_" + sfx + "(" + predicate() + ", " + where + ", " + value + ");");
+                return true;
+            }
+            std::string code = value;
+            if (!mask.empty()) code = select(mask, value, op("vld1q") + "((const " + scalar + "*)(" + address(stream, copy) + "))");
+            lines.push_back(op("vst1q") + "(" + where + ", " + code + ");");
+            return true;
+        }
+
+        // 交错组的成员先暂存, 全部成员都写过后整组 vstNq / svstN 写出
+        bool VectorLoopEmitter::storeGroup(const Stream& stream, int64_t member, const std::string& value) {
+            if (!mask.empty()) return fail("stores into interleaved '" + stream.base->getNameAsString() + "' under a condition");
+            Location location = locationOf(stream);
+            auto& pending = group_stores[location];
+            pending[member] = temporary(vectorType(), value);
+            if (static_cast<int64_t>(pending.size()) < stream.stride) return true;
+
+            std::string count = std::to_string(stream.stride);
+            std::string sfx = element->suffix;
+            std::string parts;
+            for (const auto& [index, part] : pending) parts += (parts.empty() ? "" : ", ") + part;
+            std::string where = "(" + std::string(element->scalar) + "*)(" + address(stream, copy) + ")";
+            charge(static_cast<int>(stream.stride));
+            if (sve) {
+                lines.push_back("svst" + count + "_" + sfx + "(" + prefix + "pg, " + where + ", svcreate" + count + "_" + sfx + "(" + parts + "));");
+            } else {
+                std::string group = temporary(groupType(stream.stride), "{{" + parts + "}}");
+                lines.push_back("vst" + count + "q_" + sfx + "(" + where + ", " + group + ");");
+            }
+            group_stores.erase(location);
+            // 写出后此前整组读出的值已过期
+            for (auto it = group_loads.begin(); it != group_loads.end();) {
+                it = it->first.first == location ? group_loads.erase(it) : std::next(it);
+            }
+            return true;
+        }
+
+        void VectorLoopEmitter::recordAccess(const Stream& stream, int64_t member, const std::string& kind) {
+            Location location = locationOf(stream);
+            if (mask.empty() && conditional == 0) {
+                touched.insert(location);
+                if (kind == "store") written.insert(location);
+                members[location].insert(member);
+            } else if (!sve || conditional > 0) {
+                // SVE 在 if 掩码下按谓词访问, 只有 ?: / && / || 分支中的读取会越过条件
+                std::string& guard = guarded[location];
+                if (guard != "store") guard = kind;
+            }
+        }
+
+        // if (x < c) x = c; / if (x > c) x = c; 对局部变量是逐通道 max / min.
+        // 浮点只在 c 为非零常量时改写: vmaxq 会把 -0.0 变为 +0.0, c 为 NaN 时结果也不同, 其余情况保留比较 + 选择
+        bool VectorLoopEmitter::translateClamp(const clang::IfStmt* branch, bool& matched) {
+            matched = false;
+            ReductionUpdate update;
+            if (!matchConditionalUpdate(branch, ctx, update) || update.index || countReferences(update.value, update.var) > 0) return true;
+            auto name = local_names.find(update.var);
+            if (name == local_names.end() || !isElement(update.var->getType()) || !isElement(update.value->getType())) return true;
+            if (element->is_float) {
+                clang::Expr::EvalResult bound;
+                if (update.value->isValueDependent() || !update.value->EvaluateAsRValue(bound, ctx) || !bound.Val.isFloat()) return true;
+                const llvm::APFloat& number = bound.Val.getFloat();
+                if (number.isZero() || number.isNaN()) return true;
+            }
+            matched = true;
+            Value value;
+            if (!translate(update.value, nullptr, value)) return false;
+            if (value.mask) return fail("clamps to a condition");
+            std::string var = name->second + "_v" + std::to_string(copy);
+            std::string clamped = arith(update.op == "max" ? "vmaxq" : "vminq", var, value.code);
+            lines.push_back(var + " = " + (mask.empty() ? clamped : select(mask, clamped, var)) + ";");
+            return true;
+        }
+
+        bool VectorLoopEmitter::translateStatement(const clang::Stmt* stmt) {
+            for (const auto& reduction : reductions) {
+                if (reduction.stmt == stmt) return translateReduction(reduction);
+            }
+            if (auto* compound = llvm::dyn_cast<clang::CompoundStmt>(stmt)) {
+                for (const auto* child : compound->body()) {
+                    if (!translateStatement(child)) return false;
+                }
+                return true;
+            }
+            if (llvm::isa<clang::NullStmt>(stmt)) return true;
+            if (auto* decl = llvm::dyn_cast<clang::DeclStmt>(stmt)) {
+                for (const auto* d : decl->decls()) {
+                    auto* var = llvm::cast<clang::VarDecl>(d);
+                    Value value = {splat("0"), false};
+                    if (var->hasInit() && (!translate(var->getInit(), nullptr, value) || value.mask)) {
+                        return fail("initializes '" + var->getNameAsString() + "' with a non-vectorizable value");
+                    }
+                    // 不同作用域的同名局部变量各自得到唯一名字; 名字在各展开副本间共享
+                    if (!local_names.count(var)) {
+                        std::string stem = var->getNameAsString();
+                        int suffix = 0;
+                        auto taken = [&](const std::string& candidate) {
+                            for (const auto& [other, name] : local_names) {
+                                if (name == candidate) return true;
+                            }
+                            return false;
+                        };
+                        std::string name = stem;
+                        while (taken(name)) name = stem + std::to_string(++suffix);
+                        local_names[var] = name;
+                    }
+                    lines.push_back(vectorType() + " " + local_names[var] + "_v" + std::to_string(copy) + " = " + value.code + ";");
+                }
+                return true;
+            }
+            if (auto* branch = llvm::dyn_cast<clang::IfStmt>(stmt)) {
+                if (branch->getInit() || branch->getConditionVariable() || branch->isConstexpr()) return fail("has an unsupported if form");
+                bool clamp = false;
+                if (!translateClamp(branch, clamp)) return false;
+                if (clamp) return true;
+                Value cond;
+                if (!translate(branch->getCond(), nullptr, cond)) return false;
+                if (!cond.mask) return fail("branches on a non-comparison");
+                // if/else 转为掩码: 分支内对局部变量的赋值改为按掩码选择, 存储按掩码写
+                std::string outer = mask;
+                std::string taken = temporary(maskType(), cond.code);
+                mask = outer.empty() ? taken : temporary(maskType(), maskAnd(outer, taken));
+                bool ok = translateStatement(branch->getThen());
+                if (ok && branch->getElse()) {
+                    std::string other = maskNot(taken);
+                    mask = temporary(maskType(), outer.empty() ? other : maskAnd(outer, other));
+                    ok = translateStatement(branch->getElse());
+                }
+                mask = outer;
+                return ok;
+            }
+            if (auto* expr = llvm::dyn_cast<clang::Expr>(stmt)) {
+                const clang::VarDecl* var = nullptr;
+                int64_t step = 1;
+                if (isInductionStep(expr->IgnoreParens(), var, step) && inductions.count(var)) {
+                    if (!mask.empty()) return fail("advances a pointer conditionally");
+                    advanced[var]++;
+                    return true;
+                }
+                auto* assign = llvm::dyn_cast<clang::BinaryOperator>(expr->IgnoreParens());
+                if (assign && assign->isAssignmentOp()) return translateAssignment(assign);
+            }
+            return fail(std::string("has an unsupported statement (") + stmt->getStmtClassName() + ")");
+        }
+
+        bool VectorLoopEmitter::translateReduction(const Reduction& reduction) {
+            const ReductionUpdate& update = reduction.update;
+            const std::string& kind = update.op;
+            if (!isElement(update.value->getType())) {
+                return fail("reduces a value of another type into '" + update.var->getNameAsString() + "'");
+            }
+            Value value;
+            if (!translate(update.value, nullptr, value)) return false;
+            if (value.mask) return fail("reduces a condition into '" + update.var->getNameAsString() + "'");
+
+            if (reduction.ordered) {
+                // svadda 按通道顺序累加; 各副本的这一行按副本顺序交错, 整体仍是源顺序
+                charge(lanes);
+                std::string var = update.var->getNameAsString();
+                lines.push_back(var + " = svadda_" + element->suffix + "(" + prefix + "pg, " + var + ", " + value.code + ");");
+                return true;
+            }
+            std::string suffix = "_v" + std::to_string(copy);
+            std::string acc = reduction.name + suffix;
+            if (update.index) {
+                // 严格更好的通道取新值与当前位置; 位置按相对循环入口的下标计
+                std::string candidate = temporary(element->vector, value.code);
+                std::string better = temporary(element->mask, op(kind == "argmin" ? "vcltq" : "vcgtq") + "(" + candidate + ", " + acc + ")");
+                std::string position = reduction.name + "_pos";
+                if (copy > 0) {
+                    position = maskOp("vaddq") + "(" + position + ", " +
+                               hoist(maskOp("vdupq_n") + "(" + std::to_string(copy * lanes) + ")", element->mask) + ")";
+                }
+                std::string index = reduction.name + "_idx" + suffix;
+                lines.push_back(acc + " = " + op("vbslq") + "(" + better + ", " + candidate + ", " + acc + ");");
+                lines.push_back(index + " = " + maskOp("vbslq") + "(" + better + ", " + position + ", " + index + ");");
+                return true;
+            }
+
+            // SVE 用合并 (_m) 形式, 谓词外的通道保留累加器原值
+            if (sve) {
+                charge(1);
+                lines.push_back(acc + " = " + sveName(reductionStep(kind)) + "_" + element->suffix + "_m(" + prefix + "pg, " + acc + ", " + value.code + ");");
+            } else {
+                lines.push_back(acc + " = " + arith(reductionStep(kind), acc, value.code) + ";");
+            }
+            return true;
+        }
+
+        const char* VectorLoopEmitter::reductionStep(const std::string& kind) const {
+            if (kind == "sum") return "vaddq";
+            if (kind == "product") return "vmulq";
+            if (kind == "min") return element->is_float ? "vminnmq" : "vminq";     // 同 sveOperation, 忽略 NaN 输入
+            if (kind == "max") return element->is_float ? "vmaxnmq" : "vmaxq";
+            if (kind == "and") return "vandq";
+            if (kind == "or") return "vorrq";
+            return "veorq";
+        }
+
+        // 逐通道取出后用 C 运算符合并, 用于没有跨通道指令的归约
+        std::string VectorLoopEmitter::laneFold(const std::string& vector, const std::string& suffix, int count, const char* symbol) const {
+            std::string text;
+            for (int lane = 0; lane < count; ++lane) {
+                if (lane > 0) text += std::string(" ") + symbol + " ";
+                text += "vgetq_lane_" + suffix + "(" + vector + ", " + std::to_string(lane) + ")";
+            }
+            return text;
+        }
+
+        std::string VectorLoopEmitter::reductionSetup(const std::string& indent) const {
+            std::string text;
+            for (const auto& reduction : reductions) {
+                if (reduction.ordered) continue;
+                const ReductionUpdate& update = reduction.update;
+                const std::string& kind = update.op;
+                std::string var = update.var->getNameAsString();
+                // sum/product/xor 从单位元开始, 结束时并入原值; 其余运算幂等, 直接广播原值
+                std::string init = kind == "sum" || kind == "xor" ? "0" : kind == "product" ? "1" : var;
+                for (int k = 0; k < unroll; ++k) {
+                    text += indent + vectorType() + " " + reduction.name + "_v" + std::to_string(k) + " = " + splat(init) + ";\n";
+                }
+                if (!update.index) continue;
+                // 位置通道全 1 表示从未更新; 位置相对 first 计, 入口条件保证不超过通道位宽
+                std::string none = element->bits == 32 ? "0xFFFFFFFFu" : "~0ULL";
+                for (int k = 0; k < unroll; ++k) {
+                    text += indent + element->mask + " " + reduction.name + "_idx_v" + std::to_string(k) + " = " + maskOp("vdupq_n") + "(" + none + ");\n";
+                }
+                std::string iota = element->bits == 32 ? "vcombine_u32(vcreate_u32(0x100000000ULL), vcreate_u32(0x300000002ULL))"
+                                                       : "vcombine_u64(vcreate_u64(0), vcreate_u64(1))";
+                text += indent + element->mask + " " + reduction.name + "_pos = " + iota + ";\n";
+                text += indent + "const " + iterator->getType().getAsString() + " " + reduction.name + "_first = " + iterator->getNameAsString() + ";\n";
+            }
+            return text;
+        }
+
+        std::string VectorLoopEmitter::reductionCombine(const std::string& indent) {
+            std::string text;
+            for (const auto& reduction : reductions) {
+                if (reduction.ordered) continue;
+                const ReductionUpdate& update = reduction.update;
+                const std::string& kind = update.op;
+                const std::string& name = reduction.name;
+                std::string var = update.var->getNameAsString();
+
+                // 部分累加器两两树形合并到 _v0
+                for (const auto& [keep, other] : treePairs(unroll)) {
+                    std::string a = name + "_v" + std::to_string(keep);
+                    std::string b = name + "_v" + std::to_string(other);
+                    if (!update.index) {
+                        text += indent + a + " = " + arith(reductionStep(kind), a, b) + ";\n";
+                        continue;
+                    }
+                    // 值相同时保留较小的位置, 与标量循环的首次出现一致
+                    std::string a_idx = name + "_idx_v" + std::to_string(keep);
+                    std::string b_idx = name + "_idx_v" + std::to_string(other);
+                    std::string take = name + "_take" + std::to_string(other);
+                    text += indent + "const " + element->mask + " " + take + " = " + maskOp("vorrq") + "(" +
+                            op(kind == "argmin" ? "vcltq" : "vcgtq") + "(" + b + ", " + a + "), " + maskOp("vandq") + "(" +
+                            op("vceqq") + "(" + b + ", " + a + "), " + maskOp("vcltq") + "(" + b_idx + ", " + a_idx + ")));\n";
+                    text += indent + a + " = " + op("vbslq") + "(" + take + ", " + b + ", " + a + ");\n";
+                    text += indent + a_idx + " = " + maskOp("vbslq") + "(" + take + ", " + b_idx + ", " + a_idx + ");\n";
+                }
+
+                std::string acc = name + "_v0";
+                std::string scalar_cast = element->is_float ? "" : std::string("(") + element->scalar + ")";
+                if (sve) {
+                    // 合并在全真谓词下进行, 尾部迭代未激活的通道已由 _m 形式保留
+                    std::string across;
+                    if (kind == "sum") across = "svaddv";
+                    else if (kind == "min") across = element->is_float ? "svminnmv" : "svminv";
+                    else if (kind == "max") across = element->is_float ? "svmaxnmv" : "svmaxv";
+                    else if (kind == "and") across = "svandv";
+                    else if (kind == "or") across = "svorv";
+                    else across = "sveorv";
+                    std::string reduced = across + "_" + element->suffix + "(" + prefix + "pg, " + acc + ")";
+                    if (kind == "sum") {
+                        text += indent + var + " = " + var + " + " + scalar_cast + reduced + ";\n";
+                    } else if (kind == "xor") {
+                        text += indent + var + " = " + var + " ^ " + reduced + ";\n";
+                    } else {
+                        text += indent + var + " = " + reduced + ";\n";
+                    }
+                    continue;
+                }
+                if (kind == "sum") {
+                    text += indent + var + " = " + var + " + " + scalar_cast + op("vaddvq") + "(" + acc + ");\n";
+                } else if (kind == "product") {
+                    text += indent + var + " = " + var + " * " + laneFold(acc, element->suffix, lanes, "*") + ";\n";
+                } else if (kind == "min" || kind == "max") {
+                    std::string across = kind == "min" ? (element->is_float ? "vminnmvq" : "vminvq") : (element->is_float ? "vmaxnmvq" : "vmaxvq");
+                    text += indent + var + " = " + op(across.c_str()) + "(" + acc + ");\n";
+                } else if (kind == "and" || kind == "or") {
+                    text += indent + var + " = " + laneFold(acc, element->suffix, lanes, kind == "and" ? "&" : "|") + ";\n";
+                } else if (kind == "xor") {
+                    text += indent + var + " = " + var + " ^ " + laneFold(acc, element->suffix, lanes, "^") + ";\n";
+                } else {
+                    // 取最优值, 再在等于最优值的通道中取最小位置; 全 1 表示没有通道更新过
+                    std::string best = name + "_best";
+                    std::string at = name + "_at";
+                    std::string index_type = element->bits == 32 ? "uint32_t" : "uint64_t";
+                    std::string none = element->bits == 32 ? "0xFFFFFFFFu" : "~0ULL";
+                    std::string hits = maskOp("vbslq") + "(" + op("vceqq") + "(" + acc + ", " + op("vdupq_n") + "(" + best + ")), " +
+                                       name + "_idx_v0, " + maskOp("vdupq_n") + "(" + none + "))";
+                    text += indent + "const " + element->scalar + " " + best + " = " + op(kind == "argmin" ? "vminvq" : "vmaxvq") + "(" + acc + ");\n";
+                    if (element->bits == 32) {
+                        text += indent + "const " + index_type + " " + at + " = vminvq_u32(" + hits + ");\n";
+                    } else {
+                        // 没有 64 位跨通道 min, 两个通道直接比较
+                        text += indent + "const uint64x2_t " + name + "_hits = " + hits + ";\n";
+                        text += indent + "const uint64_t " + at + " = vgetq_lane_u64(" + name + "_hits, 0) < vgetq_lane_u64(" + name +
+                                "_hits, 1) ? vgetq_lane_u64(" + name + "_hits, 0) : vgetq_lane_u64(" + name + "_hits, 1);\n";
+                    }
+                    text += indent + "if (" + at + " != " + none + ") {\n";
+                    text += indent + "    " + var + " = " + best + ";\n";
+                    text += indent + "    " + update.index->getNameAsString() + " = " + name + "_first + " + at + ";\n";
+                    text += indent + "}\n";
+                }
+            }
+            return text;
+        }
+
+        std::string VectorLoopEmitter::aliasCheck() const {
+            // 写入流与其它基址的访问区间 [begin, begin + 步长 * 剩余次数) 不得重叠, 外提的不变读取不得落在写入区间内;
+            // 间接访问的区间未知, 由 emit 中的类型证明保证不重叠
+            std::vector<std::string> checks;
+            auto range = [this](const Stream& stream, std::string& begin, std::string& end) {
+                std::string span = stream.stride == 1 ? remaining : std::to_string(stream.stride) + " * " + remaining;
+                begin = "(uintptr_t)(" + address(stream, 0) + ")";
+                end = "(uintptr_t)(" + address(stream, 0) + " + " + span + ")";
+            };
+            for (size_t i = 0; i < streams.size(); ++i) {
+                if (!streams[i].stored || streams[i].index) continue;
+                std::string store_begin, store_end;
+                range(streams[i], store_begin, store_end);
+                for (size_t k = 0; k < streams.size(); ++k) {
+                    if (streams[k].index || streams[k].base == streams[i].base || (streams[k].stored && k < i)) continue;
+                    std::string begin, end;
+                    range(streams[k], begin, end);
+                    checks.push_back("(" + store_end + " <= " + begin + " || " + end + " <= " + store_begin + ")");
+                }
+                for (const auto& point : points) {
+                    checks.push_back("((uintptr_t)(&(" + point + ") + 1) <= " + store_begin + " || " + store_end + " <= (uintptr_t)&(" + point + "))");
+                }
+            }
+            std::string text;
+            for (const auto& check : checks) text += " &&\n            " + check;
+            return text;
+        }
+
+        int64_t VectorLoopEmitter::entryAlignment(const Stream& stream) const {
+            if (stream.index || stream.induction || stream.stride != 1) return 1;
+            const int64_t bytes = element->bits / 8;
+            return std::min({alignment.alignmentOf(stream.base), lowestBit(start_multiple * bytes), lowestBit(stream.offset * bytes)});
+        }
+
+        std::string VectorLoopEmitter::alignStreams(std::vector<std::vector<std::string>>& copies, std::string& summary) const {
+            const int64_t bytes = element->bits / 8;
+            auto contiguous = [](const Stream& stream) { return !stream.index && !stream.induction && stream.stride == 1; };
+
+            // 剥离目标: 首个写入的连续流 (跨缓存行的写代价更高), 没有写入时取首个读取的连续流.
+            // 剥离只在长循环上执行, 之后的对齐是运行时性质, 不据此加对齐提示
+            const Stream* peeled = nullptr;
+            if (align_peel_trip > 0) {
+                for (bool stored : {true, false}) {
+                    for (const auto& stream : streams) {
+                        if (!peeled && contiguous(stream) && stream.stored == stored) peeled = &stream;
+                    }
+                }
+                if (peeled && entryAlignment(*peeled) >= kVectorAlignment) peeled = nullptr;
+            }
+            std::string code;
+            if (peeled) {
+                const std::string cond = printExpr(loop->getCond(), ctx);
+                const std::string count = prefix + "peel";
+                const std::string boundary = sve ? prefix + "align" : std::to_string(kVectorAlignment);
+                code += "        if (" + cond + " && " + remaining + " >= " + std::to_string(align_peel_trip) + ") {\n";
+                if (sve) code += "            const uint64_t " + boundary + " = svcntb();\n";
+                code += "            for (uint64_t " + count + " = ((" + boundary + " - (uintptr_t)(" + address(*peeled, 0) + ") % " + boundary +
+                        ") % " + boundary + ") / " + std::to_string(bytes) + "; " + count + " > 0 && " + cond + "; --" + count + ", " +
+                        printExpr(loop->getInc(), ctx) + ") {\n";
+                code += printLoopBody(loop->getBody(), ctx, 4);
+                code += "            }\n";
+                code += "        }\n";
+                summary += ", peeled to align '" + peeled->base->getNameAsString() + "'";
+            }
+
+            for (const auto& stream : streams) {
+                if (!contiguous(stream) || entryAlignment(stream) < kVectorAlignment) continue;
+                summary += ", aligned '" + stream.base->getNameAsString() + "'";
+                for (int copy_index = 0; copy_index < unroll; ++copy_index) {
+                    const std::string where = address(stream, copy_index);
+                    const std::string hint = "__builtin_assume_aligned(" + where + ", " + std::to_string(kVectorAlignment) + ")";
+                    for (const std::string& qualifier : {std::string("const "), std::string()}) {
+                        const std::string plain = "(" + qualifier + element->scalar + "*)(" + where + ")";
+                        const std::string hinted = "(" + qualifier + element->scalar + "*)" + hint;
+                        for (auto& lines_of_copy : copies) {
+                            for (auto& line : lines_of_copy) {
+                                for (size_t pos = line.find(plain); pos != std::string::npos; pos = line.find(plain, pos + hinted.size())) {
+                                    line.replace(pos, plain.size(), hinted);
+                                }
+                            }
+                        }
+                    }
+                }
+            }
+            return code;
+        }
+
+        bool VectorLoopEmitter::planStreaming(std::vector<std::vector<std::string>>& copies, std::string& guard,
+                                              std::vector<std::string>& prefetches, std::string& summary) {
+            if (streaming_bytes <= 0) return false;
+            const int64_t bytes = element->bits / 8;
+            // 每次标量迭代访问的字节数; 交错组整组读写
+            int64_t per_iteration = 0;
+            for (const auto& stream : streams) per_iteration += bytes * (stream.index ? 1 : std::max<int64_t>(1, stream.stride));
+            if (per_iteration == 0) return false;
+            const int64_t min_trip = (streaming_bytes + per_iteration - 1) / per_iteration;
+
+            // 迭代次数编译期已知时直接判断
+            auto* cond = llvm::dyn_cast<clang::BinaryOperator>(loop->getCond()->IgnoreParenImpCasts());
+            const clang::Stmt* init = loop->getInit();
+            const clang::Expr* start = nullptr;
+            if (auto* decl = llvm::dyn_cast_or_null<clang::DeclStmt>(init)) {
+                start = llvm::cast<clang::VarDecl>(decl->getSingleDecl())->getInit();
+            } else if (auto* assign = llvm::dyn_cast_or_null<clang::BinaryOperator>(init)) {
+                start = assign->getRHS();
+            }
+            clang::Expr::EvalResult first, bound;
+            if (cond && start && !start->isValueDependent() && start->EvaluateAsInt(first, ctx) && !cond->getRHS()->isValueDependent() &&
+                cond->getRHS()->EvaluateAsInt(bound, ctx)) {
+                int64_t trip = bound.Val.getInt().getExtValue() - first.Val.getInt().getExtValue();
+                if (trip < min_trip) return false;
+            }
+
+            std::vector<std::string> checks = {remaining + " >= " + std::to_string(min_trip)};
+            std::string stored_names, loaded_names;
+            for (const auto& stream : streams) {
+                const Location location = locationOf(stream);
+                const std::string name = "'" + stream.base->getNameAsString() + "'";
+                // 只写的连续流: 写入的数据不会很快再被读到, 绕过缓存避免挤掉读取流
+                if (!stream.index && stream.stride == 1 && stream.stored && !stream.loaded && !guarded.count(location)) {
+                    bool aligned = entryAlignment(stream) >= kVectorAlignment;
+                    for (int copy_index = 0; copy_index < unroll; ++copy_index) {
+                        const std::string where = address(stream, copy_index);
+                        const std::string targets[] = {
+                            "(" + std::string(element->scalar) + "*)(" + where + ")",
+                            "(" + std::string(element->scalar) + "*)__builtin_assume_aligned(" + where + ", " + std::to_string(kVectorAlignment) + ")",
+                        };
+                        for (auto& lines_of_copy : copies) {
+                            for (auto& line : lines_of_copy) {
+                                for (const auto& target : targets) {
+                                    if (sve) {
+                                        const std::string store = "svst1_" + std::string(element->suffix) + "(";
+                                        if (line.rfind(store, 0) == 0 && line.find(", " + target + ", ") != std::string::npos) {
+                                            line = "svstnt1_" + line.substr(6);
+                                        }
+                                        continue;
+                                    }
+                                    // vst1q_T(ptr, value); -> __builtin_nontemporal_store(value, (VT*)(addr)); 向量类型的指针要求 16 字节对齐
+                                    const std::string store = op("vst1q") + "(" + target + ", ";
+                                    if (line.rfind(store, 0) != 0 || line.size() < store.size() + 2) continue;
+                                    std::string value = line.substr(store.size(), line.size() - store.size() - 2);
+                                    line = "__builtin_nontemporal_store(" + value + ", (" + element->vector + "*)(" + where + "));";
+                                }
+                            }
+                        }
+                    }
+                    if (!sve && !aligned) checks.push_back("(uintptr_t)(" + address(stream, 0) + ") % " + std::to_string(kVectorAlignment) + " == 0");
+                    stored_names += (stored_names.empty() ? "" : ", ") + name;
+                }
+                if (stream.index || stream.stride > kMaxInterleave || !stream.loaded || prefetch_distance <= 0) continue;
+                // 读取流按距离提前预取; 读写同一流时预取为写
+                const int64_t ahead = std::max<int64_t>(1, prefetch_distance / bytes);
+                const std::string offset = " + " + std::to_string(ahead * std::max<int64_t>(1, stream.stride));
+                if (sve) {
+                    for (int copy_index = 0; copy_index < unroll; ++copy_index) {
+                        prefetches.push_back("svprfb(svptrue_b8(), " + address(stream, copy_index) + offset + ", " +
+                                             (stream.stored ? "SV_PSTL1STRM" : "SV_PLDL1STRM") + ");");
+                    }
+                } else {
+                    // 每条缓存行 (按 64 字节计) 预取一次
+                    const int64_t line_elements = std::max<int64_t>(1, 64 / bytes);
+                    const int64_t span = static_cast<int64_t>(unroll) * lanes * std::max<int64_t>(1, stream.stride);
+                    for (int64_t at = 0; at < span; at += line_elements) {
+                        std::string where = address(stream, 0) + offset + (at > 0 ? " + " + std::to_string(at) : std::string());
+                        prefetches.push_back("__builtin_prefetch(" + where + ", " + (stream.stored ? "1" : "0") + ", 0);");
+                    }
+                }
+                loaded_names += (loaded_names.empty() ? "" : ", ") + name;
+            }
+            if (stored_names.empty() && loaded_names.empty()) return false;
+
+            for (const auto& check : checks) guard += (guard.empty() ? "" : " && ") + check;
+            std::string note;
+            if (!stored_names.empty()) note += "non-temporal stores to " + stored_names;
+            if (!loaded_names.empty()) {
+                note += (note.empty() ? "" : ", ") + std::string("prefetch of ") + loaded_names + " " + std::to_string(prefetch_distance) + " bytes ahead";
+            }
+            note += " once " + std::to_string(min_trip) + "+ iterations remain (" + std::to_string(streaming_bytes) + " byte working set)";
+            summary += ", streaming: " + note;
+            memory_note = note;
+            return true;
+        }
+
+        std::string VectorLoopEmitter::emit(std::string& reason) {
+            if (!analyzeControl()) {
+                reason = failure;
+                return "";
+            }
+
+            // 每个展开副本独立翻译 (名字带 _vN 后缀), 各副本行数相同, 按行交错以隐藏指令延迟
+            std::vector<std::vector<std::string>> copies;
+            for (copy = 0; copy < unroll; ++copy) {
+                lines.clear();
+                temp_count = 0;
+                advanced.clear();
+                group_loads.clear();
+                group_stores.clear();
+                if (!translateStatement(loop->getBody())) {
+                    reason = failure;
+                    return "";
+                }
+                if (!group_stores.empty()) {
+                    reason = "stores only some members of an interleaved group of '" + std::get<0>(group_stores.begin()->first)->getNameAsString() + "'";
+                    return "";
+                }
+                copies.push_back(lines);
+            }
+            for (const auto& stream : streams) {
+                std::string name = stream.base->getNameAsString();
+                for (const auto& other : streams) {
+                    if (stream.stored && other.base == stream.base && locationOf(other) != locationOf(stream)) {
+                        reason = "has a loop-carried dependence through '" + name + "'";
+                        return "";
+                    }
+                }
+                if (!stream.index) continue;
+                // 间接访问的地址运行时才知道: 读改写可能在同一向量内命中重复下标, 与其它流只能靠声明证明不重叠
+                if (stream.loaded && stream.stored) {
+                    reason = "updates '" + name + "' through indices from '" + stream.index->getNameAsString() + "' that may repeat within a vector";
+                    return "";
+                }
+                for (const auto& other : streams) {
+                    if (other.base == stream.base || (!stream.stored && !other.stored) || provablyDisjoint(stream.base, other.base)) continue;
+                    reason = "cannot prove that indexed access to '" + name + "' does not overlap '" + other.base->getNameAsString() +
+                             "' (declare one of them restrict)";
+                    return "";
+                }
+                if (stream.stored && !points.empty()) {
+                    reason = "scatters into '" + name + "' while reading loop-invariant memory";
+                    return "";
+                }
+            }
+            // 只有标量循环本来就会访问的位置才能整向量读取, 本来就会写入的位置才能整向量写回, 否则可能越界或引入数据竞争
+            for (const auto& [location, kind] : guarded) {
+                bool store = kind == "store";
+                if (!(store ? written : touched).count(location)) {
+                    reason = "has a conditional " + kind + " through '" + std::get<0>(location)->getNameAsString() + "' that is not " +
+                             (store ? "stored" : "accessed") + " unconditionally" + (sve ? std::string() : " (NEON has no masked " + kind + ")");
+                    return "";
+                }
+            }
+            // 交错组按整组读取: 有成员从未被无条件访问时最后一组可能越过标量循环的末尾, 留最后一次迭代给标量循环
+            bool gap = false;
+            for (const auto& stream : streams) {
+                if (!stream.index && stream.stride > 1 && stream.stride <= kMaxInterleave &&
+                    static_cast<int64_t>(members[locationOf(stream)].size()) < stream.stride) {
+                    gap = true;
+                }
+            }
+            // gather/scatter 与逐通道模拟按元素计价; 每 lanes 个元素的向量运算不少于标量运算时保持标量
+            if (irregular && vector_work >= scalar_work * lanes) {
+                reason = "gather/scatter is not profitable here (about " + std::to_string(vector_work) + " vector vs " +
+                         std::to_string(scalar_work * lanes) + " scalar operations per " + std::to_string(lanes) + " elements)";
+                return "";
+            }
+
+            const std::string it = iterator->getNameAsString();
+            const std::string at_least = gap ? " > " : " >= ";
+            auto advance = [&](const std::string& count, const std::string& indent) {
+                std::string text;
+                for (const auto& [var, stride] : inductions) {
+                    text += indent + var->getNameAsString() + " += " + (stride == 1 ? count : std::to_string(stride) + " * " + count) + ";\n";
+                }
+                for (const auto& reduction : reductions) {
+                    if (!reduction.update.index) continue;
+                    std::string pos = reduction.name + "_pos";
+                    text += indent + pos + " = " + maskOp("vaddq") + "(" + pos + ", " + maskOp("vdupq_n") + "(" + count + "));\n";
+                }
+                return text;
+            };
+            std::string summary;
+            bool narrow_positions = false;
+            for (const auto& reduction : reductions) {
+                summary += ", " + reduction.update.op + (reduction.ordered ? " (ordered)" : "") + " of '" + reduction.update.var->getNameAsString() + "'";
+                narrow_positions = narrow_positions || (reduction.update.index && element->bits == 32);
+            }
+            for (const auto& stream : streams) {
+                std::string name = "'" + stream.base->getNameAsString() + "'";
+                if (stream.index) {
+                    summary += stream.stored ? ", scatter to " + name : ", gather from " + name;
+                } else if (stream.stride > kMaxInterleave) {
+                    summary += ", stride-" + std::to_string(stream.stride) + (stream.stored ? " scatter to " : " gather from ") + name;
+                } else if (stream.stride > 1) {
+                    summary += ", " + std::to_string(stream.stride) + "-way interleaved " + name;
+                }
+            }
+
+            const std::string peel = alignStreams(copies, summary);
+            std::vector<std::vector<std::string>> streaming_copies = copies;
+            std::string streaming_guard;
+            std::vector<std::string> prefetches;
+            const bool streaming = planStreaming(streaming_copies, streaming_guard, prefetches, summary);
+
+            std::ostringstream code;
+            const std::string head = "        " + (declares_iterator ? iterator->getType().getAsString() + " " : std::string()) + it + " = " + start_text + ";\n";
+            auto body = [&](const std::vector<std::vector<std::string>>& parts, const std::string& indent = "                ") {
+                for (size_t line = 0; line < parts[0].size(); ++line) {
+                    for (const auto& part : parts) {
+                        if (line < part.size()) code << indent << part[line] << "\n";
+                    }
+                }
+            };
+            // 工作集足够大时先由流式主循环处理, 余下的迭代交给普通主循环与尾循环
+            auto streamingLoop = [&](const std::string& step) {
+                if (!streaming) return;
+                code << "            if (" << streaming_guard << ") {\n";
+                code << "                for (; " << remaining << at_least << step << "; " << it << " += " << step << ") {\n";
+                for (const auto& line : prefetches) code << "                    " << line << "\n";
+                body(streaming_copies, "                    ");
+                code << advance(step, "                    ");
+                code << "                }\n";
+                code << "            }\n";
+            };
+            if (!sve) {
+                const int step = unroll * lanes;
+                code << "    // NEON: '" << it << "' loop as " << element->vector << " x " << unroll << " streams ("
+                     << step << " elements per iteration)" << summary << ", scalar epilogue\n";
+                code << "    {\n" << head << peel;
+                code << "        if (" << printExpr(loop->getCond(), ctx) << " && " << remaining << at_least << lanes;
+                if (narrow_positions) code << " && " << remaining << " < 0xFFFFFFFFu";
+                code << aliasCheck() << ") {\n";
+                for (const auto& value : hoisted) {
+                    code << "            const " << value.type << " " << value.name << " = " << value.value << ";\n";
+                }
+                code << reductionSetup("            ");
+                streamingLoop(std::to_string(step));
+                code << "            for (; " << remaining << at_least << step << "; " << it << " += " << step << ") {\n";
+                body(copies);
+                code << advance(std::to_string(step), "                ");
+                code << "            }\n";
+                if (unroll > 1) {
+                    code << "            for (; " << remaining << at_least << lanes << "; " << it << " += " << lanes << ") {\n";
+                    body({copies[0]});
+                    code << advance(std::to_string(lanes), "                ");
+                    code << "            }\n";
+                }
+            } else {
+                // SVE: 全真谓词的展开主循环 + whilelt 谓词的剩余迭代; 标量循环只在重叠检查不通过 (或留给交错组的最后一次迭代) 时执行
+                const std::string bits = std::to_string(element->bits);
+                const std::string pg = prefix + "pg";
+                const std::string vl = prefix + "vl";
+                const std::string step = unroll == 1 ? vl : std::to_string(unroll) + " * " + vl;
+                const std::string left = printExpr(loop->getCond(), ctx) + (gap ? " && " + remaining + " > 1" : std::string());
+                code << "    // SVE: '" << it << "' loop as " << element->sve_vector << " x " << unroll << " (" << step
+                     << " elements per iteration)" << summary << ", predicated remainder, scalar fallback\n";
+                code << "    {\n" << head << peel;
+                code << "        if (" << left << aliasCheck() << ") {\n";
+                code << "            const svbool_t " << pg << " = svptrue_b" << bits << "();\n";
+                code << "            const uint64_t " << vl << " = " << sveCount() << "();\n";
+                for (const auto& value : hoisted) {
+                    code << "            const " << value.type << " " << value.name << " = " << value.value << ";\n";
+                }
+                code << reductionSetup("            ");
+                streamingLoop(step);
+                code << "            for (; " << remaining << at_least << step << "; " << it << " += " << step << ") {\n";
+                body(copies);
+                code << advance(step, "                ");
+                code << "            }\n";
+                code << "            while (" << left << ") {\n";
+                code << "                const svbool_t " << pg << " = svwhilelt_b" << bits << "_u64(0, " << remaining << (gap ? " - 1" : "") << ");\n";
+                body({copies[0]});
+                code << "                const uint64_t " << prefix << "active = svcntp_b" << bits << "(" << pg << ", " << pg << ");\n";
+                code << "                " << it << " += " << prefix << "active;\n";
+                code << advance(prefix + "active", "                ");
+                code << "            }\n";
+            }
+            code << reductionCombine("            ");
+            code << "        }\n";
+            code << "        for (; " << printExpr(loop->getCond(), ctx) << "; " << printExpr(loop->getInc(), ctx) << ") {\n";
+            code << printLoopBody(loop->getBody(), ctx, 3);
+            code << "        }\n";
+            code << "    }\n";
+            return code.str();
+        }
+
+    }  // namespace
+
+    // ============================================================================
+    // 归约代码生成 (SVE / AVX2)
+    // ============================================================================
+
+    namespace {
+
+        struct ReductionElementType {
+            const char* scalar;
+            int bits;
+            bool is_float;
+            bool is_signed;
+            const char* sve_suffix;
+            const char* avx_vector;
+            const char* avx_suffix;
+        };
+
+        const ReductionElementType kReductionElementTypes[] = {
+            {"float", 32, true, true, "f32", "__m256", "ps"},
+            {"double", 64, true, true, "f64", "__m256d", "pd"},
+            {"int8_t", 8, false, true, "s8", "__m256i", "epi8"},
+            {"int16_t", 16, false, true, "s16", "__m256i", "epi16"},
+            {"int32_t", 32, false, true, "s32", "__m256i", "epi32"},
+            {"int64_t", 64, false, true, "s64", "__m256i", "epi64"},
+            {"uint8_t", 8, false, false, "u8", "__m256i", "epi8"},
+            {"uint16_t", 16, false, false, "u16", "__m256i", "epi16"},
+            {"uint32_t", 32, false, false, "u32", "__m256i", "epi32"},
+            {"uint64_t", 64, false, false, "u64", "__m256i", "epi64"},
+        };
+
+        // 按 LoopVectorizationPattern 中的归约描述生成 SVE / AVX2 代码:
+        //   Vector  - options.unroll 个部分累加器, 树形合并后一次水平归约
+        //   Ordered - 浮点 sum 不重结合时, SVE 用 svadda 按元素顺序累加
+        //   Scalar  - 目标没有对应指令时保持标量, 原因写在注释里
+        class ReductionCodeBuilder {
+        public:
+            ReductionCodeBuilder(const LoopVectorizationPattern& pattern, const std::string& arch, const VectorLoopOptions& options);
+
+            std::string initialization() const;
+            std::string mainLoop() const;
+            std::string tailLoop() const;
+            std::string finish() const;
+
+        private:
+            enum class Mode { Vector, Ordered, Scalar };
+
+            const LoopVectorizationPattern& pattern;
+            bool is_sve;
+            int accumulators;
+            const ReductionElementType* element = nullptr;
+            Mode mode = Mode::Scalar;
+            std::string reason;
+
+            bool isArg() const { return pattern.reduction_op == "argmin" || pattern.reduction_op == "argmax"; }
+            bool isMin() const { return pattern.reduction_op == "min" || pattern.reduction_op == "argmin"; }
+            // min/max/and/or 重复并入不改变结果, 累加器直接以归约变量的初值广播
+            bool isIdempotent() const {
+                return pattern.reduction_op == "min" || pattern.reduction_op == "max" ||
+                       pattern.reduction_op == "and" || pattern.reduction_op == "or";
+            }
+            std::string identity() const { return pattern.reduction_op == "product" ? "1" : "0"; }
+
+            std::string accumulator(int k) const { return pattern.reduction_var + "_acc" + std::to_string(k); }
+            std::string indexAccumulator(int k) const { return pattern.reduction_var + "_idx" + std::to_string(k); }
+            std::string offset(int k) const {
+                if (k == 0) return "";
+                return k == 1 ? " + vl" : " + " + std::to_string(k) + " * vl";
+            }
+
+            std::string sveVector() const {
+                return std::string("sv") + (element->is_float ? "float" : element->is_signed ? "int" : "uint") + std::to_string(element->bits) + "_t";
+            }
+            std::string sve(const std::string& name) const { return name + "_" + element->sve_suffix; }
+            std::string predicateBits() const { return "b" + std::to_string(element->bits); }
+            std::string sveCount() const {
+                switch (element->bits) {
+                    case 8: return "svcntb";
+                    case 16: return "svcnth";
+                    case 32: return "svcntw";
+                    default: return "svcntd";
+                }
+            }
+            std::string indexSuffix() const { return "u" + std::to_string(element->bits); }
+            std::string indexSentinel() const { return element->bits == 32 ? "UINT32_MAX" : "UINT64_MAX"; }
+            std::string sveOperation() const;
+            std::string sveAcross() const;
+            std::string avxOperation() const;
+            std::string avxSplat(const std::string& value) const;
+            std::string avxLoad(const std::string& address) const;
+
+            std::string combine(const std::string& a, const std::string& b) const;
+            std::string scalarUpdate() const;
+            std::string scalarLoop(const std::string& indent) const;
+        };
+
+        ReductionCodeBuilder::ReductionCodeBuilder(const LoopVectorizationPattern& p, const std::string& arch,
+                                                   const VectorLoopOptions& options)
+            : pattern(p), is_sve(arch == "SVE"), accumulators(std::max(1, options.unroll)) {
+            for (const auto& candidate : kReductionElementTypes) {
+                if (pattern.data_type == candidate.scalar) element = &candidate;
+            }
+            const std::string& op = pattern.reduction_op;
+            bool bitwise = op == "and" || op == "or" || op == "xor";
+            if (arch != "SVE" && arch != "AVX2") {
+                reason = "no " + arch + " lowering for pattern-based reductions";
+            } else if (!element) {
+                reason = "element type '" + pattern.data_type + "' has no vector mapping";
+            } else if (pattern.reduction_source.empty()) {
+                reason = "the reduced value is not a single contiguous array read";
+            } else if (bitwise && element->is_float) {
+                reason = "bitwise reduction of a floating-point value";
+            } else if (element->is_float && (op == "sum" || op == "product") && !options.reassociate_fp) {
+                // 不允许重结合时只能逐元素按源顺序累加
+                if (is_sve && op == "sum") {
+                    mode = Mode::Ordered;
+                } else {
+                    reason = "ordered floating-point " + op + " has no in-order vector instruction on " + arch;
+                }
+            } else if (isArg() && (!is_sve || element->bits < 32)) {
+                reason = is_sve ? "lane positions need 32-bit or wider lanes" : "no AVX2 argmin/argmax lowering";
+            } else if (!is_sve && avxOperation().empty()) {
+                reason = "AVX2 has no " + std::string(element->avx_suffix) + " " + op + " instruction";
+            } else {
+                mode = Mode::Vector;
+            }
+        }
+
+        std::string ReductionCodeBuilder::sveOperation() const {
+            const std::string& op = pattern.reduction_op;
+            if (op == "sum") return "svadd";
+            if (op == "product") return "svmul";
+            // 浮点用 minnm/maxnm: 与 v < s ? v : s 一样跳过 NaN 输入
+            if (isMin()) return element->is_float ? "svminnm" : "svmin";
+            if (op == "max" || op == "argmax") return element->is_float ? "svmaxnm" : "svmax";
+            if (op == "and") return "svand";
+            if (op == "or") return "svorr";
+            return "sveor";
+        }
+
+        std::string ReductionCodeBuilder::sveAcross() const {
+            const std::string& op = pattern.reduction_op;
+            if (op == "sum") return "svaddv";
+            if (op == "product") return "";
+            if (isMin()) return element->is_float && !isArg() ? "svminnmv" : "svminv";
+            if (op == "max" || op == "argmax") return element->is_float && !isArg() ? "svmaxnmv" : "svmaxv";
+            if (op == "and") return "svandv";
+            if (op == "or") return "svorv";
+            return "sveorv";
+        }
+
+        std::string ReductionCodeBuilder::avxOperation() const {
+            const std::string& op = pattern.reduction_op;
+            std::string suffix = element->avx_suffix;
+            if (op == "sum") return "_mm256_add_" + suffix;
+            if (op == "product") {
+                if (element->is_float) return "_mm256_mul_" + suffix;
+                return element->bits == 16 || element->bits == 32 ? "_mm256_mullo_" + suffix : "";
+            }
+            if (op == "min" || op == "max") {
+                if (element->is_float) return "_mm256_" + op + "_" + suffix;
+                if (element->bits == 64) return "";
+                return "_mm256_" + op + "_" + (element->is_signed ? "epi" : "epu") + std::to_string(element->bits);
+            }
+            if (op == "and" || op == "or" || op == "xor") return "_mm256_" + op + "_si256";
+            return "";
+        }
+
+        std::string ReductionCodeBuilder::avxSplat(const std::string& value) const {
+            if (element->is_float) {
+                std::string suffix = element->avx_suffix;
+                return value == "0" ? "_mm256_setzero_" + suffix + "()" : "_mm256_set1_" + suffix + "(" + value + ")";
+            }
+            if (value == "0") return "_mm256_setzero_si256()";
+            switch (element->bits) {
+                case 8: return "_mm256_set1_epi8((char)" + value + ")";
+                case 16: return "_mm256_set1_epi16((short)" + value + ")";
+                case 32: return "_mm256_set1_epi32((int)" + value + ")";
+                default: return "_mm256_set1_epi64x((long long)" + value + ")";
+            }
+        }
+
+        std::string ReductionCodeBuilder::avxLoad(const std::string& address) const {
+            if (element->is_float) return "_mm256_loadu_" + std::string(element->avx_suffix) + "(" + address + ")";
+            return "_mm256_loadu_si256((const __m256i*)(" + address + "))";
+        }
+
+        std::string ReductionCodeBuilder::combine(const std::string& a, const std::string& b) const {
+            const std::string& op = pattern.reduction_op;
+            std::string expr;
+            if (op == "sum") expr = a + " + " + b;
+            else if (op == "product") expr = a + " * " + b;
+            else if (op == "and") expr = a + " & " + b;
+            else if (op == "or") expr = a + " | " + b;
+            else if (op == "xor") expr = a + " ^ " + b;
+            else if (isMin()) return "(" + b + " < " + a + " ? " + b + " : " + a + ")";
+            else return "(" + b + " > " + a + " ? " + b + " : " + a + ")";
+            // 窄整数运算先提升为 int, 截回元素类型与标量循环一致
+            if (element && !element->is_float && element->bits < 32) return "(" + pattern.data_type + ")(" + expr + ")";
+            return expr;
+        }
+
+        std::string ReductionCodeBuilder::scalarUpdate() const {
+            std::string value = pattern.reduction_source + "[i]";
+            const std::string& var = pattern.reduction_var;
+            if (isArg()) {
+                return "if (" + value + (isMin() ? " < " : " > ") + var + ") { " + var + " = " + value + "; " +
+                       pattern.reduction_index_var + " = i; }";
+            }
+            return var + " = " + combine(var, value) + ";";
+        }
+
+        std::string ReductionCodeBuilder::scalarLoop(const std::string& indent) const {
+            return indent + "for (; i < end; i++) {\n" + indent + "    " + scalarUpdate() + "\n" + indent + "}\n";
+        }
+
+        std::string ReductionCodeBuilder::initialization() const {
+            std::stringstream code;
+            const std::string& n = pattern.end_variable;
+            code << "uint64_t i = " << pattern.start_value << ";\n";
+            code << "const uint64_t end = " << n << " > 0 ? (uint64_t)" << n << " : 0;\n";
+            if (mode == Mode::Scalar) return code.str();
+
+            const std::string& var = pattern.reduction_var;
+            std::string init = isIdempotent() || isArg() ? var : identity();
+            if (is_sve) {
+                code << "const svbool_t pg_all = svptrue_" << predicateBits() << "();\n";
+                code << "const uint64_t vl = " << sveCount() << "();\n";
+                if (mode == Mode::Ordered) return code.str();
+                for (int k = 0; k < accumulators; ++k) {
+                    code << sveVector() << " " << accumulator(k) << " = " << sve("svdup_n") << "(" << init << ");\n";
+                }
+                if (isArg()) {
+                    // 位置通道记录相对循环起点的下标, 全 1 表示该通道从未更新
+                    std::string index_vector = "svuint" + std::to_string(element->bits) + "_t";
+                    for (int k = 0; k < accumulators; ++k) {
+                        code << index_vector << " " << indexAccumulator(k) << " = svdup_n_" << indexSuffix() << "(" << indexSentinel() << ");\n";
+                    }
+                    code << index_vector << " " << var << "_pos = svindex_" << indexSuffix() << "(0, 1);\n";
+                    code << "const uint64_t " << var << "_first = i;\n";
+                }
+            } else {
+                code << "const uint64_t vl = " << 256 / element->bits << ";  // " << element->scalar << " lanes per __m256\n";
+                for (int k = 0; k < accumulators; ++k) {
+                    code << element->avx_vector << " " << accumulator(k) << " = " << avxSplat(init) << ";\n";
+                }
+            }
+            return code.str();
+        }
+
+        std::string ReductionCodeBuilder::mainLoop() const {
+            std::stringstream code;
+            const std::string& var = pattern.reduction_var;
+            const std::string& source = pattern.reduction_source;
+            if (mode == Mode::Scalar) {
+                code << "// " << pattern.reduction_op << " reduction of '" << var << "' kept scalar: " << reason << "\n";
+                if (!source.empty()) code << scalarLoop("");
+                return code.str();
+            }
+            if (mode == Mode::Ordered) {
+                code << "// Ordered floating-point sum: svadda adds the active lanes in element order,\n";
+                code << "// so '" << var << "' matches the scalar loop exactly\n";
+                code << "for (; i < end; i += vl) {\n";
+                code << "    const svbool_t pg = svwhilelt_" << predicateBits() << "(i, end);\n";
+                code << "    " << var << " = " << sve("svadda") << "(pg, " << var << ", " << sve("svld1") << "(pg, " << source << " + i));\n";
+                code << "}\n";
+                return code.str();
+            }
+
+            std::string step = accumulators == 1 ? "vl" : std::to_string(accumulators) + " * vl";
+            code << "// Main loop: " << accumulators << " partial accumulator" << (accumulators == 1 ? "" : "s")
+                 << " for the " << pattern.reduction_op << " of '" << var << "'\n";
+            code << "for (; i + " << step << " <= end";
+            if (isArg() && element->bits == 32) code << " && i - " << var << "_first + " << step << " < UINT32_MAX";
+            code << "; i += " << step << ") {\n";
+            for (int k = 0; k < accumulators; ++k) {
+                std::string acc = accumulator(k);
+                std::string address = source + " + i" + offset(k);
+                if (!is_sve) {
+                    code << "    " << acc << " = " << avxOperation() << "(" << avxLoad(address) << ", " << acc << ");\n";
+                } else if (!isArg()) {
+                    code << "    " << acc << " = " << sve(sveOperation()) << "_x(pg_all, " << acc << ", " << sve("svld1") << "(pg_all, " << address << "));\n";
+                } else {
+                    std::string position = var + "_pos";
+                    if (k > 0) {
+                        position = "svadd_n_" + indexSuffix() + "_x(pg_all, " + position + ", (uint" + std::to_string(element->bits) +
+                                   "_t)(" + offset(k).substr(3) + "))";
+                    }
+                    code << "    {\n";
+                    code << "        const " << sveVector() << " v = " << sve("svld1") << "(pg_all, " << address << ");\n";
+                    code << "        const svbool_t better = " << sve(isMin() ? "svcmplt" : "svcmpgt") << "(pg_all, v, " << acc << ");\n";
+                    code << "        " << acc << " = " << sve("svsel") << "(better, v, " << acc << ");\n";
+                    code << "        " << indexAccumulator(k) << " = svsel_" << indexSuffix() << "(better, " << position << ", " << indexAccumulator(k) << ");\n";
+                    code << "    }\n";
+                }
+            }
+            if (isArg()) {
+                code << "    " << var << "_pos = svadd_n_" << indexSuffix() << "_x(pg_all, " << var << "_pos, (uint" << element->bits << "_t)(" << step << "));\n";
+            }
+            code << "}\n";
+            return code.str();
+        }
+
+        std::string ReductionCodeBuilder::tailLoop() const {
+            std::stringstream code;
+            if (mode != Mode::Vector) return "";
+            const std::string& var = pattern.reduction_var;
+            const std::string& source = pattern.reduction_source;
+            if (!is_sve) {
+                code << "// Scalar tail folds straight into '" << var << "'; the vector partials are merged afterwards\n";
+                code << scalarLoop("");
+                return code.str();
+            }
+            code << "// Tail: svwhilelt predicate, inactive lanes keep their accumulator\n";
+            code << "for (; i < end";
+            if (isArg() && element->bits == 32) code << " && i - " << var << "_first + vl < UINT32_MAX";
+            code << "; i += vl) {\n";
+            code << "    const svbool_t pg = svwhilelt_" << predicateBits() << "(i, end);\n";
+            std::string acc = accumulator(0);
+            if (!isArg()) {
+                code << "    " << acc << " = " << sve(sveOperation()) << "_m(pg, " << acc << ", " << sve("svld1") << "(pg, " << source << " + i));\n";
+            } else {
+                code << "    const " << sveVector() << " v = " << sve("svld1") << "(pg, " << source << " + i);\n";
+                code << "    const svbool_t better = " << sve(isMin() ? "svcmplt" : "svcmpgt") << "(pg, v, " << acc << ");\n";
+                code << "    " << acc << " = " << sve("svsel") << "(better, v, " << acc << ");\n";
+                code << "    " << indexAccumulator(0) << " = svsel_" << indexSuffix() << "(better, " << var << "_pos, " << indexAccumulator(0) << ");\n";
+                code << "    " << var << "_pos = svadd_n_" << indexSuffix() << "_x(pg_all, " << var << "_pos, (uint" << element->bits << "_t)vl);\n";
+            }
+            code << "}\n";
+            return code.str();
+        }
+
+        std::string ReductionCodeBuilder::finish() const {
+            std::stringstream code;
+            if (mode != Mode::Vector) return "";
+            const std::string& var = pattern.reduction_var;
+            std::string acc = accumulator(0);
+            code << "// Combine the partial accumulators pairwise, then one horizontal step\n";
+            for (const auto& [keep, other] : treePairs(accumulators)) {
+                std::string a = accumulator(keep);
+                std::string b = accumulator(other);
+                if (!is_sve) {
+                    code << a << " = " << avxOperation() << "(" << b << ", " << a << ");\n";
+                } else if (!isArg()) {
+                    code << a << " = " << sve(sveOperation()) << "_x(pg_all, " << a << ", " << b << ");\n";
+                } else {
+                    // 值相同时保留较小的位置, 与标量循环的首次出现一致
+                    std::string compare = sve(isMin() ? "svcmplt" : "svcmpgt");
+                    code << "{\n";
+                    code << "    const svbool_t take = svorr_b_z(pg_all, " << compare << "(pg_all, " << b << ", " << a << "),\n";
+                    code << "                                    svand_b_z(pg_all, " << sve("svcmpeq") << "(pg_all, " << b << ", " << a << "), "
+                         << "svcmplt_" << indexSuffix() << "(pg_all, " << indexAccumulator(other) << ", " << indexAccumulator(keep) << ")));\n";
+                    code << "    " << a << " = " << sve("svsel") << "(take, " << b << ", " << a << ");\n";
+                    code << "    " << indexAccumulator(keep) << " = svsel_" << indexSuffix() << "(take, " << indexAccumulator(other) << ", " << indexAccumulator(keep) << ");\n";
+                    code << "}\n";
+                }
+            }
+
+            if (is_sve && isArg()) {
+                std::string index_type = "uint" + std::to_string(element->bits) + "_t";
+                code << "{\n";
+                code << "    const " << element->scalar << " best = " << sve(sveAcross()) << "(pg_all, " << acc << ");\n";
+                code << "    const " << index_type << " at = svminv_" << indexSuffix() << "(" << sve("svcmpeq") << "(pg_all, " << acc << ", "
+                     << sve("svdup_n") << "(best)), " << indexAccumulator(0) << ");\n";
+                code << "    if (at != " << indexSentinel() << ") {\n";
+                code << "        " << var << " = best;\n";
+                code << "        " << pattern.reduction_index_var << " = " << var << "_first + at;\n";
+                code << "    }\n";
+                code << "}\n";
+                // 32 位位置通道用尽时剩余元素由标量循环完成
+                if (element->bits == 32) code << scalarLoop("");
+                return code.str();
+            }
+            if (is_sve && !sveAcross().empty()) {
+                std::string across = sve(sveAcross()) + "(pg_all, " + acc + ")";
+                if (!element->is_float) across = "(" + pattern.data_type + ")" + across;
+                code << var << " = " << (isIdempotent() ? across : combine(var, across)) << ";\n";
+                return code.str();
+            }
+
+            // 没有跨通道指令 (SVE 乘积, AVX2): 经内存逐通道合并
+            std::string lanes = var + "_lanes";
+            code << "{\n";
+            if (is_sve) {
+                code << "    " << element->scalar << " " << lanes << "[2048 / " << element->bits << "];  // longest SVE vector\n";
+                code << "    " << sve("svst1") << "(pg_all, " << lanes << ", " << acc << ");\n";
+                code << "    for (uint64_t " << var << "_lane = 0; " << var << "_lane < vl; " << var << "_lane++) "
+                     << var << " = " << combine(var, lanes + "[" + var + "_lane]") << ";\n";
+            } else {
+                code << "    " << element->scalar << " " << lanes << "[" << 256 / element->bits << "];\n";
+                if (element->is_float) {
+                    code << "    _mm256_storeu_" << element->avx_suffix << "(" << lanes << ", " << acc << ");\n";
+                } else {
+                    code << "    _mm256_storeu_si256((__m256i*)" << lanes << ", " << acc << ");\n";
+                }
+                code << "    for (uint64_t " << var << "_lane = 0; " << var << "_lane < vl; " << var << "_lane++) "
+                     << var << " = " << combine(var, lanes + "[" + var + "_lane]") << ";\n";
+            }
+            code << "}\n";
+            return code.str();
+        }
+
+    }  // namespace
+
+    // ============================================================================
+    // VectorizedCodeGenerator 实现
+    // ============================================================================
+
+    std::string VectorizedCodeGenerator::generateInitialization(
+        const LoopVectorizationPattern &pattern,
+        const std::string &target_arch) {
+        if (pattern.is_reduction) {
+            return ReductionCodeBuilder(pattern, target_arch, options).initialization();
+        }
+        std::stringstream code;
+
+        if (target_arch == "SVE") {
+            code << "svbool_t pg = svptrue_b32();\n";
+            code << "uint64_t vl = svcntw();\n";
+            code << "size_t i = 0;\n";
+        } else if (target_arch == "AVX2") {
+            code << "size_t i = 0;\n";
+            code << "const size_t vl = 8;  // AVX2 处理8个int32\n";
+        }
+
+        return code.str();
+    }
+
+    std::string VectorizedCodeGenerator::generateMainLoop(
+        const LoopVectorizationPattern &pattern,
+        const std::string &target_arch) {
+        if (pattern.is_reduction) {
+            return ReductionCodeBuilder(pattern, target_arch, options).mainLoop();
+        }
+        std::stringstream code;
+
+        if (target_arch == "SVE") {
+            code << "// 主向量化循环\n";
+            code << "while (i + vl <= " << pattern.end_variable << ") {\n";
+
+            // 生成加载指令
+            for (const auto &access: pattern.array_accesses) {
+                if (access.is_read && access.is_sequential) {
+                    code << "    svint32_t " << access.array_name << "_vec = svld1_s32(pg, "
+                            << access.array_name << " + i);\n";
+                }
+            }
+
+            // 生成操作指令
+            for (const auto &op: pattern.operations) {
+                if (op.op_type == "add") {
+                    code << "    svint32_t result_vec = svadd_s32_z(pg, vec_a, vec_b);\n";
+                }
+            }
+
+            // 生成存储指令
+            for (const auto &access: pattern.array_accesses) {
+                if (!access.is_read && access.is_sequential) {
+                    code << "    svst1_s32(pg, " << access.array_name << " + i, result_vec);\n";
+                }
+            }
+
+            code << "    i += vl;\n";
+            code << "}\n";
+        } else if (target_arch == "AVX2") {
+            code << "// 主向量化循环\n";
+            code << "for (; i + vl <= " << pattern.end_variable << "; i += vl) {\n";
+
+            // AVX2 类似逻辑
+            for (const auto &access: pattern.array_accesses) {
+                if (access.is_read && access.is_sequential) {
+                    code << "    __m256i " << access.array_name << "_vec = _mm256_loadu_si256"
+                            << "((__m256i*)(" << access.array_name << " + i));\n";
+                }
+            }
+
+            code << "}\n";
+        }
+
+        return code.str();
+    }
+
+    std::string VectorizedCodeGenerator::generateTailLoop(
+        const LoopVectorizationPattern &pattern,
+        const std::string &target_arch) {
+        if (pattern.is_reduction) {
+            return ReductionCodeBuilder(pattern, target_arch, options).tailLoop();
+        }
+        std::stringstream code;
+
+        if (target_arch == "SVE") {
+            code << "// 尾部处理\n";
+            code << "if (i < " << pattern.end_variable << ") {\n";
+            code << "    svbool_t pg_tail = svwhilelt_b32(i, " << pattern.end_variable << ");\n";
+            code << "    // 使用 pg_tail 处理剩余元素\n";
+            code << "}\n";
+        } else if (target_arch == "AVX2") {
+            code << "// 标量尾部处理\n";
+            code << "for (; i < " << pattern.end_variable << "; i++) {\n";
+            code << "    // 标量处理\n";
+            code << "}\n";
+        }
+
+        return code.str();
+    }
+
+    std::string VectorizedCodeGenerator::generateReduction(
+        const LoopVectorizationPattern &pattern,
+        const std::string &target_arch) {
+        return ReductionCodeBuilder(pattern, target_arch, options).finish();
+    }
+
+    std::string VectorizedCodeGenerator::generateNeonLoop(const clang::ForStmt* loop, clang::ASTContext& ctx,
+                                                          const VectorLoopOptions& options, std::string& failure) {
+        VectorLoopEmitter emitter(loop, ctx, options, false);
+        std::string code = emitter.emit(failure);
+        memory_note = emitter.memory_note;
+        return code;
+    }
+
+    std::string VectorizedCodeGenerator::generateSveLoop(const clang::ForStmt* loop, clang::ASTContext& ctx,
+                                                         const VectorLoopOptions& options, std::string& failure) {
+        VectorLoopEmitter emitter(loop, ctx, options, true);
+        std::string code = emitter.emit(failure);
+        memory_note = emitter.memory_note;
+        return code;
+    }
+
+    std::string VectorizedCodeGenerator::generateScalarLoop(const clang::ForStmt* loop, clang::ASTContext& ctx) {
+        return printStatement(loop, ctx, 1);
     }
 } // namespace aodsolve
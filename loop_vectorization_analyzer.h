@@ -12,6 +12,13 @@ struct ArrayAccess {
     bool is_read;
     bool is_sequential;
     const clang::Expr* ast_expr;
+    bool is_write = false;
+    // contiguous: a[i + c]; interleaved: a[s * i + c], s 为 2..4; strided: 更大的常量步长;
+    // indexed: a[idx[i + c]]; invariant: 下标不含迭代变量; irregular: 其余形式
+    std::string kind;
+    int64_t stride = 0;
+    int64_t offset = 0;
+    std::string index_array;            // indexed 访问的下标数组
 };
 
 // 标量操作
@@ -33,10 +40,59 @@ struct LoopVectorizationPattern {
     bool has_loop_dependencies;
     bool is_vectorizable;
     bool is_reduction;
-    std::string reduction_op;
+    std::string reduction_op;           // sum/product/min/max/and/or/xor/argmin/argmax
     std::string reduction_var;
-    std::string data_type;
-    int element_size;
+    std::string reduction_index_var;    // argmin/argmax 记录位置的变量
+    std::string reduction_source;       // 每次迭代并入的值为 a[i] 时的数组名, 否则为空
+    std::string data_type;              // 归约变量的标量类型
+    int element_size;                   // 字节数
+};
+
+// 向量循环生成选项
+struct VectorLoopOptions {
+    int unroll = 4;     // 主循环每次迭代处理的独立向量组数, 1 表示不展开; 归约时即部分累加器个数
+    // 浮点 sum/product 归约允许重结合 (多累加器 + 树形合并);
+    // 否则保持源顺序: SVE 用 svadda 逐元素有序累加, 其它目标保持标量
+    bool reassociate_fp = false;
+    // 剩余迭代数不少于该值时先标量执行若干次, 使首个写入流 (无写入时为首个读取流) 按向量宽度对齐; 0 表示不剥离
+    int64_t align_peel_trip = 0;
+    // 每次进入循环时读写的字节数 (按剩余迭代数估计) 不少于该值时, 主循环的只写连续流改用非临时存储,
+    // 读取流提前 prefetch_distance 字节预取; 0 表示不做访存层次改写
+    int64_t streaming_bytes = 0;
+    int64_t prefetch_distance = 512;
+};
+
+// 指针对齐分析 (流不敏感): 由分配点 (aligned_alloc / posix_memalign / malloc / new)、数组的声明对齐 (alignas)、
+// __builtin_assume_aligned 与指针算术推出地址的已知对齐字节数. 整数变量同样按全部定义推出其必为 2^k 的倍数,
+// 用于 p + i 的偏移. 取地址后可能被间接修改的变量只取类型的自然对齐
+class AlignmentAnalyzer {
+public:
+    AlignmentAnalyzer(clang::ASTContext& ctx, const clang::FunctionDecl* func);
+
+    // 指针表达式所指地址的对齐字节数, 至少为 1
+    int64_t alignmentOf(const clang::Expr* expr) const;
+    // 数组为其首地址, 指针变量为其所有取值的公共对齐
+    int64_t alignmentOf(const clang::VarDecl* var) const;
+    // 整数表达式必为其倍数的最大 2 的幂
+    int64_t multipleOf(const clang::Expr* expr) const;
+
+    // 包含 stmt 的函数定义 (找不到时为空)
+    static const clang::FunctionDecl* enclosingFunction(const clang::Stmt* stmt, clang::ASTContext& ctx);
+
+private:
+    using Visiting = std::set<const clang::VarDecl*>;
+    int64_t pointerAlignment(const clang::Expr* expr, Visiting& visiting) const;
+    int64_t variableAlignment(const clang::VarDecl* var, Visiting& visiting) const;
+    int64_t integerMultiple(const clang::Expr* expr, Visiting& visiting) const;
+    int64_t variableMultiple(const clang::VarDecl* var, Visiting& visiting) const;
+    int64_t naturalAlignment(clang::QualType pointer) const;
+    int64_t elementBytes(clang::QualType pointer) const;
+
+    clang::ASTContext& ctx;
+    std::map<const clang::VarDecl*, std::vector<const clang::Expr*>> definitions;   // 初始值与 = 的右侧
+    std::map<const clang::VarDecl*, int64_t> steps;        // += / -= / ++ / -- 保证的对齐 (指针为字节, 整数为倍数)
+    std::map<const clang::VarDecl*, int64_t> allocations;  // posix_memalign(&p, N, ...) 给出的对齐
+    std::set<const clang::VarDecl*> escaped;               // 取地址或绑定到非 const 引用后可能被间接修改
 };
 
 // 函数内联候选
@@ -83,7 +139,8 @@ public:
     bool hasLoopCarriedDependencies(const LoopVectorizationPattern& pattern);
     bool isVectorizable(const LoopVectorizationPattern& pattern);
 
-    std::string generateVectorizedCode(const LoopVectorizationPattern& pattern, const std::string& target_arch);
+    std::string generateVectorizedCode(const LoopVectorizationPattern& pattern, const std::string& target_arch,
+                                       const VectorLoopOptions& options = VectorLoopOptions());
 };
 
 // 函数内联分析器
@@ -99,10 +156,37 @@ public:
 
 class VectorizedCodeGenerator {
 public:
+    VectorizedCodeGenerator() = default;
+    explicit VectorizedCodeGenerator(const VectorLoopOptions& opts) : options(opts) {}
+
+    // NEON 循环: 按 options.unroll 路交错展开的主循环 + 单向量循环 + 标量尾循环, 通道数由元素类型决定;
+    // 顶层归约语句每路一个部分累加器, 循环后树形合并并做水平归约;
+    // if 分支按掩码转换: 局部变量赋值为 vbslq 选择 (clamp 为 vmaxq/vminq), 存储为读出-混合-写回
+    // 步长 2..4 的交错访问整组 vldNq/vstNq, 更大步长与 a[idx[i]] 间接访问逐通道模拟 gather/scatter (按代价检查)
+    // 入口已知 16 字节对齐的连续流加 __builtin_assume_aligned 提示; options.align_peel_trip > 0 时长循环先标量剥离到对齐
+    // options.streaming_bytes > 0 时另生成流式主循环 (__builtin_nontemporal_store / __builtin_prefetch), 说明见 memoryNote()
+    // 无法向量化时返回空串, 原因写入 failure
+    std::string generateNeonLoop(const clang::ForStmt* loop, clang::ASTContext& ctx,
+                                 const VectorLoopOptions& options, std::string& failure);
+    // SVE 循环: 同 NEON 的翻译, 向量长度运行时取得; 主循环全真谓词, 剩余迭代用 svwhilelt 谓词,
+    // if 分支与条件存储直接按谓词执行; 交错访问为 svldN/svstN, 间接与大步长访问为 svld1_gather/svst1_scatter;
+    // 不重结合的浮点 sum 用 svadda 按顺序累加. 标量循环只在重叠检查不通过时执行; 流式主循环用 svstnt1 / svprfb
+    std::string generateSveLoop(const clang::ForStmt* loop, clang::ASTContext& ctx,
+                                const VectorLoopOptions& options, std::string& failure);
+    // 原样打印循环 (4 空格缩进), 用于保持标量的循环
+    std::string generateScalarLoop(const clang::ForStmt* loop, clang::ASTContext& ctx);
+    // 最近一次生成的循环的访存层次改写说明, 未改写时为空
+    const std::string& memoryNote() const { return memory_note; }
+
     std::string generateInitialization(const LoopVectorizationPattern& pattern, const std::string& target_arch);
     std::string generateMainLoop(const LoopVectorizationPattern& pattern, const std::string& target_arch);
     std::string generateTailLoop(const LoopVectorizationPattern& pattern, const std::string& target_arch);
+    // 归约: 初始化为 options.unroll 个部分累加器, 循环后树形合并再做一次水平归约
     std::string generateReduction(const LoopVectorizationPattern& pattern, const std::string& target_arch);
+
+private:
+    VectorLoopOptions options;
+    std::string memory_note;
 };
 
 } // namespace aodsolve
@@ -1,20 +1,182 @@
 #include "aod/optimization_rule_system.h"
+#include "aod/enhanced_aod_graph.h"
+#include "aod/intrinsic_mapping_table.h"
 #include <algorithm>
 #include <fstream>
 #include <sstream>
 #include <iostream>
+#include <cstdlib>
+#include <cctype>
+#include <cerrno>
+#include <climits>
+#include <unordered_map>
+#include <cstring>
+#include <cstdio>
+#include <string_view>
+#include <filesystem>
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
 
 namespace aodsolve {
 
+// ============================================================================
+// CodeTemplate 实现
+// ============================================================================
+
+bool CodeTemplate::compile(const std::string& text, CodeTemplate& out, std::string* error) {
+    auto fail = [&](const std::string& message, size_t at) {
+        if (error) *error = message + " at offset " + std::to_string(at);
+        return false;
+    };
+    CodeTemplate compiled;
+    compiled.source = text;
+    std::unordered_map<std::string, int> slots;
+    size_t literal_start = 0;
+    auto flushLiteral = [&](size_t end) {
+        if (end > literal_start) {
+            compiled.segments.push_back({-1, literal_start, end - literal_start});
+            compiled.literal_size += end - literal_start;
+        }
+    };
+
+    for (size_t pos = 0; pos < text.size(); ++pos) {
+        if (text.compare(pos, 2, "${") == 0) return fail("'${' placeholder syntax is not supported, use {{name}}", pos);
+        if (text.compare(pos, 2, "{{") != 0) continue;
+        size_t close = text.find("}}", pos + 2);
+        if (close == std::string::npos) return fail("unterminated '{{'", pos);
+        std::string name = text.substr(pos + 2, close - pos - 2);
+        // 占位符名须为标识符, {{0}} 这类 C 聚合初始化不是占位符
+        if (name.empty() || std::isdigit(static_cast<unsigned char>(name[0])) ||
+            !std::all_of(name.begin(), name.end(), [](char c) {
+                return std::isalnum(static_cast<unsigned char>(c)) || c == '_';
+            })) {
+            return fail("invalid placeholder name '" + name + "'", pos);
+        }
+        int index = -1;
+        if (name.rfind("input_", 0) == 0 && name.size() > 6 &&
+            std::all_of(name.begin() + 6, name.end(), [](char c) { return std::isdigit(static_cast<unsigned char>(c)); })) {
+            index = 0;
+            for (size_t i = 6; i < name.size() && index <= kMaxInputIndex; ++i) index = index * 10 + (name[i] - '0');
+            if (index > kMaxInputIndex) {
+                return fail("input index in '" + name + "' exceeds " + std::to_string(kMaxInputIndex), pos);
+            }
+        }
+        flushLiteral(pos);
+        auto inserted = slots.emplace(name, static_cast<int>(compiled.names.size()));
+        if (inserted.second) {
+            compiled.names.push_back(name);
+            if (index >= 0) {
+                if (compiled.input_slots.size() <= static_cast<size_t>(index)) compiled.input_slots.resize(index + 1, -1);
+                compiled.input_slots[index] = inserted.first->second;
+            }
+        }
+        compiled.segments.push_back({inserted.first->second, pos, close + 2 - pos});
+        pos = close + 1;
+        literal_start = close + 2;
+    }
+    flushLiteral(text.size());
+    out = std::move(compiled);
+    return true;
+}
+
+int CodeTemplate::slotOf(const std::string& name) const {
+    auto it = std::find(names.begin(), names.end(), name);
+    return it != names.end() ? static_cast<int>(it - names.begin()) : -1;
+}
+
+int CodeTemplate::inputSlot(int index) const {
+    return index >= 0 && index < static_cast<int>(input_slots.size()) ? input_slots[index] : -1;
+}
+
+void CodeTemplate::expand(const Values& values, std::string& out) const {
+    size_t size = out.size() + literal_size;
+    for (const auto* value : values) size += value ? value->size() : 0;
+    out.reserve(size);
+    for (const auto& segment : segments) {
+        const std::string* value = segment.slot >= 0 && segment.slot < static_cast<int>(values.size()) ? values[segment.slot] : nullptr;
+        if (value) out += *value;
+        else out.append(source, segment.offset, segment.length);
+    }
+}
+
+std::string CodeTemplate::expand(const std::map<std::string, std::string>& bindings) const {
+    Values values(names.size(), nullptr);
+    for (size_t i = 0; i < names.size(); ++i) {
+        auto it = bindings.find(names[i]);
+        if (it != bindings.end()) values[i] = &it->second;
+    }
+    std::string out;
+    expand(values, out);
+    return out;
+}
+
 // ============================================================================
 // RuleDatabase 实现
 // ============================================================================
 
-void RuleDatabase::addRule(const OptimizationRule& rule) {
-    rules[rule.rule_id] = rule;
+bool RuleDatabase::compileTemplates(OptimizationRule& rule, std::string* error) {
+    // 编译并校验模板: 语法错误, 或树模式中没有对应 $k 的 {{input_k}}, 整条规则作废
+    TreePattern tree;
+    bool has_tree = !rule.source_pattern.tree_pattern.empty() && TreePattern::parse(rule.source_pattern.tree_pattern, tree);
+    std::set<int> leaves;
+    std::function<void(const TreePattern&)> collectLeaves = [&](const TreePattern& node) {
+        if (node.leaf >= 0) leaves.insert(node.leaf);
+        for (const auto& child : node.children) collectLeaves(child);
+    };
+    if (has_tree) collectLeaves(tree);
+    for (auto& [arch, target] : rule.target_templates) {
+        auto compiled = std::make_shared<CodeTemplate>();
+        std::string message;
+        bool ok = CodeTemplate::compile(target.code_template, *compiled, &message);
+        for (int k = 0; ok && has_tree && k < compiled->inputCount(); ++k) {
+            if (compiled->inputSlot(k) >= 0 && !leaves.count(k)) {
+                ok = false;
+                message = "{{input_" + std::to_string(k) + "}} has no $" + std::to_string(k) + " in tree pattern";
+            }
+        }
+        if (!ok) {
+            if (error) *error = "rule " + rule.rule_id + " template for " + arch + ": " + message;
+            return false;
+        }
+        target.compiled = std::move(compiled);
+    }
+    return true;
+}
+
+void RuleDatabase::insertRule(OptimizationRule rule) {
+    // 同 ID 覆盖时先从旧分类/模式索引中移除
+    auto old = rules.find(rule.rule_id);
+    if (old != rules.end()) {
+        auto unlink = [&](std::map<std::string, std::vector<std::string>>& index, const std::string& key) {
+            auto& ids = index[key];
+            ids.erase(std::remove(ids.begin(), ids.end(), rule.rule_id), ids.end());
+        };
+        unlink(category_index, old->second.category);
+        unlink(pattern_index, old->second.source_pattern.pattern_id);
+    }
     
     // 更新分类索引
     category_index[rule.category].push_back(rule.rule_id);
+    pattern_index[rule.source_pattern.pattern_id].push_back(rule.rule_id);
+    std::string rule_id = rule.rule_id;
+    rules[rule_id] = std::move(rule);
+    generation++;
+}
+
+bool RuleDatabase::addRule(const OptimizationRule& rule, std::string* error) {
+    OptimizationRule compiled = rule;
+    std::string message;
+    if (!compileTemplates(compiled, &message)) {
+        if (error) *error = message;
+        else std::cerr << "Error: " << message << std::endl;
+        return false;
+    }
+    insertRule(std::move(compiled));
+    return true;
 }
 
 std::vector<OptimizationRule*> RuleDatabase::queryRules(const std::string& category) {
@@ -36,16 +198,20 @@ std::vector<OptimizationRule*> RuleDatabase::queryRules(const std::string& categ
 std::vector<OptimizationRule*> RuleDatabase::queryRulesByPattern(const CodePattern& pattern) {
     std::vector<OptimizationRule*> result;
     
-    // 简化实现：遍历所有规则，查找匹配的模式
-    for (auto& [rule_id, rule] : rules) {
-        if (rule.source_pattern.pattern_id == pattern.pattern_id) {
-            result.push_back(&rule);
-        }
+    auto it = pattern_index.find(pattern.pattern_id);
+    if (it != pattern_index.end()) {
+        for (const auto& rule_id : it->second) result.push_back(&rules.at(rule_id));
     }
     
     return result;
 }
 
+std::vector<OptimizationRule*> RuleDatabase::getAllRules() {
+    std::vector<OptimizationRule*> result;
+    for (auto& [rule_id, rule] : rules) result.push_back(&rule);
+    return result;
+}
+
 OptimizationRule* RuleDatabase::getRuleById(const std::string& rule_id) {
     auto it = rules.find(rule_id);
     if (it != rules.end()) {
@@ -54,19 +220,522 @@ OptimizationRule* RuleDatabase::getRuleById(const std::string& rule_id) {
     return nullptr;
 }
 
-void RuleDatabase::loadRulesFromJSON(const std::string& json_file) {
-    // TODO: 实现JSON加载
-    std::cout << "Loading rules from JSON: " << json_file << std::endl;
+// ---------------------------------------------------------------------------
+// 规则文件读写
+// ---------------------------------------------------------------------------
+
+namespace {
+
+// 只读映射整个文件; 映射失败 (如特殊文件) 时退回一次性读入
+class MappedFile {
+public:
+    bool open(const std::string& path, std::string* error) {
+#ifndef _WIN32
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) return fail(error, "cannot open " + path);
+        struct stat st;
+        if (::fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0) {
+            void* mapped = ::mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+            if (mapped != MAP_FAILED) {
+                map_base = mapped;
+                map_size = static_cast<size_t>(st.st_size);
+                ::close(fd);
+                return true;
+            }
+        }
+        ::close(fd);
+#endif
+        std::ifstream in(path, std::ios::binary);
+        if (!in) return fail(error, "cannot open " + path);
+        std::ostringstream ss;
+        ss << in.rdbuf();
+        buffer = ss.str();
+        return true;
+    }
+    
+    ~MappedFile() {
+#ifndef _WIN32
+        if (map_base) ::munmap(map_base, map_size);
+#endif
+    }
+    
+    std::string_view data() const {
+        return map_base ? std::string_view(static_cast<const char*>(map_base), map_size) : std::string_view(buffer);
+    }
+    
+private:
+    void* map_base = nullptr;
+    size_t map_size = 0;
+    std::string buffer;
+    
+    static bool fail(std::string* error, const std::string& message) {
+        if (error) *error = message;
+        return false;
+    }
+};
+
+// 在映射内存上原地扫描的 JSON 读取器: 不建 DOM, 键以 string_view 比较, 只有含转义的字符串才复制
+class JsonReader {
+public:
+    explicit JsonReader(std::string_view text) : text(text) {}
+    
+    bool ok() const { return error.empty(); }
+    
+    std::string errorMessage() const {
+        size_t line = 1, column = 1;
+        for (size_t i = 0; i < error_pos && i < text.size(); ++i) {
+            if (text[i] == '\n') { ++line; column = 1; } else { ++column; }
+        }
+        return std::to_string(line) + ":" + std::to_string(column) + ": " + error;
+    }
+    
+    bool fail(const std::string& message) {
+        if (error.empty()) {
+            error = message;
+            error_pos = pos;
+        }
+        return false;
+    }
+    
+    bool atEnd() {
+        skipSpace();
+        return pos >= text.size();
+    }
+    
+    // on_member(key) 须消费对应的值
+    template <typename F>
+    bool object(F&& on_member) {
+        if (!consume('{')) return fail("expected '{'");
+        if (consume('}')) return true;
+        do {
+            std::string_view key;
+            if (!stringView(key, key_scratch) || !consume(':')) return fail("expected object key");
+            if (!on_member(key)) return fail("bad value for '" + std::string(key) + "'");
+        } while (consume(','));
+        return consume('}') || fail("expected '}'");
+    }
+    
+    template <typename F>
+    bool array(F&& on_element) {
+        if (!consume('[')) return fail("expected '['");
+        if (consume(']')) return true;
+        do {
+            if (!on_element()) return false;
+        } while (consume(','));
+        return consume(']') || fail("expected ']'");
+    }
+    
+    bool string(std::string& out) {
+        std::string_view view;
+        if (!stringView(view)) return false;
+        out.assign(view.data(), view.size());
+        return true;
+    }
+    
+    bool integer(int& out) {
+        skipSpace();
+        size_t start = pos;
+        if (pos < text.size() && text[pos] == '-') ++pos;
+        while (pos < text.size() && std::isdigit(static_cast<unsigned char>(text[pos]))) ++pos;
+        if (pos == start) return fail("expected integer");
+        errno = 0;
+        long value = std::strtol(std::string(text.substr(start, pos - start)).c_str(), nullptr, 10);
+        if (errno == ERANGE || value < INT_MIN || value > INT_MAX) return fail("integer out of range");
+        out = static_cast<int>(value);
+        return true;
+    }
+    
+    bool stringList(std::vector<std::string>& out) {
+        out.clear();
+        return array([&] {
+            out.emplace_back();
+            return string(out.back());
+        });
+    }
+    
+    bool stringMap(std::map<std::string, std::string>& out) {
+        out.clear();
+        return object([&](std::string_view key) { return string(out[std::string(key)]); });
+    }
+    
+    // 跳过不认识的字段
+    bool skipValue() {
+        skipSpace();
+        if (pos >= text.size()) return fail("unexpected end of file");
+        char c = text[pos];
+        if (c == '{') return object([&](std::string_view) { return skipValue(); });
+        if (c == '[') return array([&] { return skipValue(); });
+        if (c == '"') {
+            std::string_view ignored;
+            return stringView(ignored);
+        }
+        size_t start = pos;
+        while (pos < text.size() && (std::isalnum(static_cast<unsigned char>(text[pos])) || std::strchr("+-.", text[pos]))) ++pos;
+        return pos > start || fail("unexpected character");
+    }
+    
+private:
+    std::string_view text;
+    size_t pos = 0;
+    std::string scratch;
+    std::string key_scratch;
+    std::string error;
+    size_t error_pos = 0;
+    
+    void skipSpace() {
+        while (pos < text.size() && std::isspace(static_cast<unsigned char>(text[pos]))) ++pos;
+    }
+    
+    bool consume(char c) {
+        skipSpace();
+        if (pos < text.size() && text[pos] == c) {
+            ++pos;
+            return true;
+        }
+        return false;
+    }
+    
+    bool stringView(std::string_view& out) { return stringView(out, scratch); }
+    
+    // 无转义时直接指向映射内存, 否则解码到 scratch (下一次调用前有效)
+    bool stringView(std::string_view& out, std::string& scratch) {
+        if (!consume('"')) return fail("expected string");
+        size_t start = pos;
+        while (pos < text.size() && text[pos] != '"' && text[pos] != '\\') ++pos;
+        if (pos < text.size() && text[pos] == '"') {
+            out = text.substr(start, pos++ - start);
+            return true;
+        }
+        scratch.assign(text.data() + start, pos - start);
+        while (pos < text.size() && text[pos] != '"') {
+            char c = text[pos++];
+            if (c != '\\') {
+                scratch += c;
+                continue;
+            }
+            if (pos >= text.size()) break;
+            char e = text[pos++];
+            switch (e) {
+                case 'n': scratch += '\n'; break;
+                case 't': scratch += '\t'; break;
+                case 'r': scratch += '\r'; break;
+                case 'b': scratch += '\b'; break;
+                case 'f': scratch += '\f'; break;
+                case 'u': {
+                    if (pos + 4 > text.size() || !std::all_of(text.begin() + pos, text.begin() + pos + 4, [](char h) {
+                            return std::isxdigit(static_cast<unsigned char>(h));
+                        })) {
+                        return fail("bad \\u escape");
+                    }
+                    unsigned code = std::stoul(std::string(text.substr(pos, 4)), nullptr, 16);
+                    pos += 4;
+                    // 规则文件只需 BMP 内字符, 按 UTF-8 编码
+                    if (code < 0x80) {
+                        scratch += static_cast<char>(code);
+                    } else if (code < 0x800) {
+                        scratch += static_cast<char>(0xC0 | (code >> 6));
+                        scratch += static_cast<char>(0x80 | (code & 0x3F));
+                    } else {
+                        scratch += static_cast<char>(0xE0 | (code >> 12));
+                        scratch += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+                        scratch += static_cast<char>(0x80 | (code & 0x3F));
+                    }
+                    break;
+                }
+                default: scratch += e; break;
+            }
+        }
+        if (pos >= text.size()) return fail("unterminated string");
+        ++pos;
+        out = scratch;
+        return true;
+    }
+};
+
+bool readTemplate(JsonReader& in, TransformTemplate& tmpl) {
+    return in.object([&](std::string_view key) {
+        if (key == "template_id") return in.string(tmpl.template_id);
+        if (key == "code_template") return in.string(tmpl.code_template);
+        if (key == "placeholders") return in.stringMap(tmpl.placeholders);
+        if (key == "required_headers") return in.stringList(tmpl.required_headers);
+        if (key == "auxiliary_vars") return in.stringList(tmpl.auxiliary_vars);
+        if (key == "performance_hints") return in.stringMap(tmpl.performance_hints);
+        if (key == "cost") return in.integer(tmpl.cost);
+        return in.skipValue();
+    });
+}
+
+bool readPattern(JsonReader& in, CodePattern& pattern) {
+    return in.object([&](std::string_view key) {
+        if (key == "pattern_id") return in.string(pattern.pattern_id);
+        if (key == "description") return in.string(pattern.description);
+        if (key == "required_node_types") return in.stringList(pattern.required_node_types);
+        if (key == "required_operations") return in.stringList(pattern.required_operations);
+        if (key == "constraints") return in.stringMap(pattern.constraints);
+        if (key == "control_structures") return in.stringList(pattern.control_structures);
+        if (key == "tree_pattern") return in.string(pattern.tree_pattern);
+        if (key == "priority") return in.integer(pattern.priority);
+        if (key == "data_dependencies") {
+            pattern.data_dependencies.clear();
+            return in.array([&] {
+                std::vector<std::string> pair;
+                if (!in.stringList(pair)) return false;
+                if (pair.size() != 2) return in.fail("data dependency must be [from, to]");
+                pattern.data_dependencies.emplace_back(pair[0], pair[1]);
+                return true;
+            });
+        }
+        return in.skipValue();
+    });
+}
+
+bool readRule(JsonReader& in, OptimizationRule& rule) {
+    bool parsed = in.object([&](std::string_view key) {
+        if (key == "rule_id") return in.string(rule.rule_id);
+        if (key == "rule_name") return in.string(rule.rule_name);
+        if (key == "category") return in.string(rule.category);
+        if (key == "code_size_impact") return in.integer(rule.code_size_impact);
+        if (key == "pattern") return readPattern(in, rule.source_pattern);
+        if (key == "targets") {
+            return in.object([&](std::string_view arch) {
+                TransformTemplate& tmpl = rule.target_templates[std::string(arch)];
+                tmpl.target_architecture = std::string(arch);
+                return readTemplate(in, tmpl);
+            });
+        }
+        return in.skipValue();
+    });
+    if (parsed && rule.rule_id.empty()) return in.fail("rule without rule_id");
+    return parsed;
+}
+
+class JsonWriter {
+public:
+    explicit JsonWriter(std::string& out) : out(out) {}
+    
+    void open(char bracket) {
+        out += bracket;
+        ++depth;
+        first = true;
+    }
+    
+    void close(char bracket) {
+        --depth;
+        if (!first) newline();
+        out += bracket;
+        first = false;
+    }
+    
+    void key(const std::string& name) {
+        element();
+        quote(name);
+        out += ": ";
+    }
+    
+    void element() {
+        if (!first) out += ',';
+        newline();
+        first = false;
+    }
+    
+    void value(const std::string& text) { quote(text); first = false; }
+    void value(int number) { out += std::to_string(number); first = false; }
+    
+    void field(const std::string& name, const std::string& text) {
+        if (text.empty()) return;
+        key(name);
+        value(text);
+    }
+    
+    void field(const std::string& name, const std::vector<std::string>& items) {
+        if (items.empty()) return;
+        key(name);
+        out += '[';
+        for (size_t i = 0; i < items.size(); ++i) {
+            if (i) out += ", ";
+            quote(items[i]);
+        }
+        out += ']';
+    }
+    
+    void field(const std::string& name, const std::map<std::string, std::string>& items) {
+        if (items.empty()) return;
+        key(name);
+        open('{');
+        for (const auto& [k, v] : items) {
+            key(k);
+            value(v);
+        }
+        close('}');
+    }
+    
+private:
+    std::string& out;
+    int depth = 0;
+    bool first = true;
+    
+    void newline() {
+        out += '\n';
+        out.append(static_cast<size_t>(depth) * 2, ' ');
+    }
+    
+    void quote(const std::string& text) {
+        out += '"';
+        for (char c : text) {
+            switch (c) {
+                case '"': out += "\\\""; break;
+                case '\\': out += "\\\\"; break;
+                case '\n': out += "\\n"; break;
+                case '\t': out += "\\t"; break;
+                case '\r': out += "\\r"; break;
+                default:
+                    if (static_cast<unsigned char>(c) < 0x20) {
+                        char escaped[8];
+                        std::snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+                        out += escaped;
+                    } else {
+                        out += c;
+                    }
+            }
+        }
+        out += '"';
+    }
+};
+
+}  // namespace
+
+bool RuleDatabase::loadRulesFromJSON(const std::string& json_file, std::string* error) {
+    MappedFile file;
+    if (!file.open(json_file, error)) return false;
+    
+    JsonReader in(file.data());
+    RulePackInfo pack;
+    pack.source = json_file;
+    int format = 0;
+    std::vector<OptimizationRule> loaded;
+    bool parsed = in.object([&](std::string_view key) {
+        if (key == "format") return in.integer(format);
+        if (key == "pack") return in.string(pack.name);
+        if (key == "version") return in.string(pack.version);
+        if (key == "rules") {
+            return in.array([&] {
+                loaded.emplace_back();
+                return readRule(in, loaded.back());
+            });
+        }
+        return in.skipValue();
+    });
+    if (parsed && !in.atEnd()) parsed = in.fail("trailing data after rule pack");
+    if (parsed && format != 1) parsed = in.fail("unsupported rule file format " + std::to_string(format) + " (expected 1)");
+    if (!parsed) {
+        if (error) *error = json_file + ":" + in.errorMessage();
+        return false;
+    }
+    
+    if (pack.name.empty()) pack.name = json_file.substr(json_file.find_last_of("/\\") + 1);
+    pack.rule_count = loaded.size();
+    // 先校验全部模板, 任一失败则整个规则包不加入
+    for (auto& rule : loaded) {
+        std::string message;
+        if (!compileTemplates(rule, &message)) {
+            if (error) *error = json_file + ": " + message;
+            return false;
+        }
+    }
+    for (auto& rule : loaded) insertRule(std::move(rule));
+    packs.push_back(std::move(pack));
+    return true;
 }
 
-void RuleDatabase::loadRulesFromYAML(const std::string& yaml_file) {
-    // TODO: 实现YAML加载
-    std::cout << "Loading rules from YAML: " << yaml_file << std::endl;
+bool RuleDatabase::loadRulesFromYAML(const std::string& yaml_file, std::string* error) {
+    // 只支持 JSON 规则文件; YAML 需先转换 (如 yq -o json)
+    if (error) *error = yaml_file + ": YAML rule files are not supported, convert to JSON";
+    return false;
 }
 
-void RuleDatabase::exportRulesToJSON(const std::string& json_file) {
-    // TODO: 实现JSON导出
-    std::cout << "Exporting rules to JSON: " << json_file << std::endl;
+std::string RuleDatabase::exportRulesToJSONString() const {
+    std::string out;
+    JsonWriter json(out);
+    json.open('{');
+    json.key("format");
+    json.value(1);
+    json.key("rules");
+    json.open('[');
+    for (const auto& [rule_id, rule] : rules) {
+        json.element();
+        json.open('{');
+        json.field("rule_id", rule.rule_id);
+        json.field("rule_name", rule.rule_name);
+        json.field("category", rule.category);
+        if (rule.code_size_impact != 0) {
+            json.key("code_size_impact");
+            json.value(rule.code_size_impact);
+        }
+        
+        const CodePattern& pattern = rule.source_pattern;
+        json.key("pattern");
+        json.open('{');
+        json.field("pattern_id", pattern.pattern_id);
+        json.field("description", pattern.description);
+        json.field("required_node_types", pattern.required_node_types);
+        json.field("required_operations", pattern.required_operations);
+        json.field("constraints", pattern.constraints);
+        if (!pattern.data_dependencies.empty()) {
+            json.key("data_dependencies");
+            json.open('[');
+            for (const auto& [from, to] : pattern.data_dependencies) {
+                json.element();
+                json.open('[');
+                json.element();
+                json.value(from);
+                json.element();
+                json.value(to);
+                json.close(']');
+            }
+            json.close(']');
+        }
+        json.field("control_structures", pattern.control_structures);
+        json.field("tree_pattern", pattern.tree_pattern);
+        if (pattern.priority != 0) {
+            json.key("priority");
+            json.value(pattern.priority);
+        }
+        json.close('}');
+        
+        json.key("targets");
+        json.open('{');
+        for (const auto& [arch, tmpl] : rule.target_templates) {
+            json.key(arch);
+            json.open('{');
+            json.field("template_id", tmpl.template_id);
+            json.field("code_template", tmpl.code_template);
+            json.field("placeholders", tmpl.placeholders);
+            json.field("required_headers", tmpl.required_headers);
+            json.field("auxiliary_vars", tmpl.auxiliary_vars);
+            json.field("performance_hints", tmpl.performance_hints);
+            if (tmpl.cost >= 0) {
+                json.key("cost");
+                json.value(tmpl.cost);
+            }
+            json.close('}');
+        }
+        json.close('}');
+        json.close('}');
+    }
+    json.close(']');
+    json.close('}');
+    out += '\n';
+    return out;
+}
+
+bool RuleDatabase::exportRulesToJSON(const std::string& json_file) const {
+    std::ofstream out(json_file, std::ios::binary);
+    if (!out) {
+        std::cerr << "Error: Could not write rules to " << json_file << std::endl;
+        return false;
+    }
+    out << exportRulesToJSONString();
+    return static_cast<bool>(out);
 }
 
 std::map<std::string, int> RuleDatabase::getCategoryStatistics() const {
@@ -83,66 +752,733 @@ std::map<std::string, int> RuleDatabase::getCategoryStatistics() const {
 // PatternMatcher 实现
 // ============================================================================
 
-std::vector<std::pair<CodePattern*, void*>> PatternMatcher::matchInCPG(
-    void* cpg_graph,
-    const std::string& category) {
-    
-    std::vector<std::pair<CodePattern*, void*>> matches;
-    
-    // TODO: 实现CPG模式匹配
-    // 这里需要根据实际的CPG结构来实现
-    (void)cpg_graph;
-    (void)category;
-    
-    return matches;
+namespace {
+
+// 模式图: 节点约束为空串时表示通配
+struct CompiledPattern {
+    struct Node {
+        std::string label;
+        std::string operation;
+        std::string node_type;
+        std::vector<std::pair<std::string, std::string>> attributes;
+    };
+    std::vector<Node> nodes;
+    std::vector<std::pair<int, int>> edges;     // 数据依赖 from -> to
+    std::vector<int> order;                     // 匹配顺序: 从锚点开始按模式边 BFS
+    std::vector<int> parent;                    // order 中各节点在已匹配部分的邻居, -1 表示新连通分量
+    int root = -1;
+    bool requires_loop = false;
+};
+
+const std::map<std::string, AODNodeType>& nodeTypeNames() {
+    static const std::map<std::string, AODNodeType> names = {
+        {"Entry", AODNodeType::Entry}, {"Exit", AODNodeType::Exit}, {"Control", AODNodeType::Control},
+        {"If", AODNodeType::If}, {"Loop", AODNodeType::Loop}, {"Switch", AODNodeType::Switch},
+        {"Break", AODNodeType::Break}, {"Continue", AODNodeType::Continue}, {"Return", AODNodeType::Return},
+        {"BlockEnd", AODNodeType::BlockEnd}, {"Load", AODNodeType::Load}, {"Store", AODNodeType::Store},
+        {"Add", AODNodeType::Add}, {"Subtract", AODNodeType::Subtract}, {"Multiply", AODNodeType::Multiply},
+        {"Divide", AODNodeType::Divide}, {"Modulo", AODNodeType::Modulo}, {"And", AODNodeType::And},
+        {"Or", AODNodeType::Or}, {"Xor", AODNodeType::Xor}, {"Not", AODNodeType::Not},
+        {"ShiftLeft", AODNodeType::ShiftLeft}, {"ShiftRight", AODNodeType::ShiftRight},
+        {"Equal", AODNodeType::Equal}, {"NotEqual", AODNodeType::NotEqual}, {"LessThan", AODNodeType::LessThan},
+        {"LessEqual", AODNodeType::LessEqual}, {"GreaterThan", AODNodeType::GreaterThan},
+        {"GreaterEqual", AODNodeType::GreaterEqual}, {"SIMD_Load", AODNodeType::SIMD_Load},
+        {"SIMD_Store", AODNodeType::SIMD_Store}, {"SIMD_Arithmetic", AODNodeType::SIMD_Arithmetic},
+        {"SIMD_Compare", AODNodeType::SIMD_Compare}, {"SIMD_Blend", AODNodeType::SIMD_Blend},
+        {"SIMD_Shuffle", AODNodeType::SIMD_Shuffle}, {"SIMD_Permute", AODNodeType::SIMD_Permute},
+        {"SIMD_Intrinsic", AODNodeType::SIMD_Intrinsic}, {"GenericStmt", AODNodeType::GenericStmt},
+        {"Call", AODNodeType::Call}, {"Param", AODNodeType::Param}, {"ReturnValue", AODNodeType::ReturnValue},
+        {"Phi", AODNodeType::Phi}, {"Merge", AODNodeType::Merge}, {"Constant", AODNodeType::Constant},
+        {"Global", AODNodeType::Global}, {"Unknown", AODNodeType::Unknown},
+    };
+    return names;
+}
+
+CompiledPattern compilePattern(const CodePattern& pattern) {
+    CompiledPattern compiled;
+    std::map<std::string, int> by_label;
+    auto add_node = [&](const std::string& label) {
+        std::string unique = label;
+        for (int k = 2; by_label.count(unique); ++k) unique = label + "#" + std::to_string(k);
+        by_label[unique] = static_cast<int>(compiled.nodes.size());
+        compiled.nodes.push_back({unique, "", "", {}});
+        return static_cast<int>(compiled.nodes.size()) - 1;
+    };
+
+    for (const auto& op : pattern.required_operations) compiled.nodes[add_node(op)].operation = op;
+    for (const auto& type : pattern.required_node_types) {
+        auto it = std::find_if(compiled.nodes.begin(), compiled.nodes.end(), [](const CompiledPattern::Node& n) {
+            return !n.operation.empty() && n.node_type.empty();
+        });
+        if (it != compiled.nodes.end()) {
+            it->node_type = type;
+            if (!by_label.count(type)) by_label[type] = static_cast<int>(it - compiled.nodes.begin());
+        } else {
+            compiled.nodes[add_node(type)].node_type = type;
+        }
+    }
+    auto resolve = [&](const std::string& label) {
+        auto it = by_label.find(label);
+        return it != by_label.end() ? it->second : add_node(label);
+    };
+    for (const auto& [from, to] : pattern.data_dependencies) compiled.edges.push_back({resolve(from), resolve(to)});
+    if (compiled.nodes.empty()) return compiled;
+
+    // 锚点: 优先取有操作约束且没有出边的节点 (表达式树的根), 操作码索引可直接给出候选
+    auto has_out = [&](int n) {
+        return std::any_of(compiled.edges.begin(), compiled.edges.end(), [&](const std::pair<int, int>& e) { return e.first == n; });
+    };
+    for (int pass = 0; pass < 3 && compiled.root == -1; ++pass) {
+        for (int n = 0; n < static_cast<int>(compiled.nodes.size()); ++n) {
+            const auto& node = compiled.nodes[n];
+            bool ok = pass == 0 ? !node.operation.empty() && !has_out(n)
+                    : pass == 1 ? !node.operation.empty() || !node.node_type.empty() : true;
+            if (ok) { compiled.root = n; break; }
+        }
+    }
+
+    for (const auto& [key, value] : pattern.constraints) {
+        size_t dot = key.find('.');
+        if (dot != std::string::npos && by_label.count(key.substr(0, dot))) {
+            compiled.nodes[by_label[key.substr(0, dot)]].attributes.push_back({key.substr(dot + 1), value});
+        } else {
+            compiled.nodes[compiled.root].attributes.push_back({key, value});
+        }
+    }
+    for (const auto& structure : pattern.control_structures) {
+        if (structure == "for" || structure == "while" || structure == "loop") compiled.requires_loop = true;
+    }
+
+    std::vector<bool> placed(compiled.nodes.size(), false);
+    auto bfs = [&](int start) {
+        std::vector<int> queue = {start};
+        placed[start] = true;
+        compiled.order.push_back(start);
+        compiled.parent.push_back(-1);
+        for (size_t head = 0; head < queue.size(); ++head) {
+            int cur = queue[head];
+            for (const auto& [a, b] : compiled.edges) {
+                int next = a == cur ? b : b == cur ? a : -1;
+                if (next == -1 || placed[next]) continue;
+                placed[next] = true;
+                queue.push_back(next);
+                compiled.order.push_back(next);
+                compiled.parent.push_back(cur);
+            }
+        }
+    };
+    bfs(compiled.root);
+    for (int n = 0; n < static_cast<int>(compiled.nodes.size()); ++n) {
+        if (!placed[n]) bfs(n);
+    }
+    return compiled;
+}
+
+// 整图只建一次的索引: 操作码/节点类型 -> 节点, 以及数据边邻接
+struct AODPatternIndex {
+    std::unordered_map<std::string, std::vector<std::shared_ptr<AODNode>>> by_operation;
+    std::unordered_map<int, std::vector<std::shared_ptr<AODNode>>> by_type;
+    std::unordered_map<int, std::vector<std::shared_ptr<AODNode>>> successors, predecessors;
+    std::set<std::pair<int, int>> data_edges;
+    const std::vector<std::shared_ptr<AODNode>>* all = nullptr;
+
+    explicit AODPatternIndex(const AODGraph& graph) {
+        all = &graph.getNodes();
+        for (const auto& node : graph.getNodes()) {
+            std::string op = node->getProperty("op_name");
+            if (!op.empty()) by_operation[op].push_back(node);
+            by_type[static_cast<int>(node->getType())].push_back(node);
+        }
+        for (const auto& edge : graph.getEdges()) {
+            if (edge->getType() != AODEdgeType::Data) continue;
+            auto src = edge->getSource(), tgt = edge->getTarget();
+            if (!data_edges.insert({src->getId(), tgt->getId()}).second) continue;
+            successors[src->getId()].push_back(tgt);
+            predecessors[tgt->getId()].push_back(src);
+        }
+    }
+
+    const std::vector<std::shared_ptr<AODNode>>& candidates(const CompiledPattern::Node& node) const {
+        static const std::vector<std::shared_ptr<AODNode>> none;
+        if (!node.operation.empty()) {
+            auto it = by_operation.find(node.operation);
+            return it != by_operation.end() ? it->second : none;
+        }
+        if (!node.node_type.empty()) {
+            auto type = nodeTypeNames().find(node.node_type);
+            if (type == nodeTypeNames().end()) return none;
+            auto it = by_type.find(static_cast<int>(type->second));
+            return it != by_type.end() ? it->second : none;
+        }
+        return *all;
+    }
+};
+
+bool nodeSatisfies(const CompiledPattern::Node& pattern, const std::shared_ptr<AODNode>& node) {
+    if (!pattern.operation.empty() && node->getProperty("op_name") != pattern.operation) return false;
+    if (!pattern.node_type.empty()) {
+        auto type = nodeTypeNames().find(pattern.node_type);
+        if (type == nodeTypeNames().end() || node->getType() != type->second) return false;
+    }
+    for (const auto& [key, value] : pattern.attributes) {
+        if (node->getProperty(key) != value) return false;
+    }
+    return true;
+}
+
+bool inLoop(const AODGraph& graph, const std::shared_ptr<AODNode>& node) {
+    int anchor = node->getId();
+    int owner = AODGraph::getStatementAnchor(*node);
+    if (!node->isStatement() && owner >= 0) anchor = owner;
+    return graph.getLoopOf(anchor) != nullptr;
 }
 
-std::vector<std::pair<CodePattern*, void*>> PatternMatcher::matchInAOD(
-    void* aod_graph,
+// 以 root 为锚点的 VF2 式回溯, 成功时 mapping 为模式节点下标 -> 图节点
+bool matchFrom(const AODGraph& graph, const CompiledPattern& compiled, const AODPatternIndex& index,
+               const std::shared_ptr<AODNode>& root, std::vector<std::shared_ptr<AODNode>>& mapping) {
+    if (compiled.root == -1 || !nodeSatisfies(compiled.nodes[compiled.root], root)) return false;
+    if (compiled.requires_loop && !inLoop(graph, root)) return false;
+
+    mapping.assign(compiled.nodes.size(), nullptr);
+    std::set<int> used;
+    auto feasible = [&](int p, const std::shared_ptr<AODNode>& node) {
+        if (used.count(node->getId()) || !nodeSatisfies(compiled.nodes[p], node)) return false;
+        for (const auto& [a, b] : compiled.edges) {
+            if (a == p && mapping[b] && !index.data_edges.count({node->getId(), mapping[b]->getId()})) return false;
+            if (b == p && mapping[a] && !index.data_edges.count({mapping[a]->getId(), node->getId()})) return false;
+            if (a == p && b == p && !index.data_edges.count({node->getId(), node->getId()})) return false;
+        }
+        return true;
+    };
+
+    std::function<bool(size_t)> extend = [&](size_t depth) {
+        if (depth == compiled.order.size()) return true;
+        int p = compiled.order[depth];
+        std::vector<std::shared_ptr<AODNode>> seed;
+        const std::vector<std::shared_ptr<AODNode>>* candidates = &seed;
+        if (depth == 0) {
+            seed.push_back(root);
+        } else if (compiled.parent[depth] != -1) {
+            // 沿模式边从已匹配的邻居出发, 只看其数据边邻接点
+            int q = compiled.parent[depth];
+            bool forward = std::any_of(compiled.edges.begin(), compiled.edges.end(),
+                                       [&](const std::pair<int, int>& e) { return e.first == q && e.second == p; });
+            const auto& adjacency = forward ? index.successors : index.predecessors;
+            auto it = adjacency.find(mapping[q]->getId());
+            if (it != adjacency.end()) candidates = &it->second;
+        } else {
+            candidates = &index.candidates(compiled.nodes[p]);
+        }
+        for (const auto& node : *candidates) {
+            if (!feasible(p, node)) continue;
+            mapping[p] = node;
+            used.insert(node->getId());
+            if (extend(depth + 1)) return true;
+            used.erase(node->getId());
+            mapping[p] = nullptr;
+        }
+        return false;
+    };
+    return extend(0);
+}
+
+}  // namespace
+
+std::vector<PatternMatch> PatternMatcher::matchInAOD(
+    const AODGraph& aod_graph,
     const std::string& category) {
     
-    std::vector<std::pair<CodePattern*, void*>> matches;
+    std::vector<PatternMatch> matches;
+    if (!rule_db) return matches;
     
-    // TODO: 实现AOD模式匹配
-    (void)aod_graph;
-    (void)category;
+    AODPatternIndex index(aod_graph);
+    auto rules = category.empty() ? rule_db->getAllRules() : rule_db->queryRules(category);
+    std::vector<std::shared_ptr<AODNode>> mapping;
+    for (auto* rule : rules) {
+        CompiledPattern compiled = compilePattern(rule->source_pattern);
+        if (compiled.root == -1) continue;
+        for (const auto& root : index.candidates(compiled.nodes[compiled.root])) {
+            if (!matchFrom(aod_graph, compiled, index, root, mapping)) continue;
+            PatternMatch match;
+            match.rule = rule;
+            match.pattern = &rule->source_pattern;
+            match.root = root;
+            match.nodes = mapping;
+            for (size_t i = 0; i < compiled.nodes.size(); ++i) match.bindings[compiled.nodes[i].label] = mapping[i];
+            matches.push_back(std::move(match));
+        }
+    }
     
     return matches;
 }
 
-bool PatternMatcher::checkPatternMatch(const CodePattern& pattern, void* graph_node) {
-    // TODO: 实现模式匹配检查
-    (void)pattern;
-    (void)graph_node;
+bool PatternMatcher::checkPatternMatch(const CodePattern& pattern, const AODGraph& graph, const std::shared_ptr<AODNode>& root) {
+    if (!root) return false;
+    CompiledPattern compiled = compilePattern(pattern);
+    AODPatternIndex index(graph);
+    std::vector<std::shared_ptr<AODNode>> mapping;
+    return matchFrom(graph, compiled, index, root, mapping);
+}
+
+std::shared_ptr<AODGraph> PatternMatcher::extractSubgraph(const AODGraph& graph, const PatternMatch& match) {
+    auto subgraph = std::make_shared<AODGraph>(graph.getName() + "_" + (match.rule ? match.rule->rule_id : "match"));
+    std::set<int> ids;
+    for (const auto& node : match.nodes) {
+        if (node && ids.insert(node->getId()).second) subgraph->addNode(node);
+    }
+    for (const auto& edge : graph.getEdges()) {
+        if (ids.count(edge->getSource()->getId()) && ids.count(edge->getTarget()->getId())) {
+            subgraph->addEdge(edge->getSource(), edge->getTarget(), edge->getType(), edge->getProperties().variable_name);
+        }
+    }
+    return subgraph;
+}
+
+bool PatternMatcher::matchNodeTypes(const std::vector<std::string>& required, const AODGraph& graph) {
+    AODPatternIndex index(graph);
+    for (const auto& type : required) {
+        CompiledPattern::Node node{type, "", type, {}};
+        if (index.candidates(node).empty()) return false;
+    }
+    return true;
+}
+
+bool PatternMatcher::matchDataDependencies(
+    const std::vector<std::pair<std::string, std::string>>& deps, 
+    const AODGraph& graph) {
     
+    CodePattern pattern;
+    pattern.data_dependencies = deps;
+    CompiledPattern compiled = compilePattern(pattern);
+    if (compiled.root == -1) return true;
+    AODPatternIndex index(graph);
+    std::vector<std::shared_ptr<AODNode>> mapping;
+    for (const auto& root : index.candidates(compiled.nodes[compiled.root])) {
+        if (matchFrom(graph, compiled, index, root, mapping)) return true;
+    }
     return false;
 }
 
-void* PatternMatcher::extractSubgraph(void* graph, void* match_location) {
-    // TODO: 实现子图提取
-    (void)graph;
-    (void)match_location;
-    
-    return nullptr;
+// ============================================================================
+// TreePattern 解析与 tile 匹配
+// ============================================================================
+
+namespace {
+
+bool parseTreePattern(const std::string& text, size_t& pos, TreePattern& out) {
+    while (pos < text.size() && std::isspace(static_cast<unsigned char>(text[pos]))) ++pos;
+    if (pos >= text.size()) return false;
+    if (text[pos] == '(') {
+        ++pos;
+        size_t start = pos;
+        while (pos < text.size() && !std::isspace(static_cast<unsigned char>(text[pos])) && text[pos] != '(' && text[pos] != ')') ++pos;
+        out.op = text.substr(start, pos - start);
+        if (out.op.empty()) return false;
+        while (true) {
+            while (pos < text.size() && std::isspace(static_cast<unsigned char>(text[pos]))) ++pos;
+            if (pos >= text.size()) return false;
+            if (text[pos] == ')') { ++pos; return true; }
+            TreePattern child;
+            if (!parseTreePattern(text, pos, child)) return false;
+            out.children.push_back(std::move(child));
+        }
+    }
+    size_t start = pos;
+    while (pos < text.size() && !std::isspace(static_cast<unsigned char>(text[pos])) && text[pos] != '(' && text[pos] != ')') ++pos;
+    std::string atom = text.substr(start, pos - start);
+    if (atom.size() > 1 && atom[0] == '$') { out.leaf = std::atoi(atom.c_str() + 1); return true; }
+    if (atom.size() > 1 && atom[0] == '#') { out.literal = atom.substr(1); return true; }
+    return false;
+}
+
+void collectPatternOperations(const TreePattern& pattern, std::vector<std::string>& ops) {
+    if (!pattern.op.empty()) ops.push_back(pattern.op);
+    for (const auto& child : pattern.children) collectPatternOperations(child, ops);
+}
+
+// 一次选择内共享的图索引: 操作数与使用次数只扫描一遍边表
+class Tiler {
+public:
+    Tiler(const AODGraph& graph) {
+        for (const auto& edge : graph.getEdges()) {
+            if (!AODGraph::isOperandEdge(*edge)) continue;
+            operands[edge->getTarget()->getId()][AODGraph::getOperandIndex(*edge)] = edge->getSource();
+            users[edge->getSource()->getId()]++;
+        }
+    }
+
+    static bool isLeaf(const std::shared_ptr<AODNode>& node) {
+        return node->isStatement() || !node->getProperty("const_kind").empty() || node->getProperty("op_name").empty();
+    }
+
+    // 以 node 为根匹配 pattern, 成功时把叶子绑定与被吸收的内部节点写入 selection
+    bool matchRoot(const TreePattern& pattern, const std::shared_ptr<AODNode>& node, TileSelection& selection) {
+        return matchNode(pattern, node, true, selection);
+    }
+
+    const std::map<int, std::shared_ptr<AODNode>>& operandsOf(int id) { return operands[id]; }
+
+private:
+    std::unordered_map<int, std::map<int, std::shared_ptr<AODNode>>> operands;
+    std::unordered_map<int, int> users;
+
+    bool matchNode(const TreePattern& pattern, const std::shared_ptr<AODNode>& node, bool is_root, TileSelection& selection) {
+        if (node->getProperty("op_name") != pattern.op || (!is_root && (isLeaf(node) || users[node->getId()] != 1))) return false;
+        if (std::atoi(node->getProperty("operand_count", "0").c_str()) != static_cast<int>(pattern.children.size())) return false;
+        if (!is_root) selection.covered.push_back(node);
+        if (matchOperands(pattern, node, false, selection)) return true;
+        if (pattern.children.size() != 2 || !isCommutativeOperationName(pattern.op)) return false;
+        return matchOperands(pattern, node, true, selection);
+    }
+
+    bool matchOperands(const TreePattern& pattern, const std::shared_ptr<AODNode>& node, bool swapped, TileSelection& selection) {
+        TileSelection saved = selection;
+        for (size_t i = 0; i < pattern.children.size(); ++i) {
+            int index = static_cast<int>(swapped ? pattern.children.size() - 1 - i : i);
+            if (!matchOperand(pattern.children[i], node, index, selection)) {
+                selection = saved;
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool matchOperand(const TreePattern& pattern, const std::shared_ptr<AODNode>& user, int index, TileSelection& selection) {
+        auto it = operands[user->getId()].find(index);
+        std::shared_ptr<AODNode> node = it != operands[user->getId()].end() ? it->second : nullptr;
+        std::string slot = std::to_string(index);
+        std::string text = user->getProperty("text_" + slot);
+        if (text.empty()) text = user->getProperty("imm_" + slot);
+
+        if (pattern.leaf >= 0) {
+            if (node) {
+                auto bound = selection.leaf_nodes.find(pattern.leaf);
+                if (bound != selection.leaf_nodes.end()) return bound->second == node;
+                if (selection.leaf_texts.count(pattern.leaf)) return false;
+                selection.leaf_nodes[pattern.leaf] = node;
+                return true;
+            }
+            auto bound = selection.leaf_texts.find(pattern.leaf);
+            if (bound != selection.leaf_texts.end()) return bound->second == text;
+            if (selection.leaf_nodes.count(pattern.leaf)) return false;
+            selection.leaf_texts[pattern.leaf] = text;
+            return true;
+        }
+        if (!pattern.literal.empty()) {
+            if (!node) return user->getProperty("imm_" + slot) == pattern.literal;
+            bool splat = node->getProperty("op_name").find("_set1_") != std::string::npos && node->getProperty("imm_0") == pattern.literal;
+            return node->getProperty("const_value") == pattern.literal || splat;
+        }
+        return node && matchNode(pattern, node, false, selection);
+    }
+};
+
+}  // namespace
+
+bool TreePattern::parse(const std::string& text, TreePattern& out) {
+    size_t pos = 0;
+    out = TreePattern();
+    if (!parseTreePattern(text, pos, out)) return false;
+    while (pos < text.size() && std::isspace(static_cast<unsigned char>(text[pos]))) ++pos;
+    return pos == text.size();
 }
 
-bool PatternMatcher::matchNodeTypes(const std::vector<std::string>& required, void* graph) {
-    // TODO: 实现节点类型匹配
-    (void)required;
-    (void)graph;
+// ============================================================================
+// CompiledRuleIndex 实现
+// ============================================================================
+
+std::shared_ptr<const CompiledRuleIndex> CompiledRuleIndex::build(RuleDatabase& db, const std::vector<std::string>& categories) {
+    auto index = std::make_shared<CompiledRuleIndex>();
+    index->generation = db.getGeneration();
+    auto intern = [](std::unordered_map<std::string, uint32_t>& ids, const std::string& name) {
+        return ids.emplace(name, static_cast<uint32_t>(ids.size())).first->second;
+    };
+
+    struct Entry { uint32_t op, arch; TemplateHandle handle; const TreePattern* tree; };
+    std::vector<Entry> entries;
+    std::vector<std::unique_ptr<TreePattern>> trees;
+    for (const auto& category : categories) {
+        for (const auto* rule : db.queryRules(category)) {
+            for (const auto& [arch, tmpl] : rule->target_templates) {
+                TemplateHandle handle;
+                handle.rule = rule;
+                handle.target = &tmpl;
+                auto hint = tmpl.performance_hints.find("return_type");
+                if (hint != tmpl.performance_hints.end()) handle.return_type = &hint->second;
+                handle.code = tmpl.compiled.get();
+                handle.cost = InstructionSelector::templateCost(*rule, tmpl, arch);
+                uint32_t arch_id = intern(index->architecture_ids, arch);
+
+                if (rule->source_pattern.tree_pattern.empty()) {
+                    for (const auto& op : rule->source_pattern.required_operations) {
+                        entries.push_back({intern(index->operation_ids, op), arch_id, handle, nullptr});
+                    }
+                    continue;
+                }
+                auto tree = std::make_unique<TreePattern>();
+                if (!TreePattern::parse(rule->source_pattern.tree_pattern, *tree) || tree->op.empty()) {
+                    std::cerr << "Warning: bad tree pattern in rule " << rule->rule_id << std::endl;
+                    continue;
+                }
+                entries.push_back({intern(index->operation_ids, tree->op), arch_id, handle, tree.get()});
+                trees.push_back(std::move(tree));
+            }
+        }
+    }
+
+    size_t slots = index->operation_ids.size() * index->architecture_ids.size();
+    index->singles.resize(slots);
+    index->fused.resize(slots);
+    for (const auto& entry : entries) {
+        size_t at = index->slot(entry.op, entry.arch);
+        if (entry.tree) index->fused[at].push_back({entry.handle, *entry.tree});
+        else index->singles[at].push_back(entry.handle);
+    }
+    for (auto& list : index->singles) {
+        std::stable_sort(list.begin(), list.end(), [](const TemplateHandle& a, const TemplateHandle& b) { return a.cost < b.cost; });
+    }
     
-    return false;
+    // 与映射表同键的规则按表项下标记录, lookup 查表后无需再查字符串索引.
+    // 与表项本身相同的规则 (导入或导出后再加载的映射表) 不算覆盖
+    index->overrides.resize(std::size(kIntrinsicMappings));
+    for (const auto& [op, op_id] : index->operation_ids) {
+        for (const auto& [arch, arch_id] : index->architecture_ids) {
+            const IntrinsicMapping* mapping = findIntrinsicMapping(op, arch);
+            if (!mapping) continue;
+            for (const auto& handle : index->singles[index->slot(op_id, arch_id)]) {
+                if (handle.rule->rule_id == mapping->rule_id && handle.target->code_template == mapping->code) continue;
+                index->overrides[mapping - kIntrinsicMappings] = handle;
+                break;
+            }
+        }
+    }
+    return index;
 }
 
-bool PatternMatcher::matchDataDependencies(
-    const std::vector<std::pair<std::string, std::string>>& deps, 
-    void* graph) {
+const CompiledRuleIndex::TemplateHandle& CompiledRuleIndex::mappingHandle(const IntrinsicMapping& mapping) {
+    struct Slot {
+        std::once_flag once;
+        OptimizationRule rule;
+        CodeTemplate code;
+        TemplateHandle handle;
+    };
+    static Slot slots[std::size(kIntrinsicMappings)];
+    Slot& entry = slots[&mapping - kIntrinsicMappings];
+    std::call_once(entry.once, [&] {
+        OptimizationRule& rule = entry.rule;
+        rule.rule_id = std::string(mapping.rule_id);
+        rule.category = "simd_instruction";
+        rule.source_pattern.required_operations = {std::string(mapping.source)};
+        TransformTemplate& target = rule.target_templates[std::string(mapping.target_arch)];
+        target.target_architecture = std::string(mapping.target_arch);
+        target.code_template = std::string(mapping.code);
+        target.cost = mapping.cost;
+        target.performance_hints["return_type"] = std::string(mapping.return_type);
+        target.performance_hints["element_type"] = std::string(mapping.element_type);
+        target.performance_hints["operands"] = std::string(mapping.operands);
+
+        entry.handle.rule = &rule;
+        entry.handle.target = &target;
+        entry.handle.return_type = &target.performance_hints["return_type"];
+        entry.handle.cost = mapping.cost;
+        std::string error;
+        if (CodeTemplate::compile(target.code_template, entry.code, &error)) {
+            entry.handle.code = &entry.code;
+        } else {
+            std::cerr << "Error: mapping " << rule.rule_id << " template: " << error << std::endl;
+        }
+    });
+    return entry.handle;
+}
+
+size_t CompiledRuleIndex::slot(uint32_t op_id, uint32_t arch_id) const {
+    return static_cast<size_t>(op_id) * architecture_ids.size() + arch_id;
+}
+
+uint32_t CompiledRuleIndex::operationId(const std::string& op_name) const {
+    auto it = operation_ids.find(op_name);
+    return it != operation_ids.end() ? it->second : kUnknown;
+}
+
+uint32_t CompiledRuleIndex::architectureId(const std::string& arch) const {
+    auto it = architecture_ids.find(arch);
+    return it != architecture_ids.end() ? it->second : kUnknown;
+}
+
+CompiledRuleIndex::TemplateHandle CompiledRuleIndex::lookup(uint32_t op_id, uint32_t arch_id) const {
+    const auto& list = candidates(op_id, arch_id);
+    return list.empty() ? TemplateHandle() : list.front();
+}
+
+CompiledRuleIndex::TemplateHandle CompiledRuleIndex::lookup(const std::string& op_name, const std::string& arch) const {
+    const IntrinsicMapping* mapping = findIntrinsicMapping(op_name, arch);
+    if (!mapping) return lookup(operationId(op_name), architectureId(arch));  // 只在规则库中的运算
+    // 规则库/规则包中显式给出的同键规则总是优先, 不与表项比较代价
+    const TemplateHandle& rule = overrides[mapping - kIntrinsicMappings];
+    return rule ? rule : mappingHandle(*mapping);
+}
+
+const std::vector<CompiledRuleIndex::TemplateHandle>& CompiledRuleIndex::candidates(uint32_t op_id, uint32_t arch_id) const {
+    static const std::vector<TemplateHandle> none;
+    if (op_id == kUnknown || arch_id == kUnknown) return none;
+    return singles[slot(op_id, arch_id)];
+}
+
+const std::vector<CompiledRuleIndex::Tile>& CompiledRuleIndex::tiles(uint32_t op_id, uint32_t arch_id) const {
+    static const std::vector<Tile> none;
+    if (op_id == kUnknown || arch_id == kUnknown) return none;
+    return fused[slot(op_id, arch_id)];
+}
+
+// ============================================================================
+// RuleRegistry 实现
+// ============================================================================
+
+RuleRegistry::RuleRegistry(Populate builtin, std::vector<std::string> categories)
+    : builtin(std::move(builtin)), categories(std::move(categories)) {}
+
+void RuleRegistry::addRuleFile(const std::string& path) {
+    std::lock_guard<std::mutex> lock(reload_mutex);
+    files.push_back(path);
+    stamps.clear();  // 下次 reloadIfChanged 必然重载
+}
+
+std::shared_ptr<const RuleSnapshot> RuleRegistry::current() const {
+    return std::atomic_load(&snapshot);
+}
+
+std::vector<std::pair<int64_t, uintmax_t>> RuleRegistry::currentStamps() const {
+    std::vector<std::pair<int64_t, uintmax_t>> result;
+    for (const auto& path : files) {
+        std::error_code ec;
+        auto mtime = std::filesystem::last_write_time(path, ec);
+        int64_t ticks = ec ? -1 : static_cast<int64_t>(mtime.time_since_epoch().count());
+        uintmax_t size = std::filesystem::file_size(path, ec);
+        result.emplace_back(ticks, ec ? 0 : size);
+    }
+    return result;
+}
+
+bool RuleRegistry::reload(std::string* error) {
+    std::lock_guard<std::mutex> lock(reload_mutex);
+    auto stamped = currentStamps();
+    auto fail = [&](const std::string& message) {
+        stamps = std::move(stamped);  // 出错的文件再次修改前不重复解析
+        if (error) *error = message;
+        else std::cerr << "Error: rule reload failed, keeping previous rules: " << message << std::endl;
+        return false;
+    };
     
-    // TODO: 实现数据依赖匹配
-    (void)deps;
-    (void)graph;
+    // 加载中的异常同样只让本次重载失败, 长驻进程继续使用旧快照
+    auto next = std::make_shared<RuleSnapshot>();
+    std::string stage = "builtin rules";
+    try {
+        next->db = std::make_shared<RuleDatabase>();
+        if (builtin) builtin(*next->db);
+        for (const auto& path : files) {
+            stage = path;
+            std::string message;
+            if (!next->db->loadRulesFromJSON(path, &message)) return fail(message);
+        }
+        stage = "rule index";
+        next->index = CompiledRuleIndex::build(*next->db, categories);
+    } catch (const std::exception& e) {
+        return fail(stage + ": " + e.what());
+    } catch (...) {
+        return fail(stage + ": unknown exception");
+    }
+    next->version = ++version;
     
-    return false;
+    stamps = std::move(stamped);
+    std::atomic_store(&snapshot, std::shared_ptr<const RuleSnapshot>(std::move(next)));
+    return true;
+}
+
+bool RuleRegistry::reloadIfChanged(std::string* error) {
+    {
+        std::lock_guard<std::mutex> lock(reload_mutex);
+        if (std::atomic_load(&snapshot) && currentStamps() == stamps) return false;
+    }
+    return reload(error);
+}
+
+// ============================================================================
+// InstructionSelector 实现
+// ============================================================================
+
+InstructionSelector::InstructionSelector(RuleDatabase* db, const std::string& arch)
+    : index(db ? CompiledRuleIndex::build(*db, {"simd_instruction", "scalar_vectorization"}) : nullptr), target_arch(arch) {}
+
+InstructionSelector::InstructionSelector(std::shared_ptr<const CompiledRuleIndex> compiled, const std::string& arch)
+    : index(std::move(compiled)), target_arch(arch) {}
+
+int InstructionSelector::templateCost(const OptimizationRule& rule, const TransformTemplate& tmpl,
+                                      const std::string& arch, const std::string& value_type) {
+    if (tmpl.cost >= 0) return tmpl.cost;
+    std::vector<std::string> ops;
+    TreePattern tree;
+    if (!rule.source_pattern.tree_pattern.empty() && TreePattern::parse(rule.source_pattern.tree_pattern, tree)) {
+        collectPatternOperations(tree, ops);
+    } else {
+        ops = rule.source_pattern.required_operations;
+    }
+    int cost = 0;
+    for (const auto& op : ops) cost += getOperationLatency(arch, op, value_type);
+    return cost;
+}
+
+std::map<int, TileSelection> InstructionSelector::select(const AODGraph& graph) {
+    std::map<int, TileSelection> selected;
+    if (!index) return selected;
+    const uint32_t arch_id = index->architectureId(target_arch);
+
+    Tiler tiler(graph);
+    const int kNoRule = 1000;  // 无规则时回退到 AST 打印, 视为很贵
+    std::unordered_map<int, int> best;
+    std::function<int(const std::shared_ptr<AODNode>&)> solve = [&](const std::shared_ptr<AODNode>& node) -> int {
+        if (Tiler::isLeaf(node)) return 0;
+        auto known = best.find(node->getId());
+        if (known != best.end()) return known->second;
+        best[node->getId()] = kNoRule;  // 数据流无环, 仅防御异常图
+
+        int result = kNoRule;
+        auto consider = [&](const CompiledRuleIndex::TemplateHandle& handle, const TreePattern& tree) {
+            TileSelection selection;
+            if (!tiler.matchRoot(tree, node, selection)) return;
+            selection.rule = handle.rule;
+            selection.target = handle.target;
+            selection.root = node;
+            selection.tile_cost = handle.cost;
+            selection.total_cost = handle.cost;
+            for (const auto& [k, leaf] : selection.leaf_nodes) selection.total_cost += solve(leaf);
+            if (selection.total_cost < result) {
+                result = selection.total_cost;
+                selected[node->getId()] = std::move(selection);
+            }
+        };
+
+        // 单运算规则的模式即 (op $0 .. $n-1), 取最便宜的一条
+        std::string op = node->getProperty("op_name");
+        uint32_t op_id = index->operationId(op);
+        if (auto single = index->lookup(op, target_arch)) {
+            TreePattern pattern;
+            pattern.op = op;
+            int count = std::atoi(node->getProperty("operand_count", "0").c_str());
+            for (int i = 0; i < count; ++i) {
+                TreePattern leaf;
+                leaf.leaf = i;
+                pattern.children.push_back(leaf);
+            }
+            consider(single, pattern);
+        }
+        for (const auto& tile : index->tiles(op_id, arch_id)) consider(tile.handle, tile.tree);
+
+        best[node->getId()] = result;
+        return result;
+    };
+
+    for (const auto& node : graph.getNodes()) solve(node);
+    return selected;
 }
 
 // ============================================================================
@@ -153,10 +1489,8 @@ std::string UniversalCodeGenerator::generateFromTemplate(
     const TransformTemplate& tmpl,
     const std::map<std::string, std::string>& bindings) {
 
-    std::string code = tmpl.code_template;
-
-    // 替换占位符
-    code = replacePlaceholders(code, bindings);
+    // 规则加载时已预编译的模板直接单遍展开
+    std::string code = tmpl.compiled ? tmpl.compiled->expand(bindings) : replacePlaceholders(tmpl.code_template, bindings);
 
     // 添加头文件
     std::string headers = insertHeaders(tmpl.required_headers);
@@ -174,7 +1508,7 @@ std::string UniversalCodeGenerator::generateFromTemplate(
 
 std::string UniversalCodeGenerator::applyRule(
     const OptimizationRule& rule,
-    void* matched_subgraph,
+    const PatternMatch& match,
     const std::string& target_arch) {
 
     auto it = rule.target_templates.find(target_arch);
@@ -182,28 +1516,22 @@ std::string UniversalCodeGenerator::applyRule(
         return "// Error: No template for target architecture: " + target_arch;
     }
 
-    // 从匹配的子图提取绑定
     std::map<std::string, std::string> bindings;
-    // TODO: 实现绑定提取逻辑
-    (void)matched_subgraph;
-
-    return generateFromTemplate(it->second, bindings);
-}
-
-std::string UniversalCodeGenerator::applyRules(
-    const std::vector<OptimizationRule*>& rules,
-    void* graph,
-    const std::string& target_arch) {
-
-    std::stringstream result;
-
-    for (auto* rule : rules) {
-        if (rule) {
-            result << applyRule(*rule, graph, target_arch) << "\n";
+    for (const auto& [label, node] : match.bindings) {
+        if (!node) continue;
+        std::string var = node->getProperty("var_name");
+        bindings[label] = var.empty() ? node->getProperty("op_name") : var;
+    }
+    if (match.root) {
+        int operand_count = std::atoi(match.root->getProperty("operand_count", "0").c_str());
+        for (int i = 0; i < operand_count; ++i) {
+            std::string key = "input_" + std::to_string(i);
+            std::string text = match.root->getProperty("text_" + std::to_string(i));
+            if (!text.empty() && !bindings.count(key)) bindings[key] = text;
         }
     }
 
-    return result.str();
+    return generateFromTemplate(it->second, bindings);
 }
 
 std::string UniversalCodeGenerator::formatCode(const std::string& code) {
@@ -215,19 +1543,13 @@ std::string UniversalCodeGenerator::replacePlaceholders(
     const std::string& template_str,
     const std::map<std::string, std::string>& bindings) {
 
-    std::string result = template_str;
-
-    // 替换所有 ${placeholder} 形式的占位符
-    for (const auto& [key, value] : bindings) {
-        std::string placeholder = "${" + key + "}";
-        size_t pos = 0;
-        while ((pos = result.find(placeholder, pos)) != std::string::npos) {
-            result.replace(pos, placeholder.length(), value);
-            pos += value.length();
-        }
+    CodeTemplate compiled;
+    std::string error;
+    if (!CodeTemplate::compile(template_str, compiled, &error)) {
+        std::cerr << "Error: bad code template: " << error << std::endl;
+        return template_str;
     }
-
-    return result;
+    return compiled.expand(bindings);
 }
 
 std::string UniversalCodeGenerator::generateAuxiliaryVars(
@@ -255,7 +1577,7 @@ std::string UniversalCodeGenerator::insertHeaders(
 // ============================================================================
 
 std::string OptimizationPipeline::runOptimization(
-    void* input_graph,
+    const AODGraph& graph,
     const std::string& target_arch,
     const std::vector<std::string>& enabled_categories) {
 
@@ -264,36 +1586,20 @@ std::string OptimizationPipeline::runOptimization(
     result << "// Optimization Pipeline Results\n";
     result << "// Target Architecture: " << target_arch << "\n\n";
 
-    // 对每个启用的类别进行优化
     for (const auto& category : enabled_categories) {
-        result << "// Category: " << category << "\n";
-
-        // 1. 模式匹配
-        auto matches = matcher.matchInCPG(input_graph, category);
-
-        // 2. 对每个匹配应用规则
-        for (const auto& [pattern, subgraph] : matches) {
-            auto rules = rule_db->queryRulesByPattern(*pattern);
-
-            for (auto* rule : rules) {
-                // 检查规则是否启用
-                if (enabled_rules.find(rule->rule_id) != enabled_rules.end() ||
-                    disabled_rules.find(rule->rule_id) == disabled_rules.end()) {
-
-                    // 应用规则
-                    std::string optimized_code = generator.applyRule(*rule, subgraph, target_arch);
-                    
-                    result << optimized_code << "\n";
-                    
-                    // 记录应用的规则
-                    applied_rules.push_back(rule->rule_id);
-                }
-            }
+        result << "// Category: " << (category.empty() ? "all" : category) << "\n";
+
+        for (const auto& match : matcher.matchInAOD(graph, category)) {
+            const OptimizationRule& rule = *match.rule;
+            if (disabled_rules.count(rule.rule_id) && !enabled_rules.count(rule.rule_id)) continue;
+
+            result << generator.applyRule(rule, match, target_arch) << "\n";
+            applied_rules.push_back(rule.rule_id);
         }
-        
+
         result << "\n";
     }
-    
+
     return result.str();
 }
 
@@ -6,9 +6,16 @@
 #include <set>
 #include <memory>
 #include <functional>
+#include <unordered_map>
+#include <cstdint>
+#include <mutex>
 
 namespace aodsolve {
 
+class AODGraph;
+class AODNode;
+struct IntrinsicMapping;
+
 // ============================================================================
 // 通用优化规则系统 - 不针对特定优化类型,而是基于CPG/AOD模式匹配
 // ============================================================================
@@ -55,12 +62,53 @@ struct CodePattern {
     // 控制流模式
     std::vector<std::string> control_structures;    // 控制结构(if, for, while)
     
+    // 指令选择用的表达式树模式, 如 "(_mm256_add_epi8 $0 (_mm256_and_si256 $1 $2))"
+    // $k 绑定模板的 {{input_k}}, #v 匹配值为 v 的立即数/常量; 为空时等价于 (op $0 .. $n-1)
+    std::string tree_pattern;
+    
     // 匹配优先级
     int priority;
     
     CodePattern() : priority(0) {}
 };
 
+/**
+ * 预编译的代码模板 - 字面量片段与占位符槽交替的序列
+ *
+ * 唯一的占位符语法为 {{name}}, name 须为标识符, {{input_N}} 的 N 不超过 kMaxInputIndex;
+ * 旧的 ${name}、未闭合的 {{、{{0}} 等在编译时报错. 展开按槽号取值, 单遍追加到调用方可复用的缓冲区;
+ * 未绑定的槽原样保留 {{name}}.
+ */
+class CodeTemplate {
+public:
+    using Values = std::vector<const std::string*>;     // 按槽号, nullptr 表示未绑定
+    static constexpr int kMaxInputIndex = 64;           // {{input_N}} 的 N 上限
+    
+    static bool compile(const std::string& source, CodeTemplate& out, std::string* error = nullptr);
+    
+    size_t slotCount() const { return names.size(); }
+    const std::vector<std::string>& slotNames() const { return names; }
+    int slotOf(const std::string& name) const;          // 不存在返回 -1
+    int inputSlot(int index) const;                     // {{input_N}} 的槽号, 不存在返回 -1
+    int inputCount() const { return static_cast<int>(input_slots.size()); }
+    
+    void expand(const Values& values, std::string& out) const;
+    // 按名字绑定 (键为不带花括号的占位符名), 用于不常走的路径
+    std::string expand(const std::map<std::string, std::string>& bindings) const;
+    
+private:
+    struct Segment {
+        int slot;           // -1 为字面量
+        size_t offset;      // 在 source 中的位置; 占位符段覆盖整个 {{name}}
+        size_t length;
+    };
+    std::string source;
+    std::vector<Segment> segments;
+    std::vector<std::string> names;
+    std::vector<int> input_slots;                       // N -> 槽号
+    size_t literal_size = 0;
+};
+
 /**
  * 代码转换模板 - 将匹配的模式转换为目标代码
  */
@@ -82,6 +130,12 @@ struct TransformTemplate {
     
     // 性能特性
     std::map<std::string, std::string> performance_hints;
+    
+    // 目标指令序列的延迟代价(周期), 指令选择按此最小化; -1 表示按源模式中各运算的延迟估计
+    int cost = -1;
+    
+    // code_template 的编译结果, 由 RuleDatabase::addRule 生成
+    std::shared_ptr<const CodeTemplate> compiled;
 };
 
 /**
@@ -101,73 +155,263 @@ struct OptimizationRule {
     // 应用条件
     std::function<bool(void*)> applicability_check; // 适用性检查函数
     
-    // 优化效果估计
-    int estimated_speedup;                          // 预估加速比
+    // 优化效果估计 (运行代价见 TransformTemplate::cost)
     int code_size_impact;                           // 代码大小影响
     
-    OptimizationRule() : estimated_speedup(1), code_size_impact(0) {}
+    OptimizationRule() : code_size_impact(0) {}
+};
+
+/**
+ * 已加载的规则包 (一个规则文件)
+ */
+struct RulePackInfo {
+    std::string name;                   // 包名, 文件未给出时取文件名
+    std::string version;                // 包版本, 仅记录
+    std::string source;                 // 文件路径
+    size_t rule_count = 0;
 };
 
 /**
  * 规则库 - 管理所有优化规则
+ *
+ * 规则文件为 JSON:
+ *   {"format": 1, "pack": "名字", "version": "1.0", "rules": [
+ *     {"rule_id": ..., "rule_name": ..., "category": ..., "code_size_impact": 0,
+ *      "pattern": {"pattern_id", "description", "required_node_types": [], "required_operations": [],
+ *                  "constraints": {}, "data_dependencies": [["a", "b"]], "control_structures": [],
+ *                  "tree_pattern", "priority"},
+ *      "targets": {"SVE": {"template_id", "code_template", "placeholders": {}, "required_headers": [],
+ *                          "auxiliary_vars": [], "performance_hints": {}, "cost": -1}}}]}
+ * format 只接受 1; 未知字段跳过. applicability_check 无法序列化, 导出时省略.
  */
 class RuleDatabase {
 public:
     RuleDatabase() = default;
     
-    // 添加规则
-    void addRule(const OptimizationRule& rule);
+    // 添加规则; 模板编译或校验失败时不加入, 返回 false (error 为空时输出到 stderr)
+    bool addRule(const OptimizationRule& rule, std::string* error = nullptr);
     
     // 查询规则
     std::vector<OptimizationRule*> queryRules(const std::string& category);
+    std::vector<OptimizationRule*> getAllRules();
     std::vector<OptimizationRule*> queryRulesByPattern(const CodePattern& pattern);
     OptimizationRule* getRuleById(const std::string& rule_id);
     
-    // 加载规则(从配置文件)
-    void loadRulesFromJSON(const std::string& json_file);
-    void loadRulesFromYAML(const std::string& yaml_file);
+    // 加载规则(从配置文件); 文件整体解析且全部模板校验通过后才加入规则, 失败时规则库不变
+    bool loadRulesFromJSON(const std::string& json_file, std::string* error = nullptr);
+    bool loadRulesFromYAML(const std::string& yaml_file, std::string* error = nullptr);
+    const std::vector<RulePackInfo>& getRulePacks() const { return packs; }
     
-    // 导出规则
-    void exportRulesToJSON(const std::string& json_file);
+    // 导出规则: 按规则ID排序, 字段顺序固定, 可直接 diff
+    bool exportRulesToJSON(const std::string& json_file) const;
+    std::string exportRulesToJSONString() const;
     
     // 统计
     size_t getRuleCount() const { return rules.size(); }
     std::map<std::string, int> getCategoryStatistics() const;
     
+    // 每次修改规则后递增, 编译索引据此判断是否过期
+    uint64_t getGeneration() const { return generation; }
+    
 private:
     std::map<std::string, OptimizationRule> rules;
     std::map<std::string, std::vector<std::string>> category_index;  // 分类索引
+    std::map<std::string, std::vector<std::string>> pattern_index;   // pattern_id -> 规则ID
+    std::vector<RulePackInfo> packs;
+    uint64_t generation = 0;
+    
+    // 编译 rule 各目标模板到 compiled; 失败时 error 给出规则、目标与原因
+    static bool compileTemplates(OptimizationRule& rule, std::string* error);
+    // 插入已编译的规则并更新索引
+    void insertRule(OptimizationRule rule);
+};
+
+/**
+ * 指令选择用的表达式树模式 (CodePattern::tree_pattern 的解析结果)
+ */
+struct TreePattern {
+    std::string op;                     // 运算名, 叶子为空
+    int leaf = -1;                      // $k
+    std::string literal;                // #v
+    std::vector<TreePattern> children;
+    
+    // 解析 "(op child...)" 形式, 语法错误返回 false
+    static bool parse(const std::string& text, TreePattern& out);
+};
+
+/**
+ * 规则库的只读编译索引 - (源运算, 目标架构) 直接映射到模板
+ *
+ * 规则加载完成后构建一次, 之后只有 const 接口, 可在线程间共享.
+ * 运算名与架构名驻留为稠密ID, 候选按 [运算ID * 架构数 + 架构ID] 平铺存放;
+ * 单运算规则按代价升序, lookup 返回最便宜的一条. 树模式规则预先解析, 按根运算归入 tiles.
+ * 编译期映射表 (intrinsic_mapping_table.h) 的单运算映射: lookup(op, arch) 先经完美哈希查表,
+ * 表项首次命中时才构建其模板; 规则库中与表项相同的导入规则跳过, 同键的其他规则 (如外部规则包) 总是覆盖表项.
+ */
+class CompiledRuleIndex {
+public:
+    static constexpr uint32_t kUnknown = ~0u;
+    
+    struct TemplateHandle {
+        const OptimizationRule* rule = nullptr;
+        const TransformTemplate* target = nullptr;
+        const std::string* return_type = nullptr;   // performance_hints 中的 return_type, 没有时为空
+        const CodeTemplate* code = nullptr;
+        int cost = 0;
+        explicit operator bool() const { return target != nullptr; }
+    };
+    struct Tile {
+        TemplateHandle handle;
+        TreePattern tree;
+    };
+    
+    // 按 categories 的顺序收录规则; 同代价时先收录者优先
+    static std::shared_ptr<const CompiledRuleIndex> build(RuleDatabase& db, const std::vector<std::string>& categories);
+    
+    uint32_t operationId(const std::string& op_name) const;
+    uint32_t architectureId(const std::string& arch) const;
+    TemplateHandle lookup(uint32_t op_id, uint32_t arch_id) const;
+    TemplateHandle lookup(const std::string& op_name, const std::string& arch) const;
+    const std::vector<TemplateHandle>& candidates(uint32_t op_id, uint32_t arch_id) const;
+    const std::vector<Tile>& tiles(uint32_t op_id, uint32_t arch_id) const;
+    
+    uint64_t getGeneration() const { return generation; }
+    
+private:
+    std::unordered_map<std::string, uint32_t> operation_ids;
+    std::unordered_map<std::string, uint32_t> architecture_ids;
+    std::vector<std::vector<TemplateHandle>> singles;   // [op * arch_count + arch]
+    std::vector<std::vector<Tile>> fused;
+    std::vector<TemplateHandle> overrides;              // [映射表下标], 规则库中同键最便宜的非表项单运算规则
+    uint64_t generation = 0;
+    
+    size_t slot(uint32_t op_id, uint32_t arch_id) const;
+    // 映射表项的模板, 进程内首次使用时构建, 之后只读
+    static const TemplateHandle& mappingHandle(const IntrinsicMapping& mapping);
+};
+
+/**
+ * 规则快照 - 规则库与其编译索引, 发布后只读
+ */
+struct RuleSnapshot {
+    std::shared_ptr<RuleDatabase> db;
+    std::shared_ptr<const CompiledRuleIndex> index;
+    uint64_t version = 0;               // 每次成功重载递增
+};
+
+/**
+ * 规则注册表 - 内置规则加规则文件, 支持长驻进程中的热重载
+ *
+ * reload 在旁路构建完整的新快照, 成功后原子替换; 任一文件出错则保留旧快照.
+ * 正在进行的翻译持有 current() 返回的 shared_ptr, 替换后仍使用旧快照直到释放.
+ */
+class RuleRegistry {
+public:
+    using Populate = std::function<void(RuleDatabase&)>;
+    
+    RuleRegistry(Populate builtin, std::vector<std::string> categories);
+    
+    void addRuleFile(const std::string& path);
+    const std::vector<std::string>& getRuleFiles() const { return files; }
+    
+    std::shared_ptr<const RuleSnapshot> current() const;
+    
+    // 重新构建快照; 失败 (含加载中抛出异常) 时保留旧快照, error 为首个出错文件的信息, 为空时输出到 stderr
+    bool reload(std::string* error = nullptr);
+    // 规则文件的修改时间或大小变化时重载, 未变化返回 false
+    bool reloadIfChanged(std::string* error = nullptr);
+    
+private:
+    Populate builtin;
+    std::vector<std::string> categories;
+    std::vector<std::string> files;
+    std::vector<std::pair<int64_t, uintmax_t>> stamps;  // 上次加载时各文件的 (mtime, size)
+    std::shared_ptr<const RuleSnapshot> snapshot;       // 经 std::atomic_load/atomic_store 访问
+    uint64_t version = 0;
+    mutable std::mutex reload_mutex;
+    
+    std::vector<std::pair<int64_t, uintmax_t>> currentStamps() const;
+};
+
+/**
+ * 模式匹配结果 - 模式节点到 AOD 图节点的绑定
+ */
+struct PatternMatch {
+    const OptimizationRule* rule = nullptr;
+    const CodePattern* pattern = nullptr;
+    std::shared_ptr<AODNode> root;                                  // 经操作码索引选出的锚点
+    std::vector<std::shared_ptr<AODNode>> nodes;                    // 按模式节点顺序
+    std::map<std::string, std::shared_ptr<AODNode>> bindings;       // 模式节点标签 -> 图节点
 };
 
 /**
  * 模式匹配器 - 在CPG/AOD图中查找匹配的模式
+ *
+ * CodePattern 编译为小型模式图:
+ *   required_operations 每项一个节点 (标签为操作名), required_node_types 依次并入尚无类型约束的操作节点,
+ *   data_dependencies 的 (from, to) 为数据边, 端点按标签引用上述节点, 未知标签为通配节点 (如 input_0);
+ *   constraints 中 "标签.属性" 约束对应节点, 无标签前缀时约束锚点; control_structures 含 for/while/loop 时锚点须在循环内.
+ * 匹配按 VF2 方式沿模式边逐点扩展, 候选只取已匹配邻居的数据边邻接点; 锚点候选来自整图只建一次的操作码索引.
  */
 class PatternMatcher {
 public:
     PatternMatcher(RuleDatabase* db) : rule_db(db) {}
     
-    // 在CPG中匹配模式
-    std::vector<std::pair<CodePattern*, void*>> matchInCPG(
-        void* cpg_graph,
+    // 在AOD图中匹配 category 下全部规则 (空串为全部规则), 每个锚点每条规则至多一个匹配
+    std::vector<PatternMatch> matchInAOD(
+        const AODGraph& aod_graph,
         const std::string& category = "");
     
-    // 在AOD图中匹配模式
-    std::vector<std::pair<CodePattern*, void*>> matchInAOD(
-        void* aod_graph,
-        const std::string& category = "");
+    // 检查单个模式是否以 root 为锚点匹配
+    bool checkPatternMatch(const CodePattern& pattern, const AODGraph& graph, const std::shared_ptr<AODNode>& root);
     
-    // 检查单个模式是否匹配
-    bool checkPatternMatch(const CodePattern& pattern, void* graph_node);
-    
-    // 提取匹配的子图
-    void* extractSubgraph(void* graph, void* match_location);
+    // 提取匹配的子图 (共享原图节点)
+    std::shared_ptr<AODGraph> extractSubgraph(const AODGraph& graph, const PatternMatch& match);
     
 private:
     RuleDatabase* rule_db;
     
     // 辅助函数
-    bool matchNodeTypes(const std::vector<std::string>& required, void* graph);
-    bool matchDataDependencies(const std::vector<std::pair<std::string, std::string>>& deps, void* graph);
+    bool matchNodeTypes(const std::vector<std::string>& required, const AODGraph& graph);
+    bool matchDataDependencies(const std::vector<std::pair<std::string, std::string>>& deps, const AODGraph& graph);
+};
+
+/**
+ * 指令选择结果 - 以某条规则的目标模板覆盖一个表达式根 (tile)
+ */
+struct TileSelection {
+    const OptimizationRule* rule = nullptr;
+    const TransformTemplate* target = nullptr;
+    std::shared_ptr<AODNode> root;
+    std::vector<std::shared_ptr<AODNode>> covered;          // 被 tile 吸收的内部节点 (不含根与叶子)
+    std::map<int, std::shared_ptr<AODNode>> leaf_nodes;     // $k -> 图节点
+    std::map<int, std::string> leaf_texts;                  // $k -> 无图节点的立即数/源码文本
+    int tile_cost = 0;
+    int total_cost = 0;                                     // 含叶子表达式子树的最优代价
+};
+
+/**
+ * 指令选择器 - 用目标模板平铺 AOD 数据流 DAG
+ *
+ * 自底向上动态规划 (BURS 式): 每个表达式节点取所有以它为根、可匹配的 tile 中
+ * tile 代价 + 叶子子树最优代价之和最小者. 被多处使用的节点只能作为 tile 的根或叶子,
+ * 避免共享子表达式被重复计算. 语句节点与常量节点是叶子, 代价为 0.
+ */
+class InstructionSelector {
+public:
+    InstructionSelector(RuleDatabase* db, const std::string& target_arch);
+    InstructionSelector(std::shared_ptr<const CompiledRuleIndex> index, const std::string& target_arch);
+    
+    // 节点ID -> 选中的 tile, 只包含存在可用规则的表达式节点
+    std::map<int, TileSelection> select(const AODGraph& graph);
+    
+    // 规则在目标架构上的代价: 模板显式给出, 或按源模式各运算的延迟之和估计
+    static int templateCost(const OptimizationRule& rule, const TransformTemplate& tmpl,
+                            const std::string& target_arch, const std::string& value_type = "");
+    
+private:
+    std::shared_ptr<const CompiledRuleIndex> index;
+    std::string target_arch;
 };
 
 /**
@@ -182,16 +426,10 @@ public:
         const TransformTemplate& tmpl,
         const std::map<std::string, std::string>& bindings);
     
-    // 应用优化规则
+    // 应用优化规则, 以匹配结果绑定占位符: 模式标签 -> 变量名/算子名, input_N -> 锚点的第 N 个操作数
     std::string applyRule(
         const OptimizationRule& rule,
-        void* matched_subgraph,
-        const std::string& target_arch);
-    
-    // 批量应用规则
-    std::string applyRules(
-        const std::vector<OptimizationRule*>& rules,
-        void* graph,
+        const PatternMatch& match,
         const std::string& target_arch);
     
     // 格式化代码
@@ -218,9 +456,9 @@ public:
     OptimizationPipeline(RuleDatabase* db) 
         : rule_db(db), matcher(db), generator() {}
     
-    // 运行优化管道
+    // 运行优化管道: 在 AOD 图上按类别 (空串为全部规则) 匹配规则并生成目标代码
     std::string runOptimization(
-        void* input_graph,          // CPG或AOD图
+        const AODGraph& graph,
         const std::string& target_arch,
         const std::vector<std::string>& enabled_categories);
     
@@ -15,6 +15,7 @@
 #include <vector>
 #include <sstream>
 #include <memory>
+#include <iostream>
 
 namespace aodsolve {
 
@@ -244,6 +245,7 @@ std::map<std::string, std::string> RuleDrivenCodeGenerator::extractLoopBindings(
     }
     
     // 分析循环体,提取数组访问
+    std::string element_type;
     if (auto* body = loop->getBody()) {
         class ArrayAccessExtractor : public clang::RecursiveASTVisitor<ArrayAccessExtractor> {
         public:
@@ -251,6 +253,9 @@ std::map<std::string, std::string> RuleDrivenCodeGenerator::extractLoopBindings(
             const std::string& loop_var;
             int input_count = 0;
             int output_count = 0;
+            // 被访问数组的元素类型, 写入的数组优先
+            clang::QualType input_type;
+            clang::QualType output_type;
             
             ArrayAccessExtractor(std::map<std::string, std::string>& b, const std::string& lv)
                 : bindings(b), loop_var(lv) {}
@@ -268,6 +273,7 @@ std::map<std::string, std::string> RuleDrivenCodeGenerator::extractLoopBindings(
                             // 这是顺序访问
                             std::string key = "{{input_" + std::to_string(input_count++) + "}}";
                             bindings[key] = array_name;
+                            if (input_type.isNull()) input_type = access->getType();
                         }
                     }
                 }
@@ -282,6 +288,7 @@ std::map<std::string, std::string> RuleDrivenCodeGenerator::extractLoopBindings(
                         if (auto* base = clang::dyn_cast<clang::DeclRefExpr>(
                                 array_access->getBase()->IgnoreImpCasts())) {
                             bindings["{{output}}"] = base->getDecl()->getNameAsString();
+                            output_type = array_access->getType();
                         }
                     }
                 }
@@ -291,16 +298,28 @@ std::map<std::string, std::string> RuleDrivenCodeGenerator::extractLoopBindings(
         
         ArrayAccessExtractor extractor(bindings, bindings["{{loop_var}}"]);
         extractor.TraverseStmt(const_cast<clang::Stmt*>(body));
+        element_type = inferElementType(!extractor.output_type.isNull() ? extractor.output_type : extractor.input_type);
     }
     
-    // 推断元素类型
-    // 这里需要从数组访问的类型推断
-    bindings["{{element_type}}"] = "f32";  // 默认,应该从AST推断
-    bindings["{{width}}"] = "b32";
+    // 元素类型取自数组访问的 QualType; 没有可识别的数组访问时按 f32
+    if (element_type.empty()) element_type = "f32";
+    bindings["{{element_type}}"] = element_type;
+    bindings["{{suffix}}"] = element_type;
+    bindings["{{neon_type}}"] = inferNEONType(element_type);
+    bindings["{{width}}"] = "b" + std::to_string(elementTypeBits(element_type));
     
     return bindings;
 }
 
+std::string RuleDrivenCodeGenerator::inferElementType(const clang::QualType& type) {
+    if (type.isNull() || !ast_context_) return "";
+    return EnhancedCPGToAODConverter::elementTypeOf(type, *ast_context_);
+}
+
+std::string RuleDrivenCodeGenerator::inferNEONType(const std::string& element_type) {
+    return vectorTypeName("NEON", element_type);
+}
+
 // ============================================================================
 // 实现: 识别循环模式
 // ============================================================================
@@ -364,36 +383,32 @@ std::string RuleDrivenCodeGenerator::applyRuleTemplate(
     const TransformTemplate& tmpl,
     const std::map<std::string, std::string>& bindings) {
     
-    std::string code = tmpl.code_template;
-    
-    // 替换所有占位符
-    code = replacePlaceholders(code, bindings);
-    
-    return code;
+    // 规则加载时已预编译的模板直接单遍展开
+    if (!tmpl.compiled) return replacePlaceholders(tmpl.code_template, bindings);
+    std::map<std::string, std::string> named;
+    for (const auto& [placeholder, value] : bindings) {
+        bool braced = placeholder.size() > 4 && placeholder.compare(0, 2, "{{") == 0 &&
+                      placeholder.compare(placeholder.size() - 2, 2, "}}") == 0;
+        named[braced ? placeholder.substr(2, placeholder.size() - 4) : placeholder] = value;
+    }
+    return tmpl.compiled->expand(named);
 }
 
 std::string RuleDrivenCodeGenerator::replacePlaceholders(
     const std::string& template_str,
     const std::map<std::string, std::string>& bindings) {
     
-    std::string result = template_str;
-    
-    // 按长度排序,先替换长的占位符
-    std::vector<std::pair<std::string, std::string>> sorted_bindings(
-        bindings.begin(), bindings.end());
-    
-    std::sort(sorted_bindings.begin(), sorted_bindings.end(),
-        [](const auto& a, const auto& b) { return a.first.length() > b.first.length(); });
-    
-    for (const auto& [placeholder, value] : sorted_bindings) {
-        size_t pos = 0;
-        while ((pos = result.find(placeholder, pos)) != std::string::npos) {
-            result.replace(pos, placeholder.length(), value);
-            pos += value.length();
-        }
+    CodeTemplate compiled;
+    std::string error;
+    if (!CodeTemplate::compile(template_str, compiled, &error)) {
+        std::cerr << "Error: bad code template: " << error << std::endl;
+        return template_str;
     }
     
-    return result;
+    // 绑定键带花括号 ({{name}}), 按名字展开时去掉
+    TransformTemplate tmpl;
+    tmpl.compiled = std::make_shared<CodeTemplate>(std::move(compiled));
+    return applyRuleTemplate(tmpl, bindings);
 }
 
 // ============================================================================
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "optimization_rule_system.h"
+#include "intrinsic_mapping_table.h"
 
 namespace aodsolve {
 
@@ -10,143 +11,70 @@ public:
     SIMDInstructionRuleBuilder(RuleDatabase* db) : rule_db(db) {}
 
     void buildAllRules() {
-        // ==========================================
-        // AVX2 -> SVE Rules
-        // ==========================================
-        {
-            OptimizationRule rule;
-            rule.rule_id = "avx2_set1_epi8";
-            rule.category = "simd_instruction";
-            rule.source_pattern.required_operations = {"_mm256_set1_epi8"};
-
-            TransformTemplate sve;
-            sve.target_architecture = "SVE";
-            sve.code_template = "svdup_s8({{input_0}})";
-            sve.performance_hints["return_type"] = "svint8_t";
-            rule.target_templates["SVE"] = sve;
-            rule_db->addRule(rule);
-        }
-        {
-            OptimizationRule rule;
-            rule.rule_id = "avx2_loadu_si256";
-            rule.category = "simd_instruction";
-            rule.source_pattern.required_operations = {"_mm256_loadu_si256"};
-
-            TransformTemplate sve;
-            sve.target_architecture = "SVE";
-            sve.code_template = "svld1_s8(pg, (const int8_t*){{input_0}})";
-            sve.performance_hints["return_type"] = "svint8_t";
-            rule.target_templates["SVE"] = sve;
-            rule_db->addRule(rule);
-        }
-        {
-            OptimizationRule rule;
-            rule.rule_id = "avx2_storeu_si256";
-            rule.category = "simd_instruction";
-            rule.source_pattern.required_operations = {"_mm256_storeu_si256"};
-
-            TransformTemplate sve;
-            sve.target_architecture = "SVE";
-            sve.code_template = "svst1_s8(pg, (int8_t*){{input_0}}, {{input_1}})";
-            sve.performance_hints["return_type"] = "void";
-            rule.target_templates["SVE"] = sve;
-            rule_db->addRule(rule);
-        }
-        {
-            OptimizationRule rule;
-            rule.rule_id = "avx2_cmpgt_epi8";
-            rule.category = "simd_instruction";
-            rule.source_pattern.required_operations = {"_mm256_cmpgt_epi8"};
-
-            TransformTemplate sve;
-            sve.target_architecture = "SVE";
-            sve.code_template = "svcmpgt_s8(pg, {{input_0}}, {{input_1}})";
-            sve.performance_hints["return_type"] = "svbool_t";
-            rule.target_templates["SVE"] = sve;
-            rule_db->addRule(rule);
-        }
-        {
-            OptimizationRule rule;
-            rule.rule_id = "avx2_and_si256";
-            rule.category = "simd_instruction";
-            rule.source_pattern.required_operations = {"_mm256_and_si256"};
-
-            TransformTemplate sve;
-            sve.target_architecture = "SVE";
-            sve.code_template = "svand_s8_z(pg, {{input_0}}, {{input_1}})";
-            sve.performance_hints["return_type"] = "svint8_t";
-            rule.target_templates["SVE"] = sve;
-            rule_db->addRule(rule);
-        }
-        {
-            OptimizationRule rule;
-            rule.rule_id = "avx2_add_epi8";
-            rule.category = "simd_instruction";
-            rule.source_pattern.required_operations = {"_mm256_add_epi8"};
-
-            TransformTemplate sve;
-            sve.target_architecture = "SVE";
-            sve.code_template = "svadd_s8_z(pg, {{input_0}}, {{input_1}})";
-            sve.performance_hints["return_type"] = "svint8_t";
-            rule.target_templates["SVE"] = sve;
-            rule_db->addRule(rule);
-        }
-
-        // ==========================================
-        // Scalar -> NEON Rules (Auto-Vectorization Ops)
-        // ==========================================
-        {
-            OptimizationRule rule;
-            rule.rule_id = "scalar_add_float";
-            rule.category = "simd_instruction"; // 统一 Category 方便查找
-            rule.source_pattern.required_operations = {"+"};
+        buildIntrinsicMappingRules();
+        buildFusedRules();
+    }
 
-            TransformTemplate neon;
-            neon.target_architecture = "NEON";
-            neon.code_template = "vaddq_f32({{input_0}}, {{input_1}})";
-            neon.performance_hints["return_type"] = "float32x4_t";
-            rule.target_templates["NEON"] = neon;
-            rule_db->addRule(rule);
+    // 把编译期映射表 (intrinsic_mapping_table.h) 导入规则库, 同 rule_id 的多个目标合并为一条规则;
+    // 供按分类查询、模式匹配与导出使用, 翻译时 CompiledRuleIndex::lookup 仍直接查表
+    void buildIntrinsicMappingRules() {
+        std::map<std::string_view, OptimizationRule> rules;
+        for (const auto& mapping : kIntrinsicMappings) {
+            OptimizationRule& rule = rules[mapping.rule_id];
+            if (rule.rule_id.empty()) {
+                rule.rule_id = std::string(mapping.rule_id);
+                rule.category = "simd_instruction"; // 标量规则也归入此类, 统一 Category 方便查找
+                rule.source_pattern.required_operations = {std::string(mapping.source)};
+            }
+
+            TransformTemplate& target = rule.target_templates[std::string(mapping.target_arch)];
+            target.target_architecture = std::string(mapping.target_arch);
+            target.code_template = std::string(mapping.code);
+            target.cost = mapping.cost;
+            target.performance_hints["return_type"] = std::string(mapping.return_type);
+            target.performance_hints["element_type"] = std::string(mapping.element_type);
+            target.performance_hints["operands"] = std::string(mapping.operands);
         }
-        {
-            OptimizationRule rule;
-            rule.rule_id = "scalar_sub_float";
-            rule.category = "simd_instruction";
-            rule.source_pattern.required_operations = {"-"};
+        for (const auto& [rule_id, rule] : rules) rule_db->addRule(rule);
+    }
 
-            TransformTemplate neon;
-            neon.target_architecture = "NEON";
-            neon.code_template = "vsubq_f32({{input_0}}, {{input_1}})";
-            neon.performance_hints["return_type"] = "float32x4_t";
-            rule.target_templates["NEON"] = neon;
-            rule_db->addRule(rule);
+    // 多节点 tile (InstructionSelector): 若干源运算合并为一条目标指令, 代价取 Neoverse V1 延迟
+    // 掩码与加减合并为谓词化的 _m 形式, 比较结果直接作谓词, 省去 svsel 物化与 and
+    void buildFusedRules() {
+        const std::string cmp1 = "(_mm256_cmpgt_epi8 $1 $2)", cmp2 = "(_mm256_cmpgt_epi8 $3 $4)";
+        const std::string pred1 = "svcmpgt_s8(pg, {{input_1}}, {{input_2}})";
+        const std::string pred2 = "svand_b_z(pg, " + pred1 + ", svcmpgt_s8(pg, {{input_3}}, {{input_4}}))";
+        for (const std::string op : {"add", "sub"}) {
+            std::string src = "_mm256_" + op + "_epi8";
+            addSVETile("sve_masked_" + op + "_s8", "(" + src + " $0 (_mm256_and_si256 " + cmp1 + " $3))",
+                       "sv" + op + "_s8_m(" + pred1 + ", {{input_0}}, {{input_3}})", "svint8_t", 5);
+            addSVETile("sve_range_masked_" + op + "_s8",
+                       "(" + src + " $0 (_mm256_and_si256 (_mm256_and_si256 " + cmp1 + " " + cmp2 + ") $5))",
+                       "sv" + op + "_s8_m(" + pred2 + ", {{input_0}}, {{input_5}})", "svint8_t", 10);
         }
-        {
-            OptimizationRule rule;
-            rule.rule_id = "scalar_load_float";
-            rule.category = "simd_instruction";
-            rule.source_pattern.required_operations = {"load_float"};
+        addSVETile("sve_not_s8", "(_mm256_xor_si256 $0 #-1)", "svnot_s8_z(pg, {{input_0}})", "svint8_t", 2);
 
-            TransformTemplate neon;
-            neon.target_architecture = "NEON";
-            neon.code_template = "vld1q_f32((const float*){{input_0}})";
-            neon.performance_hints["return_type"] = "float32x4_t";
-            rule.target_templates["NEON"] = neon;
-            rule_db->addRule(rule);
+        for (int width : {16, 32}) {
+            std::string w = std::to_string(width), s = "s" + w, type = "svint" + w + "_t";
+            addSVETile("sve_mla_" + s, "(_mm256_add_epi" + w + " $0 (_mm256_mullo_epi" + w + " $1 $2))",
+                       "svmla_" + s + "_z(pg, {{input_0}}, {{input_1}}, {{input_2}})", type, 4);
         }
-        {
-            OptimizationRule rule;
-            rule.rule_id = "scalar_store_float";
-            rule.category = "simd_instruction";
-            rule.source_pattern.required_operations = {"store_float"};
+    }
 
-            TransformTemplate neon;
-            neon.target_architecture = "NEON";
-            neon.code_template = "vst1q_f32((float*){{input_0}}, {{input_1}})";
-            neon.performance_hints["return_type"] = "void";
-            rule.target_templates["NEON"] = neon;
-            rule_db->addRule(rule);
-        }
+    void addSVETile(const std::string& rule_id, const std::string& tree, const std::string& code,
+                    const std::string& return_type, int cost) {
+        OptimizationRule rule;
+        rule.rule_id = rule_id;
+        rule.category = "simd_instruction";
+        rule.source_pattern.tree_pattern = tree;
+
+        TransformTemplate sve;
+        sve.target_architecture = "SVE";
+        sve.code_template = code;
+        sve.cost = cost;
+        sve.performance_hints["return_type"] = return_type;
+        rule.target_templates["SVE"] = sve;
+        rule_db->addRule(rule);
     }
 };
 
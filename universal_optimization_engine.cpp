@@ -16,8 +16,10 @@ namespace aodsolve {
 class UniversalOptimizationEngine {
 public:
     UniversalOptimizationEngine() : pipeline(&rule_db) { initializeRules(); }
-    std::string optimize(void* cpg_graph, void* aod_graph, const std::string& target_arch);
-    std::string optimizeWithCategories(void* cpg_graph, void* aod_graph, const std::string& target_arch, const std::vector<std::string>& categories);
+    // 在转换后的 AOD 图上应用全部规则
+    std::string optimize(const AODGraph& aod_graph, const std::string& target_arch);
+    // categories 中 "all" 表示全部类别
+    std::string optimizeWithCategories(const AODGraph& aod_graph, const std::string& target_arch, const std::vector<std::string>& categories);
 
 private:
     RuleDatabase rule_db;
@@ -26,18 +28,19 @@ private:
 };
 
 void UniversalOptimizationEngine::initializeRules() {
-    // Rule initialization logic...
+    SIMDInstructionRuleBuilder(&rule_db).buildAllRules();
+    FunctionInlineRuleBuilder(&rule_db).buildAllRules();
 }
 
-std::string UniversalOptimizationEngine::optimize(void* cpg_graph, void* aod_graph, const std::string& target_arch) {
-    return optimizeWithCategories(cpg_graph, aod_graph, target_arch, {"all"});
+std::string UniversalOptimizationEngine::optimize(const AODGraph& aod_graph, const std::string& target_arch) {
+    return optimizeWithCategories(aod_graph, target_arch, {"all"});
 }
 
-std::string UniversalOptimizationEngine::optimizeWithCategories(void* cpg_graph, void* , const std::string& target_arch, const std::vector<std::string>& categories) {
-    std::stringstream optimized_code;
-    std::string result = pipeline.runOptimization(cpg_graph, target_arch, categories);
-    optimized_code << result;
-    return optimized_code.str();
+std::string UniversalOptimizationEngine::optimizeWithCategories(const AODGraph& aod_graph, const std::string& target_arch, const std::vector<std::string>& categories) {
+    // 管道按类别查询规则, 空串匹配全部规则
+    std::vector<std::string> queried;
+    for (const auto& category : categories) queried.push_back(category == "all" ? "" : category);
+    return pipeline.runOptimization(aod_graph, target_arch, queried);
 }
 
 // ============================================================================
@@ -46,39 +49,44 @@ std::string UniversalOptimizationEngine::optimizeWithCategories(void* cpg_graph,
 
 class CPGBasedVectorizationOptimizer {
 public:
-    // 修复：移除了未使用的 ast_context 参数名，消除警告
-    CPGBasedVectorizationOptimizer(clang::ASTContext* , IntegratedCPGAnalyzer* cpg_analyzer)
-        : cpg_analyzer_(cpg_analyzer) {}
+    CPGBasedVectorizationOptimizer(clang::ASTContext* ast_context, IntegratedCPGAnalyzer* cpg_analyzer)
+        : ast_context_(ast_context), cpg_analyzer_(cpg_analyzer) {}
 
     std::string optimizeFunction(const clang::FunctionDecl* func, const std::string& target_arch);
-    void* buildCPGForFunction(const clang::FunctionDecl* func);
-    void* buildAODForFunction(const clang::FunctionDecl* func);
+    // 先做 CPG 分析, 再转换为 AOD 图; 失败时返回空指针并给出原因
+    std::shared_ptr<AODGraph> buildAODForFunction(const clang::FunctionDecl* func, const std::string& target_arch, std::string* error = nullptr);
 
 private:
+    clang::ASTContext* ast_context_;
     IntegratedCPGAnalyzer* cpg_analyzer_;
-    // 修复：移除了未使用的 ast_context_ 成员变量
 };
 
 std::string CPGBasedVectorizationOptimizer::optimizeFunction(const clang::FunctionDecl* func, const std::string& target_arch) {
     if (!func || !func->hasBody()) return "// Error: Invalid function\n";
+    std::string error;
+    auto aod = buildAODForFunction(func, target_arch, &error);
+    if (!aod) return "// Error: " + error + "\n";
+
     std::stringstream code;
     code << "// Optimized version for " << target_arch << "\n";
-    void* cpg = buildCPGForFunction(func);
-    (void)cpg;
-    void* aod = buildAODForFunction(func);
-    (void)aod;
-
     UniversalOptimizationEngine engine;
+    code << engine.optimize(*aod, target_arch);
     return code.str();
 }
 
-void* CPGBasedVectorizationOptimizer::buildCPGForFunction(const clang::FunctionDecl*) {
-    if (cpg_analyzer_) return const_cast<cpg::CPGContext*>(&cpg_analyzer_->getCPGContext());
-    return nullptr;
-}
-
-void* CPGBasedVectorizationOptimizer::buildAODForFunction(const clang::FunctionDecl*) {
-    return nullptr;
+std::shared_ptr<AODGraph> CPGBasedVectorizationOptimizer::buildAODForFunction(const clang::FunctionDecl* func, const std::string& target_arch, std::string* error) {
+    if (!ast_context_ || !cpg_analyzer_) {
+        if (error) *error = "no AST context or CPG analyzer";
+        return nullptr;
+    }
+    cpg_analyzer_->analyzeFunctionWithCPG(func);
+    EnhancedCPGToAODConverter converter(*ast_context_, *cpg_analyzer_);
+    auto result = converter.convertWithOperators(func, "AVX2", target_arch);
+    if (!result.successful || !result.aod_graph) {
+        if (error) *error = result.error_message.empty() ? "AOD conversion failed" : result.error_message;
+        return nullptr;
+    }
+    return result.aod_graph;
 }
 
 } // namespace aodsolve